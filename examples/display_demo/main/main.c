@@ -10,8 +10,10 @@
  * @details Four-tab LVGL UI demonstrating backlight control, USB file browser, optional AHT30 sensor data, and display sleep/wake.
  *
  * Four-tab LVGL UI:
- *  - Backlight  : Interactive slider to control PWM backlight brightness
- *  - USB        : File browser — lists files/directories from an inserted USB drive
+ *  - Backlight  : Interactive slider to control PWM backlight brightness, on a static
+ *                 card layout served from the BSP background cache (toggle + render time)
+ *  - USB        : File browser — lists files/directories from an inserted USB drive, sorted, in a
+ *                 BSP virtual list, so thousands of entries cost only the visible rows
  *  - Sensor     : Live temperature & humidity from the optional Panda Sense (AHT30)
  *                 Gracefully shows "not connected" when the module is absent
  *  - Sleep      : One-button test of bsp_display_enter_sleep / bsp_display_exit_sleep
@@ -20,56 +22,56 @@
  *  - LVGL task (no affinity): drives lv_timer_handler; never blocks on I/O
  *                             LVGL heap routed to PSRAM so large sub-layer buffers can be
  *                             allocated without exhausting the small internal SRAM heap.
- *  - msc_app_task (CPU0, p5): USB mount/unmount; reads dir BEFORE taking LVGL lock
- *  - sensor_task (CPU0, p4) : reads AHT30 every 2 s; posts results to s_sensor_queue
- *  - LVGL sensor timer      : drains s_sensor_queue; zero blocking I2C inside LVGL task
+ *  - msc_app_task (CPU0, p5): USB mount/unmount; only posts to the LVGL task
+ *  - BSP file service task : lists /usb into the BSP directory index, or reads the index
+ *                             cached on the drive; posts each batch to the LVGL task
+ *  - BSP sensor hub task   : runs the AHT30 state machine every 2 s and sleeps through its
+ *                             conversions; an LVGL timer reads the newest sample from the
+ *                             lock-free sample ring, never waiting for the sensor
  */
 
 #include <stdio.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
-#include <dirent.h>
+#include <errno.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
 #include "esp_log.h"
-#include "driver/i2c_master.h"
 
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "bsp/esp-bsp.h"
-#include "aht30.h"
 
 static const char *TAG = "demo";
 
 /* ── AHT30 on external I2C header (I2C1 / GPIO3+4) ─────────────────────── */
-static i2c_master_bus_handle_t s_ext_i2c    = NULL;
-static aht30_handle_t          s_aht30      = NULL;
+#define SENSOR_PERIOD_MS   2000
+static bsp_sensor_t           *s_sensor     = NULL;
 static bool                    s_sensor_ok  = false;
-
-/* Sensor reading passed from sensor_task → LVGL timer via queue (depth=1) */
-typedef struct {
-    float temp;
-    float hum;
-    bool  ok;
-} sensor_reading_t;
-static QueueHandle_t s_sensor_queue = NULL;
-
-/* ── USB file list snapshot (read outside LVGL lock) ───────────────────── */
-#define USB_MAX_FILES  32
-#define USB_NAME_MAX   256
-
-typedef struct {
-    char     name[USB_NAME_MAX];
-    uint8_t  is_dir;
-} usb_entry_t;
-
-typedef struct {
-    usb_entry_t entries[USB_MAX_FILES];
-    int         count;
-    bool        open_ok;
-    bool        mounted;
-} usb_snapshot_t;
+static uint32_t                s_sensor_seq = UINT32_MAX;   /* sample shown */
+static bool                    s_sensor_err = false;        /* read error shown */
+
+/* Temperature history: 34 min of 2 s samples, then averages of 8, 64 and 512 of them (12 days), in PSRAM */
+#define HISTORY_CAPACITY   1024
+#define HISTORY_LEVELS     4
+#define HISTORY_FACTOR     8
+#define HISTORY_SPAN_S     (30 * 60)
+#define HISTORY_POINTS     300                                  /* one every 6 s */
+static bsp_sensor_series_t     s_history;
+static bool                    s_history_ok = false;
+
+/* ── USB directory (sorted and cached by the BSP, see bsp_usb_dir_open) ─── */
+#define USB_ROW_HEIGHT 40
+
+/* Directory shown by the virtual list; only opened, closed and read in the LVGL task */
+static bsp_usb_dir_handle_t s_usb_dir       = NULL;
+static uint32_t             s_usb_dir_gen   = 0;        /* mount it was opened for */
+static bool                 s_usb_open_err  = false;
+static bool                 s_usb_logged    = false;    /* time to the complete list logged */
+static int64_t              s_usb_open_us   = 0;
+static volatile uint32_t    s_usb_mount_gen = 0;        /* counts mounts, written by msc_app_task */
 
 /* ── LVGL widget refs (set during ui_create, used in callbacks) ─────────── */
 static lv_obj_t *s_brightness_label = NULL;
@@ -79,6 +81,14 @@ static lv_obj_t *s_temp_label       = NULL;
 static lv_obj_t *s_hum_label        = NULL;
 static lv_obj_t *s_sleep_btn        = NULL;
 static lv_obj_t *s_sleep_label      = NULL;
+static lv_obj_t *s_bg_cache         = NULL;
+static lv_obj_t *s_cache_switch     = NULL;
+static lv_obj_t *s_render_label     = NULL;
+
+/* Render time accumulated between LV_EVENT_RENDER_START / LV_EVENT_RENDER_READY */
+static int64_t   s_render_start_us  = 0;
+static int64_t   s_render_total_us  = 0;
+static uint32_t  s_render_frames    = 0;
 
 /* ── Colour palette ─────────────────────────────────────────────────────── */
 #define COL_BG        lv_color_hex(0x1a1a2e)
@@ -96,145 +106,141 @@ static lv_obj_t *s_sleep_label      = NULL;
  * ════════════════════════════════════════════════════════════════════════════ */
 static void sensor_init(void)
 {
-    const i2c_master_bus_config_t bus_cfg = {
-        .i2c_port                     = BSP_EXT_I2C_NUM,
-        .sda_io_num                   = BSP_EXT_I2C_SDA,
-        .scl_io_num                   = BSP_EXT_I2C_SCL,
-        .clk_source                   = I2C_CLK_SRC_DEFAULT,
-        .glitch_ignore_cnt            = 7,
-        .flags.enable_internal_pullup = true,
-    };
-
-    if (i2c_new_master_bus(&bus_cfg, &s_ext_i2c) != ESP_OK) {
-        ESP_LOGW(TAG, "Ext I2C bus init failed — AHT30 unavailable");
+    if (bsp_ext_i2c_probe(BSP_SENSOR_AHT30_ADDR) != ESP_OK) {
+        ESP_LOGW(TAG, "AHT30 not found on I2C1 — sensor tab will show N/A");
         return;
     }
 
-    if (aht30_create(s_ext_i2c, AHT30_I2C_ADDRESS, &s_aht30) != ESP_OK) {
-        ESP_LOGW(TAG, "AHT30 not found on I2C1 — sensor tab will show N/A");
-        i2c_del_master_bus(s_ext_i2c);
-        s_ext_i2c = NULL;
+    /* Run by the BSP sensor hub; other expansion sensors can share the bus and the task */
+    const bsp_ext_i2c_sensor_config_t cfg = {
+        .driver    = &bsp_sensor_aht30,
+        .dev       = { .name = "aht30", .addr = BSP_SENSOR_AHT30_ADDR },
+        .period_ms = SENSOR_PERIOD_MS,
+    };
+    if (bsp_ext_i2c_sensor_add(&cfg, &s_sensor) != ESP_OK) {
+        ESP_LOGW(TAG, "AHT30 could not be added to the sensor hub");
         return;
     }
 
     s_sensor_ok = true;
     ESP_LOGI(TAG, "AHT30 ready on I2C1 (GPIO%d/GPIO%d)",
              BSP_EXT_I2C_SCL, BSP_EXT_I2C_SDA);
-}
 
-/* ════════════════════════════════════════════════════════════════════════════
- *  Sensor task — runs on CPU1, posts to queue; never touches LVGL
- * ════════════════════════════════════════════════════════════════════════════ */
-static void sensor_task(void *arg)
-{
-    (void)arg;
-    sensor_reading_t reading;
-    while (1) {
-        reading.ok = (aht30_get_temperature_humidity_value(s_aht30,
-                          &reading.temp, &reading.hum) == ESP_OK);
-        xQueueOverwrite(s_sensor_queue, &reading);
-        vTaskDelay(pdMS_TO_TICKS(2000));
+    bsp_sensor_point_t *points = heap_caps_malloc(HISTORY_LEVELS * HISTORY_CAPACITY * sizeof(bsp_sensor_point_t),
+                                                  MALLOC_CAP_SPIRAM);
+    s_history_ok = points && bsp_sensor_series_init(&s_history, points, HISTORY_CAPACITY, HISTORY_LEVELS,
+                                                    HISTORY_FACTOR);
+    if (!s_history_ok) {
+        ESP_LOGW(TAG, "No memory for the temperature history");
     }
 }
 
 /* ════════════════════════════════════════════════════════════════════════════
- *  USB file list — two-phase update
- *
- *  usb_snapshot_read()   : block I/O OUTSIDE the LVGL lock
- *  usb_snapshot_render() : LVGL calls INSIDE the LVGL lock
+ *  USB file list — a BSP directory index
  *
- *  Keeping filesystem I/O outside the LVGL mutex prevents the LVGL task
- *  from starving IDLE0 during USB block reads (root cause of WDT crash).
+ *  The mount callbacks only post to the LVGL task, which opens /usb with
+ *  bsp_usb_dir_open(). The file service lists it in the background into a
+ *  sorted index in PSRAM; every batch of entries posts a refresh, and the
+ *  virtual list reads just its visible rows from the index. On the next
+ *  mount of the same stick the index cached on it is shown at once. Neither
+ *  the MSC task nor the LVGL task waits for the drive.
  * ════════════════════════════════════════════════════════════════════════════ */
-static void usb_snapshot_read(usb_snapshot_t *snap)
-{
-    snap->count   = 0;
-    snap->open_ok = false;
-    snap->mounted = bsp_usb_is_mounted();
-
-    if (!snap->mounted) {
-        return;
-    }
+#define USB_POST_KEY ((uintptr_t)&s_usb_dir)
 
-    DIR *dir = opendir("/usb");
-    if (!dir) {
+/* Virtual list data source: fills a recycled row with entry index */
+static void usb_bind_row(lv_obj_t *row, uint32_t index, void *user_ctx)
+{
+    bsp_usb_dir_entry_t e;
+    if (!s_usb_dir || bsp_usb_dir_read(s_usb_dir, index, 1, &e) != 1) {
+        lv_label_set_text(lv_obj_get_child(row, 0), "");
         return;
     }
-    snap->open_ok = true;
-
-    struct dirent *ent;
-    while ((ent = readdir(dir)) != NULL && snap->count < USB_MAX_FILES) {
-        if (ent->d_name[0] == '.') {
-            continue;
-        }
-        usb_entry_t *e = &snap->entries[snap->count++];
-        strlcpy(e->name, ent->d_name, sizeof(e->name));
-        e->is_dir = (ent->d_type == DT_DIR);
-    }
-    closedir(dir);
+    lv_label_set_text_fmt(lv_obj_get_child(row, 0), "%s  %s", e.is_dir ? LV_SYMBOL_DIRECTORY : LV_SYMBOL_FILE,
+                          e.name);
 }
 
-static void usb_snapshot_render(const usb_snapshot_t *snap)
+static void usb_status(const char *text)
 {
-    lv_obj_clean(s_usb_list);
+    lv_label_set_text(s_usb_status, text);
+    lv_obj_clear_flag(s_usb_status, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_flag(s_usb_list, LV_OBJ_FLAG_HIDDEN);
+    bsp_vlist_set_count(s_usb_list, 0);
+}
 
-    if (!snap->mounted) {
-        lv_label_set_text(s_usb_status, LV_SYMBOL_USB "  No USB drive connected");
-        lv_obj_clear_flag(s_usb_status, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_add_flag(s_usb_list, LV_OBJ_FLAG_HIDDEN);
+static void usb_render(void)
+{
+    if (!s_usb_dir) {
+        usb_status(s_usb_open_err ? LV_SYMBOL_WARNING "  Failed to open /usb" :
+                   LV_SYMBOL_USB "  No USB drive connected");
         return;
     }
 
-    if (!snap->open_ok) {
-        lv_label_set_text(s_usb_status, LV_SYMBOL_WARNING "  Failed to open /usb");
-        lv_obj_clear_flag(s_usb_status, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_add_flag(s_usb_list, LV_OBJ_FLAG_HIDDEN);
-        return;
+    bsp_usb_dir_info_t info;
+    bsp_usb_dir_get_info(s_usb_dir, &info);
+    if (info.complete && !s_usb_logged) {
+        s_usb_logged = true;
+        ESP_LOGI(TAG, "%" PRIu32 " entries of /usb %s in %" PRId64 " ms", info.count,
+                 info.cached ? "from the cached index" : "listed", (esp_timer_get_time() - s_usb_open_us) / 1000);
     }
-
-    if (snap->count == 0) {
-        lv_label_set_text(s_usb_status, LV_SYMBOL_USB "  Drive is empty");
-        lv_obj_clear_flag(s_usb_status, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_add_flag(s_usb_list, LV_OBJ_FLAG_HIDDEN);
+    if (info.count == 0) {
+        usb_status(!info.complete ? LV_SYMBOL_USB "  Reading drive..." :
+                   (info.err && info.err != ECANCELED) ? LV_SYMBOL_WARNING "  Failed to open /usb" :
+                   LV_SYMBOL_USB "  Drive is empty");
         return;
     }
 
-    char line[USB_NAME_MAX + 8];
-    for (int i = 0; i < snap->count; i++) {
-        const char *icon = snap->entries[i].is_dir
-                           ? LV_SYMBOL_DIRECTORY "  "
-                           : LV_SYMBOL_FILE      "  ";
-        snprintf(line, sizeof(line), "%s%s", icon, snap->entries[i].name);
-        lv_list_add_text(s_usb_list, line);
-    }
-    lv_obj_add_flag(s_usb_status, LV_OBJ_FLAG_HIDDEN);
+    lv_label_set_text_fmt(s_usb_status, LV_SYMBOL_USB "  %" PRIu32 " entries%s", info.count,
+                          !info.complete ? ", listing..." : info.cached ? " (cached index)" : "");
+    lv_obj_clear_flag(s_usb_status, LV_OBJ_FLAG_HIDDEN);
     lv_obj_clear_flag(s_usb_list, LV_OBJ_FLAG_HIDDEN);
+    bsp_vlist_set_count(s_usb_list, info.count);    /* re-binds the visible rows: entries move while listing */
 }
 
-static void usb_update(void)
+static void usb_sync(const void *data, void *user_ctx);
+
+/* File service task: entries were found, or the listing ended */
+static void usb_dir_changed(bsp_usb_dir_handle_t dir, void *user_ctx)
 {
-    usb_snapshot_t *snap = malloc(sizeof(usb_snapshot_t));
-    if (!snap) {
-        ESP_LOGE(TAG, "USB snapshot alloc failed");
-        return;
+    bsp_display_post(USB_POST_KEY, usb_sync, NULL, NULL, 0);
+}
+
+/* LVGL task: open /usb after a mount, close it after a removal, and show its entries */
+static void usb_sync(const void *data, void *user_ctx)
+{
+    const uint32_t gen = s_usb_mount_gen;
+    const bool mounted = bsp_usb_is_mounted();
+    if (s_usb_dir && (!mounted || s_usb_dir_gen != gen)) {
+        bsp_usb_dir_close(s_usb_dir);
+        s_usb_dir = NULL;
     }
-    usb_snapshot_read(snap);
-    bsp_display_lock(portMAX_DELAY);
-    usb_snapshot_render(snap);
-    bsp_display_unlock();
-    free(snap);
+    if (!mounted) {
+        s_usb_open_err = false;
+    } else if (!s_usb_dir && s_usb_dir_gen != gen) {
+        const bsp_usb_dir_cfg_t cfg = {
+            .path        = "/usb",
+            .skip_hidden = true,
+            .on_change   = usb_dir_changed,
+        };
+        s_usb_dir_gen  = gen;
+        s_usb_logged   = false;
+        s_usb_open_us  = esp_timer_get_time();
+        s_usb_open_err = bsp_usb_dir_open(&cfg, &s_usb_dir) != ESP_OK;
+        bsp_vlist_scroll_to(s_usb_list, 0, LV_ANIM_OFF);
+    }
+    usb_render();
 }
 
 static void on_usb_mount(void)
 {
     ESP_LOGI(TAG, "USB mounted");
-    usb_update();
+    s_usb_mount_gen++;
+    bsp_display_post(USB_POST_KEY, usb_sync, NULL, NULL, 0);
 }
 
 static void on_usb_unmount(void)
 {
     ESP_LOGI(TAG, "USB removed");
-    usb_update();
+    bsp_display_post(USB_POST_KEY, usb_sync, NULL, NULL, 0);
 }
 
 /* ════════════════════════════════════════════════════════════════════════════
@@ -249,61 +255,148 @@ static void brightness_cb(lv_event_t *e)
     lv_label_set_text_fmt(s_brightness_label, "%d%%", val);
 }
 
+/* Render time per frame, averaged over one second: compare with the BG cache on and off
+ * while dragging the brightness slider. */
+static void render_time_cb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        s_render_start_us = esp_timer_get_time();
+    } else if (s_render_start_us) {
+        s_render_total_us += esp_timer_get_time() - s_render_start_us;
+        s_render_frames++;
+        s_render_start_us = 0;
+    }
+}
+
+static void render_stats_timer_cb(lv_timer_t *t)
+{
+    (void)t;
+    if (s_render_frames == 0) {
+        return;
+    }
+    int us = (int)(s_render_total_us / s_render_frames);
+    bool on = s_bg_cache && lv_obj_has_state(s_cache_switch, LV_STATE_CHECKED);
+    lv_label_set_text_fmt(s_render_label, "BG cache %s   render: %d.%02d ms",
+                          on ? "on " : "off", us / 1000, (us % 1000) / 10);
+    s_render_total_us = 0;
+    s_render_frames   = 0;
+}
+
+/* Touch I2C traffic and INT-to-LVGL latency; compare with CONFIG_BSP_TOUCH_INTERRUPT on and off */
+static void touch_stats_timer_cb(lv_timer_t *t)
+{
+    (void)t;
+    bsp_touch_stats_t ts;
+    if (bsp_touch_get_stats(&ts) != ESP_OK) {
+        return;
+    }
+    ESP_LOGI(TAG, "touch (%s, %s): %" PRIu32 " I2C reads, %" PRIu32 " idle, %" PRIu32 " INT, latency avg %" PRIu32
+             " us max %" PRIu32 " us, I2C wait %" PRIu32 " us/s (LVGL task %" PRIu32 " us/s), %" PRIu32
+             " samples to LVGL (%" PRIu32 " lost)",
+             ts.interrupt_mode ? "interrupt" : "polling", ts.background_read ? "touch task" : "LVGL task",
+             ts.i2c_reads, ts.idle_reads, ts.interrupts, ts.latency_avg_us, ts.latency_max_us,
+             ts.i2c_wait_us_per_s, ts.lvgl_wait_us_per_s, ts.samples, ts.samples_lost);
+    bsp_touch_reset_stats();
+}
+
+static void bg_cache_switch_cb(lv_event_t *e)
+{
+    (void)e;
+    bsp_display_bg_cache_set_enabled(s_bg_cache, lv_obj_has_state(s_cache_switch, LV_STATE_CHECKED));
+}
+
+/* Reads the newest sample straight from the sensor ring; runs in the LVGL task, never blocks */
 static void sensor_timer_cb(lv_timer_t *t)
 {
     (void)t;
-    sensor_reading_t reading;
-    if (xQueueReceive(s_sensor_queue, &reading, 0) != pdTRUE) {
+    const int32_t status = s_sensor->status;
+    if (status != 0 && status != BSP_SENSOR_PENDING) {
+        if (!s_sensor_err) {
+            lv_label_set_text(s_temp_label, LV_SYMBOL_WARNING "  Read error");
+            lv_label_set_text(s_hum_label,  "");
+            s_sensor_err = true;
+        }
         return;
     }
-    if (reading.ok) {
-        int t10 = (int)(reading.temp * 10.0f + (reading.temp >= 0.0f ? 0.5f : -0.5f));
-        int h10 = (int)(reading.hum  * 10.0f + 0.5f);
-        lv_label_set_text_fmt(s_temp_label,
-                              "%d.%d" "\xc2\xb0" "C",
-                              t10 / 10, abs(t10 % 10));
-        lv_label_set_text_fmt(s_hum_label,
-                              "%d.%d %%RH",
-                              h10 / 10, h10 % 10);
-    } else {
-        lv_label_set_text(s_temp_label, LV_SYMBOL_WARNING "  Read error");
-        lv_label_set_text(s_hum_label,  "");
+    bsp_sensor_sample_t sample;
+    if (!bsp_sensor_ring_latest(&s_sensor->ring, &sample) || (sample.seq == s_sensor_seq && !s_sensor_err)) {
+        return;
     }
+    s_sensor_seq = sample.seq;
+    s_sensor_err = false;
+    /* m°C and m%RH, rounded to one decimal */
+    int t10 = (sample.value[0] + (sample.value[0] >= 0 ? 50 : -50)) / 100;
+    int h10 = (sample.value[1] + 50) / 100;
+    lv_label_set_text_fmt(s_temp_label,
+                          "%s%d.%d" "\xc2\xb0" "C",
+                          t10 < 0 ? "-" : "", abs(t10) / 10, abs(t10) % 10);
+    lv_label_set_text_fmt(s_hum_label,
+                          "%d.%d %%RH",
+                          h10 / 10, h10 % 10);
+}
+
+/* Expansion bus occupancy; the AHT30 costs a few hundred us per sample */
+static void ext_i2c_stats_timer_cb(lv_timer_t *t)
+{
+    (void)t;
+    bsp_ext_i2c_stats_t st;
+    if (bsp_ext_i2c_get_stats(&st, NULL, 0, NULL) != ESP_OK) {
+        return;
+    }
+    ESP_LOGI(TAG, "ext I2C: %" PRIu32 " sessions, %" PRIu32 " transfers, %" PRIu32 " errors, busy %" PRIu32
+             " us/s, longest session %" PRIu32 " us, sensor errors %" PRIu32,
+             st.sessions, st.transfers, st.errors, st.busy_us_per_s, st.session_max_us, s_sensor->errors);
+    bsp_ext_i2c_reset_stats();
 }
 
 /* ════════════════════════════════════════════════════════════════════════════
  *  Sleep test
  *  The actual sleep/wake cycle runs in a dedicated FreeRTOS task so the
- *  LVGL thread is not blocked.  The task disables the button, sleeps 3 s,
- *  wakes, and re-enables the button.
+ *  LVGL thread is not blocked.  The task disables the button, sleeps until
+ *  the screen is touched or 10 s have passed, wakes, and re-enables the
+ *  button with the wake latency.
  * ════════════════════════════════════════════════════════════════════════════ */
-#define SLEEP_TEST_SECONDS 3
+#define SLEEP_TEST_SECONDS 10
 
 static void sleep_test_task(void *arg)
 {
     (void)arg;
 
-    ESP_LOGI(TAG, "Entering display sleep for %d seconds", SLEEP_TEST_SECONDS);
+    ESP_LOGI(TAG, "Entering display sleep for up to %d seconds", SLEEP_TEST_SECONDS);
+    bool by_touch = false;
     esp_err_t err = bsp_display_enter_sleep();
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "bsp_display_enter_sleep failed: %s", esp_err_to_name(err));
         goto done;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(SLEEP_TEST_SECONDS * 1000));
+    /* A touch wakes the display by itself (CONFIG_BSP_TOUCH_WAKE) */
+    for (int i = 0; i < SLEEP_TEST_SECONDS * 10 && bsp_display_is_sleeping(); i++) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
 
-    ESP_LOGI(TAG, "Exiting display sleep");
-    err = bsp_display_exit_sleep();
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "bsp_display_exit_sleep failed: %s", esp_err_to_name(err));
+    by_touch = !bsp_display_is_sleeping();
+    if (!by_touch) {
+        ESP_LOGI(TAG, "Exiting display sleep");
+        err = bsp_display_exit_sleep();
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "bsp_display_exit_sleep failed: %s", esp_err_to_name(err));
+        }
     }
-    bsp_display_brightness_set(80);
 
 done:
+    /* Wait for the first frame, which measures the wake */
+    vTaskDelay(pdMS_TO_TICKS(200));
+    bsp_display_wake_stats_t ws = {0};
+    bsp_display_get_wake_stats(&ws);
     if (bsp_display_lock(0)) {
-        lv_label_set_text(s_sleep_label,
-                          err == ESP_OK ? "Awake!  Sleep test passed."
-                                       : "Sleep test failed!");
+        if (err == ESP_OK) {
+            lv_label_set_text_fmt(s_sleep_label, "Awake%s in %" PRIu32 " ms  (max %" PRIu32 " ms over %" PRIu32
+                                  " wakes)", by_touch ? " by touch" : "", ws.last_us / 1000, ws.max_us / 1000,
+                                  ws.wakes);
+        } else {
+            lv_label_set_text(s_sleep_label, "Sleep test failed!");
+        }
         lv_obj_remove_flag(s_sleep_btn, LV_OBJ_FLAG_HIDDEN);
         bsp_display_unlock();
     }
@@ -316,7 +409,7 @@ static void sleep_btn_cb(lv_event_t *e)
     (void)e;
     lv_obj_add_flag(s_sleep_btn, LV_OBJ_FLAG_HIDDEN);
     lv_label_set_text(s_sleep_label,
-                      LV_SYMBOL_EYE_CLOSE "  Sleeping for 3 s ...");
+                      LV_SYMBOL_EYE_CLOSE "  Sleeping, touch to wake ...");
 
     BaseType_t rc = xTaskCreatePinnedToCore(sleep_test_task, "sleep_test", 4096, NULL, 3, NULL, 0);
     if (rc != pdPASS) {
@@ -363,21 +456,45 @@ static void ui_create(void)
     }
 
     /* ── Tab 1: Backlight ─────────────────────────────────────────────────── */
+    lv_obj_set_style_pad_all(tab_bl, 0, 0);
     lv_obj_set_flex_flow(tab_bl, LV_FLEX_FLOW_COLUMN);
     lv_obj_set_flex_align(tab_bl, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
     lv_obj_set_style_pad_row(tab_bl, 28, 0);
 
-    lv_obj_t *bl_title = lv_label_create(tab_bl);
-    lv_label_set_text(bl_title, "Screen Brightness");
-    lv_obj_set_style_text_font(bl_title, &lv_font_montserrat_18, 0);
-    lv_obj_set_style_text_color(bl_title, COL_MUTED, 0);
+    /* Static card layout: gradient, shadowed card and title never change, so they are
+     * rendered once into the BSP background cache. Only the slider, value and stats
+     * labels below are re-rendered when they change. */
+    s_bg_cache = bsp_display_bg_cache_create(tab_bl);
+    if (s_bg_cache) {
+        lv_obj_set_style_bg_color(s_bg_cache, COL_BG, 0);
+        lv_obj_set_style_bg_grad_color(s_bg_cache, COL_BORDER, 0);
+        lv_obj_set_style_bg_grad_dir(s_bg_cache, LV_GRAD_DIR_VER, 0);
+        lv_obj_set_style_bg_opa(s_bg_cache, LV_OPA_COVER, 0);
+
+        lv_obj_t *card = lv_obj_create(s_bg_cache);
+        lv_obj_set_size(card, 720, 340);
+        lv_obj_center(card);
+        lv_obj_set_style_bg_color(card, COL_CARD, 0);
+        lv_obj_set_style_border_color(card, COL_BORDER, 0);
+        lv_obj_set_style_radius(card, 16, 0);
+        lv_obj_set_style_shadow_width(card, 40, 0);
+        lv_obj_set_style_shadow_spread(card, 4, 0);
+        lv_obj_set_style_shadow_color(card, lv_color_black(), 0);
+        lv_obj_set_style_shadow_opa(card, LV_OPA_70, 0);
+
+        lv_obj_t *bl_title = lv_label_create(card);
+        lv_label_set_text(bl_title, "Screen Brightness");
+        lv_obj_set_style_text_font(bl_title, &lv_font_montserrat_18, 0);
+        lv_obj_set_style_text_color(bl_title, COL_MUTED, 0);
+        lv_obj_align(bl_title, LV_ALIGN_TOP_MID, 0, 8);
+    }
 
     lv_obj_t *slider = lv_slider_create(tab_bl);
     lv_slider_set_range(slider, 1, 100);
     lv_slider_set_value(slider, 80, LV_ANIM_OFF);
     lv_obj_set_width(slider, 640);
     lv_obj_set_height(slider, 28);
-    lv_obj_set_style_bg_color(slider, COL_CARD,   LV_PART_MAIN);
+    lv_obj_set_style_bg_color(slider, COL_BG,     LV_PART_MAIN);
     lv_obj_set_style_bg_color(slider, COL_BORDER, LV_PART_INDICATOR);
     lv_obj_set_style_bg_color(slider, COL_ACCENT, LV_PART_KNOB);
     lv_obj_set_style_pad_all(slider, 8, LV_PART_KNOB);
@@ -388,6 +505,28 @@ static void ui_create(void)
     lv_obj_set_style_text_font(s_brightness_label, &lv_font_montserrat_48, 0);
     lv_obj_set_style_text_color(s_brightness_label, COL_ACCENT, 0);
 
+    lv_obj_t *cache_row = lv_obj_create(tab_bl);
+    lv_obj_remove_style_all(cache_row);
+    lv_obj_set_size(cache_row, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(cache_row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(cache_row, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(cache_row, 16, 0);
+
+    s_cache_switch = lv_switch_create(cache_row);
+    lv_obj_add_state(s_cache_switch, LV_STATE_CHECKED);
+    lv_obj_set_style_bg_color(s_cache_switch, COL_ACCENT, LV_PART_INDICATOR | LV_STATE_CHECKED);
+    lv_obj_add_event_cb(s_cache_switch, bg_cache_switch_cb, LV_EVENT_VALUE_CHANGED, NULL);
+
+    s_render_label = lv_label_create(cache_row);
+    lv_label_set_text(s_render_label, "BG cache on   render: -- ms");
+    lv_obj_set_style_text_font(s_render_label, &lv_font_montserrat_16, 0);
+    lv_obj_set_style_text_color(s_render_label, COL_MUTED, 0);
+
+    lv_display_add_event_cb(lv_display_get_default(), render_time_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(lv_display_get_default(), render_time_cb, LV_EVENT_RENDER_READY, NULL);
+    lv_timer_create(render_stats_timer_cb, 1000, NULL);
+    lv_timer_create(touch_stats_timer_cb, 10000, NULL);
+
     /* ── Tab 2: USB ───────────────────────────────────────────────────────── */
     lv_obj_set_flex_flow(tab_usb, LV_FLEX_FLOW_COLUMN);
     lv_obj_set_flex_align(tab_usb, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
@@ -403,7 +542,13 @@ static void ui_create(void)
     lv_obj_set_style_text_color(s_usb_status, COL_MUTED, 0);
     lv_obj_set_style_text_font(s_usb_status, &lv_font_montserrat_16, 0);
 
-    s_usb_list = lv_list_create(tab_usb);
+    /* Only the visible rows exist as objects, however many files the drive holds */
+    const bsp_vlist_cfg_t usb_list_cfg = {
+        .count      = 0,
+        .row_height = USB_ROW_HEIGHT,
+        .bind_row   = usb_bind_row,
+    };
+    s_usb_list = bsp_vlist_create(tab_usb, &usb_list_cfg);
     lv_obj_set_width(s_usb_list, lv_pct(100));
     lv_obj_set_flex_grow(s_usb_list, 1);
     lv_obj_set_style_bg_color(s_usb_list, COL_CARD, 0);
@@ -417,7 +562,7 @@ static void ui_create(void)
     /* ── Tab 3: Sensor ────────────────────────────────────────────────────── */
     lv_obj_set_flex_flow(tab_sen, LV_FLEX_FLOW_COLUMN);
     lv_obj_set_flex_align(tab_sen, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    lv_obj_set_style_pad_row(tab_sen, 28, 0);
+    lv_obj_set_style_pad_row(tab_sen, 16, 0);
 
     if (s_sensor_ok) {
         lv_obj_t *sen_title = lv_label_create(tab_sen);
@@ -435,7 +580,30 @@ static void ui_create(void)
         lv_obj_set_style_text_font(s_hum_label, &lv_font_montserrat_48, 0);
         lv_obj_set_style_text_color(s_hum_label, COL_CYAN, 0);
 
+        if (s_history_ok) {
+            /* Drains the sensor ring itself; each new 6 s slot redraws only its own segment */
+            const bsp_sensor_chart_cfg_t chart_cfg = {
+                .series = &s_history,
+                .ring   = &s_sensor->ring,
+                .index  = 0,
+                .span_s = HISTORY_SPAN_S,
+                .points = HISTORY_POINTS,
+                .min    = 10000,
+                .max    = 40000,
+                .color  = COL_ACCENT,
+            };
+            lv_obj_t *chart = bsp_sensor_chart_create(tab_sen, &chart_cfg);
+            if (chart) {
+                lv_obj_set_size(chart, 720, 140);
+                lv_obj_set_style_bg_color(chart, COL_CARD, 0);
+                lv_obj_set_style_border_color(chart, COL_BORDER, 0);
+                lv_obj_set_style_line_color(chart, COL_BORDER, LV_PART_MAIN);
+                lv_chart_set_div_line_count(chart, 4, 6);
+            }
+        }
+
         lv_timer_create(sensor_timer_cb, 250, NULL);
+        lv_timer_create(ext_i2c_stats_timer_cb, 10000, NULL);
     } else {
         lv_obj_t *msg = lv_label_create(tab_sen);
         lv_label_set_text(msg,
@@ -464,7 +632,7 @@ static void ui_create(void)
     lv_obj_set_style_bg_color(s_sleep_btn, COL_ACCENT, 0);
 
     lv_obj_t *btn_lbl = lv_label_create(s_sleep_btn);
-    lv_label_set_text(btn_lbl, LV_SYMBOL_EYE_CLOSE "  Sleep 3 s");
+    lv_label_set_text(btn_lbl, LV_SYMBOL_EYE_CLOSE "  Sleep");
     lv_obj_set_style_text_font(btn_lbl, &lv_font_montserrat_18, 0);
     lv_obj_center(btn_lbl);
     lv_obj_add_event_cb(s_sleep_btn, sleep_btn_cb, LV_EVENT_CLICKED, NULL);
@@ -526,22 +694,10 @@ void app_main(void)
     assert(disp);
     bsp_display_brightness_set(80);
 
-    if (s_sensor_ok) {
-        s_sensor_queue = xQueueCreate(1, sizeof(sensor_reading_t));
-        if (s_sensor_queue == NULL) {
-            ESP_LOGE(TAG, "Failed to create sensor queue; disabling sensor task");
-            s_sensor_ok = false;
-        }
-    }
-
     bsp_display_lock(portMAX_DELAY);
     ui_create();
     bsp_display_unlock();
 
-    if (s_sensor_ok && s_sensor_queue != NULL) {
-        xTaskCreatePinnedToCore(sensor_task, "sensor", 4096, NULL, 4, NULL, 1);
-    }
-
     bsp_usb_on_mount(on_usb_mount);
     bsp_usb_on_unmount(on_usb_unmount);
     if (bsp_usb_start() != ESP_OK) {
@@ -0,0 +1,151 @@
+/**
+ * @file main.c
+ * @brief Flash write stress test
+ * @details Animates the display while NVS commits and raw partition erase/write cycles run in the
+ *          background, and verifies with the BSP scanout counters that no frame was missed.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+#include "bsp/esp-bsp.h"
+#include "esp_partition.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "esp_log.h"
+
+static const char *TAG = "flash_stress";
+
+#define STRESS_DURATION_S   (60)
+#define STRESS_REPORT_S     (5)
+#define STRESS_SECTOR_SIZE  (4096)
+#define STRESS_PART_SUBTYPE (0x40)
+
+static volatile uint32_t s_bytes_written;
+static lv_obj_t         *s_status_label;
+
+static void nvs_stress_step(nvs_handle_t nvs, uint32_t iter)
+{
+    uint8_t blob[256];
+    memset(blob, (int)iter, sizeof(blob));
+
+    ESP_ERROR_CHECK(nvs_set_u32(nvs, "iter", iter));
+    ESP_ERROR_CHECK(nvs_set_blob(nvs, "blob", blob, sizeof(blob)));
+    ESP_ERROR_CHECK(nvs_commit(nvs));
+    s_bytes_written += sizeof(blob) + sizeof(iter);
+}
+
+static void partition_stress_step(const esp_partition_t *part, uint8_t *sector, uint32_t iter)
+{
+    const size_t offset = (iter * STRESS_SECTOR_SIZE) % part->size;
+
+    memset(sector, (int)iter, STRESS_SECTOR_SIZE);
+    ESP_ERROR_CHECK(esp_partition_erase_range(part, offset, STRESS_SECTOR_SIZE));
+    ESP_ERROR_CHECK(esp_partition_write(part, offset, sector, STRESS_SECTOR_SIZE));
+    s_bytes_written += STRESS_SECTOR_SIZE;
+}
+
+static void flash_stress_task(void *arg)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, STRESS_PART_SUBTYPE, "stress");
+    if (!part) {
+        ESP_LOGE(TAG, "No 'stress' partition, check partitions.csv");
+        vTaskDelete(NULL);
+    }
+
+    nvs_handle_t nvs;
+    ESP_ERROR_CHECK(nvs_open("stress", NVS_READWRITE, &nvs));
+
+    static uint8_t sector[STRESS_SECTOR_SIZE];
+    for (uint32_t iter = 0;; iter++) {
+        nvs_stress_step(nvs, iter);
+        partition_stress_step(part, sector, iter);
+        /* Leave the lower-priority tasks (idle, LVGL on the other core) some air */
+        vTaskDelay(1);
+    }
+}
+
+static void bar_anim_cb(void *bar, int32_t v)
+{
+    lv_bar_set_value(bar, v, LV_ANIM_OFF);
+}
+
+static void status_timer_cb(lv_timer_t *t)
+{
+    bsp_display_scanout_stats_t st;
+    bsp_display_get_scanout_stats(&st);
+    lv_label_set_text_fmt(s_status_label, "%" PRIu32 " KB written\n%" PRIu32 " frames, %" PRIu32 " late",
+                          s_bytes_written / 1024, st.frames, st.late_frames);
+}
+
+static void create_ui(void)
+{
+    lv_obj_t *scr = lv_scr_act();
+
+    lv_obj_t *spinner = lv_spinner_create(scr);
+    lv_obj_set_size(spinner, 120, 120);
+    lv_obj_align(spinner, LV_ALIGN_CENTER, 0, -80);
+
+    lv_obj_t *bar = lv_bar_create(scr);
+    lv_obj_set_size(bar, 600, 30);
+    lv_obj_align(bar, LV_ALIGN_CENTER, 0, 40);
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, bar);
+    lv_anim_set_exec_cb(&a, bar_anim_cb);
+    lv_anim_set_values(&a, 0, 100);
+    lv_anim_set_duration(&a, 1000);
+    lv_anim_set_reverse_duration(&a, 1000);
+    lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+    lv_anim_start(&a);
+
+    s_status_label = lv_label_create(scr);
+    lv_obj_set_style_text_align(s_status_label, LV_TEXT_ALIGN_CENTER, 0);
+    lv_obj_align(s_status_label, LV_ALIGN_CENTER, 0, 120);
+    lv_timer_create(status_timer_cb, 250, NULL);
+}
+
+void app_main(void)
+{
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
+
+    lv_display_t *disp = bsp_display_start();
+    assert(disp);
+    bsp_display_brightness_set(80);
+
+    if (!bsp_display_lock(portMAX_DELAY)) {
+        ESP_LOGE(TAG, "Failed to acquire display lock");
+        return;
+    }
+    create_ui();
+    bsp_display_unlock();
+
+#if !CONFIG_BSP_LCD_FLASH_WRITE_SAFE
+    ESP_LOGW(TAG, "CONFIG_BSP_LCD_FLASH_WRITE_SAFE is off, expect late frames");
+#endif
+
+    bsp_display_reset_scanout_stats();
+    xTaskCreatePinnedToCore(flash_stress_task, "flash_stress", 4096, NULL, 5, NULL, 0);
+
+    bsp_display_scanout_stats_t st;
+    for (int s = STRESS_REPORT_S; s <= STRESS_DURATION_S; s += STRESS_REPORT_S) {
+        vTaskDelay(pdMS_TO_TICKS(STRESS_REPORT_S * 1000));
+        bsp_display_get_scanout_stats(&st);
+        ESP_LOGI(TAG, "%" PRIu32 " frames, %" PRIu32 " late, interval %" PRIu32 "..%" PRIu32 " us (nominal %" PRIu32
+                 " us), %" PRIu32 " KB written", st.frames, st.late_frames, st.min_frame_us, st.max_frame_us,
+                 st.nominal_frame_us, s_bytes_written / 1024);
+    }
+
+    if (st.late_frames == 0 && st.frames > 0) {
+        ESP_LOGI(TAG, "PASS: %" PRIu32 " frames, no late frame during %" PRIu32 " KB of flash writes",
+                 st.frames, s_bytes_written / 1024);
+    } else {
+        ESP_LOGE(TAG, "FAIL: %" PRIu32 " of %" PRIu32 " frames late, worst interval %" PRIu32 " us",
+                 st.late_frames, st.frames, st.max_frame_us);
+    }
+}
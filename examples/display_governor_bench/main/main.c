@@ -0,0 +1,223 @@
+/**
+ * @file main.c
+ * @brief Frame-budget governor benchmark
+ * @details Measures frame times of an effect-heavy animated scene with and without the BSP governor,
+ *          under a synthetic load of PSRAM copy bursts, and prints one GOV_RESULT line per phase.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "bsp/esp-bsp.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "gov_bench";
+
+#define PHASE_DURATION_MS   (15000)
+#define FRAME_BUDGET_US     (33000)
+#define MAX_SAMPLES         (2048)
+#define CARD_COUNT          (12)
+#define LOAD_BLOCK_SIZE     (256 * 1024)
+#define LOAD_BURST_MS       (300)
+#define LOAD_PAUSE_MS       (500)
+
+static uint32_t         *s_samples;
+static volatile uint32_t s_sample_count;
+static volatile bool     s_recording;
+static volatile bool     s_load_on;
+static int64_t           s_render_start;
+
+/* ── LVGL heap in PSRAM (opacity layers need large buffers) ─────────────── */
+void lv_mem_init(void)   { }
+void lv_mem_deinit(void) { }
+
+void *lv_malloc_core(size_t size)
+{
+    void *p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!p) {
+        p = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    return p;
+}
+
+void *lv_realloc_core(void *p, size_t new_size)
+{
+    if (new_size == 0) {
+        heap_caps_free(p);
+        return NULL;
+    }
+    void *new_p = heap_caps_realloc(p, new_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!new_p) {
+        new_p = heap_caps_realloc(p, new_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    return new_p;
+}
+
+void lv_free_core(void *p)
+{
+    heap_caps_free(p);
+}
+
+/* ── Synthetic I/O load: PSRAM copy bursts on both cores ──────────────────── */
+static void load_task(void *arg)
+{
+    uint8_t *src = heap_caps_malloc(LOAD_BLOCK_SIZE, MALLOC_CAP_SPIRAM);
+    uint8_t *dst = heap_caps_malloc(LOAD_BLOCK_SIZE, MALLOC_CAP_SPIRAM);
+    assert(src && dst);
+
+    while (1) {
+        if (!s_load_on) {
+            vTaskDelay(pdMS_TO_TICKS(50));
+            continue;
+        }
+        const int64_t burst_end = esp_timer_get_time() + LOAD_BURST_MS * 1000;
+        while (esp_timer_get_time() < burst_end) {
+            memcpy(dst, src, LOAD_BLOCK_SIZE);
+            bsp_psram_monitor_account(BSP_PSRAM_CONSUMER_APP, 2 * LOAD_BLOCK_SIZE);
+            vTaskDelay(1);  /* let the LVGL task run between blocks, like a real copy loop */
+        }
+        vTaskDelay(pdMS_TO_TICKS(LOAD_PAUSE_MS));
+    }
+}
+
+/* ── Frame time recording ──────────────────────────────────────────────── */
+static void render_time_cb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        s_render_start = esp_timer_get_time();
+        return;
+    }
+    if (s_recording && s_render_start && s_sample_count < MAX_SAMPLES) {
+        s_samples[s_sample_count++] = (uint32_t)(esp_timer_get_time() - s_render_start);
+    }
+    s_render_start = 0;
+}
+
+static int u32_cmp(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *sorted, uint32_t n, uint32_t pct)
+{
+    return n ? sorted[(n - 1) * pct / 100] : 0;
+}
+
+static void run_phase(const char *name, bool load, bool governor)
+{
+    if (governor) {
+        const bsp_display_gov_cfg_t gov_cfg = {
+            .budget_us = FRAME_BUDGET_US,
+        };
+        bsp_display_lock(portMAX_DELAY);
+        ESP_ERROR_CHECK(bsp_display_governor_start(&gov_cfg));
+        bsp_display_unlock();
+    }
+    s_load_on = load;
+    vTaskDelay(pdMS_TO_TICKS(1000));  /* settle */
+
+    s_sample_count = 0;
+    s_recording = true;
+    vTaskDelay(pdMS_TO_TICKS(PHASE_DURATION_MS));
+    s_recording = false;
+
+    bsp_display_gov_stats_t gov = {0};
+    bsp_display_lock(portMAX_DELAY);
+    bsp_display_governor_get_stats(&gov);
+    if (governor) {
+        bsp_display_governor_stop();
+    }
+    bsp_display_unlock();
+    s_load_on = false;
+
+    const uint32_t n = s_sample_count;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        total += s_samples[i];
+    }
+    qsort(s_samples, n, sizeof(s_samples[0]), u32_cmp);
+
+    printf("GOV_RESULT phase=%s frames=%" PRIu32 " avg_us=%" PRIu32 " p50_us=%" PRIu32 " p95_us=%" PRIu32
+           " p99_us=%" PRIu32 " max_us=%" PRIu32 " level=%d degrades=%" PRIu32 " restores=%" PRIu32 "\n",
+           name, n, n ? (uint32_t)(total / n) : 0, percentile(s_samples, n, 50), percentile(s_samples, n, 95),
+           percentile(s_samples, n, 99), n ? s_samples[n - 1] : 0,
+           governor ? gov.level : 0, governor ? gov.degrades : 0, governor ? gov.restores : 0);
+}
+
+/* ── Scene: effect-heavy cards, all moving ──────────────────────────────── */
+static void card_anim_cb(void *card, int32_t v)
+{
+    lv_obj_set_style_translate_y(card, v, 0);
+}
+
+static void create_scene(void)
+{
+    lv_obj_t *scr = lv_scr_act();
+    lv_obj_set_style_bg_color(scr, lv_color_hex(0x202830), 0);
+    lv_obj_set_flex_flow(scr, LV_FLEX_FLOW_ROW_WRAP);
+    lv_obj_set_flex_align(scr, LV_FLEX_ALIGN_SPACE_EVENLY, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    for (int i = 0; i < CARD_COUNT; i++) {
+        lv_obj_t *card = lv_obj_create(scr);
+        lv_obj_set_size(card, 170, 120);
+        lv_obj_set_style_radius(card, 18, 0);
+        lv_obj_set_style_bg_color(card, lv_palette_main((lv_palette_t)(i % LV_PALETTE_LAST)), 0);
+        lv_obj_set_style_bg_grad_color(card, lv_palette_darken((lv_palette_t)(i % LV_PALETTE_LAST), 3), 0);
+        lv_obj_set_style_bg_grad_dir(card, LV_GRAD_DIR_VER, 0);
+        lv_obj_set_style_shadow_width(card, 40, 0);
+        lv_obj_set_style_shadow_spread(card, 4, 0);
+        lv_obj_set_style_opa_layered(card, LV_OPA_80, 0);
+
+        lv_obj_t *label = lv_label_create(card);
+        lv_label_set_text_fmt(label, "Card %d", i + 1);
+        lv_obj_center(label);
+
+        lv_anim_t a;
+        lv_anim_init(&a);
+        lv_anim_set_var(&a, card);
+        lv_anim_set_exec_cb(&a, card_anim_cb);
+        lv_anim_set_values(&a, -12, 12);
+        lv_anim_set_duration(&a, 700 + i * 60);
+        lv_anim_set_reverse_duration(&a, 700 + i * 60);
+        lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+        lv_anim_start(&a);
+
+        ESP_ERROR_CHECK(bsp_display_governor_add(card));
+    }
+}
+
+void app_main(void)
+{
+    s_samples = heap_caps_malloc(MAX_SAMPLES * sizeof(uint32_t), MALLOC_CAP_SPIRAM);
+    assert(s_samples);
+
+    lv_display_t *disp = bsp_display_start();
+    assert(disp);
+    ESP_ERROR_CHECK(bsp_display_backlight_on());
+
+    if (!bsp_display_lock(portMAX_DELAY)) {
+        ESP_LOGE(TAG, "Failed to acquire display lock");
+        return;
+    }
+    create_scene();
+    lv_display_add_event_cb(disp, render_time_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, render_time_cb, LV_EVENT_RENDER_READY, NULL);
+    bsp_display_unlock();
+
+    /* Above the LVGL task's priority, as USB and sensor tasks usually are */
+    xTaskCreatePinnedToCore(load_task, "load0", 3072, NULL, 6, NULL, 0);
+    xTaskCreatePinnedToCore(load_task, "load1", 3072, NULL, 6, NULL, 1);
+
+    ESP_LOGI(TAG, "Running 3 phases of %d s", PHASE_DURATION_MS / 1000);
+    run_phase("idle", false, false);
+    run_phase("load", true, false);
+    run_phase("load_gov", true, true);
+    ESP_LOGI(TAG, "Done");
+}
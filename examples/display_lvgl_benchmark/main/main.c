@@ -48,6 +48,13 @@ void app_main(void)
 
     ESP_ERROR_CHECK(bsp_display_backlight_on());
 
+    /* Log PSRAM bandwidth per consumer and the remaining headroom while the scenes run */
+    const bsp_psram_monitor_cfg_t psram_cfg = {
+        .period_ms  = 5000,
+        .log_report = true,
+    };
+    ESP_ERROR_CHECK(bsp_psram_monitor_start(&psram_cfg));
+
     ESP_LOGI(TAG, "Running LVGL benchmark");
 
     if (bsp_display_lock(0)) {
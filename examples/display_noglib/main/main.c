@@ -1,21 +1,38 @@
 /**
  * @file main.c
  * @brief display_noglib — raw panel access example
- * @details Demonstrates direct framebuffer access without LVGL using the pandatouch_noglib component variant.
+ * @details Demonstrates direct framebuffer access without LVGL using the pandatouch_noglib component variant,
+ *          and multi-touch gestures through the BSP gesture recognizer callback.
  */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "bsp/esp-bsp.h"
 #include "bsp/display.h"
 #include "bsp/touch.h"
 
 static const char *TAG = "display_noglib";
 
+/* Set to 1 to print every touch sample as a trace line for tools/gesture_replay */
+#define PRINT_TRACE (0)
+
+static void gesture_cb(const bsp_gesture_event_t *ev, void *user_ctx)
+{
+    static const char *const types[] = { "none", "long press", "pinch", "rotate", "scroll" };
+    static const char *const phases[] = { "begin", "update", "end" };
+    ESP_LOGI(TAG, "%s %s at %d,%d: scale %" PRId32 "/1000, angle %d.%d deg, scroll %d,%d",
+             types[ev->type], phases[ev->phase], ev->x, ev->y, (ev->scale_q16 * 1000) >> 16,
+             ev->angle_ddeg / 10, abs(ev->angle_ddeg % 10), ev->total_dx, ev->total_dy);
+}
+
 void app_main(void)
 {
     esp_lcd_panel_handle_t panel;
@@ -36,13 +53,33 @@ void app_main(void)
     esp_lcd_touch_handle_t tp;
     const bsp_touch_config_t tp_cfg = { .dummy = NULL };
     ESP_ERROR_CHECK(bsp_touch_new(&tp_cfg, &tp));
+
+    bsp_gesture_t gesture;
+    bsp_gesture_init(&gesture, NULL, gesture_cb, NULL);
     while (1) {
         esp_lcd_touch_read_data(tp);
-        esp_lcd_touch_point_data_t pts[1];
+        esp_lcd_touch_point_data_t pts[BSP_GESTURE_MAX_POINTS];
         uint8_t count = 0;
-        if (esp_lcd_touch_get_data(tp, pts, &count, 1) == ESP_OK && count) {
-            ESP_LOGI(TAG, "x=%d y=%d", pts[0].x, pts[0].y);
+        if (esp_lcd_touch_get_data(tp, pts, &count, BSP_GESTURE_MAX_POINTS) != ESP_OK) {
+            count = 0;
+        }
+
+        const uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        bsp_gesture_point_t points[BSP_GESTURE_MAX_POINTS];
+        for (uint8_t i = 0; i < count; i++) {
+            points[i] = (bsp_gesture_point_t) {
+                .x = pts[i].x, .y = pts[i].y, .id = pts[i].track_id
+            };
+        }
+        bsp_gesture_feed(&gesture, points, count, now_ms);
+
+#if PRINT_TRACE
+        printf("TRACE %" PRIu32 " %d", now_ms, count);
+        for (uint8_t i = 0; i < count; i++) {
+            printf(" %d %d %d", points[i].x, points[i].y, points[i].id);
         }
+        printf("\n");
+#endif
         vTaskDelay(pdMS_TO_TICKS(20));
     }
 }
@@ -12,119 +12,86 @@
 
 #include <slint-esp.h>
 #include <slint.h>
+#include <chrono>
+#include <cstdlib>
 #include <optional>
 #include <string>
 #include <vector>
 #include <memory>
+#include <cerrno>
 #include <cstdio>
-#include <dirent.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
-#include "driver/i2c_master.h"
 #include "bsp/esp-bsp.h"
-#include "aht30.h"
 
 #include "ui.h"
 
 static const char *TAG = "display_slint";
 
-static i2c_master_bus_handle_t s_ext_i2c = nullptr;
-static aht30_handle_t s_aht30 = nullptr;
+static bsp_sensor_t *s_sensor = nullptr;
 static bool s_sensor_ok = false;
+static uint32_t s_sensor_seq = UINT32_MAX;
 
 static void sensor_init(void)
 {
-    const i2c_master_bus_config_t bus_cfg = {
-        .i2c_port = BSP_EXT_I2C_NUM,
-        .sda_io_num = BSP_EXT_I2C_SDA,
-        .scl_io_num = BSP_EXT_I2C_SCL,
-        .clk_source = I2C_CLK_SRC_DEFAULT,
-        .glitch_ignore_cnt = 7,
-        .intr_priority = 0,
-        .trans_queue_depth = 0,
-        .flags = { .enable_internal_pullup = true, .allow_pd = false },
-    };
-
-    if (i2c_new_master_bus(&bus_cfg, &s_ext_i2c) != ESP_OK) {
-        ESP_LOGW(TAG, "Ext I2C bus init failed — AHT30 unavailable");
+    if (bsp_ext_i2c_probe(BSP_SENSOR_AHT30_ADDR) != ESP_OK) {
+        ESP_LOGW(TAG, "AHT30 not found on I2C1 — sensor tab will show N/A");
         return;
     }
 
-    if (aht30_create(s_ext_i2c, AHT30_I2C_ADDRESS, &s_aht30) != ESP_OK) {
-        ESP_LOGW(TAG, "AHT30 not found on I2C1 — sensor tab will show N/A");
-        i2c_del_master_bus(s_ext_i2c);
-        s_ext_i2c = nullptr;
+    /* Run by the BSP sensor hub; other expansion sensors can share the bus and the task */
+    bsp_ext_i2c_sensor_config_t cfg = {};
+    cfg.driver = &bsp_sensor_aht30;
+    cfg.dev.name = "aht30";
+    cfg.dev.addr = BSP_SENSOR_AHT30_ADDR;
+    cfg.period_ms = 2000;
+    if (bsp_ext_i2c_sensor_add(&cfg, &s_sensor) != ESP_OK) {
+        ESP_LOGW(TAG, "AHT30 could not be added to the sensor hub");
         return;
     }
 
     s_sensor_ok = true;
 }
 
-static void sensor_task(void *arg)
+/* Runs on the Slint event loop: reads the newest sample straight from the sensor ring, never blocks */
+static void sensor_update(const slint::ComponentWeakHandle<AppWindow> &weak_ui)
 {
-    auto *weak_ui_ptr = static_cast<slint::ComponentWeakHandle<AppWindow> *>(arg);
-    while (true) {
-        float temp = 0.0f;
-        float hum = 0.0f;
-        bool ok = (aht30_get_temperature_humidity_value(s_aht30, &temp, &hum) == ESP_OK);
-
-        char temp_buf[32] = {0};
-        char hum_buf[32] = {0};
-        if (ok) {
-            snprintf(temp_buf, sizeof(temp_buf), "%.1f °C", temp);
-            snprintf(hum_buf, sizeof(hum_buf), "%.1f %%", hum);
-        }
-
-        slint::invoke_from_event_loop([
-            weak_ui_ptr,
-            ok,
-            temp_str = std::string(ok ? temp_buf : ""),
-            hum_str = std::string(ok ? hum_buf : "")
-        ]() {
-            if (auto handle = weak_ui_ptr->lock()) {
-                auto &ui = *handle;
-                ui->set_sensor_connected(ok);
-                if (ok) {
-                    ui->set_temperature(slint::SharedString(temp_str.c_str()));
-                    ui->set_humidity(slint::SharedString(hum_str.c_str()));
-                }
-            }
-        });
+    auto handle = weak_ui.lock();
+    if (!handle) {
+        return;
+    }
+    auto &ui = *handle;
 
-        vTaskDelay(pdMS_TO_TICKS(2000));
+    const int32_t status = s_sensor->status;
+    if (status != 0 && status != BSP_SENSOR_PENDING) {
+        ui->set_sensor_connected(false);
+        return;
+    }
+    bsp_sensor_sample_t sample;
+    if (!bsp_sensor_ring_latest(&s_sensor->ring, &sample) || sample.seq == s_sensor_seq) {
+        return;
     }
+    s_sensor_seq = sample.seq;
+
+    /* m°C and m%RH, rounded to one decimal */
+    const int t10 = (sample.value[0] + (sample.value[0] >= 0 ? 50 : -50)) / 100;
+    const int h10 = (sample.value[1] + 50) / 100;
+    char temp_buf[32];
+    char hum_buf[32];
+    snprintf(temp_buf, sizeof(temp_buf), "%s%d.%d °C", t10 < 0 ? "-" : "", std::abs(t10) / 10, std::abs(t10) % 10);
+    snprintf(hum_buf, sizeof(hum_buf), "%d.%d %%", h10 / 10, h10 % 10);
+    ui->set_sensor_connected(true);
+    ui->set_temperature(slint::SharedString(temp_buf));
+    ui->set_humidity(slint::SharedString(hum_buf));
 }
 
 static std::optional<slint::ComponentWeakHandle<AppWindow>> s_usb_ui;
 
-static void usb_update(const slint::ComponentWeakHandle<AppWindow> &weak_ui)
+static void usb_show(const slint::ComponentWeakHandle<AppWindow> &weak_ui, std::vector<slint::SharedString> files,
+                     std::string status_str)
 {
-    bool mounted = bsp_usb_is_mounted();
-    std::vector<slint::SharedString> files;
-    std::string status_str;
-
-    if (!mounted) {
-        status_str = "No USB Device";
-    } else {
-        DIR *dir = opendir("/usb");
-        if (!dir) {
-            status_str = "Failed to open /usb";
-        } else {
-            status_str = "USB Mounted";
-            struct dirent *ent;
-            while ((ent = readdir(dir)) != nullptr) {
-                if (ent->d_name[0] == '.') {
-                    continue;
-                }
-                std::string prefix = (ent->d_type == DT_DIR) ? "[D] " : "[F] ";
-                files.push_back(slint::SharedString((prefix + ent->d_name).c_str()));
-            }
-            closedir(dir);
-        }
-    }
-
     slint::invoke_from_event_loop([
         weak_ui,
         files = std::move(files),
@@ -142,6 +109,53 @@ static void usb_update(const slint::ComponentWeakHandle<AppWindow> &weak_ui)
     });
 }
 
+/* Filled entry by entry by the BSP file service task */
+struct UsbListing {
+    slint::ComponentWeakHandle<AppWindow> ui;
+    std::vector<slint::SharedString> files;
+};
+
+static bool usb_list_entry(const char *name, bool is_dir, void *user_ctx)
+{
+    auto *listing = static_cast<UsbListing *>(user_ctx);
+    if (name[0] != '.') {
+        std::string prefix = is_dir ? "[D] " : "[F] ";
+        listing->files.push_back(slint::SharedString((prefix + name).c_str()));
+    }
+    return true;
+}
+
+static void usb_list_done(const bsp_fs_result_t *result, void *user_ctx)
+{
+    std::unique_ptr<UsbListing> listing(static_cast<UsbListing *>(user_ctx));
+    if (result->err == ECANCELED) {
+        return;     /* The drive went away; on_usb_unmount() shows it */
+    }
+    usb_show(listing->ui, std::move(listing->files), result->err ? "Failed to open /usb" : "USB Mounted");
+}
+
+/* Only queues the listing: called from the BSP MSC task, which must not wait for the drive */
+static void usb_update(const slint::ComponentWeakHandle<AppWindow> &weak_ui)
+{
+    if (!bsp_usb_is_mounted()) {
+        usb_show(weak_ui, {}, "No USB Device");
+        return;
+    }
+
+    auto *listing = new UsbListing{weak_ui, {}};
+    bsp_fs_request_t req = {};
+    req.op = BSP_FS_OP_LIST;
+    req.prio = BSP_FS_PRIO_INTERACTIVE;
+    req.path = "/usb";
+    req.on_entry = usb_list_entry;
+    req.on_done = usb_list_done;
+    req.user_ctx = listing;
+    if (bsp_usb_fs_submit(&req, nullptr) != ESP_OK) {
+        delete listing;
+        usb_show(weak_ui, {}, "Failed to open /usb");
+    }
+}
+
 static void on_usb_mount(void)
 {
     ESP_LOGI(TAG, "USB mounted");
@@ -192,14 +206,10 @@ extern "C" void app_main(void)
     usb_update(weak_ui);
 
     sensor_init();
-    static slint::ComponentWeakHandle<AppWindow> s_sensor_weak;
+    slint::Timer sensor_timer;
     if (s_sensor_ok) {
-        s_sensor_weak = weak_ui;
-        BaseType_t rc = xTaskCreatePinnedToCore(sensor_task, "sensor", 4096, &s_sensor_weak, 4, nullptr, 1);
-        if (rc != pdPASS) {
-            ESP_LOGE(TAG, "Failed to create sensor task");
-            ui->set_sensor_connected(false);
-        }
+        sensor_timer.start(slint::TimerMode::Repeated, std::chrono::milliseconds(250),
+                           [weak_ui] { sensor_update(weak_ui); });
     } else {
         ui->set_sensor_connected(false);
     }
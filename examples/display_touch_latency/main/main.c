@@ -0,0 +1,94 @@
+/**
+ * @file main.c
+ * @brief Touch-to-photon latency
+ * @details Toggles a small indicator on every tap and prints the BSP latency harness percentiles,
+ *          from the GT911 INT edge to the vsync after the frame showing the change.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "bsp/esp-bsp.h"
+#include "esp_log.h"
+
+static const char *TAG = "touch_latency";
+
+#define TARGET_SAMPLES      (100)
+#define REPORT_PERIOD_MS    (10000)
+
+static lv_obj_t *s_indicator;
+static lv_obj_t *s_count_label;
+static uint32_t  s_taps;
+
+/* Small redraw per tap, like typical press feedback */
+static void screen_pressed_cb(lv_event_t *e)
+{
+    s_taps++;
+    lv_obj_set_style_bg_color(s_indicator, (s_taps & 1) ? lv_palette_main(LV_PALETTE_GREEN)
+                              : lv_palette_main(LV_PALETTE_BLUE), 0);
+    lv_label_set_text_fmt(s_count_label, "Taps: %" PRIu32, s_taps);
+}
+
+static void create_ui(void)
+{
+    lv_obj_t *scr = lv_scr_act();
+    lv_obj_set_style_bg_color(scr, lv_color_hex(0x202830), 0);
+    lv_obj_remove_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(scr, screen_pressed_cb, LV_EVENT_PRESSED, NULL);
+
+    lv_obj_t *hint = lv_label_create(scr);
+    lv_label_set_text_fmt(hint, "Tap anywhere, %d times", TARGET_SAMPLES);
+    lv_obj_set_style_text_color(hint, lv_color_white(), 0);
+    lv_obj_set_style_text_font(hint, &lv_font_montserrat_28, 0);
+    lv_obj_align(hint, LV_ALIGN_TOP_MID, 0, 40);
+
+    s_indicator = lv_obj_create(scr);
+    lv_obj_remove_style_all(s_indicator);
+    lv_obj_set_size(s_indicator, 120, 120);
+    lv_obj_set_style_radius(s_indicator, 16, 0);
+    lv_obj_set_style_bg_opa(s_indicator, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(s_indicator, lv_palette_main(LV_PALETTE_BLUE), 0);
+    lv_obj_remove_flag(s_indicator, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_center(s_indicator);
+
+    s_count_label = lv_label_create(scr);
+    lv_label_set_text(s_count_label, "Taps: 0");
+    lv_obj_set_style_text_color(s_count_label, lv_color_white(), 0);
+    lv_obj_set_style_text_font(s_count_label, &lv_font_montserrat_28, 0);
+    lv_obj_align(s_count_label, LV_ALIGN_BOTTOM_MID, 0, -40);
+}
+
+void app_main(void)
+{
+    lv_display_t *disp = bsp_display_start();
+    assert(disp);
+    ESP_ERROR_CHECK(bsp_display_backlight_on());
+
+    if (!bsp_display_lock(portMAX_DELAY)) {
+        ESP_LOGE(TAG, "Failed to acquire display lock");
+        return;
+    }
+    create_ui();
+    bsp_display_unlock();
+
+    bsp_touch_stats_t ts = {0};
+    bsp_touch_get_stats(&ts);
+    ESP_LOGI(TAG, "Tap the screen %d times (%s touch reads)", TARGET_SAMPLES,
+             ts.interrupt_mode ? "interrupt-driven" : "polled");
+
+    bsp_touch_lat_report_t report = {0};
+    uint32_t last_samples = 0;
+    while (report.samples < TARGET_SAMPLES) {
+        vTaskDelay(pdMS_TO_TICKS(REPORT_PERIOD_MS));
+        ESP_ERROR_CHECK(bsp_touch_latency_get_report(&report));
+        if (report.samples != last_samples) {
+            last_samples = report.samples;
+            bsp_touch_latency_print_report();
+        }
+    }
+
+    printf("TOUCH_LAT_FINAL\n");
+    bsp_touch_latency_print_report();
+    ESP_LOGI(TAG, "Done");
+}
@@ -0,0 +1,80 @@
+# SPDX-FileCopyrightText: 2026 fmauNeko
+# SPDX-License-Identifier: CC0-1.0
+
+import datetime
+import json
+from pathlib import Path
+
+import pytest
+from pytest_embedded import Dut
+
+BOARD = "pandatouch"
+STAGES = ["i2c", "dispatch", "render", "swap", "vsync"]
+STAGE_TITLES = {
+    "i2c": "INT → I2C read",
+    "dispatch": "INT → LVGL dispatch",
+    "render": "INT → render done",
+    "swap": "INT → buffer swap",
+    "vsync": "INT → vsync (photon)",
+}
+
+
+def _write(ext: str, text: str) -> None:
+    with open(f"touch_latency_{BOARD}{ext}", "a") as f:
+        f.write(text)
+
+
+@pytest.mark.pandatouch
+@pytest.mark.parametrize("target", ["esp32s3"])
+def test_touch_latency(dut: Dut) -> None:
+    date = datetime.datetime.now()
+
+    Path(f"touch_latency_{BOARD}.md").unlink(missing_ok=True)
+    Path(f"touch_latency_{BOARD}.json").unlink(missing_ok=True)
+
+    m = dut.expect(r"touch_latency: Tap the screen \d+ times \(([\w-]+) touch reads\)", timeout=120)
+    mode = m[1].decode()
+
+    # Someone (or a tapping rig) has to touch the panel: allow plenty of time
+    dut.expect_exact("TOUCH_LAT_FINAL", timeout=1800)
+
+    output: dict = {
+        "date": date.strftime("%d.%m.%Y %H:%M"),
+        "board": BOARD,
+        "touch_reads": mode,
+        "stages": [],
+    }
+
+    _write(".md", f"# Touch-to-photon latency for BOARD {BOARD}\n\n")
+    _write(".md", f"**DATE:** {date.strftime('%d.%m.%Y %H:%M')}\n\n")
+    _write(".md", f"**Touch reads:** {mode}\n\n")
+    _write(".md", "| Stage | p50 [us] | p90 [us] | p99 [us] | max [us] |\n")
+    _write(".md", "| ----- | :------: | :------: | :------: | :------: |\n")
+
+    for stage in STAGES:
+        m = dut.expect(
+            rf"TOUCH_LAT stage={stage} samples=(\d+) p50_us=(\d+) p90_us=(\d+) "
+            r"p99_us=(\d+) max_us=(\d+)",
+            timeout=30,
+        )
+        entry = {
+            "Stage": stage,
+            "Samples": int(m[1]),
+            "p50": int(m[2]),
+            "p90": int(m[3]),
+            "p99": int(m[4]),
+            "max": int(m[5]),
+        }
+        output["stages"].append(entry)
+        _write(
+            ".md",
+            f"| {STAGE_TITLES[stage]} | {entry['p50']} | {entry['p90']} "
+            f"| {entry['p99']} | {entry['max']} |\n",
+        )
+
+    m = dut.expect(r"TOUCH_LAT_SUMMARY samples=(\d+) dropped=(\d+)", timeout=30)
+    output["samples"] = int(m[1])
+    output["dropped"] = int(m[2])
+    _write(".md", f"\n{output['samples']} taps measured, {output['dropped']} dropped.\n")
+
+    _write(".json", json.dumps(output, indent=4))
@@ -0,0 +1,211 @@
+/**
+ * @file main.c
+ * @brief Touch record and replay
+ * @details Plays touch traces into a scrolling list with an ink overlay and prints the frame
+ *          statistics of each run, so the same interaction can be measured on every build.
+ *          Commands are read from the console, one per line:
+ *
+ *          TOUCH_PLAY_BEGIN       start a streamed trace; the following lines are trace samples
+ *          TOUCH_PLAY_END         end of the streamed trace; prints TOUCH_PLAY_DONE
+ *          TOUCH_PLAY_FILE <path> play a trace file, e.g. from /usb; prints TOUCH_PLAY_DONE
+ *          TOUCH_REC <path>       record the touch input, e.g. to /usb/swipe.trace
+ *          TOUCH_REC_STOP         stop recording
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#if CONFIG_ESP_CONSOLE_UART
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
+#elif CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+#include "driver/usb_serial_jtag.h"
+#include "driver/usb_serial_jtag_vfs.h"
+#endif
+#include "bsp/esp-bsp.h"
+
+static const char *TAG = "touch_replay";
+
+#define LIST_ROWS       (200)
+#define INK_POINTS      (256)
+#define CMD_LINE_MAX    (160)
+
+/* Ink overlay; LVGL task only */
+static lv_obj_t           *s_ink;
+static lv_point_precise_t  s_ink_pts[INK_POINTS];
+static uint32_t            s_ink_count;
+static uint32_t            s_ink_cursor;
+static bool                s_ink_new_stroke;
+
+/* Frame statistics of the current run; LVGL task only */
+static int64_t             s_render_start_us;
+static uint32_t            s_frames;
+static uint64_t            s_render_total_us;
+static uint32_t            s_render_max_us;
+
+static void render_event_cb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        s_render_start_us = esp_timer_get_time();
+    } else if (s_render_start_us) {
+        const uint32_t us = (uint32_t)(esp_timer_get_time() - s_render_start_us);
+        s_frames++;
+        s_render_total_us += us;
+        if (us > s_render_max_us) {
+            s_render_max_us = us;
+        }
+        s_render_start_us = 0;
+    }
+}
+
+/* Draws the stroke through every recorded sample, not only those LVGL saw */
+static void ink_timer_cb(lv_timer_t *t)
+{
+    (void)t;
+    bsp_touch_sample_t samples[32];
+    size_t n = 0;
+    bool changed = false;
+    while (bsp_display_touch_read_samples(&s_ink_cursor, samples, 32, &n, NULL) == ESP_OK && n) {
+        for (size_t i = 0; i < n; i++) {
+            if (samples[i].count == 0) {
+                s_ink_new_stroke = true;    /* keep the stroke shown until the next press */
+                continue;
+            }
+            if (s_ink_new_stroke || s_ink_count == INK_POINTS) {
+                s_ink_new_stroke = false;
+                s_ink_count = 0;
+            }
+            s_ink_pts[s_ink_count].x = samples[i].x;
+            s_ink_pts[s_ink_count].y = samples[i].y;
+            s_ink_count++;
+            changed = true;
+        }
+    }
+    if (changed) {
+        lv_line_set_points(s_ink, s_ink_pts, s_ink_count);
+    }
+}
+
+static void create_ui(void)
+{
+    lv_obj_t *scr = lv_scr_act();
+
+    lv_obj_t *list = lv_list_create(scr);
+    lv_obj_set_size(list, LV_PCT(100), LV_PCT(100));
+    for (int i = 0; i < LIST_ROWS; i++) {
+        char text[32];
+        snprintf(text, sizeof(text), "Row %d", i);
+        lv_list_add_button(list, (i % 3) ? LV_SYMBOL_FILE : LV_SYMBOL_DIRECTORY, text);
+    }
+
+    s_ink = lv_line_create(scr);
+    lv_obj_set_size(s_ink, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_style_line_width(s_ink, 4, 0);
+    lv_obj_set_style_line_color(s_ink, lv_palette_main(LV_PALETTE_RED), 0);
+    lv_obj_set_style_line_rounded(s_ink, true, 0);
+    lv_obj_remove_flag(s_ink, LV_OBJ_FLAG_CLICKABLE);
+    lv_timer_create(ink_timer_cb, 33, NULL);
+
+    lv_display_t *disp = lv_display_get_default();
+    lv_display_add_event_cb(disp, render_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, render_event_cb, LV_EVENT_RENDER_READY, NULL);
+}
+
+static void stats_reset(void)
+{
+    bsp_display_lock(0);
+    s_frames = 0;
+    s_render_total_us = 0;
+    s_render_max_us = 0;
+    bsp_display_unlock();
+    bsp_touch_reset_stats();
+}
+
+static void play_report(void)
+{
+    bsp_touch_play_wait(0);
+
+    bsp_touch_play_stats_t ps = {0};
+    bsp_touch_stats_t ts = {0};
+    bsp_touch_play_get_stats(&ps);
+    bsp_touch_get_stats(&ts);
+    bsp_display_lock(0);
+    const uint32_t frames = s_frames;
+    const uint32_t render_avg_us = s_frames ? (uint32_t)(s_render_total_us / s_frames) : 0;
+    const uint32_t render_max_us = s_render_max_us;
+    bsp_display_unlock();
+
+    printf("TOUCH_PLAY_DONE samples=%" PRIu32 " late_avg_us=%" PRIu32 " late_max_us=%" PRIu32
+           " lvgl_samples=%" PRIu32 " lost=%" PRIu32 " frames=%" PRIu32 " render_avg_us=%" PRIu32
+           " render_max_us=%" PRIu32 "\n", ps.samples, ps.late_avg_us, ps.late_max_us, ts.samples,
+           ts.samples_lost, frames, render_avg_us, render_max_us);
+}
+
+static void console_init(void)
+{
+    setvbuf(stdin, NULL, _IONBF, 0);
+#if CONFIG_ESP_CONSOLE_UART
+    ESP_ERROR_CHECK(uart_driver_install(CONFIG_ESP_CONSOLE_UART_NUM, 4096, 0, 0, NULL, 0));
+    uart_vfs_dev_use_driver(CONFIG_ESP_CONSOLE_UART_NUM);
+#elif CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    usb_serial_jtag_driver_config_t cfg = USB_SERIAL_JTAG_DRIVER_CONFIG_DEFAULT();
+    cfg.rx_buffer_size = 4096;
+    ESP_ERROR_CHECK(usb_serial_jtag_driver_install(&cfg));
+    usb_serial_jtag_vfs_use_driver();
+#endif
+}
+
+void app_main(void)
+{
+    lv_display_t *disp = bsp_display_start();
+    assert(disp);
+    ESP_ERROR_CHECK(bsp_display_backlight_on());
+    if (bsp_usb_start() != ESP_OK) {
+        ESP_LOGW(TAG, "USB host unavailable — traces can only be streamed");
+    }
+
+    bsp_display_lock(0);
+    create_ui();
+    bsp_display_unlock();
+
+    console_init();
+    ESP_LOGI(TAG, "Ready for touch traces on the console");
+
+    char line[CMD_LINE_MAX];
+    bool streaming = false;
+    while (fgets(line, sizeof(line), stdin)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (streaming) {
+            if (strcmp(line, "TOUCH_PLAY_END") == 0) {
+                streaming = false;
+                bsp_touch_play_feed(NULL, 0);
+                play_report();
+            } else {
+                bsp_touch_play_feed(line, 0);
+            }
+        } else if (strcmp(line, "TOUCH_PLAY_BEGIN") == 0) {
+            stats_reset();
+            streaming = (bsp_touch_play_start(NULL) == ESP_OK);
+            printf("%s\n", streaming ? "TOUCH_PLAY_READY" : "TOUCH_PLAY_ERROR");
+        } else if (strncmp(line, "TOUCH_PLAY_FILE ", 16) == 0) {
+            stats_reset();
+            if (bsp_touch_play_start(line + 16) == ESP_OK) {
+                play_report();
+            } else {
+                printf("TOUCH_PLAY_ERROR\n");
+            }
+        } else if (strncmp(line, "TOUCH_REC ", 10) == 0) {
+            ESP_LOGI(TAG, "Record: %s", esp_err_to_name(bsp_touch_record_start(line + 10)));
+        } else if (strcmp(line, "TOUCH_REC_STOP") == 0) {
+            bsp_touch_record_stats_t rs = {0};
+            const esp_err_t ret = bsp_touch_record_stop(&rs);
+            ESP_LOGI(TAG, "Recorded %" PRIu32 " samples, %" PRIu32 " lost: %s", rs.samples, rs.lost,
+                     esp_err_to_name(ret));
+        }
+    }
+}
@@ -0,0 +1,83 @@
+# SPDX-FileCopyrightText: 2026 fmauNeko
+# SPDX-License-Identifier: CC0-1.0
+
+import datetime
+import json
+import re
+import time
+from pathlib import Path
+
+import pytest
+from pytest_embedded import Dut
+
+BOARD = "pandatouch"
+TRACES = ["scroll", "draw"]
+LEAD_MS = 200
+TRACE_RE = re.compile(r"^\s*(?:.*TRACE )?(\d+)\s+(\d+)")
+
+
+def _write(ext: str, text: str) -> None:
+    with open(f"touch_replay_{BOARD}{ext}", "a") as f:
+        f.write(text)
+
+
+def _read_trace(path: Path) -> list:
+    samples = []
+    for line in path.read_text(encoding="utf-8").splitlines():
+        m = TRACE_RE.match(line)
+        if m and not line.lstrip().startswith("#"):
+            samples.append((int(m[1]), line[m.start(1):].strip()))
+    return samples
+
+
+def _play(dut: Dut, samples: list) -> dict:
+    dut.write("TOUCH_PLAY_BEGIN")
+    dut.expect_exact("TOUCH_PLAY_READY", timeout=5)
+
+    # Same pacing as tools/touch_play: each line reaches the board LEAD_MS before it is due
+    start = time.monotonic()
+    t0 = samples[0][0]
+    for t_ms, line in samples:
+        delay = start + (t_ms - t0 - LEAD_MS) / 1000 - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        dut.write(line)
+    dut.write("TOUCH_PLAY_END")
+
+    m = dut.expect(r"TOUCH_PLAY_DONE((?: \w+=\d+)+)", timeout=30)
+    return {k: int(v) for k, v in (kv.split("=") for kv in m[1].decode().split())}
+
+
+@pytest.mark.pandatouch
+@pytest.mark.parametrize("target", ["esp32s3"])
+def test_touch_replay(dut: Dut) -> None:
+    date = datetime.datetime.now()
+
+    Path(f"touch_replay_{BOARD}.md").unlink(missing_ok=True)
+    Path(f"touch_replay_{BOARD}.json").unlink(missing_ok=True)
+
+    dut.expect_exact("Ready for touch traces on the console", timeout=30)
+
+    output: dict = {
+        "date": date.strftime("%d.%m.%Y %H:%M"),
+        "board": BOARD,
+        "traces": [],
+    }
+
+    _write(".md", f"# Touch replay for BOARD {BOARD}\n\n")
+    _write(".md", f"**DATE:** {date.strftime('%d.%m.%Y %H:%M')}\n\n")
+    _write(".md", "| Trace | Samples | Late avg [us] | Late max [us] | Lost | Frames | Render avg [us] | Render max [us] |\n")
+    _write(".md", "| ----- | :-----: | :-----------: | :-----------: | :--: | :----: | :-------------: | :-------------: |\n")
+
+    for name in TRACES:
+        samples = _read_trace(Path(__file__).parent / "traces" / f"{name}.trace")
+        stats = _play(dut, samples)
+        assert stats["samples"] == len(samples)
+        output["traces"].append({"Trace": name, **stats})
+        _write(
+            ".md",
+            f"| {name} | {stats['samples']} | {stats['late_avg_us']} | {stats['late_max_us']} "
+            f"| {stats['lost']} | {stats['frames']} | {stats['render_avg_us']} | {stats['render_max_us']} |\n",
+        )
+
+    _write(".json", json.dumps(output, indent=4))
@@ -0,0 +1,223 @@
+/**
+ * @file main.c
+ * @brief USB drive read throughput benchmark
+ * @details Reads the same file from the USB drive with stdio, with plain read() calls and with BSP streams
+ *          of several chunk sizes, and prints one USB_BENCH line per method. The "_work" rows add a
+ *          simulated decoder that spends a fixed time per KiB, to show the read-ahead of streams
+ *          overlapping the drive with the application.
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "bsp/esp-bsp.h"
+
+static const char *TAG = "usb_bench";
+
+#define BENCH_FILE          "/usb/bench.bin"
+#define BENCH_FILE_SIZE     (8 * 1024 * 1024)
+#define BENCH_BLOCK         (32 * 1024)
+#define WORK_US_PER_KIB     (500)           /* about half of what the drive takes to read a KiB */
+
+static SemaphoreHandle_t s_mounted;
+
+/* Runs in the BSP's MSC task: only signal, the benchmark runs in app_main */
+static void on_mount(void)
+{
+    xSemaphoreGive(s_mounted);
+}
+
+/* The file holds its own offsets, as 32-bit words, so every method can check what it read */
+static bool check_block(const uint8_t *data, size_t len, uint64_t offset)
+{
+    for (size_t i = 0; i + 4 <= len; i += 4096) {
+        uint32_t word;
+        memcpy(&word, data + i, 4);
+        if (word != (uint32_t)(offset + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void work(size_t len)
+{
+    esp_rom_delay_us(len / 1024 * WORK_US_PER_KIB);
+}
+
+static void report(const char *method, uint64_t bytes, int64_t us, uint64_t stall_us, bool ok)
+{
+    printf("USB_BENCH method=%s bytes=%" PRIu64 " ms=%" PRId64 " kib_s=%" PRIu64 " stall_ms=%" PRIu64
+           " ok=%d\n", method, bytes, us / 1000, us ? bytes * 1000000 / 1024 / us : 0, stall_us / 1000, ok);
+}
+
+static esp_err_t prepare_file(uint8_t *buf)
+{
+    struct stat st;
+    if (stat(BENCH_FILE, &st) == 0 && st.st_size == BENCH_FILE_SIZE) {
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Writing %d MiB to %s", BENCH_FILE_SIZE / (1024 * 1024), BENCH_FILE);
+    FILE *f = fopen(BENCH_FILE, "wb");
+    if (!f) {
+        return ESP_FAIL;
+    }
+    const int64_t t0 = esp_timer_get_time();
+    bool ok = true;
+    for (uint32_t off = 0; off < BENCH_FILE_SIZE && ok; off += BENCH_BLOCK) {
+        for (uint32_t i = 0; i < BENCH_BLOCK; i += 4) {
+            const uint32_t word = off + i;
+            memcpy(buf + i, &word, 4);
+        }
+        ok = fwrite(buf, 1, BENCH_BLOCK, f) == BENCH_BLOCK;
+    }
+    ok = (fclose(f) == 0) && ok;
+    report("write_32k", BENCH_FILE_SIZE, esp_timer_get_time() - t0, 0, ok);
+    return ok ? ESP_OK : ESP_FAIL;
+}
+
+/* What applications do by default: fread() through the stdio buffer */
+static void bench_fread(uint8_t *buf, size_t block)
+{
+    char method[24];
+    snprintf(method, sizeof(method), "fread_%uk", (unsigned)(block / 1024));
+    FILE *f = fopen(BENCH_FILE, "rb");
+    if (!f) {
+        report(method, 0, 0, 0, false);
+        return;
+    }
+    uint64_t total = 0;
+    bool ok = true;
+    const int64_t t0 = esp_timer_get_time();
+    size_t n;
+    while ((n = fread(buf, 1, block, f)) > 0) {
+        ok = check_block(buf, n, total) && ok;
+        total += n;
+    }
+    report(method, total, esp_timer_get_time() - t0, 0, ok && total == BENCH_FILE_SIZE);
+    fclose(f);
+}
+
+/* Synchronous read() calls: the application waits for every block */
+static void bench_read(uint8_t *buf, size_t block, bool with_work)
+{
+    char method[24];
+    snprintf(method, sizeof(method), "read_%uk%s", (unsigned)(block / 1024), with_work ? "_work" : "");
+    const int fd = open(BENCH_FILE, O_RDONLY);
+    if (fd < 0) {
+        report(method, 0, 0, 0, false);
+        return;
+    }
+    uint64_t total = 0;
+    uint64_t stall_us = 0;
+    bool ok = true;
+    const int64_t t0 = esp_timer_get_time();
+    for (;;) {
+        const int64_t r0 = esp_timer_get_time();
+        const ssize_t n = read(fd, buf, block);
+        stall_us += esp_timer_get_time() - r0;
+        if (n <= 0) {
+            ok = ok && n == 0;
+            break;
+        }
+        ok = check_block(buf, n, total) && ok;
+        if (with_work) {
+            work(n);
+        }
+        total += n;
+    }
+    report(method, total, esp_timer_get_time() - t0, stall_us, ok && total == BENCH_FILE_SIZE);
+    close(fd);
+}
+
+/* BSP stream: cluster-aligned reads, read ahead while the application uses the previous chunk */
+static void bench_stream(size_t chunk_size, uint8_t buffers, bool with_work)
+{
+    char method[32];
+    snprintf(method, sizeof(method), "stream_%uk_x%u%s", (unsigned)(chunk_size / 1024), buffers,
+             with_work ? "_work" : "");
+    const bsp_usb_stream_cfg_t cfg = {
+        .chunk_size = chunk_size,
+        .buffers    = buffers,
+    };
+    bsp_usb_stream_handle_t stream;
+    const int64_t t0 = esp_timer_get_time();
+    if (bsp_usb_stream_open(BENCH_FILE, &cfg, &stream) != ESP_OK) {
+        report(method, 0, 0, 0, false);
+        return;
+    }
+    uint64_t total = 0;
+    bool ok = true;
+    for (;;) {
+        const void *data;
+        size_t n;
+        const esp_err_t ret = bsp_usb_stream_acquire(stream, &data, &n, 5000);
+        if (ret != ESP_OK || n == 0) {
+            ok = ok && ret == ESP_OK;
+            break;
+        }
+        ok = check_block(data, n, total) && ok;
+        if (with_work) {
+            work(n);
+        }
+        total += n;
+        bsp_usb_stream_release(stream);
+    }
+    const int64_t us = esp_timer_get_time() - t0;
+
+    bsp_usb_stream_stats_t st;
+    bsp_usb_stream_get_stats(stream, &st);
+    bsp_usb_stream_close(stream);
+    report(method, total, us, st.stall_us, ok && total == BENCH_FILE_SIZE);
+    ESP_LOGI(TAG, "%s: %" PRIu32 " reads of %u bytes, cluster %u, %s buffers, drive %" PRIu64 " KiB/s", method,
+             st.reads, (unsigned)st.chunk_size, (unsigned)st.cluster_size, st.dma ? "DMA" : "PSRAM",
+             st.read_us ? st.bytes * 1000000 / 1024 / st.read_us : 0);
+}
+
+void app_main(void)
+{
+    s_mounted = xSemaphoreCreateBinary();
+    bsp_usb_on_mount(on_mount);
+
+    /* Two files at most are open at once here; streams read 32 KiB by default */
+    const bsp_usb_cfg_t usb_cfg = {
+        .max_files         = 2,
+        .stream_chunk_size = 32 * 1024,
+        .stream_buffers    = 2,
+    };
+    ESP_ERROR_CHECK(bsp_usb_start_with_config(&usb_cfg));
+    ESP_LOGI(TAG, "Waiting for a USB drive");
+    xSemaphoreTake(s_mounted, portMAX_DELAY);
+
+    uint8_t *buf = heap_caps_aligned_alloc(64, BENCH_BLOCK, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    assert(buf);
+    if (prepare_file(buf) != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot write %s; is the drive write-protected?", BENCH_FILE);
+        printf("USB_BENCH_DONE\n");
+        return;
+    }
+
+    bench_fread(buf, 1024);
+    bench_read(buf, 4 * 1024, false);
+    bench_read(buf, 32 * 1024, false);
+    bench_stream(16 * 1024, 2, false);
+    bench_stream(32 * 1024, 2, false);
+    bench_stream(64 * 1024, 2, false);
+    bench_stream(32 * 1024, 4, false);
+    bench_read(buf, 32 * 1024, true);
+    bench_stream(32 * 1024, 2, true);
+
+    heap_caps_free(buf);
+    printf("USB_BENCH_DONE\n");
+}
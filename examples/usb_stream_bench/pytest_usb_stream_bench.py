@@ -0,0 +1,58 @@
+# SPDX-FileCopyrightText: 2026 fmauNeko
+# SPDX-License-Identifier: CC0-1.0
+
+import datetime
+import json
+import re
+from pathlib import Path
+
+import pytest
+from pytest_embedded import Dut
+
+BOARD = "pandatouch"
+RESULT_RE = re.compile(rb"USB_BENCH method=(\w+)((?: \w+=\d+)+)")
+
+
+def _write(ext: str, text: str) -> None:
+    with open(f"usb_stream_bench_{BOARD}{ext}", "a") as f:
+        f.write(text)
+
+
+@pytest.mark.pandatouch
+@pytest.mark.parametrize("target", ["esp32s3"])
+def test_usb_stream_bench(dut: Dut) -> None:
+    date = datetime.datetime.now()
+
+    Path(f"usb_stream_bench_{BOARD}.md").unlink(missing_ok=True)
+    Path(f"usb_stream_bench_{BOARD}.json").unlink(missing_ok=True)
+
+    dut.expect_exact("Waiting for a USB drive", timeout=30)
+
+    results = {}
+    while True:
+        m = dut.expect([RESULT_RE, re.compile(rb"USB_BENCH_DONE")], timeout=300)
+        if m.group(0) == b"USB_BENCH_DONE":
+            break
+        fields = {k: int(v) for k, v in (kv.split("=") for kv in m.group(2).decode().split())}
+        results[m.group(1).decode()] = fields
+
+    output = {
+        "date": date.strftime("%d.%m.%Y %H:%M"),
+        "board": BOARD,
+        "methods": [{"Method": k, **v} for k, v in results.items()],
+    }
+
+    _write(".md", f"# USB read throughput for BOARD {BOARD}\n\n")
+    _write(".md", f"**DATE:** {date.strftime('%d.%m.%Y %H:%M')}\n\n")
+    _write(".md", "| Method | Bytes | Time [ms] | Throughput [KiB/s] | Waiting for data [ms] |\n")
+    _write(".md", "| ------ | :---: | :-------: | :----------------: | :-------------------: |\n")
+    for name, r in results.items():
+        _write(".md", f"| {name} | {r['bytes']} | {r['ms']} | {r['kib_s']} | {r['stall_ms']} |\n")
+    _write(".json", json.dumps(output, indent=4))
+
+    assert results, "no USB drive was benchmarked"
+    for name, r in results.items():
+        assert r["ok"] == 1, f"{name} read wrong data"
+    assert results["stream_32k_x2"]["kib_s"] > results["fread_1k"]["kib_s"]
+    # Read-ahead overlaps the drive with the simulated decoder
+    assert results["stream_32k_x2_work"]["ms"] < results["read_32k_work"]["ms"]
@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP scanline compositor
+ *
+ * Framebuffer-less rendering for simple sprite and tilemap UIs. Each scanline is composed on the fly
+ * from a background colour, a stack of tilemap layers and a list of sprites, directly into the RGB
+ * panel's bounce buffers. Pass a scene to bsp_display_new() via bsp_display_config_t::comp_scene to
+ * run the panel without any PSRAM framebuffer.
+ *
+ * This header and the renderer behind it have no ESP-IDF dependencies, so the same code can be
+ * built on the host (see tools/compositor_ref) and its output diffed against the reference renderer.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup g04_display
+ *  @{
+ */
+
+/**
+ * @brief Tilemap layer
+ *
+ * Tiles are square, RGB565, stored row-major one after another. The map wraps around in both
+ * directions, so scrolling past its edges repeats it.
+ */
+typedef struct {
+    const uint16_t *tiles;        /*!< Tile pixels, (1 << tile_shift)^2 pixels per tile */
+    const uint8_t  *map;          /*!< Tile indices, map_w * map_h entries, row-major */
+    uint16_t        map_w;        /*!< Map width in tiles */
+    uint16_t        map_h;        /*!< Map height in tiles */
+    uint8_t         tile_shift;   /*!< log2 of the tile size in pixels (3 = 8 px, 4 = 16 px) */
+    bool            transparent;  /*!< Pixels equal to key show the layers below */
+    uint16_t        key;          /*!< Transparent colour key, used when transparent is set */
+    int16_t         scroll_x;     /*!< Horizontal scroll offset in pixels */
+    int16_t         scroll_y;     /*!< Vertical scroll offset in pixels */
+} bsp_comp_layer_t;
+
+/**
+ * @brief Sprite
+ *
+ * Sprites are drawn after all layers, in array order, so later sprites cover earlier ones.
+ * Pixels equal to key are transparent.
+ */
+typedef struct {
+    const uint16_t *pixels;     /*!< Sprite pixels, RGB565, w * h, row-major */
+    uint16_t        w;          /*!< Width in pixels */
+    uint16_t        h;          /*!< Height in pixels */
+    int16_t         x;          /*!< Screen X of the top-left corner, may be off-screen */
+    int16_t         y;          /*!< Screen Y of the top-left corner, may be off-screen */
+    uint16_t        key;        /*!< Transparent colour key */
+    bool            visible;    /*!< Skip the sprite when false */
+} bsp_comp_sprite_t;
+
+/**
+ * @brief Compositor scene
+ *
+ * All referenced data must stay valid while the scene is displayed. When the panel is built with
+ * CONFIG_LCD_RGB_ISR_IRAM_SAFE alone, tiles, maps and sprite pixels must live in internal RAM;
+ * CONFIG_BSP_LCD_FLASH_WRITE_SAFE keeps PSRAM and constant data reachable as well.
+ */
+typedef struct {
+    uint16_t                 bg;            /*!< Colour shown where no layer or sprite is opaque */
+    const bsp_comp_layer_t  *layers;        /*!< Layers, bottom to top */
+    uint8_t                  layer_count;   /*!< Number of layers */
+    const bsp_comp_sprite_t *sprites;       /*!< Sprites, bottom to top */
+    uint8_t                  sprite_count;  /*!< Number of sprites */
+} bsp_comp_scene_t;
+
+/**
+ * @brief Compose one scanline
+ *
+ * Span-based renderer used by the panel's bounce-buffer refill. Safe to call from ISR context.
+ *
+ * @param[in]  scene Scene to render
+ * @param[in]  y     Scanline index
+ * @param[out] line  Output pixels, at least width entries
+ * @param[in]  width Line width in pixels
+ */
+void bsp_comp_render_line(const bsp_comp_scene_t *scene, int y, uint16_t *line, int width);
+
+/**
+ * @brief Compose one scanline, reference implementation
+ *
+ * Evaluates every pixel independently. Slow, but simple enough to be obviously correct;
+ * bsp_comp_render_line() must produce identical output.
+ *
+ * @param[in]  scene Scene to render
+ * @param[in]  y     Scanline index
+ * @param[out] line  Output pixels, at least width entries
+ * @param[in]  width Line width in pixels
+ */
+void bsp_comp_render_line_ref(const bsp_comp_scene_t *scene, int y, uint16_t *line, int width);
+
+/** @} */ // end of g04_display
+
+#ifdef __cplusplus
+}
+#endif
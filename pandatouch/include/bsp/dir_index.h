@@ -0,0 +1,187 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP directory index
+ *
+ * An index holds the entries of one directory in display order: directories first, then names
+ * compared without case. It is built while the directory is listed and can be read a page at a time
+ * from the first entry on, so a file browser shows the beginning of a large directory long before the
+ * listing ends; entries found later slide into place.
+ *
+ * Memory follows the actual names: each entry is one 32-bit reference to its name, and names are
+ * packed back to back in blocks of BSP_DIR_INDEX_BLOCK bytes that never move. New entries are
+ * appended unsorted and merged into the sorted ones when a page is read, so reading pages while the
+ * listing runs costs one merge per read, not one per entry.
+ *
+ * An index is saved to a byte buffer tagged with a key: the volume serial number, the modification time
+ * of the directory and its path. Loading it back with a different key fails with ESTALE, and a damaged
+ * buffer with EILSEQ, so a cache file on the drive itself can stand in for the listing.
+ *
+ * An index is not thread-safe. bsp_usb_dir_open() (bsp/pandatouch.h) builds and caches the indexes of
+ * directories on the USB drive.
+ *
+ * This header has no ESP-IDF dependencies; see tools/dir_index_test.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup g07_usb
+ *  @{
+ */
+
+#define BSP_DIR_NAME_MAX    (256)       /*!< Longest entry name, with its terminating zero */
+#define BSP_DIR_INDEX_BLOCK (16384)     /*!< Bytes of a name block */
+
+/**
+ * @brief Memory hook of an index
+ *
+ * Same contract as realloc(); called with size 0 to free ptr.
+ */
+typedef void *(*bsp_dir_index_mem_t)(void *ptr, size_t size);
+
+/**
+ * @brief Entry of a page
+ */
+typedef struct {
+    const char *name;   /*!< Name; valid until the index is cleared */
+    bool        is_dir; /*!< Entry is a directory */
+} bsp_dir_entry_t;
+
+/**
+ * @brief Key of a saved index
+ */
+typedef struct {
+    uint32_t    volume_serial;  /*!< Serial number of the volume */
+    int64_t     dir_mtime;      /*!< Modification time of the directory in seconds, 0 if unknown */
+    const char *path;           /*!< Path of the directory */
+} bsp_dir_index_key_t;
+
+/**
+ * @brief Directory index
+ *
+ * Allocated by the caller, initialized by bsp_dir_index_init(). All fields are private.
+ */
+typedef struct {
+    uint32_t           *refs;           /* per entry: directory flag, name block and offset */
+    uint32_t           *scratch;        /* merge space, capacity entries */
+    uint32_t            count;
+    uint32_t            sorted;         /* refs[0, sorted) are in order; the others were added since */
+    uint32_t            capacity;
+    char              **blocks;
+    uint32_t            block_count;
+    uint32_t            block_used;     /* bytes used in the last block */
+    uint32_t            name_bytes;     /* of all names, with their terminating zeros */
+    bsp_dir_index_mem_t mem;
+} bsp_dir_index_t;
+
+/**
+ * @brief Initialize an empty index
+ *
+ * @param[out] index Index
+ * @param[in]  mem   Memory hook, e.g. to put the index in PSRAM; NULL for realloc() and free()
+ */
+void bsp_dir_index_init(bsp_dir_index_t *index, bsp_dir_index_mem_t mem);
+
+/**
+ * @brief Remove all entries and free the memory of an index
+ *
+ * The index stays usable.
+ *
+ * @param[in] index Index
+ */
+void bsp_dir_index_clear(bsp_dir_index_t *index);
+
+/**
+ * @brief Add an entry
+ *
+ * @param[in] index  Index
+ * @param[in] name   Name, copied; 1 to BSP_DIR_NAME_MAX - 1 bytes
+ * @param[in] is_dir Entry is a directory
+ * @return true on success, false if the name is empty or too long, or on lack of memory
+ */
+bool bsp_dir_index_add(bsp_dir_index_t *index, const char *name, bool is_dir);
+
+/**
+ * @brief Get the number of entries
+ *
+ * @param[in] index Index
+ * @return Entries, sorted or not
+ */
+uint32_t bsp_dir_index_count(const bsp_dir_index_t *index);
+
+/**
+ * @brief Merge the entries added since the last sort into the sorted ones
+ *
+ * @param[in] index Index
+ */
+void bsp_dir_index_sort(bsp_dir_index_t *index);
+
+/**
+ * @brief Read a page of entries in display order
+ *
+ * Sorts the index first.
+ *
+ * @param[in]  index Index
+ * @param[in]  first Position of the first entry
+ * @param[in]  count Entries wanted
+ * @param[out] out   count entries
+ * @return Entries written to out; fewer than count at the end of the index
+ */
+uint32_t bsp_dir_index_page(bsp_dir_index_t *index, uint32_t first, uint32_t count, bsp_dir_entry_t *out);
+
+/**
+ * @brief Compare the entries of two indexes
+ *
+ * Sorts both indexes first.
+ *
+ * @param[in] a Index
+ * @param[in] b Index
+ * @return true if they hold the same entries
+ */
+bool bsp_dir_index_equal(bsp_dir_index_t *a, bsp_dir_index_t *b);
+
+/**
+ * @brief Save an index to a buffer
+ *
+ * Sorts the index first.
+ *
+ * @param[in]  index Index
+ * @param[in]  key   Key to save with it; path up to 65535 bytes
+ * @param[out] buf   Buffer, may be NULL to get the size
+ * @param[in]  size  Buffer size
+ * @return Bytes of the saved index, nothing written if it is larger than size; 0 if the path is too long
+ */
+size_t bsp_dir_index_save(bsp_dir_index_t *index, const bsp_dir_index_key_t *key, void *buf, size_t size);
+
+/**
+ * @brief Load an index saved by bsp_dir_index_save()
+ *
+ * Replaces the entries of index. The index is empty on failure.
+ *
+ * @param[in] index Index
+ * @param[in] key   Expected key
+ * @param[in] data  Saved index
+ * @param[in] len   Its size
+ * @return 0 on success, ESTALE if it was saved with another key, EILSEQ if it is damaged, ENOMEM on
+ *         lack of memory
+ */
+int bsp_dir_index_load(bsp_dir_index_t *index, const bsp_dir_index_key_t *key, const void *data, size_t len);
+
+/** @} */ // end of g07_usb
+
+#ifdef __cplusplus
+}
+#endif
@@ -18,6 +18,7 @@
 #pragma once
 #include "esp_lcd_types.h"
 #include "esp_lcd_panel_ops.h"
+#include "bsp/compositor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,13 +48,53 @@ extern "C" {
 #define BSP_LCD_H_RES              (800)
 #define BSP_LCD_V_RES              (480)
 
+/* LCD timings (DE mode, porches in pixel clocks / lines) */
+#define BSP_LCD_HSYNC_PULSE_WIDTH  (4)
+#define BSP_LCD_HSYNC_BACK_PORCH   (8)
+#define BSP_LCD_HSYNC_FRONT_PORCH  (8)
+#define BSP_LCD_VSYNC_PULSE_WIDTH  (4)
+#define BSP_LCD_VSYNC_BACK_PORCH   (16)
+#define BSP_LCD_VSYNC_FRONT_PORCH  (16)
+/* Pixel clocks per scanline and scanlines per frame, blanking included */
+#define BSP_LCD_H_TOTAL            (BSP_LCD_H_RES + BSP_LCD_HSYNC_PULSE_WIDTH + \
+                                    BSP_LCD_HSYNC_BACK_PORCH + BSP_LCD_HSYNC_FRONT_PORCH)
+#define BSP_LCD_V_TOTAL            (BSP_LCD_V_RES + BSP_LCD_VSYNC_PULSE_WIDTH + \
+                                    BSP_LCD_VSYNC_BACK_PORCH + BSP_LCD_VSYNC_FRONT_PORCH)
+
 /**
  * @brief BSP display configuration structure
  */
 typedef struct {
-    void *dummy;    /*!< Prepared for future use. */
+    void *dummy;                            /*!< Unused, kept for source compatibility. */
+    const bsp_comp_scene_t *comp_scene;     /*!< If set, the panel runs without a framebuffer and
+                                                 every scanline is composed from this scene. */
 } bsp_display_config_t;
 
+/**
+ * @brief Scanline compositor statistics
+ */
+typedef struct {
+    uint32_t lines;          /*!< Scanlines composed since bsp_display_new() */
+    uint32_t budget_cycles;  /*!< CPU cycles available per scanline at the configured pixel clock */
+    uint32_t max_cycles;     /*!< Worst observed CPU cycles spent per scanline */
+    uint32_t overruns;       /*!< Bounce-buffer refills that exceeded the per-line budget */
+} bsp_display_comp_stats_t;
+
+/**
+ * @brief Scanout continuity statistics
+ *
+ * Measured from the panel's vsync interrupt. A frame whose interval exceeds 1.5 times the nominal frame
+ * time is counted as late: the panel stalled or had to resynchronise, which shows up as a visible glitch.
+ */
+typedef struct {
+    uint32_t frames;            /*!< Vsync interrupts seen since the last reset */
+    uint32_t late_frames;       /*!< Frame intervals longer than 1.5 x nominal_frame_us */
+    uint32_t min_frame_us;      /*!< Shortest observed frame interval in [us] */
+    uint32_t max_frame_us;      /*!< Longest observed frame interval in [us] */
+    uint32_t nominal_frame_us;  /*!< Frame time derived from the panel timings in [us] */
+    uint64_t elapsed_us;        /*!< Sum of all measured frame intervals in [us] */
+} bsp_display_scanout_stats_t;
+
 /**
  * @brief Create new display panel
  *
@@ -63,6 +104,10 @@ typedef struct {
  *
  * @note For RGB panels, ret_io will always be set to NULL (no IO bus).
  *
+ * @note When config->comp_scene is set, no framebuffer is allocated and esp_lcd_panel_draw_bitmap()
+ *       must not be used. The scene is rendered line by line from the bounce-buffer refill interrupt;
+ *       switch scenes with bsp_display_comp_set_scene().
+ *
  * @param[in]  config    Display configuration. May be NULL for defaults.
  * @param[out] ret_panel esp_lcd panel handle
  * @param[out] ret_io    esp_lcd IO handle (always NULL for RGB panels)
@@ -74,6 +119,52 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config,
                            esp_lcd_panel_handle_t     *ret_panel,
                            esp_lcd_panel_io_handle_t  *ret_io);
 
+/**
+ * @brief Switch the scene shown by the scanline compositor
+ *
+ * The new scene is latched at the start of the next frame, so a frame is always composed from a
+ * single scene. Once this function returns ESP_OK the previous scene is no longer referenced and may
+ * be modified or freed.
+ *
+ * @param[in] scene      New scene
+ * @param[in] timeout_ms Time to wait for the scene to be latched in [ms]
+ * @return
+ *      - ESP_OK                Scene latched
+ *      - ESP_ERR_INVALID_ARG   scene is NULL
+ *      - ESP_ERR_INVALID_STATE Panel was not created in compositor mode
+ *      - ESP_ERR_TIMEOUT       Scene not latched within timeout_ms
+ */
+esp_err_t bsp_display_comp_set_scene(const bsp_comp_scene_t *scene, uint32_t timeout_ms);
+
+/**
+ * @brief Get scanline compositor statistics
+ *
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   stats is NULL
+ *      - ESP_ERR_INVALID_STATE Panel was not created in compositor mode
+ */
+esp_err_t bsp_display_comp_get_stats(bsp_display_comp_stats_t *stats);
+
+/**
+ * @brief Get scanout continuity statistics
+ *
+ * Counters run from bsp_display_new() or the last bsp_display_reset_scanout_stats() call. With
+ * CONFIG_BSP_LCD_FLASH_WRITE_SAFE, late_frames must stay at zero while flash is being written.
+ *
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   stats is NULL
+ */
+esp_err_t bsp_display_get_scanout_stats(bsp_display_scanout_stats_t *stats);
+
+/**
+ * @brief Reset scanout continuity statistics
+ */
+void bsp_display_reset_scanout_stats(void);
+
 /**
  * @brief Initialize display's brightness control
  *
@@ -0,0 +1,372 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP expansion I2C bus
+ *
+ * The BSP owns I2C1, the bus on the 4-pin expansion header. Devices are registered with their own
+ * clock speed and talked to through the BSP, which keeps them from interleaving multi-step exchanges
+ * and accounts for the time each of them holds the bus.
+ *
+ * A bus session is one hold of the bus lock. bsp_ext_i2c_run_batch() runs several transfers in one
+ * session, and the poll scheduler collects the periodic reads that fall due together into one batch,
+ * so sensors sharing the header are read back to back instead of competing for the bus.
+ *
+ * Drivers that only accept a bus handle (e.g. espressif/aht30) can still use bsp_ext_i2c_get_handle();
+ * their transfers are serialized by the I2C driver but are not counted in the statistics.
+ *
+ * Sensors added with bsp_ext_i2c_sensor_add() are run by the sensor hub (bsp/sensor.h): one task steps
+ * their state machines, in one bus session per wake-up, and sleeps through their conversions.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2c_master.h"
+#include "bsp/sensor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup g08_ext_i2c
+ *  @{
+ */
+
+#define BSP_EXT_I2C_POLL_MAX_WRITE  (4)     /*!< Longest command or register address written by a poll */
+#define BSP_EXT_I2C_POLL_MAX_READ   (32)    /*!< Longest read of a poll */
+
+/** @brief Handle of a device registered on the expansion bus */
+typedef struct bsp_ext_i2c_dev_s *bsp_ext_i2c_dev_handle_t;
+
+/** @brief Handle of a periodic read */
+typedef struct bsp_ext_i2c_poll_s *bsp_ext_i2c_poll_handle_t;
+
+/**
+ * @brief Expansion device configuration
+ */
+typedef struct {
+    const char *name;           /*!< Name in the statistics, copied; may be NULL */
+    uint16_t    addr;           /*!< 7-bit I2C address */
+    uint32_t    scl_speed_hz;   /*!< Clock speed for this device; 0 selects CONFIG_BSP_EXT_I2C_CLK_SPEED_HZ */
+    uint32_t    timeout_ms;     /*!< Timeout of one transfer; 0 selects 50 ms */
+} bsp_ext_i2c_dev_config_t;
+
+/**
+ * @brief One transfer of a batch
+ *
+ * A transfer with both write and read bytes is a write followed by a repeated start and the read.
+ */
+typedef struct {
+    bsp_ext_i2c_dev_handle_t dev;       /*!< Target device */
+    const uint8_t           *write;     /*!< Bytes to write, may be NULL */
+    size_t                   write_len; /*!< Number of bytes to write */
+    uint8_t                 *read;      /*!< Buffer for the bytes read, may be NULL */
+    size_t                   read_len;  /*!< Number of bytes to read */
+    esp_err_t                result;    /*!< Set by bsp_ext_i2c_run_batch() */
+} bsp_ext_i2c_op_t;
+
+/**
+ * @brief Periodic read callback
+ *
+ * Called from the BSP I2C task right after the batch its read was part of. Keep it short; it may hand
+ * the data to the display with bsp_display_post().
+ *
+ * @param[in] dev      Device that was read
+ * @param[in] result   ESP_OK, or the error of the transfer
+ * @param[in] data     Bytes read; valid during the call only
+ * @param[in] len      Number of bytes read
+ * @param[in] time_us  esp_timer time at which the batch completed
+ * @param[in] user_ctx User context from the poll configuration
+ */
+typedef void (*bsp_ext_i2c_poll_cb_t)(bsp_ext_i2c_dev_handle_t dev, esp_err_t result, const uint8_t *data,
+                                      size_t len, int64_t time_us, void *user_ctx);
+
+/**
+ * @brief Periodic read configuration
+ */
+typedef struct {
+    bsp_ext_i2c_dev_handle_t dev;               /*!< Device to read */
+    uint8_t  write[BSP_EXT_I2C_POLL_MAX_WRITE]; /*!< Command or register address written before the read */
+    uint8_t  write_len;                         /*!< Number of bytes in write; 0 for a plain read */
+    uint8_t  read_len;                          /*!< Number of bytes to read, 1..BSP_EXT_I2C_POLL_MAX_READ */
+    uint32_t period_ms;                         /*!< Read period in [ms] */
+    bsp_ext_i2c_poll_cb_t cb;                   /*!< Called with every result */
+    void    *user_ctx;                          /*!< Passed to cb */
+} bsp_ext_i2c_poll_config_t;
+
+/**
+ * @brief Bus statistics since the last bsp_ext_i2c_reset_stats()
+ */
+typedef struct {
+    uint32_t sessions;          /*!< Bus sessions, including batches */
+    uint32_t batches;           /*!< Batches, from bsp_ext_i2c_run_batch() and the poll scheduler */
+    uint32_t transfers;         /*!< Transfers of registered devices */
+    uint32_t errors;            /*!< Transfers that failed */
+    uint32_t busy_us_per_s;     /*!< Bus occupancy: time spent in transfers, per second, in [us] */
+    uint32_t session_max_us;    /*!< Longest session in [us] */
+    uint32_t wait_max_us;       /*!< Longest wait for the bus in [us] */
+    uint32_t polls_late;        /*!< Periodic reads that ran more than one period late */
+} bsp_ext_i2c_stats_t;
+
+/**
+ * @brief Per-device statistics since the last bsp_ext_i2c_reset_stats()
+ */
+typedef struct {
+    char     name[16];          /*!< Device name */
+    uint16_t addr;              /*!< 7-bit I2C address */
+    uint32_t scl_speed_hz;      /*!< Clock speed */
+    uint32_t transfers;         /*!< Transfers */
+    uint32_t errors;            /*!< Transfers that failed */
+    uint32_t bytes;             /*!< Bytes written and read */
+    uint32_t busy_us_per_s;     /*!< Share of the bus occupancy in [us] per second */
+} bsp_ext_i2c_dev_stats_t;
+
+/**
+ * @brief Sensor on the expansion bus
+ */
+typedef struct {
+    const bsp_sensor_driver_t *driver;      /*!< Driver, e.g. &bsp_sensor_aht30 */
+    bsp_ext_i2c_dev_config_t   dev;         /*!< Device on the bus */
+    uint32_t                   period_ms;   /*!< Time between two samples; 0 selects 1000 ms */
+    uint32_t                   ring_len;    /*!< Samples kept, rounded up to a power of two; 0 selects 16 */
+} bsp_ext_i2c_sensor_config_t;
+
+/**
+ * @brief Init the expansion I2C bus
+ *
+ * @note This function is idempotent — safe to call multiple times.
+ *
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_NO_MEM        Out of memory
+ *      - Else                  I2C driver installation error
+ */
+esp_err_t bsp_ext_i2c_init(void);
+
+/**
+ * @brief Deinit the expansion I2C bus and free its resources
+ *
+ * Waits for the poll task to finish the callbacks of its last batch and stop.
+ *
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Devices are still registered, or called from a poll callback
+ *      - Else                  I2C driver error
+ */
+esp_err_t bsp_ext_i2c_deinit(void);
+
+/**
+ * @brief Get the expansion I2C bus handle
+ *
+ * For drivers that add their own device to the bus. Their transfers are not part of BSP sessions;
+ * wrap multi-step exchanges in bsp_ext_i2c_lock() / bsp_ext_i2c_unlock() to keep them together.
+ *
+ * @note Lazily initializes the bus if not already done.
+ *
+ * @return I2C master bus handle, or NULL on error
+ */
+i2c_master_bus_handle_t bsp_ext_i2c_get_handle(void);
+
+/**
+ * @brief Register a device on the expansion bus
+ *
+ * @note Lazily initializes the bus if not already done.
+ *
+ * @param[in]  config  Device configuration
+ * @param[out] ret_dev Device handle
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   NULL argument or invalid address
+ *      - ESP_ERR_INVALID_STATE Address already registered
+ *      - ESP_ERR_NO_MEM        CONFIG_BSP_EXT_I2C_MAX_DEVICES reached
+ *      - Else                  I2C driver error
+ */
+esp_err_t bsp_ext_i2c_add_device(const bsp_ext_i2c_dev_config_t *config, bsp_ext_i2c_dev_handle_t *ret_dev);
+
+/**
+ * @brief Unregister a device
+ *
+ * @param[in] dev Device handle
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Unknown device
+ *      - ESP_ERR_INVALID_STATE Periodic reads of the device are still registered
+ */
+esp_err_t bsp_ext_i2c_remove_device(bsp_ext_i2c_dev_handle_t dev);
+
+/**
+ * @brief Check whether a device answers at an address
+ *
+ * @param[in] addr 7-bit I2C address
+ * @return
+ *      - ESP_OK                A device acknowledged
+ *      - ESP_ERR_NOT_FOUND     No acknowledge
+ *      - ESP_ERR_INVALID_STATE Bus could not be initialized
+ *      - Else                  Bus error or timeout
+ */
+esp_err_t bsp_ext_i2c_probe(uint16_t addr);
+
+/**
+ * @brief Start a bus session
+ *
+ * Keeps other tasks off the bus until bsp_ext_i2c_unlock(). Sessions nest; the transfer functions can
+ * be called inside one.
+ *
+ * @param[in] timeout_ms Longest wait for the bus; 0 waits forever
+ * @return true if the bus was taken, false on timeout
+ */
+bool bsp_ext_i2c_lock(uint32_t timeout_ms);
+
+/**
+ * @brief End a bus session started by bsp_ext_i2c_lock()
+ */
+void bsp_ext_i2c_unlock(void);
+
+/**
+ * @brief Write to a device
+ *
+ * @param[in] dev  Device handle
+ * @param[in] data Bytes to write
+ * @param[in] len  Number of bytes
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   NULL argument
+ *      - Else                  I2C error, e.g. ESP_ERR_TIMEOUT
+ */
+esp_err_t bsp_ext_i2c_write(bsp_ext_i2c_dev_handle_t dev, const uint8_t *data, size_t len);
+
+/**
+ * @brief Read from a device
+ *
+ * @param[in]  dev  Device handle
+ * @param[out] data Buffer for the bytes read
+ * @param[in]  len  Number of bytes
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   NULL argument
+ *      - Else                  I2C error, e.g. ESP_ERR_TIMEOUT
+ */
+esp_err_t bsp_ext_i2c_read(bsp_ext_i2c_dev_handle_t dev, uint8_t *data, size_t len);
+
+/**
+ * @brief Write to a device, then read from it after a repeated start
+ *
+ * @param[in]  dev       Device handle
+ * @param[in]  write     Bytes to write, typically a register address
+ * @param[in]  write_len Number of bytes to write
+ * @param[out] read      Buffer for the bytes read
+ * @param[in]  read_len  Number of bytes to read
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   NULL argument
+ *      - Else                  I2C error, e.g. ESP_ERR_TIMEOUT
+ */
+esp_err_t bsp_ext_i2c_write_read(bsp_ext_i2c_dev_handle_t dev, const uint8_t *write, size_t write_len,
+                                 uint8_t *read, size_t read_len);
+
+/**
+ * @brief Run several transfers in one bus session
+ *
+ * Transfers are grouped by clock speed so the bus is reconfigured as few times as possible. Transfers
+ * to the same device keep their order. A failed or invalid transfer does not stop the others; check
+ * the result of each op.
+ *
+ * @param[inout] ops   Transfers; result is set on each
+ * @param[in]    count Number of transfers
+ * @return
+ *      - ESP_OK                All transfers succeeded
+ *      - ESP_ERR_INVALID_ARG   ops is NULL
+ *      - Else                  Error of the first failed transfer, ESP_ERR_INVALID_ARG for an op with an
+ *                              unknown device or without data
+ */
+esp_err_t bsp_ext_i2c_run_batch(bsp_ext_i2c_op_t *ops, size_t count);
+
+/**
+ * @brief Read a device periodically
+ *
+ * The BSP I2C task is started with the first poll. Polls due within CONFIG_BSP_EXT_I2C_BATCH_WINDOW_MS
+ * of each other are read in the same batch, each poll running up to that much early.
+ *
+ * @param[in]  config   Poll configuration
+ * @param[out] ret_poll Poll handle, may be NULL
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   NULL argument, no callback, zero period or invalid lengths
+ *      - ESP_ERR_NO_MEM        CONFIG_BSP_EXT_I2C_MAX_POLLS reached, or the task could not be created
+ */
+esp_err_t bsp_ext_i2c_poll_add(const bsp_ext_i2c_poll_config_t *config, bsp_ext_i2c_poll_handle_t *ret_poll);
+
+/**
+ * @brief Stop a periodic read
+ *
+ * When called from another task, returns after any callback of the poll in progress has finished.
+ *
+ * @param[in] poll Poll handle
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Unknown poll
+ */
+esp_err_t bsp_ext_i2c_poll_remove(bsp_ext_i2c_poll_handle_t poll);
+
+/**
+ * @brief Add a sensor to the sensor hub
+ *
+ * Registers the device and hands the sensor to the hub task, started with the first sensor. Its first
+ * conversion starts at once. Read the samples from any task with bsp_sensor_ring_latest() or
+ * bsp_sensor_ring_read() on sensor->ring; sensor->status tells whether the sensor answers.
+ *
+ * @param[in]  config     Sensor configuration
+ * @param[out] ret_sensor Sensor
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   NULL argument or no driver
+ *      - ESP_ERR_NO_MEM        Out of memory, or the task could not be created
+ *      - Else                  Error of bsp_ext_i2c_add_device()
+ */
+esp_err_t bsp_ext_i2c_sensor_add(const bsp_ext_i2c_sensor_config_t *config, bsp_sensor_t **ret_sensor);
+
+/**
+ * @brief Remove a sensor from the sensor hub and free it
+ *
+ * @note Readers of its ring must have stopped using it.
+ *
+ * @param[in] sensor Sensor from bsp_ext_i2c_sensor_add()
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Unknown sensor
+ */
+esp_err_t bsp_ext_i2c_sensor_remove(bsp_sensor_t *sensor);
+
+/**
+ * @brief Get bus statistics
+ *
+ * @param[out] stats     Bus statistics
+ * @param[out] devs      Per-device statistics, may be NULL
+ * @param[in]  max_devs  Capacity of devs
+ * @param[out] ret_count Number of entries written to devs, may be NULL
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   stats is NULL
+ *      - ESP_ERR_INVALID_STATE Bus not initialized
+ */
+esp_err_t bsp_ext_i2c_get_stats(bsp_ext_i2c_stats_t *stats, bsp_ext_i2c_dev_stats_t *devs, size_t max_devs,
+                                size_t *ret_count);
+
+/**
+ * @brief Clear bus statistics
+ */
+void bsp_ext_i2c_reset_stats(void);
+
+/** @} */ // end of g08_ext_i2c
+
+#ifdef __cplusplus
+}
+#endif
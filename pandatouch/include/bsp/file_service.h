@@ -0,0 +1,304 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP file service core
+ *
+ * File requests (open, read, write, close, stat, list, mkdir) are queued and executed one step at a time by a
+ * single worker, which reports each one to a completion callback. Callers never wait for the file
+ * system: a UI asks for a directory listing and draws it when the callback delivers it.
+ *
+ * Requests have a priority. The worker always steps the oldest request of the highest priority, and a
+ * step transfers at most one slice of a read or write, or one batch of directory entries, so an
+ * interactive request waits for one step of a bulk copy at most, not for the whole copy.
+ *
+ * Every accepted request completes exactly once: with 0, with an errno value, or with ECANCELED when
+ * it was cancelled. bsp_fs_queue_cancel_path() cancels everything under a mount point, e.g. when the
+ * drive is unplugged, and invalidates the files opened there.
+ *
+ * The queue is not thread-safe: submit, pick, finish and cancel under one lock, and run
+ * bsp_fs_queue_step() outside it, from the worker only. File access goes through the POSIX calls, so
+ * the core runs on the host against a local directory (see tools/file_service_test). On the board,
+ * bsp_usb_fs_submit() (bsp/pandatouch.h) runs it in the BSP file service task.
+ *
+ * This header has no ESP-IDF dependencies.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup g07_usb
+ *  @{
+ */
+
+#define BSP_FS_PATH_MAX     (128)   /*!< Longest path of a request, with its terminating zero */
+#define BSP_FS_LIST_BATCH   (16)    /*!< Directory entries listed per step */
+#define BSP_FS_POS_CURRENT  (-1)    /*!< Offset of a read or write that goes on from the previous one */
+#define BSP_FS_FILE_NONE    (-1)    /*!< No file */
+
+/**
+ * @brief Request operations
+ */
+typedef enum {
+    BSP_FS_OP_OPEN,     /*!< Open path with flags; the result holds the new file */
+    BSP_FS_OP_CLOSE,    /*!< Close file */
+    BSP_FS_OP_READ,     /*!< Read len bytes of file into buf */
+    BSP_FS_OP_WRITE,    /*!< Write len bytes of data to file */
+    BSP_FS_OP_STAT,     /*!< Get the size, time and type of path */
+    BSP_FS_OP_LIST,     /*!< Call on_entry for each entry of the directory path */
+    BSP_FS_OP_MKDIR,    /*!< Create the directory path; EEXIST if it exists */
+} bsp_fs_op_t;
+
+/**
+ * @brief Request priorities, highest first
+ */
+typedef enum {
+    BSP_FS_PRIO_INTERACTIVE,    /*!< A user waits for it: listings, stats, small reads */
+    BSP_FS_PRIO_NORMAL,         /*!< Background work that should not lag */
+    BSP_FS_PRIO_BULK,           /*!< Copies and other long transfers */
+    BSP_FS_PRIO_COUNT,
+} bsp_fs_prio_t;
+
+/**
+ * @brief Result of a request
+ */
+typedef struct {
+    uint32_t    id;         /*!< Request id from bsp_fs_queue_submit() */
+    bsp_fs_op_t op;         /*!< Operation */
+    int         err;        /*!< 0 on success, else an errno value; ECANCELED when cancelled */
+    int32_t     file;       /*!< OPEN: the new file; CLOSE, READ, WRITE: the file of the request */
+    size_t      len;        /*!< READ, WRITE: bytes transferred, also when err is set; LIST: entries listed */
+    uint64_t    size;       /*!< STAT: size in bytes */
+    int64_t     mtime;      /*!< STAT: modification time in seconds since the epoch */
+    bool        is_dir;     /*!< STAT: path is a directory */
+} bsp_fs_result_t;
+
+/**
+ * @brief Completion callback, run by the worker once per request
+ *
+ * @param[in] result   Result; valid during the call only
+ * @param[in] user_ctx User context of the request
+ */
+typedef void (*bsp_fs_done_cb_t)(const bsp_fs_result_t *result, void *user_ctx);
+
+/**
+ * @brief Directory entry callback of a LIST request, run by the worker
+ *
+ * "." and ".." are not listed.
+ *
+ * @param[in] name     Entry name; valid during the call only
+ * @param[in] is_dir   Entry is a directory
+ * @param[in] user_ctx User context of the request
+ * @return true to go on, false to end the listing
+ */
+typedef bool (*bsp_fs_entry_cb_t)(const char *name, bool is_dir, void *user_ctx);
+
+/**
+ * @brief Request
+ *
+ * Copied by bsp_fs_queue_submit(), path included. buf and data are not copied: they must stay valid
+ * until the request completes.
+ */
+typedef struct {
+    bsp_fs_op_t       op;       /*!< Operation */
+    bsp_fs_prio_t     prio;     /*!< Priority */
+    const char       *path;     /*!< OPEN, STAT, LIST, MKDIR: path */
+    int               flags;    /*!< OPEN: open() flags, e.g. O_RDONLY or O_WRONLY | O_CREAT | O_TRUNC */
+    int32_t           file;     /*!< CLOSE, READ, WRITE: file from an OPEN result */
+    int64_t           offset;   /*!< READ, WRITE: file position to start at, or BSP_FS_POS_CURRENT */
+    void             *buf;      /*!< READ: destination */
+    const void       *data;     /*!< WRITE: source */
+    size_t            len;      /*!< READ, WRITE: bytes; a read stops short only at the end of the file */
+    bsp_fs_entry_cb_t on_entry; /*!< LIST: entry callback */
+    bsp_fs_done_cb_t  on_done;  /*!< Completion callback, may be NULL */
+    void             *user_ctx; /*!< User context of both callbacks */
+} bsp_fs_request_t;
+
+/**
+ * @brief File service statistics
+ */
+typedef struct {
+    uint32_t submitted;                     /*!< Requests accepted */
+    uint32_t rejected;                      /*!< Requests refused because the queue was full */
+    uint32_t completed;                     /*!< Requests completed, failed and cancelled ones included */
+    uint32_t failed;                        /*!< Requests completed with an error other than ECANCELED */
+    uint32_t cancelled;                     /*!< Requests completed with ECANCELED */
+    uint16_t queued;                        /*!< Requests waiting or running now */
+    uint16_t queued_max;                    /*!< Most requests waiting or running at once */
+    int64_t  wait_max_us[BSP_FS_PRIO_COUNT]; /*!< Longest time from submission to first step, per priority */
+    uint64_t bytes_read;                    /*!< Bytes read by READ requests */
+    uint64_t bytes_written;                 /*!< Bytes written by WRITE requests */
+} bsp_fs_stats_t;
+
+/**
+ * @brief Request slot; private
+ */
+typedef struct {
+    bsp_fs_request_t req;
+    char             path[BSP_FS_PATH_MAX]; /* of the request, or of its file */
+    uint32_t         id;                    /* 0 when free */
+    uint8_t          state;
+    volatile bool    cancel;
+    bool             done;                  /* set by the step, read by bsp_fs_queue_finish() */
+    uint32_t         steps;
+    int64_t          submit_us;
+    int              fd;                    /* OPEN: descriptor opened by the step */
+    void            *dir;                   /* LIST: directory stream between steps */
+    bsp_fs_result_t  result;
+    uint16_t         next;                  /* next slot of the same priority */
+} bsp_fs_slot_t;
+
+/**
+ * @brief Open file; private
+ */
+typedef struct {
+    int      fd;                    /* -1 when closed */
+    uint16_t gen;                   /* changes at each open, so old handles of the entry fail */
+    bool     used;
+    bool     stale;                 /* its volume went away */
+    char     path[BSP_FS_PATH_MAX];
+} bsp_fs_file_t;
+
+/**
+ * @brief Request queue
+ *
+ * Allocated by the caller, initialized by bsp_fs_queue_init(). All fields are private.
+ */
+typedef struct {
+    bsp_fs_slot_t  *slots;
+    bsp_fs_file_t  *files;
+    uint16_t        slot_count;
+    uint16_t        file_count;
+    uint16_t        head[BSP_FS_PRIO_COUNT];
+    uint16_t        tail[BSP_FS_PRIO_COUNT];
+    bsp_fs_slot_t  *running;        /* between bsp_fs_queue_next() and bsp_fs_queue_finish() */
+    size_t          slice;          /* bytes per READ or WRITE step */
+    uint32_t        next_id;
+    bsp_fs_stats_t  stats;
+} bsp_fs_queue_t;
+
+/**
+ * @brief Completion of a finished request, to run outside the queue lock
+ */
+typedef struct {
+    bsp_fs_done_cb_t on_done;   /*!< Completion callback, may be NULL */
+    void            *user_ctx;  /*!< Its user context */
+    bsp_fs_result_t  result;    /*!< Its result */
+} bsp_fs_completion_t;
+
+/**
+ * @brief Initialize a queue
+ *
+ * @param[out] queue      Queue
+ * @param[in]  slots      slot_count request slots
+ * @param[in]  slot_count Requests queued at once, 1 to 65534
+ * @param[in]  files      file_count files
+ * @param[in]  file_count Files open at once, 1 to 255
+ * @param[in]  slice      Bytes transferred per READ or WRITE step, 0 for no limit
+ * @return true on success, false if an argument is out of range
+ */
+bool bsp_fs_queue_init(bsp_fs_queue_t *queue, bsp_fs_slot_t *slots, uint16_t slot_count, bsp_fs_file_t *files,
+                       uint16_t file_count, size_t slice);
+
+/**
+ * @brief Queue a request
+ *
+ * @param[in]  queue  Queue
+ * @param[in]  req    Request, copied
+ * @param[in]  now_us Current time, for the wait statistics
+ * @param[out] ret_id Request id, never 0; may be NULL
+ * @return 0 on success, EINVAL if the request is malformed or its path too long, EAGAIN if the queue is full
+ */
+int bsp_fs_queue_submit(bsp_fs_queue_t *queue, const bsp_fs_request_t *req, int64_t now_us, uint32_t *ret_id);
+
+/**
+ * @brief Pick the request to step next: the oldest one of the highest priority
+ *
+ * @param[in] queue  Queue
+ * @param[in] now_us Current time, for the wait statistics
+ * @return Slot to pass to bsp_fs_queue_step() and then bsp_fs_queue_finish(), NULL if the queue is empty
+ */
+bsp_fs_slot_t *bsp_fs_queue_next(bsp_fs_queue_t *queue, int64_t now_us);
+
+/**
+ * @brief Run one step of a request: the file system calls, and the entry callbacks of a listing
+ *
+ * Called without the queue lock.
+ *
+ * @param[in] queue Queue
+ * @param[in] slot  Slot from bsp_fs_queue_next()
+ */
+void bsp_fs_queue_step(bsp_fs_queue_t *queue, bsp_fs_slot_t *slot);
+
+/**
+ * @brief Complete a stepped request, or queue it again for its next step
+ *
+ * A request that goes on keeps its place before the other requests of its priority.
+ *
+ * @param[in]  queue Queue
+ * @param[in]  slot  Slot passed to bsp_fs_queue_step()
+ * @param[out] out   Completion, when the request is complete
+ * @return true if the request is complete: run out->on_done, outside the lock
+ */
+bool bsp_fs_queue_finish(bsp_fs_queue_t *queue, bsp_fs_slot_t *slot, bsp_fs_completion_t *out);
+
+/**
+ * @brief Cancel a request
+ *
+ * A waiting request completes with ECANCELED before any other one; a running one at the end of its
+ * current step.
+ *
+ * @param[in] queue Queue
+ * @param[in] id    Request id
+ * @return true if the request was waiting or running, false if it already completed
+ */
+bool bsp_fs_queue_cancel(bsp_fs_queue_t *queue, uint32_t id);
+
+/**
+ * @brief Cancel every request under a path and invalidate the files opened there
+ *
+ * Used when a volume goes away. The files are closed at once, or at the end of the step using them;
+ * their requests fail with ECANCELED until they are closed with CLOSE.
+ *
+ * @param[in] queue  Queue
+ * @param[in] prefix Mount point, e.g. "/usb"; matches "/usb" and "/usb/..." but not "/usb2"
+ * @return Number of requests cancelled
+ */
+uint32_t bsp_fs_queue_cancel_path(bsp_fs_queue_t *queue, const char *prefix);
+
+/**
+ * @brief Check whether requests under a path are waiting or running
+ *
+ * After bsp_fs_queue_cancel_path(), false means that they all completed and that nothing under the
+ * path is open any more; the completion of the last one may still be running.
+ *
+ * @param[in] queue  Queue
+ * @param[in] prefix Path
+ * @return true if a request under prefix has not completed yet
+ */
+bool bsp_fs_queue_busy(const bsp_fs_queue_t *queue, const char *prefix);
+
+/**
+ * @brief Get queue statistics
+ *
+ * @param[in]  queue Queue
+ * @param[out] stats Statistics snapshot
+ */
+void bsp_fs_queue_get_stats(const bsp_fs_queue_t *queue, bsp_fs_stats_t *stats);
+
+/** @} */ // end of g07_usb
+
+#ifdef __cplusplus
+}
+#endif
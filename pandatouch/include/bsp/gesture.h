@@ -0,0 +1,165 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP multi-touch gesture recognizer
+ *
+ * Recognizes long press, pinch, rotate and two-finger scroll from the raw GT911 points, in integer
+ * math only. Feed it every touch sample with bsp_gesture_feed(); it reports gestures through a plain
+ * callback. With LVGL, bsp_display_gesture_enable() runs it on the BSP touch input device and delivers
+ * the gestures as LVGL events instead.
+ *
+ * This header and the recognizer behind it have no ESP-IDF dependencies, so recorded point traces can
+ * be replayed on the host (see tools/gesture_replay).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup g04_display
+ *  @{
+ */
+
+/**
+ * @brief Most touch points considered per sample (GT911 reports up to 5)
+ */
+#define BSP_GESTURE_MAX_POINTS  (5)
+
+/**
+ * @brief One touch point
+ */
+typedef struct {
+    int16_t x;      /*!< X coordinate in pixels */
+    int16_t y;      /*!< Y coordinate in pixels */
+    uint8_t id;     /*!< Track ID, stable while the finger stays down */
+} bsp_gesture_point_t;
+
+/**
+ * @brief Gesture type
+ */
+typedef enum {
+    BSP_GESTURE_NONE = 0,
+    BSP_GESTURE_LONG_PRESS,     /*!< One finger held still */
+    BSP_GESTURE_PINCH,          /*!< Two fingers moving apart or together */
+    BSP_GESTURE_ROTATE,         /*!< Two fingers turning around their centre */
+    BSP_GESTURE_SCROLL,         /*!< Two fingers moving together in the same direction */
+} bsp_gesture_type_t;
+
+/**
+ * @brief Gesture phase
+ */
+typedef enum {
+    BSP_GESTURE_BEGIN = 0,      /*!< Gesture recognized */
+    BSP_GESTURE_UPDATE,         /*!< Fingers moved */
+    BSP_GESTURE_END,            /*!< A finger of the gesture was lifted */
+} bsp_gesture_phase_t;
+
+/**
+ * @brief Gesture event
+ *
+ * A two-finger gesture keeps the type it was recognized as until a finger is lifted.
+ */
+typedef struct {
+    bsp_gesture_type_t  type;       /*!< Gesture type */
+    bsp_gesture_phase_t phase;      /*!< Gesture phase */
+    uint32_t            time_ms;    /*!< Time of the sample that produced the event */
+    int16_t             x;          /*!< Finger position, or centre between the two fingers */
+    int16_t             y;          /*!< Finger position, or centre between the two fingers */
+    int32_t             scale_q16;  /*!< PINCH: finger distance relative to the start, Q16.16 (65536 = 1.0) */
+    int16_t             angle_ddeg; /*!< ROTATE: rotation since the start in 0.1 degrees, clockwise positive */
+    int16_t             dx;         /*!< SCROLL: movement of the centre since the previous event */
+    int16_t             dy;         /*!< SCROLL: movement of the centre since the previous event */
+    int16_t             total_dx;   /*!< SCROLL: movement of the centre since the fingers landed */
+    int16_t             total_dy;   /*!< SCROLL: movement of the centre since the fingers landed */
+} bsp_gesture_event_t;
+
+/**
+ * @brief Gesture callback
+ *
+ * @param[in] event    Gesture event, only valid during the call
+ * @param[in] user_ctx User context given to bsp_gesture_init()
+ */
+typedef void (*bsp_gesture_cb_t)(const bsp_gesture_event_t *event, void *user_ctx);
+
+/**
+ * @brief Recognition thresholds; 0 selects the default
+ */
+typedef struct {
+    uint16_t long_press_ms;     /*!< Hold time for a long press (default 600 ms) */
+    uint16_t slop_px;           /*!< Movement that cancels a long press (default 12 px) */
+    uint16_t pinch_px;          /*!< Change of finger distance that starts a pinch (default 24 px) */
+    uint16_t rotate_ddeg;       /*!< Rotation that starts a rotate, in 0.1 degrees (default 150) */
+    uint16_t scroll_px;         /*!< Centre movement that starts a two-finger scroll (default 16 px) */
+} bsp_gesture_cfg_t;
+
+/**
+ * @brief Recognizer state
+ *
+ * Allocated by the caller, initialized by bsp_gesture_init(). The fields are private.
+ */
+typedef struct {
+    bsp_gesture_cfg_t  cfg;
+    bsp_gesture_cb_t   cb;
+    void              *user_ctx;
+    bsp_gesture_type_t active;      /* gesture reported with BEGIN and not ended yet */
+    uint8_t            fingers;     /* fingers down in the previous sample */
+    bool               blocked;     /* no new gesture until every finger is lifted */
+    /* One finger */
+    uint32_t           down_ms;
+    int16_t            down_x;
+    int16_t            down_y;
+    /* Two fingers */
+    uint8_t            id[2];
+    int32_t            dist0;
+    int16_t            angle0;
+    int16_t            cx0;
+    int16_t            cy0;
+    bsp_gesture_event_t last;       /* last event reported */
+} bsp_gesture_t;
+
+/**
+ * @brief Initialize a recognizer
+ *
+ * @param[out] g        Recognizer state
+ * @param[in]  cfg      Thresholds, may be NULL for the defaults
+ * @param[in]  cb       Callback receiving the gestures
+ * @param[in]  user_ctx User context passed to cb
+ */
+void bsp_gesture_init(bsp_gesture_t *g, const bsp_gesture_cfg_t *cfg, bsp_gesture_cb_t cb, void *user_ctx);
+
+/**
+ * @brief Feed one touch sample
+ *
+ * Call for every sample, including those with no finger down, so lifts and hold times are seen.
+ * Runs the callback zero or more times before returning.
+ *
+ * @param[in] g       Recognizer state
+ * @param[in] points  Points of the sample, in controller order
+ * @param[in] count   Number of points (extra points beyond BSP_GESTURE_MAX_POINTS are ignored)
+ * @param[in] time_ms Sample time in milliseconds, from any monotonic clock
+ */
+void bsp_gesture_feed(bsp_gesture_t *g, const bsp_gesture_point_t *points, uint8_t count, uint32_t time_ms);
+
+/**
+ * @brief Reset a recognizer, ending the active gesture if any
+ *
+ * @param[in] g       Recognizer state
+ * @param[in] time_ms Time reported by the END event
+ */
+void bsp_gesture_reset(bsp_gesture_t *g, uint32_t time_ms);
+
+/** @} */ // end of g04_display
+
+#ifdef __cplusplus
+}
+#endif
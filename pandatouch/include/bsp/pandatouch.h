@@ -18,6 +18,11 @@
 #include "bsp/config.h"
 #include "bsp/display.h"
 #include "bsp/touch.h"
+#include "bsp/psram.h"
+#include "bsp/ext_i2c.h"
+#include "bsp/sensor_series.h"
+#include "bsp/file_service.h"
+#include "bsp/dir_index.h"
 
 #if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
 #include "lvgl.h"
@@ -176,6 +181,19 @@ i2c_master_bus_handle_t bsp_i2c_get_handle(void);
 /** @brief USB event callback type */
 typedef void (*bsp_usb_event_cb_t)(void);
 
+#define BSP_USB_STREAM_MAX_BUFFERS  (4)     /*!< Most read-ahead buffers of a USB stream */
+
+/**
+ * @brief USB MSC configuration
+ *
+ * Zero fields take their Kconfig default.
+ */
+typedef struct {
+    uint8_t max_files;          /*!< Files open at once on /usb (CONFIG_BSP_USB_MAX_FILES) */
+    size_t  stream_chunk_size;  /*!< Default read size of a stream in bytes (CONFIG_BSP_USB_STREAM_CHUNK_KB) */
+    uint8_t stream_buffers;     /*!< Default read-ahead buffers of a stream (CONFIG_BSP_USB_STREAM_BUFFERS) */
+} bsp_usb_cfg_t;
+
 /**
  * @brief Start USB MSC host
  *
@@ -188,6 +206,18 @@ typedef void (*bsp_usb_event_cb_t)(void);
  */
 esp_err_t bsp_usb_start(void);
 
+/**
+ * @brief Start USB MSC host with a configuration
+ *
+ * Same as bsp_usb_start(), with the mount options and stream defaults of cfg.
+ *
+ * @param[in] cfg Configuration, copied; NULL for the Kconfig defaults
+ * @return
+ *      - ESP_OK    On success
+ *      - Else      USB host or MSC error
+ */
+esp_err_t bsp_usb_start_with_config(const bsp_usb_cfg_t *cfg);
+
 /**
  * @brief Stop USB MSC host and release resources
  */
@@ -200,6 +230,20 @@ void bsp_usb_stop(void);
  */
 bool bsp_usb_is_mounted(void);
 
+/**
+ * @brief Get the serial number of the mounted volume
+ *
+ * The number FAT and exFAT write to the boot sector when the volume is formatted; Windows shows it as
+ * XXXX-XXXX. It tells sticks apart, e.g. to key data cached on them.
+ *
+ * @param[out] serial Serial number
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   serial is NULL
+ *      - ESP_ERR_INVALID_STATE No drive is mounted, or its boot sector could not be read
+ */
+esp_err_t bsp_usb_get_volume_serial(uint32_t *serial);
+
 /**
  * @brief Register callback for USB device mount event
  *
@@ -214,6 +258,279 @@ void bsp_usb_on_mount(bsp_usb_event_cb_t cb);
  */
 void bsp_usb_on_unmount(bsp_usb_event_cb_t cb);
 
+/**
+ * @brief USB stream handle
+ */
+typedef struct bsp_usb_stream_s *bsp_usb_stream_handle_t;
+
+/**
+ * @brief USB stream configuration
+ *
+ * Zero fields take the defaults of bsp_usb_start_with_config().
+ */
+typedef struct {
+    size_t  chunk_size;     /*!< Bytes per read, rounded up to a multiple of the cluster size */
+    uint8_t buffers;        /*!< Read-ahead buffers, 2 to BSP_USB_STREAM_MAX_BUFFERS */
+} bsp_usb_stream_cfg_t;
+
+/**
+ * @brief USB stream statistics
+ */
+typedef struct {
+    uint64_t bytes;         /*!< Bytes read from the file */
+    uint32_t reads;         /*!< Reads issued to the file system */
+    uint64_t read_us;       /*!< Time spent in those reads in [us]; bytes / read_us is the drive throughput */
+    uint64_t stall_us;      /*!< Time the application waited for data in [us] */
+    size_t   chunk_size;    /*!< Bytes per read */
+    size_t   cluster_size;  /*!< Cluster size of the volume (4096 if unknown); reads start on cluster boundaries */
+    bool     dma;           /*!< Buffers are in DMA-capable internal RAM, not in PSRAM */
+} bsp_usb_stream_stats_t;
+
+/**
+ * @brief Open a file for fast sequential reading
+ *
+ * A reader task reads the file in chunks of whole clusters into DMA-capable buffers, ahead of the
+ * application: while the application uses one chunk, the next one is read from the drive. Each read
+ * starts on a cluster boundary and covers whole clusters, which FATFS transfers straight into the
+ * buffer with one multi-sector command per cluster instead of going through its sector cache.
+ *
+ * Buffers are taken from internal DMA-capable RAM, or from PSRAM if it is short.
+ *
+ * @note A stream is used by one task at a time. It holds one of the files of
+ *       bsp_usb_cfg_t::max_files while open.
+ *
+ * @param[in]  path       File path, e.g. "/usb/assets.bin"
+ * @param[in]  cfg        Configuration, NULL for the defaults
+ * @param[out] ret_stream Stream
+ * @return
+ *      - ESP_OK              On success
+ *      - ESP_ERR_INVALID_ARG path or ret_stream is NULL
+ *      - ESP_ERR_NOT_FOUND   The file could not be opened
+ *      - ESP_ERR_NO_MEM      No memory for the buffers or the reader task
+ */
+esp_err_t bsp_usb_stream_open(const char *path, const bsp_usb_stream_cfg_t *cfg, bsp_usb_stream_handle_t *ret_stream);
+
+/**
+ * @brief Get the next chunk of a stream without copying it
+ *
+ * The chunk stays valid until bsp_usb_stream_release(). Read-ahead continues in the other buffers
+ * meanwhile, so release a chunk as soon as it is used. After bsp_usb_stream_read(), the rest of the
+ * chunk it was copying from comes first.
+ *
+ * @param[in]  stream     Stream
+ * @param[out] data       Chunk data
+ * @param[out] len        Chunk size; 0 at the end of the file
+ * @param[in]  timeout_ms Time to wait for the chunk
+ * @return
+ *      - ESP_OK                On success, or at the end of the file
+ *      - ESP_ERR_INVALID_ARG   An argument is NULL
+ *      - ESP_ERR_INVALID_STATE The previous chunk was not released
+ *      - ESP_ERR_TIMEOUT       The chunk was not read in time
+ *      - ESP_FAIL              A read failed, e.g. the drive was removed
+ */
+esp_err_t bsp_usb_stream_acquire(bsp_usb_stream_handle_t stream, const void **data, size_t *len,
+                                 uint32_t timeout_ms);
+
+/**
+ * @brief Give the chunk of bsp_usb_stream_acquire() back for read-ahead
+ *
+ * @param[in] stream Stream
+ */
+void bsp_usb_stream_release(bsp_usb_stream_handle_t stream);
+
+/**
+ * @brief Copy the next bytes of a stream
+ *
+ * Copies from the read-ahead chunks, waiting for the next one when needed.
+ *
+ * @param[in]  stream     Stream
+ * @param[out] dst        Destination
+ * @param[in]  len        Bytes wanted
+ * @param[out] out_len    Bytes copied; below len only at the end of the file or on error, may be NULL
+ * @param[in]  timeout_ms Time to wait for each chunk
+ * @return
+ *      - ESP_OK                On success, or at the end of the file
+ *      - ESP_ERR_INVALID_ARG   stream or dst is NULL
+ *      - ESP_ERR_INVALID_STATE A chunk is held by bsp_usb_stream_acquire()
+ *      - ESP_ERR_TIMEOUT       A chunk was not read in time
+ *      - ESP_FAIL              A read failed, e.g. the drive was removed
+ */
+esp_err_t bsp_usb_stream_read(bsp_usb_stream_handle_t stream, void *dst, size_t len, size_t *out_len,
+                              uint32_t timeout_ms);
+
+/**
+ * @brief Get USB stream statistics
+ *
+ * @param[in]  stream Stream
+ * @param[out] stats  Statistics snapshot
+ * @return
+ *      - ESP_OK              On success
+ *      - ESP_ERR_INVALID_ARG An argument is NULL
+ */
+esp_err_t bsp_usb_stream_get_stats(bsp_usb_stream_handle_t stream, bsp_usb_stream_stats_t *stats);
+
+/**
+ * @brief Stop the read-ahead, close the file and free the stream
+ *
+ * @param[in] stream Stream, may be NULL
+ */
+void bsp_usb_stream_close(bsp_usb_stream_handle_t stream);
+
+/**
+ * @brief Queue a request to the BSP file service
+ *
+ * The file service task, started by bsp_usb_start(), runs the requests of bsp/file_service.h one step at
+ * a time, highest priority first, and reports each one to req->on_done. UI code lists, stats and reads
+ * files this way without ever waiting for the drive; the callbacks run in the service task, so hand
+ * their results to the UI, e.g. with bsp_display_post(), rather than taking the display lock there.
+ *
+ * When the drive is unplugged, the requests on /usb complete with ECANCELED, and the files opened there
+ * fail with ECANCELED until closed, before the unmount callback runs.
+ *
+ * @param[in]  req    Request, copied; buffers must stay valid until it completes
+ * @param[out] ret_id Request id, for bsp_usb_fs_cancel(); may be NULL
+ * @return
+ *      - ESP_OK                On success: on_done will be called exactly once
+ *      - ESP_ERR_INVALID_ARG   The request is malformed or its path longer than BSP_FS_PATH_MAX
+ *      - ESP_ERR_INVALID_STATE USB was never started
+ *      - ESP_ERR_NO_MEM        CONFIG_BSP_USB_FS_QUEUE_LEN requests are queued already
+ */
+esp_err_t bsp_usb_fs_submit(const bsp_fs_request_t *req, uint32_t *ret_id);
+
+/**
+ * @brief Cancel a file service request
+ *
+ * A waiting request completes with ECANCELED before the other ones; a running one at the end of its
+ * current step.
+ *
+ * @param[in] id Request id from bsp_usb_fs_submit()
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_NOT_FOUND     The request already completed
+ *      - ESP_ERR_INVALID_STATE USB was never started
+ */
+esp_err_t bsp_usb_fs_cancel(uint32_t id);
+
+/**
+ * @brief Get file service statistics
+ *
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   stats is NULL
+ *      - ESP_ERR_INVALID_STATE USB was never started
+ */
+esp_err_t bsp_usb_fs_get_stats(bsp_fs_stats_t *stats);
+
+/**
+ * @brief USB directory handle
+ */
+typedef struct bsp_usb_dir_s *bsp_usb_dir_handle_t;
+
+/**
+ * @brief USB directory change callback
+ *
+ * Runs in the file service task, with the directory locked: it may read entries and the state of dir,
+ * but must not close it, nor wait for the display lock; post to the UI instead, e.g. with
+ * bsp_display_post().
+ *
+ * @param[in] dir      Directory
+ * @param[in] user_ctx User context of the configuration
+ */
+typedef void (*bsp_usb_dir_cb_t)(bsp_usb_dir_handle_t dir, void *user_ctx);
+
+/**
+ * @brief USB directory configuration
+ */
+typedef struct {
+    const char      *path;          /*!< Directory, "/usb" or below it; required */
+    bool             no_cache;      /*!< Neither read nor write the index cache on the drive */
+    bool             skip_hidden;   /*!< Leave out the names starting with a dot */
+    bsp_usb_dir_cb_t on_change;     /*!< Entries were added or replaced, or the state changed; may be NULL */
+    void            *user_ctx;      /*!< User context of on_change */
+} bsp_usb_dir_cfg_t;
+
+/**
+ * @brief Entry of a USB directory
+ */
+typedef struct {
+    char name[BSP_DIR_NAME_MAX];    /*!< Name */
+    bool is_dir;                    /*!< Entry is a directory */
+} bsp_usb_dir_entry_t;
+
+/**
+ * @brief State of a USB directory
+ */
+typedef struct {
+    uint32_t count;     /*!< Entries now */
+    bool     complete;  /*!< The entries are final: the listing, or the check of the cached index, ended */
+    bool     cached;    /*!< The entries came from the index cache on the drive */
+    int      err;       /*!< 0, or the errno value the listing failed with; ECANCELED if the drive went away */
+    uint32_t list_ms;   /*!< Time the listing took, 0 if the directory was not listed */
+} bsp_usb_dir_info_t;
+
+/**
+ * @brief Open a directory of the USB drive as a sorted, paged index
+ *
+ * Returns at once. The file service lists the directory in the background, at normal priority, into a
+ * sorted index in PSRAM (bsp/dir_index.h): bsp_usb_dir_read() returns any page of the entries found
+ * so far, directories first and then by name, and on_change tells when more are found.
+ *
+ * Unless cfg->no_cache is set, the index is then saved to BSPIDX/ at the root of the drive, tagged with
+ * the volume serial number and the modification time of the directory. The next time the directory is
+ * opened on the same stick, the saved index is read instead of listing the directory, which takes a
+ * fraction of the time for thousands of files. A directory time that changed, e.g. because a computer
+ * added a file, makes the saved index stale and the directory is listed again. The root directory has
+ * no time: its saved index is shown at once and checked by a listing in the background.
+ *
+ * @note FATFS does not update the time of a directory when the board itself adds or removes entries in
+ *       it: open the directories the application writes to with no_cache.
+ *
+ * @param[in]  cfg     Configuration, copied
+ * @param[out] ret_dir Directory
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   An argument is NULL, or the path is not under /usb or too long
+ *      - ESP_ERR_INVALID_STATE No drive is mounted
+ *      - ESP_ERR_NO_MEM        No memory, or the file service queue is full
+ */
+esp_err_t bsp_usb_dir_open(const bsp_usb_dir_cfg_t *cfg, bsp_usb_dir_handle_t *ret_dir);
+
+/**
+ * @brief Copy entries of a USB directory, in order
+ *
+ * The order is final once bsp_usb_dir_info_t::complete is set; until then, entries found later may
+ * come before the ones already read.
+ *
+ * @param[in]  dir   Directory
+ * @param[in]  first Position of the first entry
+ * @param[in]  count Entries wanted
+ * @param[out] out   count entries
+ * @return Entries copied; fewer than count at the end of the entries found so far
+ */
+uint32_t bsp_usb_dir_read(bsp_usb_dir_handle_t dir, uint32_t first, uint32_t count, bsp_usb_dir_entry_t *out);
+
+/**
+ * @brief Get the state of a USB directory
+ *
+ * @param[in]  dir  Directory
+ * @param[out] info State
+ * @return
+ *      - ESP_OK              On success
+ *      - ESP_ERR_INVALID_ARG An argument is NULL
+ */
+esp_err_t bsp_usb_dir_get_info(bsp_usb_dir_handle_t dir, bsp_usb_dir_info_t *info);
+
+/**
+ * @brief Close a USB directory
+ *
+ * Cancels the listing if it still runs; an index being saved is still written. on_change is not called
+ * any more once this returns.
+ *
+ * @param[in] dir Directory, may be NULL
+ */
+void bsp_usb_dir_close(bsp_usb_dir_handle_t dir);
+
 /** @} */ // end of g07_usb
 
 #if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
@@ -275,43 +592,1117 @@ lv_display_t *bsp_display_start_with_config(const bsp_display_cfg_t *cfg);
 lv_indev_t *bsp_display_get_input_dev(void);
 
 /**
- * @brief Take LVGL mutex
+ * @brief Touch input statistics
  *
- * @param[in] timeout_ms Timeout in [ms]. 0 will block indefinitely.
- * @return true if mutex was taken, false on timeout
+ * Compare idle_reads and the latency figures with CONFIG_BSP_TOUCH_INTERRUPT enabled and disabled to
+ * see what interrupt-driven reads save. INT edges are timestamped in both modes. Compare the I2C wait
+ * figures with CONFIG_BSP_TOUCH_BACKGROUND_READ enabled and disabled to see what the LVGL task saves.
  */
-bool bsp_display_lock(uint32_t timeout_ms);
+typedef struct {
+    bool     interrupt_mode;    /*!< CONFIG_BSP_TOUCH_INTERRUPT is in effect */
+    bool     background_read;   /*!< CONFIG_BSP_TOUCH_BACKGROUND_READ is in effect */
+    uint32_t interrupts;        /*!< INT edges from the GT911 */
+    uint32_t i2c_reads;         /*!< Touch data reads over I2C */
+    uint32_t idle_reads;        /*!< Reads that found no finger down and no release to report */
+    uint32_t samples;           /*!< Samples handed to LVGL, replayed ones included */
+    uint32_t samples_lost;      /*!< Recorded samples overwritten before LVGL could replay them */
+    uint32_t latency_samples;   /*!< Samples that followed an INT edge, used for the latency figures */
+    uint32_t latency_avg_us;    /*!< Average time from INT edge to LVGL processing the sample in [us] */
+    uint32_t latency_max_us;    /*!< Worst time from INT edge to LVGL processing the sample in [us] */
+    uint32_t i2c_wait_us_per_s; /*!< Time spent waiting on touch reads over I2C, per second, in [us] */
+    uint32_t lvgl_wait_us_per_s;/*!< Part of i2c_wait_us_per_s paid by the LVGL task, in [us] */
+} bsp_touch_stats_t;
 
 /**
- * @brief Give LVGL mutex
+ * @brief Get touch input statistics
+ *
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   stats is NULL
+ *      - ESP_ERR_INVALID_STATE Touch input device not initialized
  */
-void bsp_display_unlock(void);
+esp_err_t bsp_touch_get_stats(bsp_touch_stats_t *stats);
 
 /**
- * @brief Rotate screen
+ * @brief Clear touch input statistics
+ */
+void bsp_touch_reset_stats(void);
+
+/**
+ * @brief Gesture recognizer statistics
+ */
+typedef struct {
+    uint32_t samples;       /*!< Touch samples fed to the recognizer */
+    uint32_t events;        /*!< Gesture events produced */
+    uint32_t dropped;       /*!< Events lost because the LVGL task fell behind */
+    uint32_t cycles_avg;    /*!< Average CPU cycles spent in the recognizer per sample */
+    uint32_t cycles_max;    /*!< Worst CPU cycles spent in the recognizer for one sample */
+} bsp_display_gesture_stats_t;
+
+/**
+ * @brief Recognize multi-touch gestures on the BSP input device
  *
- * @param[in] disp     Pointer to LVGL display
- * @param[in] rotation Rotation angle
+ * Every touch sample, with all its points, is fed to the gesture recognizer (bsp/gesture.h). Each
+ * gesture event is sent from the LVGL task, with the event code returned by
+ * bsp_display_gesture_event_code(), to the object under the fingers when the gesture began (the active
+ * screen if none); lv_event_get_param() returns a `const bsp_gesture_event_t *`. Set
+ * LV_OBJ_FLAG_EVENT_BUBBLE on children to handle gestures on a parent.
+ *
+ * When a two-finger gesture begins, the press LVGL was tracking for the first finger is cancelled, so
+ * the gesture does not also click or drag.
+ *
+ * Calling again replaces the thresholds. Takes effect from the next touch sample.
+ *
+ * @note Must be called with the display lock held.
+ *
+ * @param[in] cfg Thresholds, may be NULL for the defaults
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Touch input device not initialized
+ *      - ESP_ERR_NO_MEM        Event queue could not be allocated
  */
-void bsp_display_rotate(lv_display_t *disp, lv_disp_rotation_t rotation);
+esp_err_t bsp_display_gesture_enable(const bsp_gesture_cfg_t *cfg);
 
 /**
- * @brief Put display (LCD + backlight + touch) into sleep mode
+ * @brief Stop recognizing gestures; a gesture in progress gets its END event
+ */
+void bsp_display_gesture_disable(void);
+
+/**
+ * @brief Get the LVGL event code of gesture events
+ *
+ * @return Event code, or 0 before the first bsp_display_gesture_enable()
+ */
+uint32_t bsp_display_gesture_event_code(void);
+
+/**
+ * @brief Get gesture recognizer statistics
  *
+ * @param[out] stats Statistics snapshot
  * @return
- *      - ESP_OK on success
- *      - ESP_ERR_NOT_SUPPORTED if panel does not support sleep
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   stats is NULL
  */
-esp_err_t bsp_display_enter_sleep(void);
+esp_err_t bsp_display_gesture_get_stats(bsp_display_gesture_stats_t *stats);
 
 /**
- * @brief Wake display (LCD + backlight + touch) from sleep mode
+ * @brief Change the GT911 configuration of the BSP input device
  *
+ * Same as bsp_touch_set_config() on the touchscreen created by bsp_display_start().
+ *
+ * @param[in] config Settings to change; fields left 0 are kept
  * @return
- *      - ESP_OK on success
- *      - ESP_ERR_NOT_SUPPORTED if panel does not support sleep
+ *      - ESP_ERR_INVALID_STATE Touch input device not initialized
+ *      - Else                  See bsp_touch_set_config()
  */
-esp_err_t bsp_display_exit_sleep(void);
+esp_err_t bsp_display_touch_set_config(const bsp_touch_config_t *config);
+
+/**
+ * @brief Filter the touch point handed to LVGL
+ *
+ * The first finger is passed through the touch point filter (bsp/touch_filter.h) before LVGL sees it:
+ * jitter at rest is smoothed away, and with cfg->predict_ms set the point is extrapolated ahead along
+ * the finger speed to make up for part of the render and scanout delay. Gestures still see the raw
+ * points.
+ *
+ * With CONFIG_BSP_TOUCH_FILTER this is called by bsp_display_start() with the Kconfig settings. Calling
+ * again replaces the settings. Takes effect from the next touch sample.
+ *
+ * @param[in] cfg Filter parameters, may be NULL for the defaults
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Touch input device not initialized
+ */
+esp_err_t bsp_display_touch_filter_enable(const bsp_touch_filter_cfg_t *cfg);
+
+/**
+ * @brief Hand the raw touch point to LVGL again
+ */
+void bsp_display_touch_filter_disable(void);
+
+/**
+ * @brief Read the touch samples recorded since the last call
+ *
+ * With CONFIG_BSP_TOUCH_SAMPLE_RING every report of the GT911 is recorded with its time and all its
+ * points, whatever the LVGL read period, in a ring of CONFIG_BSP_TOUCH_SAMPLE_RING_LEN samples. Drawing
+ * code calling this from an LVGL timer or event gets the full controller rate, e.g. to draw a stroke
+ * through every point rather than through one point per refresh. Each caller keeps its own cursor.
+ *
+ * Lock-free: may be called from any task, with or without the display lock.
+ *
+ * @param[inout] cursor  Sequence number of the next sample to read; start with 0
+ * @param[out]   samples Samples, oldest first
+ * @param[in]    max     Capacity of samples
+ * @param[out]   count   Samples written
+ * @param[out]   lost    Samples overwritten before they were read, may be NULL
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   NULL argument
+ *      - ESP_ERR_INVALID_STATE Touch input device not initialized or CONFIG_BSP_TOUCH_SAMPLE_RING disabled
+ */
+esp_err_t bsp_display_touch_read_samples(uint32_t *cursor, bsp_touch_sample_t *samples, size_t max,
+                                         size_t *count, uint32_t *lost);
+
+/**
+ * @brief Hand every recorded touch sample to LVGL
+ *
+ * LVGL normally sees the latest sample at each read; reports that arrived since its previous read, e.g.
+ * while it was rendering, are lost to it. With replay, each read hands LVGL the samples it missed one
+ * after the other, so press, move and release events are not decimated. The replayed samples carry the
+ * LVGL tick of the read, not their report time: use bsp_display_touch_read_samples() where timing
+ * matters.
+ *
+ * With CONFIG_BSP_TOUCH_SAMPLE_REPLAY this is called by bsp_display_start().
+ *
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Touch input device not initialized or CONFIG_BSP_TOUCH_SAMPLE_RING disabled
+ */
+esp_err_t bsp_display_touch_replay_enable(void);
+
+/**
+ * @brief Hand LVGL only the latest touch sample at each read again
+ */
+void bsp_display_touch_replay_disable(void);
+
+/**
+ * @brief Touch recording statistics
+ */
+typedef struct {
+    bool      recording;    /*!< A recording is running */
+    uint32_t  samples;      /*!< Samples written */
+    uint32_t  lost;         /*!< Samples overwritten in the sample ring before they could be written */
+    esp_err_t error;        /*!< ESP_FAIL once a write failed, which ends the recording */
+} bsp_touch_record_stats_t;
+
+/**
+ * @brief Record the touch input to a file
+ *
+ * Every sample of the BSP input device, with all its points, is written as a line of a touch trace
+ * (bsp/touch_trace.h), timed from the start of the recording. A task drains the touch sample ring to the
+ * file, so the touch reads never wait for the file system. Samples played by bsp_touch_play_start() are
+ * recorded too.
+ *
+ * Write to `/usb` (bsp_usb_start()) or to any mounted file system. Traces can be played back with
+ * bsp_touch_play_start(), streamed from a host with tools/touch_play, and replayed on the host through
+ * the gesture recognizer and the point filter (tools/gesture_replay, tools/touch_filter_replay).
+ *
+ * @param[in] path File to create; an existing file is replaced
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   path is NULL
+ *      - ESP_ERR_NOT_SUPPORTED Touch input device not initialized or CONFIG_BSP_TOUCH_SAMPLE_RING disabled
+ *      - ESP_ERR_INVALID_STATE A recording is running
+ *      - ESP_ERR_NOT_FOUND     File could not be created
+ *      - ESP_ERR_NO_MEM        Task could not be created
+ */
+esp_err_t bsp_touch_record_start(const char *path);
+
+/**
+ * @brief Stop recording, write the last samples and close the file
+ *
+ * @param[out] stats Final statistics, may be NULL
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE No recording was started
+ *      - ESP_FAIL              A write failed, e.g. the USB drive was removed; the trace is truncated
+ */
+esp_err_t bsp_touch_record_stop(bsp_touch_record_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the running or last recording
+ *
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   stats is NULL
+ */
+esp_err_t bsp_touch_record_get_stats(bsp_touch_record_stats_t *stats);
+
+/**
+ * @brief Touch playback statistics
+ */
+typedef struct {
+    bool     playing;       /*!< A playback is running */
+    uint32_t samples;       /*!< Samples played */
+    uint32_t late_avg_us;   /*!< Average delay between the trace time of a sample and its injection, in [us] */
+    uint32_t late_max_us;   /*!< Worst delay between the trace time of a sample and its injection, in [us] */
+} bsp_touch_play_stats_t;
+
+/**
+ * @brief Play a touch trace into the BSP input device
+ *
+ * The samples replace the GT911 reads and go the way of real reports: point filter, sample ring,
+ * gestures and LVGL, so the same scenario can be run against every build. Each sample is injected at its
+ * trace time relative to the first sample. With CONFIG_BSP_TOUCH_BACKGROUND_READ and a 1 kHz FreeRTOS
+ * tick, samples reach the input device within tens of microseconds of their time; without background
+ * reads LVGL picks them up at its next read. The real panel is ignored during playback. A finger still
+ * down at the end of the trace is released.
+ *
+ * With path NULL, the trace is streamed with bsp_touch_play_feed() instead, e.g. from a host script
+ * over the console (see tools/touch_play).
+ *
+ * @param[in] path Trace file (bsp/touch_trace.h), or NULL to stream
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Touch input device not initialized, or a playback is running
+ *      - ESP_ERR_NOT_FOUND     File could not be opened
+ *      - ESP_ERR_NO_MEM        Task or queue could not be created
+ */
+esp_err_t bsp_touch_play_start(const char *path);
+
+/**
+ * @brief Stream one line of a trace to the player
+ *
+ * Lines are buffered, so a host can send them ahead of their time; the call blocks while the buffer is
+ * full. Comments and empty lines are accepted and ignored.
+ *
+ * @param[in] line       Trace line, or NULL at the end of the trace
+ * @param[in] timeout_ms Longest wait for room in the buffer; 0 waits forever
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE No streamed playback is running
+ *      - ESP_ERR_TIMEOUT       Buffer still full after timeout_ms
+ */
+esp_err_t bsp_touch_play_feed(const char *line, uint32_t timeout_ms);
+
+/**
+ * @brief Wait for the end of the playback
+ *
+ * @param[in] timeout_ms Timeout in [ms]; 0 waits forever
+ * @return
+ *      - ESP_OK                Playback over
+ *      - ESP_ERR_INVALID_STATE No playback was started
+ *      - ESP_ERR_TIMEOUT       Still playing
+ */
+esp_err_t bsp_touch_play_wait(uint32_t timeout_ms);
+
+/**
+ * @brief Abort the playback; the real panel is read again
+ *
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE No playback was started
+ */
+esp_err_t bsp_touch_play_stop(void);
+
+/**
+ * @brief Get the statistics of the running or last playback
+ *
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   stats is NULL
+ */
+esp_err_t bsp_touch_play_get_stats(bsp_touch_play_stats_t *stats);
+
+/**
+ * @brief Touch-to-photon latency stages, in the order a touch goes through them
+ */
+typedef enum {
+    BSP_TOUCH_LAT_STAGE_INT = 0,    /*!< GT911 INT edge for the report of a landing finger (time origin) */
+    BSP_TOUCH_LAT_STAGE_I2C,        /*!< Touch point read over I2C */
+    BSP_TOUCH_LAT_STAGE_DISPATCH,   /*!< Press handed to LVGL input processing */
+    BSP_TOUCH_LAT_STAGE_RENDER,     /*!< First frame rendered after the press handed to flush */
+    BSP_TOUCH_LAT_STAGE_SWAP,       /*!< That frame became the scanout buffer */
+    BSP_TOUCH_LAT_STAGE_VSYNC,      /*!< Next vsync: the frame has been scanned out entirely (photon) */
+    BSP_TOUCH_LAT_STAGE_MAX,
+} bsp_touch_lat_stage_t;
+
+/**
+ * @brief Touch-to-photon latency percentiles
+ *
+ * Every figure is the time from the INT edge to the stage, in [us]. Index BSP_TOUCH_LAT_STAGE_INT is
+ * always 0.
+ */
+typedef struct {
+    uint32_t samples;                           /*!< Complete measurements the percentiles are based on */
+    uint32_t dropped;                           /*!< Landings abandoned before vsync, e.g. no redraw */
+    uint32_t p50_us[BSP_TOUCH_LAT_STAGE_MAX];   /*!< Median */
+    uint32_t p90_us[BSP_TOUCH_LAT_STAGE_MAX];   /*!< 90th percentile */
+    uint32_t p99_us[BSP_TOUCH_LAT_STAGE_MAX];   /*!< 99th percentile */
+    uint32_t max_us[BSP_TOUCH_LAT_STAGE_MAX];   /*!< Worst case */
+} bsp_touch_lat_report_t;
+
+/**
+ * @brief Get touch-to-photon latency percentiles
+ *
+ * Only available with CONFIG_BSP_TOUCH_LATENCY. Each finger landing is followed through every stage;
+ * the last CONFIG_BSP_TOUCH_LATENCY_SAMPLES complete measurements are kept. A landing only completes
+ * if it causes a redraw, so point the harness at a UI that reacts to presses.
+ *
+ * @note Sorting the samples allocates a temporary array; do not call from an ISR.
+ *
+ * @param[out] report Percentiles
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   report is NULL
+ *      - ESP_ERR_NO_MEM        Temporary array could not be allocated
+ *      - ESP_ERR_NOT_SUPPORTED CONFIG_BSP_TOUCH_LATENCY is disabled
+ */
+esp_err_t bsp_touch_latency_get_report(bsp_touch_lat_report_t *report);
+
+/**
+ * @brief Print the latency percentiles to stdout
+ *
+ * One machine-readable line per stage:
+ * `TOUCH_LAT stage=<name> samples=<n> p50_us=<us> p90_us=<us> p99_us=<us> max_us=<us>`
+ */
+void bsp_touch_latency_print_report(void);
+
+/**
+ * @brief Discard every latency measurement
+ */
+void bsp_touch_latency_reset(void);
+
+/**
+ * @brief Take LVGL mutex
+ *
+ * @param[in] timeout_ms Timeout in [ms]. 0 will block indefinitely.
+ * @return true if mutex was taken, false on timeout
+ */
+bool bsp_display_lock(uint32_t timeout_ms);
+
+/**
+ * @brief Give LVGL mutex
+ */
+void bsp_display_unlock(void);
+
+/**
+ * @brief Number of buckets of the display lock histograms
+ *
+ * Bucket 0 counts durations below 2 us, bucket i durations in [2^i, 2^(i+1)) us and the last bucket
+ * everything from 2^(BSP_DISPLAY_LOCK_HIST_BUCKETS - 1) us up.
+ */
+#define BSP_DISPLAY_LOCK_HIST_BUCKETS  (16)
+
+/**
+ * @brief bsp_display_lock() statistics of one calling task
+ */
+typedef struct {
+    char     task[16];                                  /*!< Task name */
+    uint32_t locks;                                     /*!< Successful bsp_display_lock() calls */
+    uint32_t timeouts;                                  /*!< Calls that timed out */
+    uint64_t wait_us;                                   /*!< Total time spent waiting for the lock in [us] */
+    uint64_t hold_us;                                   /*!< Total time the lock was held in [us] */
+    uint32_t max_wait_us;                               /*!< Longest wait in [us] */
+    uint32_t max_hold_us;                               /*!< Longest hold in [us] */
+    uint32_t wait_hist[BSP_DISPLAY_LOCK_HIST_BUCKETS];  /*!< Wait time histogram */
+    uint32_t hold_hist[BSP_DISPLAY_LOCK_HIST_BUCKETS];  /*!< Hold time histogram */
+} bsp_display_lock_caller_stats_t;
+
+/**
+ * @brief One wait longer than CONFIG_BSP_DISPLAY_LOCK_STATS_LONG_WAIT_US
+ */
+typedef struct {
+    char     waiter[16];    /*!< Task that waited */
+    char     holder[16];    /*!< Task holding the lock when the wait started; "LVGL" if the lock was not
+                                 taken through bsp_display_lock(), i.e. the LVGL task was rendering or
+                                 running timers */
+    uint32_t wait_us;       /*!< Wait duration in [us] */
+    int64_t  time_us;       /*!< esp_timer time at which the wait ended */
+} bsp_display_lock_long_wait_t;
+
+/**
+ * @brief Get bsp_display_lock() statistics per calling task
+ *
+ * Only available with CONFIG_BSP_DISPLAY_LOCK_STATS. Callers are reported in the order they first took
+ * the lock; the LVGL task's own rendering does not go through bsp_display_lock() and shows up as the
+ * "LVGL" holder of long waits instead.
+ *
+ * @param[out] callers Array receiving the statistics
+ * @param[in]  max     Size of callers
+ * @param[out] count   Number of entries written
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   callers or count is NULL
+ *      - ESP_ERR_NOT_SUPPORTED CONFIG_BSP_DISPLAY_LOCK_STATS is disabled
+ */
+esp_err_t bsp_display_lock_get_stats(bsp_display_lock_caller_stats_t *callers, size_t max, size_t *count);
+
+/**
+ * @brief Get the most recent long waits for the display lock, oldest first
+ *
+ * @param[out] waits Array receiving the long waits
+ * @param[in]  max   Size of waits
+ * @param[out] count Number of entries written
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   waits or count is NULL
+ *      - ESP_ERR_NOT_SUPPORTED CONFIG_BSP_DISPLAY_LOCK_STATS is disabled
+ */
+esp_err_t bsp_display_lock_get_long_waits(bsp_display_lock_long_wait_t *waits, size_t max, size_t *count);
+
+/**
+ * @brief Clear the display lock statistics and long waits
+ */
+void bsp_display_lock_reset_stats(void);
+
+/**
+ * @brief Log a display lock summary: per task lock count, wait and hold times, and recent long waits
+ *
+ * Also logged every CONFIG_BSP_DISPLAY_LOCK_STATS_LOG_PERIOD_MS when that option is not 0.
+ */
+void bsp_display_lock_log_stats(void);
+
+/**
+ * @brief Rotate screen
+ *
+ * @param[in] disp     Pointer to LVGL display
+ * @param[in] rotation Rotation angle
+ */
+void bsp_display_rotate(lv_display_t *disp, lv_disp_rotation_t rotation);
+
+/**
+ * @brief Put display (LCD + backlight + touch) into sleep mode
+ *
+ * Blanks the framebuffers, stops rendering and turns the backlight off. With CONFIG_BSP_TOUCH_WAKE, the
+ * touch task then only waits for the GT911 INT line, without any I2C traffic, and a touch wakes the
+ * display. That touch is not handed to LVGL, so it does not click the woken UI.
+ *
+ * @note Scanout keeps running while the display sleeps: the RGB panel driver holds a PM lock that
+ *       prevents automatic light sleep for as long as the panel exists.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if the display is not started
+ *      - ESP_ERR_NOT_SUPPORTED if panel does not support sleep
+ */
+esp_err_t bsp_display_enter_sleep(void);
+
+/**
+ * @brief Wake display (LCD + backlight + touch) from sleep mode
+ *
+ * Rendering resumes at once. The backlight comes back on, at the level last set with
+ * bsp_display_brightness_set(), with the first frame drawn afterwards, so the blank framebuffers are
+ * never shown. The time from the wake to that frame is reported by bsp_display_get_wake_stats().
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if the display is not started
+ *      - ESP_ERR_NOT_SUPPORTED if panel does not support sleep
+ */
+esp_err_t bsp_display_exit_sleep(void);
+
+/**
+ * @brief Check whether the display sleeps
+ *
+ * @return true between bsp_display_enter_sleep() and the next wake, by touch or bsp_display_exit_sleep()
+ */
+bool bsp_display_is_sleeping(void);
+
+/**
+ * @brief Display wake statistics
+ *
+ * A wake is measured from bsp_display_exit_sleep(), or the GT911 INT edge of a waking touch, to the
+ * backlight coming back on with the first frame.
+ */
+typedef struct {
+    uint32_t wakes;         /*!< Wakes measured */
+    uint32_t touch_wakes;   /*!< Wakes caused by a touch */
+    uint32_t last_us;       /*!< Latency of the last wake in [us] */
+    uint32_t avg_us;        /*!< Average wake latency in [us] */
+    uint32_t max_us;        /*!< Longest wake latency in [us] */
+    uint32_t over_target;   /*!< Wakes slower than CONFIG_BSP_DISPLAY_WAKE_TARGET_MS */
+} bsp_display_wake_stats_t;
+
+/**
+ * @brief Get display wake statistics
+ *
+ * @param[out] stats Statistics since bsp_display_start()
+ * @return
+ *      - ESP_OK              On success
+ *      - ESP_ERR_INVALID_ARG stats is NULL
+ */
+esp_err_t bsp_display_get_wake_stats(bsp_display_wake_stats_t *stats);
+
+/**
+ * @brief LVGL render mode
+ */
+typedef enum {
+    BSP_DISPLAY_RENDER_DIRECT = 0,  /*!< Render dirty areas straight into the panel framebuffers (default) */
+    BSP_DISPLAY_RENDER_PARTIAL,     /*!< Render into band buffers and copy them to the visible framebuffer */
+    BSP_DISPLAY_RENDER_FULL,        /*!< Redraw the whole screen into the back framebuffer every frame */
+    BSP_DISPLAY_RENDER_MODE_MAX,
+} bsp_display_render_mode_t;
+
+/**
+ * @brief Render mode configuration
+ */
+typedef struct {
+    bsp_display_render_mode_t mode;  /*!< Render mode */
+    uint32_t partial_lines;          /*!< Band buffer height in lines for PARTIAL,
+                                          0 for CONFIG_BSP_LCD_DRAW_BUF_HEIGHT */
+    bool     partial_double;         /*!< Use two band buffers for PARTIAL */
+} bsp_display_render_cfg_t;
+
+/**
+ * @brief Per-screen render statistics for one render mode
+ */
+typedef struct {
+    uint32_t frames;  /*!< Frames rendered on this screen in this mode */
+    uint32_t avg_us;  /*!< Average render + flush time per frame in [us] */
+    uint32_t max_us;  /*!< Worst render + flush time per frame in [us] */
+} bsp_display_mode_stats_t;
+
+/**
+ * @brief Switch the LVGL render mode at runtime
+ *
+ * All modes share the two PSRAM framebuffers allocated by the RGB panel: DIRECT and FULL render
+ * into them alternately, PARTIAL keeps the front framebuffer on screen and carves its band buffers
+ * out of the back one. Nothing is allocated or freed. The active screen is fully redrawn once after
+ * the switch.
+ *
+ * @note PARTIAL writes into the framebuffer being scanned out and may tear.
+ * @note Must be called under bsp_display_lock().
+ *
+ * @param[in] cfg Render mode configuration
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid configuration
+ *      - ESP_ERR_INVALID_SIZE  Band buffers do not fit in one framebuffer
+ *      - ESP_ERR_INVALID_STATE Display not started
+ */
+esp_err_t bsp_display_set_render_mode(const bsp_display_render_cfg_t *cfg);
+
+/**
+ * @brief Get the active LVGL render mode
+ *
+ * @return Active render mode
+ */
+bsp_display_render_mode_t bsp_display_get_render_mode(void);
+
+/**
+ * @brief Get render statistics of a screen in a given mode
+ *
+ * Render time is measured from LV_EVENT_RENDER_START to LV_EVENT_RENDER_READY for every frame,
+ * keyed by the active screen and render mode. The forced full redraw after a mode switch is not
+ * counted.
+ *
+ * @param[in]  screen Screen object
+ * @param[in]  mode   Render mode
+ * @param[out] stats  Statistics
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   Invalid argument
+ *      - ESP_ERR_NOT_FOUND     No frames recorded for this screen
+ */
+esp_err_t bsp_display_get_mode_stats(lv_obj_t *screen, bsp_display_render_mode_t mode,
+                                     bsp_display_mode_stats_t *stats);
+
+/**
+ * @brief Get the render mode with the lowest average frame time for a screen
+ *
+ * @param[in] screen Screen object
+ * @return Fastest mode measured so far, or BSP_DISPLAY_RENDER_MODE_MAX if nothing was recorded
+ */
+bsp_display_render_mode_t bsp_display_get_best_render_mode(lv_obj_t *screen);
+
+/**
+ * @brief Log render statistics of every screen and mode
+ */
+void bsp_display_log_mode_stats(void);
+
+/**
+ * @brief Background cache statistics
+ */
+typedef struct {
+    bool     valid;            /*!< The cached snapshot is current and being used for redraws */
+    uint32_t rebuilds;         /*!< Number of times the snapshot was re-rendered */
+    uint32_t last_rebuild_us;  /*!< Duration of the last re-render in [us] */
+} bsp_display_bg_cache_stats_t;
+
+/**
+ * @brief Create a cached static background layer
+ *
+ * Returns a full-size container on parent for objects that rarely change (gradients, shadows,
+ * cards). Its content is rendered once into an RGB565 snapshot in PSRAM; redraws of any region
+ * it covers then start from a copy of that snapshot instead of re-executing the background's
+ * draw tasks. Widgets created on parent after this call are drawn on top as usual.
+ *
+ * The cache is rebuilt automatically when style, size, layout, state or value of an object in the
+ * container changes, or when children are added, moved in or removed: the BSP adds an event callback to
+ * every object below the container for this, and leaves event bubbling alone. Changes that emit none of
+ * these events (e.g. lv_label_set_text() without a size change) need bsp_display_bg_cache_invalidate().
+ *
+ * @note Requires CONFIG_LV_USE_SNAPSHOT. Must be called under bsp_display_lock().
+ * @note The snapshot has no alpha channel: the container should paint an opaque background.
+ *
+ * @param[in] parent Object the layer is created on, typically a screen or tab
+ * @return Container for static objects, or NULL on error
+ */
+lv_obj_t *bsp_display_bg_cache_create(lv_obj_t *parent);
+
+/**
+ * @brief Force the background cache to be re-rendered on the next LVGL timer run
+ *
+ * @param[in] cache Container returned by bsp_display_bg_cache_create()
+ */
+void bsp_display_bg_cache_invalidate(lv_obj_t *cache);
+
+/**
+ * @brief Enable or disable the background cache
+ *
+ * While disabled, the static objects are drawn normally on every redraw.
+ *
+ * @param[in] cache   Container returned by bsp_display_bg_cache_create()
+ * @param[in] enabled true to use the cached snapshot
+ */
+void bsp_display_bg_cache_set_enabled(lv_obj_t *cache, bool enabled);
+
+/**
+ * @brief Get background cache statistics
+ *
+ * @param[in]  cache Container returned by bsp_display_bg_cache_create()
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   cache is not a background cache or stats is NULL
+ *      - ESP_ERR_NOT_SUPPORTED LVGL built without snapshot support
+ */
+esp_err_t bsp_display_bg_cache_get_stats(lv_obj_t *cache, bsp_display_bg_cache_stats_t *stats);
+
+/**
+ * @brief Frame-budget governor quality levels
+ *
+ * Each level includes the savings of the levels before it.
+ */
+typedef enum {
+    BSP_DISPLAY_GOV_LEVEL_FULL = 0,     /*!< Full quality */
+    BSP_DISPLAY_GOV_LEVEL_NO_EFFECTS,   /*!< Shadows and opacity layers off on governed objects */
+    BSP_DISPLAY_GOV_LEVEL_SLOW_ANIM,    /*!< Animations stepped at half the refresh rate */
+    BSP_DISPLAY_GOV_LEVEL_SIMPLE,       /*!< Gradients and rounded corners off on governed objects */
+    BSP_DISPLAY_GOV_LEVEL_MAX,
+} bsp_display_gov_level_t;
+
+/**
+ * @brief Called from the LVGL task, under the display lock, after the governor changed level
+ *
+ * Lets the application switch its own heavy widgets to simplified variants.
+ */
+typedef void (*bsp_display_gov_level_cb_t)(bsp_display_gov_level_t level, void *user_ctx);
+
+/**
+ * @brief Frame-budget governor configuration
+ */
+typedef struct {
+    uint32_t budget_us;         /*!< Frame budget in [us] */
+    uint8_t  degrade_frames;    /*!< Consecutive frames over budget before stepping one level down, 0 for 3 */
+    uint8_t  restore_frames;    /*!< Consecutive frames under the restore threshold before stepping one level up,
+                                     0 for 30 */
+    uint8_t  restore_percent;   /*!< Restore threshold in [%] of budget_us, 0 for 60 */
+    bsp_display_gov_level_t max_level;      /*!< Deepest level the governor may reach,
+                                                 0 for BSP_DISPLAY_GOV_LEVEL_MAX - 1 */
+    bsp_display_gov_level_cb_t on_level;    /*!< Optional level change callback */
+    void    *user_ctx;          /*!< Passed to on_level */
+} bsp_display_gov_cfg_t;
+
+/**
+ * @brief Frame-budget governor statistics
+ */
+typedef struct {
+    bsp_display_gov_level_t level;  /*!< Current level */
+    uint32_t frame_us;              /*!< Smoothed frame time in [us] */
+    uint32_t frames;                /*!< Frames observed since start */
+    uint32_t over_budget;           /*!< Frames that exceeded budget_us */
+    uint32_t degrades;              /*!< Level decreases in quality */
+    uint32_t restores;              /*!< Level increases in quality */
+} bsp_display_gov_stats_t;
+
+/**
+ * @brief Start the frame-budget governor
+ *
+ * Frame time is measured from LV_EVENT_RENDER_START to LV_EVENT_RENDER_READY. After degrade_frames
+ * consecutive frames over budget the governor steps one quality level down; it steps back up only
+ * after restore_frames consecutive frames below restore_percent of the budget, so a load hovering
+ * around the budget does not make it oscillate.
+ *
+ * @note Must be called under bsp_display_lock().
+ *
+ * @param[in] cfg Governor configuration
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   cfg is NULL or budget_us is 0
+ *      - ESP_ERR_INVALID_STATE Display not started
+ */
+esp_err_t bsp_display_governor_start(const bsp_display_gov_cfg_t *cfg);
+
+/**
+ * @brief Stop the governor and restore full quality
+ *
+ * @note Must be called under bsp_display_lock().
+ */
+void bsp_display_governor_stop(void);
+
+/**
+ * @brief Put an object under governor control
+ *
+ * Its shadows, opacity layers, gradients and rounded corners are switched off and back on as the
+ * governor changes level. Register the few widgets that dominate render time rather than whole
+ * screens. The object is released automatically when it is deleted.
+ *
+ * @note Must be called under bsp_display_lock().
+ *
+ * @param[in] obj Object to govern
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   obj is NULL
+ *      - ESP_ERR_NO_MEM        Too many governed objects
+ */
+esp_err_t bsp_display_governor_add(lv_obj_t *obj);
+
+/**
+ * @brief Get governor statistics
+ *
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   stats is NULL
+ */
+esp_err_t bsp_display_governor_get_stats(bsp_display_gov_stats_t *stats);
+
+/**
+ * @brief Draws a vector icon into a layer
+ *
+ * Issue LVGL draw calls (lv_draw_vector(), lv_draw_arc(), lv_draw_image() of an SVG, ...) covering
+ * the area (0, 0) .. (size - 1, size - 1) of layer.
+ *
+ * @param[in] layer     Layer to draw into
+ * @param[in] size      Icon width and height in pixels
+ * @param[in] color     Requested icon color
+ * @param[in] user_data bsp_icon_t::user_data
+ */
+typedef void (*bsp_icon_draw_cb_t)(lv_layer_t *layer, int32_t size, lv_color_t color, void *user_data);
+
+/**
+ * @brief Vector icon
+ *
+ * Icons are identified by the address of their bsp_icon_t, which must stay valid while the cache
+ * holds rasterized copies of it. Define them as static const.
+ */
+typedef struct {
+    bsp_icon_draw_cb_t draw;    /*!< Draws the icon. If NULL, src is drawn scaled to the requested size */
+    const void *src;            /*!< Image source for the default drawing, e.g. an SVG lv_image_dsc_t */
+    void       *user_data;      /*!< Passed to draw */
+    bool        multicolor;     /*!< false: rasterized once per size to an A8 mask, colored when drawn.
+                                     true: rasterized per size and color to ARGB8565 */
+} bsp_icon_t;
+
+/**
+ * @brief Icon warm-up request
+ */
+typedef struct {
+    const bsp_icon_t *icon;     /*!< Icon */
+    int32_t           size;     /*!< Size in pixels */
+    lv_color_t        color;    /*!< Color */
+} bsp_icon_req_t;
+
+/**
+ * @brief Icon cache statistics
+ */
+typedef struct {
+    uint32_t hits;          /*!< Lookups served from the cache */
+    uint32_t misses;        /*!< Lookups that had to rasterize */
+    uint32_t evictions;     /*!< Entries dropped to stay under the memory cap */
+    uint32_t failures;      /*!< Lookups that could not be served at all */
+    uint32_t entries;       /*!< Rasterized icons currently cached */
+    size_t   bytes_used;    /*!< PSRAM used by cached icons */
+    size_t   bytes_cap;     /*!< Memory cap */
+    uint32_t raster_us;     /*!< Total time spent rasterizing in [us] */
+} bsp_icon_cache_stats_t;
+
+/**
+ * @brief Initialize the icon cache
+ *
+ * Vector icons are rasterized once per (icon, size, color) into PSRAM and then drawn as plain image
+ * blits. The least recently used entries are evicted when the cache would exceed mem_cap bytes.
+ *
+ * @note Must be called under bsp_display_lock(), like every bsp_icon_* function.
+ *
+ * @param[in] mem_cap Memory cap in bytes
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   mem_cap is 0
+ *      - ESP_ERR_INVALID_STATE Already initialized
+ */
+esp_err_t bsp_icon_cache_init(size_t mem_cap);
+
+/**
+ * @brief Create an image object showing a cached icon
+ *
+ * The cached raster is pinned while the object exists, so it is never evicted under it.
+ *
+ * @param[in] parent Parent object
+ * @param[in] icon   Icon
+ * @param[in] size   Size in pixels
+ * @param[in] color  Color
+ * @return Image object, or NULL if the icon could not be rasterized within the memory cap
+ */
+lv_obj_t *bsp_icon_create(lv_obj_t *parent, const bsp_icon_t *icon, int32_t size, lv_color_t color);
+
+/**
+ * @brief Change the icon, size or color shown by an object from bsp_icon_create()
+ *
+ * @param[in] obj   Object created by bsp_icon_create()
+ * @param[in] icon  Icon
+ * @param[in] size  Size in pixels
+ * @param[in] color Color
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   obj was not created by bsp_icon_create()
+ *      - ESP_ERR_NO_MEM        The icon could not be rasterized within the memory cap
+ */
+esp_err_t bsp_icon_set(lv_obj_t *obj, const bsp_icon_t *icon, int32_t size, lv_color_t color);
+
+/**
+ * @brief Rasterize icons ahead of time
+ *
+ * Queues the icons of an upcoming screen. They are rasterized from an LVGL timer, a few milliseconds
+ * per run, so warming up does not stall the current screen. Requests are copied.
+ *
+ * @param[in] reqs  Icons to rasterize
+ * @param[in] count Number of requests
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_STATE Cache not initialized
+ *      - ESP_ERR_NO_MEM        Queue could not be allocated
+ */
+esp_err_t bsp_icon_cache_warm_up(const bsp_icon_req_t *reqs, size_t count);
+
+/**
+ * @brief Drop every unpinned entry
+ */
+void bsp_icon_cache_clear(void);
+
+/**
+ * @brief Get icon cache statistics
+ *
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   stats is NULL
+ */
+esp_err_t bsp_icon_cache_get_stats(bsp_icon_cache_stats_t *stats);
+
+/**
+ * @brief Creates the widgets of one virtual list row
+ *
+ * @param[in] parent   Virtual list, to be used as the row's parent
+ * @param[in] user_ctx bsp_vlist_cfg_t::user_ctx
+ * @return Row object
+ */
+typedef lv_obj_t *(*bsp_vlist_create_row_cb_t)(lv_obj_t *parent, void *user_ctx);
+
+/**
+ * @brief Fills a recycled row with the data of entry index
+ *
+ * Called whenever a row scrolls into view. Only update the row's widgets here; creating or
+ * deleting objects defeats the recycling.
+ *
+ * @param[in] row      Row object, as returned by the create_row callback
+ * @param[in] index    Entry index, 0 .. count - 1
+ * @param[in] user_ctx bsp_vlist_cfg_t::user_ctx
+ */
+typedef void (*bsp_vlist_bind_row_cb_t)(lv_obj_t *row, uint32_t index, void *user_ctx);
+
+/**
+ * @brief Virtual list configuration
+ */
+typedef struct {
+    uint32_t count;                         /*!< Number of entries */
+    int32_t  row_height;                    /*!< Height of every row in pixels */
+    bsp_vlist_create_row_cb_t create_row;   /*!< Row factory. NULL for a row holding one vertically
+                                                 centered label, lv_obj_get_child(row, 0) */
+    bsp_vlist_bind_row_cb_t   bind_row;     /*!< Data-source callback, required */
+    void    *user_ctx;                      /*!< Passed to the callbacks */
+} bsp_vlist_cfg_t;
+
+/**
+ * @brief Create a virtualized list
+ *
+ * Only the rows that fit in the visible area, plus two spares, exist as LVGL objects. While
+ * scrolling, rows leaving the view are moved to the entries entering it and re-bound through
+ * bind_row, so memory use does not depend on count.
+ *
+ * Clicks on a row bubble up to the list; use bsp_vlist_get_index() on the event target to find
+ * the entry.
+ *
+ * @note Must be called under bsp_display_lock(), like every bsp_vlist_* function.
+ *
+ * @param[in] parent Parent object
+ * @param[in] cfg    List configuration
+ * @return List object, or NULL on error
+ */
+lv_obj_t *bsp_vlist_create(lv_obj_t *parent, const bsp_vlist_cfg_t *cfg);
+
+/**
+ * @brief Change the number of entries and re-bind the visible rows
+ *
+ * @param[in] list  List created by bsp_vlist_create()
+ * @param[in] count New number of entries
+ */
+void bsp_vlist_set_count(lv_obj_t *list, uint32_t count);
+
+/**
+ * @brief Re-bind the visible rows after the underlying data changed
+ *
+ * @param[in] list List created by bsp_vlist_create()
+ */
+void bsp_vlist_refresh(lv_obj_t *list);
+
+/**
+ * @brief Scroll so that an entry is at the top of the list
+ *
+ * @param[in] list  List created by bsp_vlist_create()
+ * @param[in] index Entry index
+ * @param[in] anim  LV_ANIM_ON to scroll with animation
+ */
+void bsp_vlist_scroll_to(lv_obj_t *list, uint32_t index, lv_anim_enable_t anim);
+
+/**
+ * @brief Get the entry shown by a row, or by any object inside a row
+ *
+ * @param[in] list List created by bsp_vlist_create()
+ * @param[in] obj  Row, or a descendant of a row
+ * @return Entry index, or -1 if obj is not part of a bound row
+ */
+int32_t bsp_vlist_get_index(lv_obj_t *list, lv_obj_t *obj);
+
+/**
+ * @brief Largest payload accepted by bsp_display_post()
+ */
+#define BSP_DISPLAY_POST_DATA_MAX  (16)
+
+/**
+ * @brief Applies a posted UI update
+ *
+ * Runs in the LVGL task with the display lock held, right before a display refresh.
+ *
+ * @param[in] data     Word-aligned copy of the latest payload posted for the key
+ * @param[in] user_ctx User context given to bsp_display_post()
+ */
+typedef void (*bsp_display_post_cb_t)(const void *data, void *user_ctx);
+
+/**
+ * @brief UI update queue statistics
+ */
+typedef struct {
+    uint32_t posted;        /*!< Successful bsp_display_post() calls */
+    uint32_t coalesced;     /*!< Posts that replaced a not yet applied update of the same key */
+    uint32_t applied;       /*!< Callbacks run by the LVGL task */
+    uint32_t dropped;       /*!< Posts rejected because every slot was in use */
+    uint32_t max_drain_us;  /*!< Longest time spent applying updates in one frame in [us] */
+    uint32_t slots_used;    /*!< Keys currently holding a slot */
+} bsp_display_post_stats_t;
+
+/**
+ * @brief Post a UI update from any task without taking the display lock
+ *
+ * The payload is copied into the slot of key and cb(data, user_ctx) is called once by the LVGL task
+ * within one display refresh period, right before the refresh. Posting again before then replaces the
+ * pending update, so a value that changes many times between frames costs a single callback. Posting
+ * never waits for LVGL to finish rendering; it only waits for a concurrent post of the same key to copy
+ * its payload, so the latest post is the one applied. The widget an update targets is usually a good key.
+ *
+ * Updates of different keys are not ordered with respect to each other. Because intermediate
+ * payloads may be dropped, do not post pointers that transfer ownership.
+ *
+ * A key keeps its slot until bsp_display_post_forget() is called for it (CONFIG_BSP_DISPLAY_POST_SLOTS
+ * slots in total).
+ *
+ * @param[in] key      Non-zero update key
+ * @param[in] cb       Callback applying the update
+ * @param[in] user_ctx User context passed to cb
+ * @param[in] data     Payload, may be NULL if len is 0
+ * @param[in] len      Payload size in bytes, at most BSP_DISPLAY_POST_DATA_MAX
+ * @return
+ *      - ESP_OK              On success
+ *      - ESP_ERR_INVALID_ARG key is 0, cb is NULL or len is too large
+ *      - ESP_ERR_NO_MEM      Every slot is held by another key
+ */
+esp_err_t bsp_display_post(uintptr_t key, bsp_display_post_cb_t cb, void *user_ctx, const void *data, size_t len);
+
+/**
+ * @brief Release the slot of a key
+ *
+ * Drops the pending update of key, if any, e.g. before deleting the widget it targets.
+ *
+ * @note Must be called under bsp_display_lock(), and only once no task posts to key anymore.
+ *
+ * @param[in] key Update key
+ */
+void bsp_display_post_forget(uintptr_t key);
+
+/**
+ * @brief Get UI update queue statistics
+ *
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK              On success
+ *      - ESP_ERR_INVALID_ARG stats is NULL
+ */
+esp_err_t bsp_display_post_get_stats(bsp_display_post_stats_t *stats);
+
+/**
+ * @brief Sensor history chart configuration
+ */
+typedef struct {
+    bsp_sensor_series_t     *series;    /*!< History drawn, required; see bsp/sensor_series.h */
+    const bsp_sensor_ring_t *ring;      /*!< Ring drained into series by the chart, e.g. &sensor->ring.
+                                             NULL if the application feeds series in the LVGL task */
+    uint8_t                  index;     /*!< Value index drawn, e.g. 0 for the AHT30 temperature */
+    uint32_t                 span_s;    /*!< Time shown across the chart in [s] */
+    uint32_t                 points;    /*!< Points across the chart, 0 for one per pixel of content width */
+    int32_t                  min;       /*!< Value at the bottom, in the units of the driver */
+    int32_t                  max;       /*!< Value at the top */
+    lv_color_t               color;     /*!< Line color */
+} bsp_sensor_chart_cfg_t;
+
+/**
+ * @brief Sensor history chart statistics
+ */
+typedef struct {
+    uint32_t rebuilds;  /*!< Full redraws: at creation, on resize and each time half a span has passed */
+    uint32_t slots;     /*!< Points added one at a time, each redrawing only its own line segments */
+    uint32_t lost;      /*!< Samples overwritten in the ring before the chart drained them */
+} bsp_sensor_chart_stats_t;
+
+/**
+ * @brief Create a chart of the history of a sensor value
+ *
+ * The chart is divided into points time slots of span_s / points each. A slot shows the sample that
+ * bsp_sensor_series_pick() chooses among those of its time, so spikes are not averaged away, and
+ * long spans read the coarser levels of the series. The newest sample starts in the middle of the
+ * chart; each completed slot then adds one point and redraws only the line segments next to it. When
+ * the chart is full, it moves by half a span in one redraw.
+ *
+ * A slot without samples leaves a gap in the line: keep span_s / points at or above the sample period,
+ * and the series long enough to hold a point per slot over the whole span.
+ *
+ * The series must only be fed and queried in the LVGL task while the chart exists, which is the case
+ * when ring is set. Style the result like any lv_chart, e.g. with lv_chart_set_div_line_count().
+ *
+ * @note Must be called under bsp_display_lock().
+ *
+ * @param[in] parent Parent object
+ * @param[in] cfg    Chart configuration, copied
+ * @return Chart object, or NULL on error
+ */
+lv_obj_t *bsp_sensor_chart_create(lv_obj_t *parent, const bsp_sensor_chart_cfg_t *cfg);
+
+/**
+ * @brief Get sensor history chart statistics
+ *
+ * @note Must be called under bsp_display_lock().
+ *
+ * @param[in]  chart Chart created by bsp_sensor_chart_create()
+ * @param[out] stats Statistics snapshot
+ * @return
+ *      - ESP_OK              On success
+ *      - ESP_ERR_INVALID_ARG chart is not a sensor chart, or stats is NULL
+ */
+esp_err_t bsp_sensor_chart_get_stats(lv_obj_t *chart, bsp_sensor_chart_stats_t *stats);
 
 /** @} */ // end of g04_display
 
@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP PSRAM bandwidth monitor
+ *
+ * The octal PSRAM is shared by RGB scanout, LVGL rendering, buffer copies and the application heap.
+ * The monitor estimates how much bandwidth each of them consumes and periodically measures how much is
+ * still available, so features can be sized against real headroom.
+ *
+ * Consumption is an estimate: scanout is derived from the panel timings and the measured frame rate,
+ * rendering and copies from the bytes the BSP moves, and application traffic from what the application
+ * reports with bsp_psram_monitor_account(). Headroom is measured: a low-priority task streams a small
+ * uncached PSRAM buffer and times it.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup g05_psram PSRAM
+ *  @brief PSRAM bandwidth monitor API
+ *  @{
+ */
+
+/**
+ * @brief PSRAM bandwidth consumers
+ */
+typedef enum {
+    BSP_PSRAM_CONSUMER_SCANOUT = 0,  /*!< RGB panel reading the framebuffer, derived from the panel timings */
+    BSP_PSRAM_CONSUMER_RENDER,       /*!< LVGL writing rendered pixels into PSRAM framebuffers */
+    BSP_PSRAM_CONSUMER_COPY,         /*!< Buffer copies and DMA transfers to or from PSRAM */
+    BSP_PSRAM_CONSUMER_APP,          /*!< Traffic reported by the application */
+    BSP_PSRAM_CONSUMER_MAX,
+} bsp_psram_consumer_t;
+
+/**
+ * @brief PSRAM bandwidth monitor configuration
+ */
+typedef struct {
+    uint32_t period_ms;    /*!< Report window and probe period in [ms], 100..10000. 0 selects 1000 ms */
+    uint32_t probe_size;   /*!< Bytes streamed per probe. 0 selects 32 KB */
+    bool     log_report;   /*!< Log a one-line report at the end of every window */
+} bsp_psram_monitor_cfg_t;
+
+/**
+ * @brief PSRAM bandwidth report
+ *
+ * All rates are in bytes per second, averaged over the last complete window.
+ */
+typedef struct {
+    uint32_t consumer_bps[BSP_PSRAM_CONSUMER_MAX];  /*!< Estimated bandwidth per consumer */
+    uint32_t consumed_bps;    /*!< Sum of consumer_bps */
+    uint32_t headroom_bps;    /*!< Measured streaming read bandwidth still available */
+    uint32_t bus_bps;         /*!< Theoretical bus bandwidth from the PSRAM mode and clock */
+    uint8_t  utilization;     /*!< consumed_bps * 100 / (consumed_bps + headroom_bps), in [%] */
+    uint32_t window_ms;       /*!< Length of the window the report covers in [ms] */
+} bsp_psram_report_t;
+
+/**
+ * @brief Start the PSRAM bandwidth monitor
+ *
+ * @param[in] cfg Monitor configuration. May be NULL for defaults.
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   period_ms out of range
+ *      - ESP_ERR_INVALID_STATE Monitor already running
+ *      - ESP_ERR_NO_MEM        Probe buffer or task could not be allocated
+ */
+esp_err_t bsp_psram_monitor_start(const bsp_psram_monitor_cfg_t *cfg);
+
+/**
+ * @brief Stop the PSRAM bandwidth monitor and free its resources
+ */
+void bsp_psram_monitor_stop(void);
+
+/**
+ * @brief Account bytes moved to or from PSRAM
+ *
+ * Cheap enough to call from any task or ISR. Traffic is only accumulated while the monitor runs.
+ *
+ * @param[in] consumer Consumer the traffic belongs to
+ * @param[in] bytes    Bytes read or written
+ */
+void bsp_psram_monitor_account(bsp_psram_consumer_t consumer, uint32_t bytes);
+
+/**
+ * @brief Get the last complete bandwidth report
+ *
+ * @param[out] report Report snapshot
+ * @return
+ *      - ESP_OK                On success
+ *      - ESP_ERR_INVALID_ARG   report is NULL
+ *      - ESP_ERR_INVALID_STATE No window completed yet
+ */
+esp_err_t bsp_psram_monitor_get_report(bsp_psram_report_t *report);
+
+/**
+ * @brief Log the last complete bandwidth report
+ */
+void bsp_psram_monitor_log_report(void);
+
+/** @} */ // end of g05_psram
+
+#ifdef __cplusplus
+}
+#endif
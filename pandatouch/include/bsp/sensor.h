@@ -0,0 +1,231 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP sensor hub core
+ *
+ * Sensors are driven as state machines: a step starts a conversion, or reads a finished one, and tells
+ * the hub when it wants to run again. No step waits for a conversion, so one task serves every sensor
+ * and spends the conversion times sleeping.
+ *
+ * Each sensor writes timestamped samples into a ring. The ring has a single writer (the hub) and any
+ * number of lock-free readers: UI code reads the latest sample, or every sample since its last read,
+ * without waiting for the sensor task.
+ *
+ * This header has no ESP-IDF dependencies. Sensors talk to their device through bsp_sensor_io_t, so the
+ * state machines run on the host against a mock device (see tools/sensor_hub_test). On the board,
+ * bsp_ext_i2c_sensor_add() (bsp/ext_i2c.h) runs them on the expansion I2C bus.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup g08_ext_i2c
+ *  @{
+ */
+
+#define BSP_SENSOR_MAX_VALUES   (4)         /*!< Values per sample */
+#define BSP_SENSOR_PENDING      (INT32_MIN) /*!< Sensor status before its first sample */
+#define BSP_SENSOR_ERR_TIMEOUT  (0x107)     /*!< Conversion did not finish; same value as ESP_ERR_TIMEOUT */
+#define BSP_SENSOR_ERR_CRC      (0x109)     /*!< Data failed its checksum; same value as ESP_ERR_INVALID_CRC */
+
+#define BSP_SENSOR_AHT30_ADDR   (0x38)      /*!< I2C address of the AHT30 */
+
+/**
+ * @brief One sample
+ */
+typedef struct {
+    int64_t  time_us;                       /*!< Time the sample was read, from the hub's clock */
+    uint32_t seq;                           /*!< Sample number, counted from 0 for each sensor */
+    int32_t  value[BSP_SENSOR_MAX_VALUES];  /*!< Values in the units of the driver */
+} bsp_sensor_sample_t;
+
+/**
+ * @brief Ring slot; seq is seq + 1 of the sample it holds, 0 while it is being written
+ */
+typedef struct {
+    volatile uint32_t   seq;
+    bsp_sensor_sample_t sample;
+} bsp_sensor_slot_t;
+
+/**
+ * @brief Sample ring: one writer, lock-free readers
+ */
+typedef struct {
+    bsp_sensor_slot_t *slots;   /*!< Storage */
+    uint32_t           mask;    /*!< Capacity - 1; the capacity is a power of two */
+    volatile uint32_t  head;    /*!< Samples written so far */
+} bsp_sensor_ring_t;
+
+/**
+ * @brief Access to the device of a sensor
+ *
+ * Both functions return 0 on success, else an error code (esp_err_t on the board).
+ */
+typedef struct {
+    int  (*write)(void *ctx, const uint8_t *data, size_t len);  /*!< Write bytes to the device */
+    int  (*read)(void *ctx, uint8_t *data, size_t len);         /*!< Read bytes from the device */
+    void  *ctx;                                                 /*!< Passed to write and read */
+} bsp_sensor_io_t;
+
+typedef struct bsp_sensor_s bsp_sensor_t;
+
+/**
+ * @brief Sensor driver
+ */
+typedef struct {
+    const char *name;           /*!< Driver name */
+    uint8_t     value_count;    /*!< Values per sample, up to BSP_SENSOR_MAX_VALUES */
+    /**
+     * Run one step of the state machine, kept in sensor->state and sensor->retries; state 0 is the
+     * start after power-up or an error. A step does a few short transfers at most and never waits.
+     *
+     * @param[in]  sensor   Sensor
+     * @param[out] values   Filled when *done is set
+     * @param[out] delay_ms Time until the next step; not used when *done is set, the next conversion
+     *                      then starts one period after the previous one
+     * @param[out] done     Set when a sample is complete
+     * @return 0, or an error code: the hub counts it and restarts the sensor from state 0 a period later
+     */
+    int (*step)(bsp_sensor_t *sensor, int32_t *values, uint32_t *delay_ms, bool *done);
+} bsp_sensor_driver_t;
+
+/**
+ * @brief Sensor
+ *
+ * Allocated by the caller, initialized by bsp_sensor_init(). Readers may use ring, status and errors;
+ * the other fields are private.
+ */
+struct bsp_sensor_s {
+    const bsp_sensor_driver_t *driver;
+    bsp_sensor_io_t            io;
+    uint32_t                   period_ms;
+    bsp_sensor_ring_t          ring;        /*!< Samples, see bsp_sensor_ring_latest() and bsp_sensor_ring_read() */
+    volatile int32_t           status;      /*!< 0 after a good sample, BSP_SENSOR_PENDING, or the last error */
+    volatile uint32_t          errors;      /*!< Failed steps */
+    uint8_t                    state;
+    uint8_t                    retries;
+    bool                       cycle_start; /* next step starts a conversion cycle */
+    int64_t                    cycle_us;    /* start of the current cycle */
+    int64_t                    due_us;      /* time of the next step */
+    bsp_sensor_t              *next;
+};
+
+/**
+ * @brief Sensor hub: the sensors run by one task
+ */
+typedef struct {
+    bsp_sensor_t *first;        /*!< Private */
+} bsp_sensor_hub_t;
+
+/** @brief AHT30 temperature and humidity sensor: value[0] in [m°C], value[1] in [m%RH] */
+extern const bsp_sensor_driver_t bsp_sensor_aht30;
+
+/**
+ * @brief Initialize a ring
+ *
+ * @param[out] ring     Ring
+ * @param[in]  slots    Storage, zeroed
+ * @param[in]  capacity Number of slots, a power of two
+ */
+void bsp_sensor_ring_init(bsp_sensor_ring_t *ring, bsp_sensor_slot_t *slots, uint32_t capacity);
+
+/**
+ * @brief Append a sample, overwriting the oldest one when the ring is full
+ *
+ * Single writer only. sample->seq is ignored; the ring numbers the samples.
+ *
+ * @param[in] ring   Ring
+ * @param[in] sample Sample
+ */
+void bsp_sensor_ring_push(bsp_sensor_ring_t *ring, const bsp_sensor_sample_t *sample);
+
+/**
+ * @brief Get the newest sample; lock-free, from any task
+ *
+ * @param[in]  ring Ring
+ * @param[out] out  Newest sample
+ * @return true if there is one, false if the ring is empty
+ */
+bool bsp_sensor_ring_latest(const bsp_sensor_ring_t *ring, bsp_sensor_sample_t *out);
+
+/**
+ * @brief Get the samples written since the last call; lock-free, from any task
+ *
+ * Samples are returned oldest first. Samples that were overwritten before they could be read are
+ * skipped and counted in lost.
+ *
+ * @param[in]    ring   Ring
+ * @param[inout] cursor Sequence number of the next sample to read; start with 0, or with the seq of the
+ *                      newest sample + 1 to skip the history
+ * @param[out]   out    Samples
+ * @param[in]    max    Capacity of out
+ * @param[out]   lost   Samples skipped, may be NULL
+ * @return Number of samples written to out
+ */
+size_t bsp_sensor_ring_read(const bsp_sensor_ring_t *ring, uint32_t *cursor, bsp_sensor_sample_t *out,
+                            size_t max, uint32_t *lost);
+
+/**
+ * @brief Initialize a sensor
+ *
+ * @param[out] sensor    Sensor
+ * @param[in]  driver    Driver
+ * @param[in]  io        Access to the device, copied
+ * @param[in]  period_ms Time between the starts of two conversions
+ * @param[in]  slots     Ring storage, zeroed
+ * @param[in]  capacity  Number of slots, a power of two
+ */
+void bsp_sensor_init(bsp_sensor_t *sensor, const bsp_sensor_driver_t *driver, const bsp_sensor_io_t *io,
+                     uint32_t period_ms, bsp_sensor_slot_t *slots, uint32_t capacity);
+
+/**
+ * @brief Initialize a hub
+ *
+ * @param[out] hub Hub
+ */
+void bsp_sensor_hub_init(bsp_sensor_hub_t *hub);
+
+/**
+ * @brief Add a sensor to a hub; its first step is due at once
+ *
+ * @param[in] hub    Hub
+ * @param[in] sensor Initialized sensor
+ * @param[in] now_us Current time
+ */
+void bsp_sensor_hub_add(bsp_sensor_hub_t *hub, bsp_sensor_t *sensor, int64_t now_us);
+
+/**
+ * @brief Remove a sensor from a hub
+ *
+ * @param[in] hub    Hub
+ * @param[in] sensor Sensor
+ * @return true if the sensor was in the hub
+ */
+bool bsp_sensor_hub_remove(bsp_sensor_hub_t *hub, bsp_sensor_t *sensor);
+
+/**
+ * @brief Run the steps that are due
+ *
+ * @param[in] hub    Hub
+ * @param[in] now_us Current time; samples are stamped with it
+ * @return Time the next step is due, INT64_MAX when the hub is empty
+ */
+int64_t bsp_sensor_hub_run(bsp_sensor_hub_t *hub, int64_t now_us);
+
+/** @} */ // end of g08_ext_i2c
+
+#ifdef __cplusplus
+}
+#endif
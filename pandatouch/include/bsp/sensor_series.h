@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP sensor time series
+ *
+ * A series keeps the history of a sensor in fixed memory, at several resolutions. Level 0 holds the
+ * samples as they were read; every factor points of a level are averaged into one point of the next
+ * level. Each level is a ring of the same capacity, so with a capacity of 512 points, a factor of 8 and
+ * a sample every 2 s, four levels cover 17 min at full resolution, 2.3 h, 18 h and 6 days.
+ *
+ * Queries return a given number of points, usually the width of a chart in pixels, picked with the
+ * Largest-Triangle-Three-Buckets (LTTB) algorithm: peaks and edges survive the decimation, unlike with
+ * plain averaging or striding. For each part of its time range, a query reads the finest level that
+ * still holds it: a week-long chart ends with the samples of the last minutes, not with an average.
+ *
+ * A series is not thread-safe: feed and query it from one task, e.g. the LVGL task draining the sensor
+ * ring with bsp_sensor_series_drain(). bsp_sensor_chart_create() (bsp/pandatouch.h) draws one.
+ *
+ * This header has no ESP-IDF dependencies; see tools/sensor_series_test.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bsp/sensor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup g08_ext_i2c
+ *  @{
+ */
+
+#define BSP_SENSOR_SERIES_MAX_LEVELS  (4)   /*!< Resolutions kept by a series */
+
+/**
+ * @brief Point of a series: a sample, or the average of factor points of the level below
+ */
+typedef struct {
+    int64_t time_us;                        /*!< Sample time, or average time of the merged points */
+    int32_t value[BSP_SENSOR_MAX_VALUES];   /*!< Values, or their averages */
+} bsp_sensor_point_t;
+
+/**
+ * @brief Point returned by a query
+ */
+typedef struct {
+    int64_t time_us;    /*!< Time of the point */
+    int32_t value;      /*!< Value of the queried index */
+} bsp_sensor_xy_t;
+
+/**
+ * @brief One resolution of a series; private
+ */
+typedef struct {
+    bsp_sensor_point_t *points;                         /* ring of capacity points */
+    uint32_t            head;                           /* points written so far */
+    uint32_t            pending;                        /* points of the level below not merged yet */
+    int64_t             sum_time;                       /* their sums */
+    int64_t             sum_value[BSP_SENSOR_MAX_VALUES];
+} bsp_sensor_level_t;
+
+/**
+ * @brief Time series
+ *
+ * Allocated by the caller, initialized by bsp_sensor_series_init(). All fields are private.
+ */
+typedef struct {
+    bsp_sensor_level_t level[BSP_SENSOR_SERIES_MAX_LEVELS];
+    uint32_t           capacity;    /* points per level */
+    uint16_t           factor;      /* points of a level merged into one of the next */
+    uint8_t            levels;
+    uint32_t           cursor;      /* next sample of the ring drained by bsp_sensor_series_drain() */
+} bsp_sensor_series_t;
+
+/**
+ * @brief Initialize a series
+ *
+ * @param[out] series   Series
+ * @param[in]  storage  levels * capacity points, e.g. in PSRAM
+ * @param[in]  capacity Points per level, at least factor
+ * @param[in]  levels   Resolutions, 1 to BSP_SENSOR_SERIES_MAX_LEVELS
+ * @param[in]  factor   Points of a level averaged into one point of the next, at least 2
+ * @return true on success, false if an argument is out of range
+ */
+bool bsp_sensor_series_init(bsp_sensor_series_t *series, bsp_sensor_point_t *storage, uint32_t capacity,
+                            uint8_t levels, uint16_t factor);
+
+/**
+ * @brief Append a sample
+ *
+ * Samples must be added in time order. The oldest point of each level is overwritten when it is full.
+ *
+ * @param[in] series  Series
+ * @param[in] time_us Sample time
+ * @param[in] values  BSP_SENSOR_MAX_VALUES values
+ */
+void bsp_sensor_series_add(bsp_sensor_series_t *series, int64_t time_us, const int32_t *values);
+
+/**
+ * @brief Append the samples written to a sensor ring since the last call
+ *
+ * The first call takes the whole history still in the ring.
+ *
+ * @param[in]  series Series
+ * @param[in]  ring   Ring of the sensor, e.g. sensor->ring
+ * @param[out] lost   Samples overwritten in the ring before they were drained, may be NULL
+ * @return Number of samples added
+ */
+size_t bsp_sensor_series_drain(bsp_sensor_series_t *series, const bsp_sensor_ring_t *ring, uint32_t *lost);
+
+/**
+ * @brief Get the time span of a series
+ *
+ * @param[in]  series   Series
+ * @param[out] first_us Time of the oldest point kept, may be NULL
+ * @param[out] last_us  Time of the newest sample, may be NULL
+ * @return true if the series holds a point, false if it is empty
+ */
+bool bsp_sensor_series_span(const bsp_sensor_series_t *series, int64_t *first_us, int64_t *last_us);
+
+/**
+ * @brief Get n points of a time range, decimated with LTTB
+ *
+ * The first and the last point of the range are always returned. When the range holds fewer than n
+ * points, all of them are returned.
+ *
+ * @param[in]  series  Series
+ * @param[in]  index   Value index, below BSP_SENSOR_MAX_VALUES
+ * @param[in]  from_us Start of the range
+ * @param[in]  to_us   End of the range, excluded; INT64_MAX for everything up to the newest sample
+ * @param[out] out     Points, oldest first
+ * @param[in]  n       Capacity of out, e.g. the width of the chart in pixels
+ * @return Number of points written to out: n, or fewer if the range holds fewer points
+ */
+size_t bsp_sensor_series_query(const bsp_sensor_series_t *series, uint8_t index, int64_t from_us,
+                               int64_t to_us, bsp_sensor_xy_t *out, size_t n);
+
+/**
+ * @brief Pick one point of a time range, keeping its peaks
+ *
+ * Returns the point of the range that forms the largest triangle with prev and the average of the
+ * range itself, among the finest points kept for the range. Unlike LTTB, which uses the average of the
+ * next bucket, this needs no point after the range, so a chart can be drawn one time bucket at a time,
+ * e.g. extended by the bucket that just completed without querying it again. The picks can differ from
+ * those of bsp_sensor_series_query() over the same buckets.
+ *
+ * @param[in]  series  Series
+ * @param[in]  index   Value index, below BSP_SENSOR_MAX_VALUES
+ * @param[in]  from_us Start of the range
+ * @param[in]  to_us   End of the range, excluded
+ * @param[in]  prev    Point picked before, NULL to compare with the first point of the range
+ * @param[out] out     Picked point
+ * @return true if the range holds a point, false if it is empty
+ */
+bool bsp_sensor_series_pick(const bsp_sensor_series_t *series, uint8_t index, int64_t from_us, int64_t to_us,
+                            const bsp_sensor_xy_t *prev, bsp_sensor_xy_t *out);
+
+/** @} */ // end of g08_ext_i2c
+
+#ifdef __cplusplus
+}
+#endif
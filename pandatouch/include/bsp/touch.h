@@ -14,10 +14,20 @@
  *
  * For standard LCD initialization with LVGL graphical library, you can call
  * all-in-one function bsp_display_start().
+ *
+ * Without LVGL, feed the points from esp_lcd_touch_get_data() to the gesture
+ * recognizer in bsp/gesture.h for pinch, rotate and two-finger scroll, and
+ * smooth them with bsp/touch_filter.h. bsp/touch_ring.h keeps every sample for
+ * readers slower than the controller, and bsp/touch_trace.h reads and writes
+ * recorded touch traces.
  */
 
 #pragma once
 #include "esp_lcd_touch.h"
+#include "bsp/gesture.h"
+#include "bsp/touch_filter.h"
+#include "bsp/touch_ring.h"
+#include "bsp/touch_trace.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,7 +41,13 @@ extern "C" {
  * @brief BSP touch configuration structure
  */
 typedef struct {
-    void *dummy;    /*!< Prepared for future use. */
+    void    *dummy;             /*!< Prepared for future use. */
+    uint8_t  report_period_ms;  /*!< GT911 report period, 5..20 ms; 0 keeps the controller's setting */
+    uint8_t  touch_level;       /*!< Signal threshold for a touch; 0 keeps the controller's setting */
+    uint8_t  leave_level;       /*!< Signal threshold for a release, below touch_level; 0 keeps the setting */
+    uint8_t  noise_reduction;   /*!< Noise reduction level, 1..15; 0 keeps the controller's setting */
+    uint8_t  filter;            /*!< Coordinate filter strength, 1..63; 0 keeps the controller's setting */
+    uint8_t  low_power_s;       /*!< Idle time before the low-power scan rate, 1..15 s; 0 keeps the setting */
 } bsp_touch_config_t;
 
 /**
@@ -40,6 +56,8 @@ typedef struct {
  * If you want to free resources allocated by this function, you can use
  * esp_lcd_touch API: esp_lcd_touch_del(tp)
  *
+ * The fields of config that are not 0 are written to the GT911, see bsp_touch_set_config().
+ *
  * @param[in]  config    Touch configuration. May be NULL for defaults.
  * @param[out] ret_touch esp_lcd_touch touchscreen handle
  * @return
@@ -49,6 +67,33 @@ typedef struct {
 esp_err_t bsp_touch_new(const bsp_touch_config_t *config,
                          esp_lcd_touch_handle_t   *ret_touch);
 
+/**
+ * @brief Change the GT911 configuration
+ *
+ * Reads the configuration block of the controller, changes the fields of config that are not 0, and
+ * writes the block back with its checksum in a single transfer. The GT911 only takes the new block
+ * once the transfer is complete with a valid checksum, so a reset during the write leaves the previous
+ * configuration in place. Nothing is written when the settings already match, which makes it safe to
+ * apply the same configuration after every reset.
+ *
+ * A shorter report period suits drawing screens, a longer one saves power and I2C traffic. Once no
+ * finger has been down for low_power_s, the GT911 scans at its low-power rate until the next touch;
+ * the touch that ends it is still reported on INT, a little later.
+ *
+ * @note The GT911 keeps the configuration in non-volatile memory: change it when switching screens,
+ *       not continuously.
+ *
+ * @param[in] tp     Touchscreen handle from bsp_touch_new()
+ * @param[in] config Settings to change
+ * @return
+ *      - ESP_OK                 On success, or nothing to change
+ *      - ESP_ERR_INVALID_ARG    NULL argument or setting out of range
+ *      - ESP_ERR_INVALID_CRC    Configuration read from the controller is corrupt; nothing written
+ *      - ESP_ERR_INVALID_RESPONSE Configuration read back after the write does not match
+ *      - Else                   I2C failure
+ */
+esp_err_t bsp_touch_set_config(esp_lcd_touch_handle_t tp, const bsp_touch_config_t *config);
+
 /** @} */ // end of g04_display
 
 #ifdef __cplusplus
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP touch point filter
+ *
+ * Adaptive low-pass filter (1-euro filter) with optional extrapolation of the filtered position. At
+ * rest the cutoff frequency is low and the GT911 jitter is smoothed away; as the finger speeds up the
+ * cutoff rises so the point keeps up with it. Extrapolating along the filtered speed then compensates
+ * part of the render and scanout delay.
+ *
+ * Integer math only. With LVGL, bsp_display_touch_filter_enable() (or CONFIG_BSP_TOUCH_FILTER) applies
+ * it to the BSP input device. This header has no ESP-IDF dependencies, so recorded traces can be
+ * replayed on the host (see tools/touch_filter_replay).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup g04_display
+ *  @{
+ */
+
+/**
+ * @brief Filter parameters; 0 selects the default unless noted
+ */
+typedef struct {
+    uint32_t min_cutoff_mhz;    /*!< Cutoff at rest in [mHz]; lower is smoother but lags slow moves (default 1500) */
+    uint32_t beta;              /*!< Cutoff increase in [mHz] per px/s of speed; higher follows fast moves closer (default 20) */
+    uint32_t d_cutoff_mhz;      /*!< Cutoff of the speed estimate in [mHz] (default 2000) */
+    uint16_t predict_ms;        /*!< Extrapolation horizon in [ms]; 0 disables prediction */
+    uint16_t predict_max_px;    /*!< Longest extrapolation in [px] (default 24) */
+} bsp_touch_filter_cfg_t;
+
+/**
+ * @brief Filter state
+ *
+ * Allocated by the caller, initialized by bsp_touch_filter_init(). The fields are private.
+ */
+typedef struct {
+    bsp_touch_filter_cfg_t cfg;
+    bool                   active;      /* following a finger */
+    uint32_t               time_us;     /* time of the previous sample */
+    int32_t                x_q4;        /* filtered position, 1/16 px */
+    int32_t                y_q4;
+    int32_t                vx_q4;       /* filtered speed, 1/16 px/s */
+    int32_t                vy_q4;
+    uint32_t               speed_pxs;   /* magnitude of the filtered speed, px/s */
+} bsp_touch_filter_t;
+
+/**
+ * @brief Initialize a filter
+ *
+ * @param[out] f   Filter state
+ * @param[in]  cfg Parameters, may be NULL for the defaults
+ */
+void bsp_touch_filter_init(bsp_touch_filter_t *f, const bsp_touch_filter_cfg_t *cfg);
+
+/**
+ * @brief Filter one sample of a finger
+ *
+ * The first sample after bsp_touch_filter_init() or bsp_touch_filter_reset() is passed through.
+ *
+ * @param[in]  f       Filter state
+ * @param[in]  x       Raw X coordinate in pixels
+ * @param[in]  y       Raw Y coordinate in pixels
+ * @param[in]  time_us Sample time in microseconds, from any monotonic clock (may wrap)
+ * @param[out] out_x   Filtered, possibly extrapolated X coordinate; may be outside the panel
+ * @param[out] out_y   Filtered, possibly extrapolated Y coordinate; may be outside the panel
+ */
+void bsp_touch_filter_apply(bsp_touch_filter_t *f, int16_t x, int16_t y, uint32_t time_us,
+                            int16_t *out_x, int16_t *out_y);
+
+/**
+ * @brief Forget the followed finger; call when it is lifted
+ *
+ * @param[in] f Filter state
+ */
+void bsp_touch_filter_reset(bsp_touch_filter_t *f);
+
+/** @} */ // end of g04_display
+
+#ifdef __cplusplus
+}
+#endif
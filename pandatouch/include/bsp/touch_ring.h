@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP touch sample ring
+ *
+ * Keeps every touch sample read from the controller, with all its points and the time it was reported,
+ * so a reader polling at the UI refresh rate still sees the full controller rate. The ring has a single
+ * writer (the task reading the controller) and any number of lock-free readers, each with its own
+ * cursor. With LVGL, the BSP input device fills a ring that bsp_display_touch_read_samples() drains, and
+ * that can be replayed into LVGL sample by sample.
+ *
+ * This header has no ESP-IDF dependencies (see tools/touch_ring_test).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup g04_display
+ *  @{
+ */
+
+#define BSP_TOUCH_RING_MAX_POINTS   (5)     /*!< Points per sample (GT911 reports up to 5) */
+
+/**
+ * @brief One touch point
+ */
+typedef struct {
+    uint16_t x;         /*!< X coordinate in pixels */
+    uint16_t y;         /*!< Y coordinate in pixels */
+    uint16_t strength;  /*!< Signal strength reported by the controller */
+    uint8_t  id;        /*!< Track ID, stable while the finger stays down */
+} bsp_touch_point_t;
+
+/**
+ * @brief One touch sample: a controller report
+ *
+ * A sample with count 0 is a release; idle reports with no finger down are not recorded.
+ */
+typedef struct {
+    int64_t           time_us;  /*!< Time the controller reported the sample */
+    uint32_t          seq;      /*!< Sample number, counted from 0 */
+    uint16_t          x;        /*!< Pointer position: first finger as handed to the UI (filtered), last one on release */
+    uint16_t          y;        /*!< Pointer position, see x */
+    uint8_t           count;    /*!< Valid entries in points */
+    bsp_touch_point_t points[BSP_TOUCH_RING_MAX_POINTS];  /*!< Raw points */
+} bsp_touch_sample_t;
+
+/**
+ * @brief Ring slot; seq is seq + 1 of the sample it holds, 0 while it is being written
+ */
+typedef struct {
+    volatile uint32_t  seq;
+    bsp_touch_sample_t sample;
+} bsp_touch_slot_t;
+
+/**
+ * @brief Touch sample ring: one writer, lock-free readers
+ */
+typedef struct {
+    bsp_touch_slot_t  *slots;   /*!< Storage */
+    uint32_t           mask;    /*!< Capacity - 1; the capacity is a power of two */
+    volatile uint32_t  head;    /*!< Samples written so far */
+} bsp_touch_ring_t;
+
+/**
+ * @brief Initialize a ring
+ *
+ * @param[out] ring     Ring
+ * @param[in]  slots    Storage, zeroed
+ * @param[in]  capacity Number of slots, a power of two
+ */
+void bsp_touch_ring_init(bsp_touch_ring_t *ring, bsp_touch_slot_t *slots, uint32_t capacity);
+
+/**
+ * @brief Append a sample, overwriting the oldest one when the ring is full
+ *
+ * Single writer only. sample->seq is ignored; the ring numbers the samples.
+ *
+ * @param[in] ring   Ring
+ * @param[in] sample Sample
+ */
+void bsp_touch_ring_push(bsp_touch_ring_t *ring, const bsp_touch_sample_t *sample);
+
+/**
+ * @brief Get the number of samples written so far; the cursor of a reader that skips the history
+ *
+ * @param[in] ring Ring
+ * @return Sequence number of the next sample to be written
+ */
+uint32_t bsp_touch_ring_head(const bsp_touch_ring_t *ring);
+
+/**
+ * @brief Get the samples written since the last call; lock-free, from any task
+ *
+ * Samples are returned oldest first. Samples that were overwritten before they could be read are
+ * skipped and counted in lost.
+ *
+ * @param[in]    ring   Ring
+ * @param[inout] cursor Sequence number of the next sample to read; start with 0, or with
+ *                      bsp_touch_ring_head() to skip the history
+ * @param[out]   out    Samples
+ * @param[in]    max    Capacity of out
+ * @param[out]   lost   Samples skipped, may be NULL
+ * @return Number of samples written to out
+ */
+size_t bsp_touch_ring_read(const bsp_touch_ring_t *ring, uint32_t *cursor, bsp_touch_sample_t *out,
+                           size_t max, uint32_t *lost);
+
+/** @} */ // end of g04_display
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * @brief BSP touch trace format
+ *
+ * A touch trace holds one sample per line, `<time_ms> <count> [<x> <y> <id>]...`, with the time counted
+ * from the start of the recording. Lines may carry a `TRACE ` prefix, anything before it is skipped, and
+ * `#` starts a comment, so console logs can be used as traces. bsp_touch_record_start() writes this
+ * format, bsp_touch_play_start() replays it, and the host tools (tools/gesture_replay,
+ * tools/touch_filter_replay, tools/touch_play) read it.
+ *
+ * This header has no ESP-IDF dependencies.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bsp/touch_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup g04_display
+ *  @{
+ */
+
+#define BSP_TOUCH_TRACE_LINE_MAX    (112)   /*!< Longest trace line, newline and terminator included */
+
+/**
+ * @brief Format a sample as a trace line
+ *
+ * @param[in]  sample   Sample; only the time, the count and the points are written
+ * @param[in]  start_us Time of the start of the recording
+ * @param[out] buf      Line, ending with a newline
+ * @param[in]  len      Size of buf, BSP_TOUCH_TRACE_LINE_MAX is always enough
+ * @return Length of the line, 0 if buf is too small
+ */
+size_t bsp_touch_trace_format(const bsp_touch_sample_t *sample, int64_t start_us, char *buf, size_t len);
+
+/**
+ * @brief Parse a trace line
+ *
+ * The sample's x and y are set to its first point, seq to 0. Points beyond BSP_TOUCH_RING_MAX_POINTS are
+ * ignored.
+ *
+ * @param[in]  line   Line, with or without its newline
+ * @param[out] sample Sample, time_us in [us] from the start of the recording
+ * @return true for a sample line, false for a comment, an empty or a malformed line
+ */
+bool bsp_touch_trace_parse(const char *line, bsp_touch_sample_t *sample);
+
+/** @} */ // end of g04_display
+
+#ifdef __cplusplus
+}
+#endif
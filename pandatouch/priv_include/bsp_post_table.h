@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Slot table of the UI update queue (bsp_display_post()).
+ *
+ * Every key owns one slot of a fixed open-addressed table, so coalescing is just overwriting the slot.
+ * Producers claim a slot with a CAS on its key and write the payload under the slot's sequence number,
+ * odd while a write is in progress. Writes of one slot are serialized: a producer that finds another one
+ * writing waits for it and then writes its own payload, so the latest write is the one applied. The
+ * consumer never waits: it skips a slot being written, and the writer marks the slot pending again when
+ * it is done.
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/display_post_test.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BSP_POST_DATA_MAX   (16)                /* same as BSP_DISPLAY_POST_DATA_MAX */
+#define BSP_POST_KEY_FREE   ((uintptr_t)0)
+#define BSP_POST_KEY_GONE   (UINTPTR_MAX)       /* forgotten: keeps probe chains intact, reusable */
+
+typedef void (*bsp_post_cb_t)(const void *data, void *user_ctx);
+
+typedef struct {
+    atomic_uintptr_t key;
+    atomic_uint      seq;               /* odd while a producer writes the fields below */
+    atomic_bool      pending;
+    bsp_post_cb_t    cb;
+    void            *user_ctx;
+    uint8_t          len;
+    uint8_t          data[BSP_POST_DATA_MAX];
+} bsp_post_slot_t;
+
+typedef struct {
+    bsp_post_slot_t *slots;
+    uint32_t         count;
+    atomic_uint      used;              /* keys holding a slot */
+} bsp_post_table_t;
+
+/**
+ * @brief Initialize a table over zeroed slots
+ */
+void bsp_post_table_init(bsp_post_table_t *table, bsp_post_slot_t *slots, uint32_t count);
+
+/**
+ * @brief Find the slot of key, claiming a free one if it has none
+ *
+ * @return Slot, or NULL if every slot is held by another key
+ */
+bsp_post_slot_t *bsp_post_table_claim(bsp_post_table_t *table, uintptr_t key);
+
+/**
+ * @brief Release the slot of key and drop its pending update
+ *
+ * Only once no producer writes to key anymore.
+ */
+void bsp_post_table_forget(bsp_post_table_t *table, uintptr_t key);
+
+/**
+ * @brief Start writing a slot, waiting for a write of another producer to end
+ *
+ * The wait lasts one bsp_post_slot_fill() of the other producer, provided it cannot be preempted by this
+ * one; on a single core, callers make the write non-preemptible.
+ *
+ * @return Sequence number to give to bsp_post_slot_end()
+ */
+unsigned bsp_post_slot_begin(bsp_post_slot_t *slot);
+
+/**
+ * @brief Set the update of a slot between bsp_post_slot_begin() and bsp_post_slot_end()
+ */
+void bsp_post_slot_fill(bsp_post_slot_t *slot, bsp_post_cb_t cb, void *user_ctx, const void *data, size_t len);
+
+/**
+ * @brief Publish the update of a slot and mark it pending
+ *
+ * @return true if it replaced an update not applied yet
+ */
+bool bsp_post_slot_end(bsp_post_slot_t *slot, unsigned seq);
+
+/**
+ * @brief Write an update to a slot: begin, fill and end
+ *
+ * @return true if it replaced an update not applied yet
+ */
+bool bsp_post_slot_write(bsp_post_slot_t *slot, bsp_post_cb_t cb, void *user_ctx, const void *data, size_t len);
+
+/**
+ * @brief Take the pending update of a slot; consumer only, never waits
+ *
+ * @param[out] data Copy of the payload, BSP_POST_DATA_MAX bytes
+ * @return false if nothing is pending, or if a producer is writing the slot; it is then pending again
+ *         once the producer is done
+ */
+bool bsp_post_slot_take(bsp_post_slot_t *slot, bsp_post_cb_t *cb, void **user_ctx, void *data);
+
+#ifdef __cplusplus
+}
+#endif
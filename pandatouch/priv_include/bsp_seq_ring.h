@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Seqlock ring shared by the sensor rings (bsp_sensor.c) and the touch ring (bsp_touch_ring.c).
+ *
+ * Each slot is a small seqlock: a volatile uint32_t sequence number first, then the sample. The writer
+ * clears the slot's number, writes the sample and then publishes the number, seq + 1 of the sample; a
+ * reader copies the sample between two loads of the number and keeps the copy only if both match the
+ * sample it wanted. A reader never blocks the writer, and a slot overwritten during the copy is detected
+ * rather than returned torn. The public ring types keep their own slot and sample types: the functions
+ * below take the ring's fields and a layout describing where the sample and its own seq field are.
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/sensor_hub_test and tools/touch_ring_test.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Slot of a ring: the slot's sequence number at offset 0, then the sample */
+typedef struct {
+    size_t slot_size;       /* sizeof the slot type */
+    size_t sample_offset;   /* offsetof the sample in the slot */
+    size_t sample_size;     /* sizeof the sample */
+    size_t seq_offset;      /* offsetof the uint32_t sample number in the sample */
+} bsp_seq_ring_layout_t;
+
+/**
+ * @brief Append a sample, numbering it head; single writer only
+ */
+void bsp_seq_ring_push(const bsp_seq_ring_layout_t *layout, void *slots, uint32_t mask,
+                       volatile uint32_t *head, const void *sample);
+
+/**
+ * @brief Copy sample seq
+ *
+ * @return false if its slot holds another sample or was rewritten during the copy
+ */
+bool bsp_seq_ring_copy(const bsp_seq_ring_layout_t *layout, const void *slots, uint32_t mask,
+                       uint32_t seq, void *out);
+
+/**
+ * @brief Copy the samples from cursor to head, oldest first, counting the overwritten ones in lost
+ *
+ * A cursor ahead of head, from a ring that was reset, restarts at head.
+ */
+size_t bsp_seq_ring_read(const bsp_seq_ring_layout_t *layout, const void *slots, uint32_t mask,
+                         const volatile uint32_t *head, uint32_t *cursor, void *out, size_t max, uint32_t *lost);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,147 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Scanline compositor — renderer core.
+ *
+ * Kept free of ESP-IDF includes so it also builds on the host; the panel glue
+ * (bounce-buffer refill, cycle budget accounting) lives in bsp_display.c.
+ */
+#include <string.h>
+#include "bsp/compositor.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define BSP_COMP_ATTR IRAM_ATTR
+#else
+#define BSP_COMP_ATTR
+#endif
+
+static BSP_COMP_ATTR int wrap(int v, int m)
+{
+    v %= m;
+    return (v < 0) ? v + m : v;
+}
+
+static BSP_COMP_ATTR void render_layer(const bsp_comp_layer_t *layer, int y, uint16_t *line, int width)
+{
+    const int tile_size = 1 << layer->tile_shift;
+    const int tile_mask = tile_size - 1;
+    const int map_px_w  = layer->map_w << layer->tile_shift;
+    const int map_px_h  = layer->map_h << layer->tile_shift;
+
+    const int      src_y    = wrap(y + layer->scroll_y, map_px_h);
+    const uint8_t *map_row  = layer->map + (src_y >> layer->tile_shift) * layer->map_w;
+    const int      tile_row = (src_y & tile_mask) << layer->tile_shift;
+
+    int src_x = wrap(layer->scroll_x, map_px_w);
+    int x = 0;
+    while (x < width) {
+        /* Copy the run up to the next tile boundary in one go */
+        const int in_tile = src_x & tile_mask;
+        int run = tile_size - in_tile;
+        if (run > width - x) {
+            run = width - x;
+        }
+        const uint16_t *src = layer->tiles
+                              + ((size_t)map_row[src_x >> layer->tile_shift] << (2 * layer->tile_shift))
+                              + tile_row + in_tile;
+
+        if (!layer->transparent) {
+            memcpy(&line[x], src, run * sizeof(uint16_t));
+        } else {
+            for (int i = 0; i < run; i++) {
+                if (src[i] != layer->key) {
+                    line[x + i] = src[i];
+                }
+            }
+        }
+
+        x += run;
+        src_x += run;
+        if (src_x >= map_px_w) {
+            src_x -= map_px_w;
+        }
+    }
+}
+
+static BSP_COMP_ATTR void render_sprite(const bsp_comp_sprite_t *spr, int y, uint16_t *line, int width)
+{
+    if (!spr->visible || y < spr->y || y >= spr->y + spr->h) {
+        return;
+    }
+
+    int x0 = spr->x;
+    int x1 = spr->x + spr->w;
+    if (x0 < 0) {
+        x0 = 0;
+    }
+    if (x1 > width) {
+        x1 = width;
+    }
+
+    const uint16_t *src = spr->pixels + (size_t)(y - spr->y) * spr->w;
+    for (int x = x0; x < x1; x++) {
+        const uint16_t c = src[x - spr->x];
+        if (c != spr->key) {
+            line[x] = c;
+        }
+    }
+}
+
+BSP_COMP_ATTR void bsp_comp_render_line(const bsp_comp_scene_t *scene, int y, uint16_t *line, int width)
+{
+    int first = 0;
+
+    /* An opaque bottom layer covers the whole line, so the background fill can be skipped */
+    if (scene->layer_count == 0 || scene->layers[0].transparent) {
+        for (int x = 0; x < width; x++) {
+            line[x] = scene->bg;
+        }
+    } else {
+        render_layer(&scene->layers[0], y, line, width);
+        first = 1;
+    }
+
+    for (int i = first; i < scene->layer_count; i++) {
+        render_layer(&scene->layers[i], y, line, width);
+    }
+    for (int i = 0; i < scene->sprite_count; i++) {
+        render_sprite(&scene->sprites[i], y, line, width);
+    }
+}
+
+void bsp_comp_render_line_ref(const bsp_comp_scene_t *scene, int y, uint16_t *line, int width)
+{
+    for (int x = 0; x < width; x++) {
+        uint16_t px = scene->bg;
+
+        for (int i = 0; i < scene->layer_count; i++) {
+            const bsp_comp_layer_t *l = &scene->layers[i];
+            const int size = 1 << l->tile_shift;
+            const int mx = wrap(x + l->scroll_x, l->map_w * size);
+            const int my = wrap(y + l->scroll_y, l->map_h * size);
+            const int tile = l->map[(my / size) * l->map_w + (mx / size)];
+            const uint16_t c = l->tiles[tile * size * size + (my % size) * size + (mx % size)];
+            if (!l->transparent || c != l->key) {
+                px = c;
+            }
+        }
+
+        for (int i = 0; i < scene->sprite_count; i++) {
+            const bsp_comp_sprite_t *s = &scene->sprites[i];
+            if (!s->visible || x < s->x || x >= s->x + s->w || y < s->y || y >= s->y + s->h) {
+                continue;
+            }
+            const uint16_t c = s->pixels[(y - s->y) * s->w + (x - s->x)];
+            if (c != s->key) {
+                px = c;
+            }
+        }
+
+        line[x] = px;
+    }
+}
@@ -0,0 +1,343 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Directory index: packed names, sorted references, and the saved form.
+ *
+ * A reference holds the directory flag in bit 31, the name block in bits 30..14 and the offset of the
+ * name in its block in bits 13..0. Sorting only moves references: the entries added since the last sort
+ * are heap-sorted in place, then merged into the sorted ones from the back, through a copy of the new
+ * ones in the scratch array. Listings come in creation order, which has little to do with name order,
+ * so the merge usually moves most references; it is still linear, and runs once per page read.
+ *
+ * Saved form, little-endian: "BSPDIX", format version, 0, volume serial (u32), directory time (i64),
+ * entries (u32), path length (u16), path, then for each entry in order a flag byte (bit 0: directory)
+ * and the name with its terminating zero, then the CRC-32 of everything before it.
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/dir_index_test.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bsp/dir_index.h"
+
+#define REF_DIR         (1u << 31)
+#define REF_BLOCK_SHIFT (14)
+#define REF_BLOCK_MAX   (1u << 17)
+#define REF_OFF_MASK    ((1u << REF_BLOCK_SHIFT) - 1)
+#define FIRST_CAPACITY  (256)
+
+#define SAVE_VERSION    (1)
+#define SAVE_HEADER     (26)    /* magic, serial, time, entries, path length */
+#define SAVE_CRC        (4)
+
+_Static_assert(BSP_DIR_INDEX_BLOCK <= (1 << REF_BLOCK_SHIFT), "name offsets do not fit in a reference");
+
+static const uint8_t s_magic[8] = { 'B', 'S', 'P', 'D', 'I', 'X', SAVE_VERSION, 0 };
+
+static void *mem_resize(const bsp_dir_index_t *index, void *ptr, size_t size)
+{
+    if (index->mem) {
+        return index->mem(ptr, size);
+    }
+    if (size == 0) {
+        free(ptr);
+        return NULL;
+    }
+    return realloc(ptr, size);
+}
+
+static const char *ref_name(const bsp_dir_index_t *index, uint32_t ref)
+{
+    return index->blocks[(ref & ~REF_DIR) >> REF_BLOCK_SHIFT] + (ref & REF_OFF_MASK);
+}
+
+static int fold(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+/* Directories first, then names without case; names differing only in case in byte order */
+static int ref_cmp(const bsp_dir_index_t *index, uint32_t a, uint32_t b)
+{
+    if ((a ^ b) & REF_DIR) {
+        return (a & REF_DIR) ? -1 : 1;
+    }
+    const unsigned char *x = (const unsigned char *)ref_name(index, a);
+    const unsigned char *y = (const unsigned char *)ref_name(index, b);
+    for (size_t i = 0;; i++) {
+        const int d = fold(x[i]) - fold(y[i]);
+        if (d || !x[i]) {
+            return d ? d : strcmp((const char *)x, (const char *)y);
+        }
+    }
+}
+
+static void sift_down(const bsp_dir_index_t *index, uint32_t *a, size_t root, size_t n)
+{
+    const uint32_t v = a[root];
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n && ref_cmp(index, a[child + 1], a[child]) > 0) {
+            child++;
+        }
+        if (ref_cmp(index, a[child], v) <= 0) {
+            break;
+        }
+        a[root] = a[child];
+        root = child;
+    }
+    a[root] = v;
+}
+
+static void heap_sort(const bsp_dir_index_t *index, uint32_t *a, size_t n)
+{
+    for (size_t i = n / 2; i-- > 0;) {
+        sift_down(index, a, i, n);
+    }
+    for (size_t end = n; end-- > 1;) {
+        const uint32_t top = a[0];
+        a[0] = a[end];
+        a[end] = top;
+        sift_down(index, a, 0, end);
+    }
+}
+
+static uint32_t crc32(const uint8_t *data, size_t len)
+{
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static void put_le(uint8_t *p, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const uint8_t *p, int bytes)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) {
+        v |= (uint64_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+void bsp_dir_index_init(bsp_dir_index_t *index, bsp_dir_index_mem_t mem)
+{
+    memset(index, 0, sizeof(*index));
+    index->mem = mem;
+}
+
+void bsp_dir_index_clear(bsp_dir_index_t *index)
+{
+    for (uint32_t i = 0; i < index->block_count; i++) {
+        mem_resize(index, index->blocks[i], 0);
+    }
+    mem_resize(index, index->blocks, 0);
+    mem_resize(index, index->refs, 0);
+    mem_resize(index, index->scratch, 0);
+    bsp_dir_index_init(index, index->mem);
+}
+
+bool bsp_dir_index_add(bsp_dir_index_t *index, const char *name, bool is_dir)
+{
+    const size_t len = strlen(name) + 1;
+    if (len < 2 || len > BSP_DIR_NAME_MAX) {
+        return false;
+    }
+
+    if (index->count == index->capacity) {
+        const uint32_t capacity = index->capacity ? index->capacity * 2 : FIRST_CAPACITY;
+        uint32_t *refs = mem_resize(index, index->refs, capacity * sizeof(uint32_t));
+        if (!refs) {
+            return false;
+        }
+        index->refs = refs;
+        uint32_t *scratch = mem_resize(index, index->scratch, capacity * sizeof(uint32_t));
+        if (!scratch) {
+            return false;
+        }
+        index->scratch = scratch;
+        index->capacity = capacity;
+    }
+
+    if (index->block_count == 0 || index->block_used + len > BSP_DIR_INDEX_BLOCK) {
+        if (index->block_count == REF_BLOCK_MAX) {
+            return false;
+        }
+        char **blocks = mem_resize(index, index->blocks, (index->block_count + 1) * sizeof(char *));
+        if (!blocks) {
+            return false;
+        }
+        index->blocks = blocks;
+        blocks[index->block_count] = mem_resize(index, NULL, BSP_DIR_INDEX_BLOCK);
+        if (!blocks[index->block_count]) {
+            return false;
+        }
+        index->block_count++;
+        index->block_used = 0;
+    }
+
+    const uint32_t block = index->block_count - 1;
+    memcpy(index->blocks[block] + index->block_used, name, len);
+    index->refs[index->count++] = (is_dir ? REF_DIR : 0) | (block << REF_BLOCK_SHIFT) | index->block_used;
+    index->block_used += len;
+    index->name_bytes += len;
+    return true;
+}
+
+uint32_t bsp_dir_index_count(const bsp_dir_index_t *index)
+{
+    return index->count;
+}
+
+void bsp_dir_index_sort(bsp_dir_index_t *index)
+{
+    const uint32_t left = index->sorted;
+    const uint32_t added = index->count - left;
+    if (added == 0) {
+        return;
+    }
+
+    uint32_t *refs = index->refs;
+    heap_sort(index, refs + left, added);
+    if (left && ref_cmp(index, refs[left - 1], refs[left]) > 0) {
+        memcpy(index->scratch, refs + left, added * sizeof(uint32_t));
+        uint32_t i = left;
+        uint32_t j = added;
+        uint32_t w = index->count;
+        while (j > 0) {
+            if (i > 0 && ref_cmp(index, refs[i - 1], index->scratch[j - 1]) > 0) {
+                refs[--w] = refs[--i];
+            } else {
+                refs[--w] = index->scratch[--j];
+            }
+        }
+    }
+    index->sorted = index->count;
+}
+
+uint32_t bsp_dir_index_page(bsp_dir_index_t *index, uint32_t first, uint32_t count, bsp_dir_entry_t *out)
+{
+    bsp_dir_index_sort(index);
+    if (first >= index->count) {
+        return 0;
+    }
+    if (count > index->count - first) {
+        count = index->count - first;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t ref = index->refs[first + i];
+        out[i].name = ref_name(index, ref);
+        out[i].is_dir = (ref & REF_DIR) != 0;
+    }
+    return count;
+}
+
+bool bsp_dir_index_equal(bsp_dir_index_t *a, bsp_dir_index_t *b)
+{
+    bsp_dir_index_sort(a);
+    bsp_dir_index_sort(b);
+    if (a->count != b->count || a->name_bytes != b->name_bytes) {
+        return false;
+    }
+    for (uint32_t i = 0; i < a->count; i++) {
+        if (((a->refs[i] ^ b->refs[i]) & REF_DIR) || strcmp(ref_name(a, a->refs[i]), ref_name(b, b->refs[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t bsp_dir_index_save(bsp_dir_index_t *index, const bsp_dir_index_key_t *key, void *buf, size_t size)
+{
+    const size_t path_len = strlen(key->path);
+    if (path_len > UINT16_MAX) {
+        return 0;
+    }
+    const size_t total = SAVE_HEADER + path_len + index->count + index->name_bytes + SAVE_CRC;
+    if (!buf || size < total) {
+        return total;
+    }
+
+    bsp_dir_index_sort(index);
+    uint8_t *p = buf;
+    memcpy(p, s_magic, sizeof(s_magic));
+    put_le(p + 8, key->volume_serial, 4);
+    put_le(p + 12, (uint64_t)key->dir_mtime, 8);
+    put_le(p + 20, index->count, 4);
+    put_le(p + 24, path_len, 2);
+    memcpy(p + SAVE_HEADER, key->path, path_len);
+    p += SAVE_HEADER + path_len;
+    for (uint32_t i = 0; i < index->count; i++) {
+        const uint32_t ref = index->refs[i];
+        const char *name = ref_name(index, ref);
+        const size_t len = strlen(name) + 1;
+        *p++ = (ref & REF_DIR) ? 1 : 0;
+        memcpy(p, name, len);
+        p += len;
+    }
+    put_le(p, crc32(buf, total - SAVE_CRC), 4);
+    return total;
+}
+
+int bsp_dir_index_load(bsp_dir_index_t *index, const bsp_dir_index_key_t *key, const void *data, size_t len)
+{
+    bsp_dir_index_clear(index);
+
+    const uint8_t *p = data;
+    if (len < SAVE_HEADER + SAVE_CRC || memcmp(p, s_magic, sizeof(s_magic)) != 0 ||
+        crc32(p, len - SAVE_CRC) != (uint32_t)get_le(p + len - SAVE_CRC, 4)) {
+        return EILSEQ;
+    }
+    const uint32_t count = (uint32_t)get_le(p + 20, 4);
+    const size_t path_len = (size_t)get_le(p + 24, 2);
+    if (SAVE_HEADER + path_len > len - SAVE_CRC) {
+        return EILSEQ;
+    }
+    if ((uint32_t)get_le(p + 8, 4) != key->volume_serial || (int64_t)get_le(p + 12, 8) != key->dir_mtime ||
+        path_len != strlen(key->path) || memcmp(p + SAVE_HEADER, key->path, path_len) != 0) {
+        return ESTALE;
+    }
+
+    const uint8_t *end = p + len - SAVE_CRC;
+    p += SAVE_HEADER + path_len;
+    int ret = 0;
+    for (uint32_t i = 0; i < count && ret == 0; i++) {
+        const uint8_t *zero = (p < end) ? memchr(p + 1, 0, end - p - 1) : NULL;
+        if (!zero || *p > 1 || zero - p > BSP_DIR_NAME_MAX || zero == p + 1) {
+            ret = EILSEQ;
+        } else if (!bsp_dir_index_add(index, (const char *)p + 1, *p == 1)) {
+            ret = ENOMEM;
+        } else if (i > 0 && ref_cmp(index, index->refs[i - 1], index->refs[i]) >= 0) {
+            ret = EILSEQ;   /* saved in order, so loading needs no sort */
+        } else {
+            p = zero + 1;
+        }
+    }
+    if (ret == 0 && p != end) {
+        ret = EILSEQ;
+    }
+    if (ret != 0) {
+        bsp_dir_index_clear(index);
+        return ret;
+    }
+    index->sorted = index->count;
+    return 0;
+}
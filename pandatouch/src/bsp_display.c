@@ -4,12 +4,17 @@
  * SPDX-License-Identifier: MIT
  */
 #include <string.h>
+#include <inttypes.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/ledc.h"
 #include "driver/gpio.h"
 #include "esp_lcd_panel_rgb.h"
 #include "esp_lcd_panel_ops.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 #include "bsp/pandatouch.h"
 #include "bsp/display.h"
@@ -20,10 +25,43 @@
 /* Forward declarations — implemented in bsp_touch.c */
 esp_err_t bsp_display_indev_init(lv_display_t *disp);
 void bsp_display_set_touch_indev(lv_indev_t *indev);
+bool bsp_touch_set_sleep(bool sleep);
+
+/* Forward declarations — implemented in bsp_display_mode.c */
+esp_err_t bsp_display_mode_init(lv_display_t *disp, esp_lcd_panel_handle_t panel);
+bool bsp_display_mode_on_vsync(void);
+
+/* Forward declaration — implemented in bsp_display_post.c */
+esp_err_t bsp_display_post_init(lv_display_t *disp);
+
+#if CONFIG_BSP_TOUCH_LATENCY
+/* Forward declaration — implemented in bsp_touch_latency.c */
+void bsp_touch_lat_mark(bsp_touch_lat_stage_t stage);
+#endif
+
+#if CONFIG_BSP_DISPLAY_LOCK_STATS
+/* Forward declarations — implemented in bsp_display_lock_stats.c */
+esp_err_t bsp_display_lock_stats_init(void);
+bool bsp_display_lock_stats_lock(uint32_t timeout_ms);
+void bsp_display_lock_stats_unlock(void);
+#endif
 #endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
 
 static const char *TAG = "pandatouch";
 
+/* Scanline compositor state — only used when bsp_display_new() is given a comp_scene */
+static const bsp_comp_scene_t *volatile s_comp_scene   = NULL;
+static const bsp_comp_scene_t *volatile s_comp_pending = NULL;
+static SemaphoreHandle_t                s_comp_latched = NULL;
+static bsp_display_comp_stats_t         s_comp_stats;
+
+/* Scanout continuity, measured from the vsync interrupt */
+static bsp_display_scanout_stats_t      s_scanout_stats;
+static uint32_t                         s_scanout_last;      /* CPU cycle count at the last vsync */
+static uint32_t                         s_scanout_late_cycles;
+
+static int                              s_brightness = 100;  /* last level set, restored when the display wakes */
+
 esp_err_t bsp_display_brightness_init(void)
 {
     ledc_timer_config_t ledc_timer = {
@@ -49,6 +87,16 @@ esp_err_t bsp_display_brightness_init(void)
     return ESP_OK;
 }
 
+static esp_err_t bsp_display_brightness_write(int brightness_percent)
+{
+    ESP_LOGI(TAG, "Setting LCD backlight: %d%%", brightness_percent);
+    uint32_t duty = (brightness_percent * ((1 << LEDC_TIMER_11_BIT) - 1)) / 100;
+    BSP_ERROR_CHECK_RETURN_ERR(ledc_set_duty(LEDC_LOW_SPEED_MODE, CONFIG_BSP_DISPLAY_BRIGHTNESS_LEDC_CH, duty));
+    BSP_ERROR_CHECK_RETURN_ERR(ledc_update_duty(LEDC_LOW_SPEED_MODE, CONFIG_BSP_DISPLAY_BRIGHTNESS_LEDC_CH));
+
+    return ESP_OK;
+}
+
 esp_err_t bsp_display_brightness_set(int brightness_percent)
 {
     if (brightness_percent > 100) {
@@ -58,12 +106,8 @@ esp_err_t bsp_display_brightness_set(int brightness_percent)
         brightness_percent = 0;
     }
 
-    ESP_LOGI(TAG, "Setting LCD backlight: %d%%", brightness_percent);
-    uint32_t duty = (brightness_percent * ((1 << LEDC_TIMER_11_BIT) - 1)) / 100;
-    BSP_ERROR_CHECK_RETURN_ERR(ledc_set_duty(LEDC_LOW_SPEED_MODE, CONFIG_BSP_DISPLAY_BRIGHTNESS_LEDC_CH, duty));
-    BSP_ERROR_CHECK_RETURN_ERR(ledc_update_duty(LEDC_LOW_SPEED_MODE, CONFIG_BSP_DISPLAY_BRIGHTNESS_LEDC_CH));
-
-    return ESP_OK;
+    s_brightness = brightness_percent;
+    return bsp_display_brightness_write(brightness_percent);
 }
 
 esp_err_t bsp_display_backlight_on(void)
@@ -76,6 +120,163 @@ esp_err_t bsp_display_backlight_off(void)
     return bsp_display_brightness_set(0);
 }
 
+/*
+ * Bounce-buffer refill in compositor mode. Runs in the LCD ISR, so it must stay
+ * in IRAM and only touch scene data that is reachable with the cache disabled
+ * when CONFIG_LCD_RGB_ISR_IRAM_SAFE is set.
+ */
+static IRAM_ATTR bool bsp_display_comp_fill(esp_lcd_panel_handle_t panel, void *bounce_buf,
+                                            int pos_px, int len_bytes, void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    const uint32_t start = esp_cpu_get_cycle_count();
+
+    /* Latch a pending scene only at the top of a frame so no frame mixes two scenes */
+    if (pos_px == 0 && s_comp_pending) {
+        s_comp_scene   = s_comp_pending;
+        s_comp_pending = NULL;
+        xSemaphoreGiveFromISR(s_comp_latched, &need_yield);
+    }
+
+    const bsp_comp_scene_t *scene = s_comp_scene;
+    uint16_t *line  = bounce_buf;
+    int       y     = pos_px / BSP_LCD_H_RES;
+    const int lines = len_bytes / (BSP_LCD_H_RES * sizeof(uint16_t));
+    for (int i = 0; i < lines && y < BSP_LCD_V_RES; i++, y++) {
+        bsp_comp_render_line(scene, y, line, BSP_LCD_H_RES);
+        line += BSP_LCD_H_RES;
+    }
+
+    if (lines > 0) {
+        const uint32_t per_line = (esp_cpu_get_cycle_count() - start) / lines;
+        if (per_line > s_comp_stats.max_cycles) {
+            s_comp_stats.max_cycles = per_line;
+        }
+        if (per_line > s_comp_stats.budget_cycles) {
+            s_comp_stats.overruns++;
+        }
+        s_comp_stats.lines += lines;
+    }
+
+    return need_yield == pdTRUE;
+}
+
+static esp_err_t bsp_display_comp_attach(const bsp_comp_scene_t *scene)
+{
+    if (!s_comp_latched) {
+        s_comp_latched = xSemaphoreCreateBinary();
+        BSP_NULL_CHECK(s_comp_latched, ESP_ERR_NO_MEM);
+    }
+
+    memset(&s_comp_stats, 0, sizeof(s_comp_stats));
+    /* One scanline lasts H_TOTAL pixel clocks; that is all the CPU time a line may cost */
+    s_comp_stats.budget_cycles = (uint32_t)((uint64_t)BSP_LCD_H_TOTAL * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+                                            * 1000000ULL / BSP_LCD_PIXEL_CLOCK_HZ);
+    s_comp_pending = NULL;
+    s_comp_scene   = scene;
+
+    ESP_LOGI(TAG, "Scanline compositor: %" PRIu32 " cycles per line budget", s_comp_stats.budget_cycles);
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_comp_set_scene(const bsp_comp_scene_t *scene, uint32_t timeout_ms)
+{
+    if (!scene) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_comp_scene) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_comp_latched, 0);  /* drop a stale latch notification */
+    s_comp_pending = scene;
+    if (xSemaphoreTake(s_comp_latched, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_comp_get_stats(bsp_display_comp_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_comp_scene) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *stats = s_comp_stats;
+    return ESP_OK;
+}
+
+/*
+ * Vsync interrupt: frame interval accounting, then render-mode hand-off. Like the
+ * bounce-buffer refill it must stay in IRAM, so scanout keeps being observed while
+ * flash writes have the cache disabled.
+ */
+static IRAM_ATTR bool bsp_display_on_vsync(esp_lcd_panel_handle_t panel,
+                                           const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    const uint32_t now = esp_cpu_get_cycle_count();
+
+    if (s_scanout_last) {
+        const uint32_t us = (now - s_scanout_last) / CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+        if (us < s_scanout_stats.min_frame_us || !s_scanout_stats.min_frame_us) {
+            s_scanout_stats.min_frame_us = us;
+        }
+        if (us > s_scanout_stats.max_frame_us) {
+            s_scanout_stats.max_frame_us = us;
+        }
+        if (now - s_scanout_last > s_scanout_late_cycles) {
+            s_scanout_stats.late_frames++;
+        }
+        s_scanout_stats.elapsed_us += us;
+    }
+    s_scanout_last = now;
+    s_scanout_stats.frames++;
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+#if CONFIG_BSP_TOUCH_LATENCY
+    bsp_touch_lat_mark(BSP_TOUCH_LAT_STAGE_VSYNC);
+#endif
+    return bsp_display_mode_on_vsync();
+#else
+    return false;
+#endif
+}
+
+/*
+ * Registers the BSP's panel callbacks. Registering replaces the whole callback set,
+ * so every user of panel events goes through here.
+ */
+esp_err_t bsp_display_register_callbacks(esp_lcd_panel_handle_t panel)
+{
+    const esp_lcd_rgb_panel_event_callbacks_t cbs = {
+        .on_vsync        = bsp_display_on_vsync,
+        .on_bounce_empty = s_comp_scene ? bsp_display_comp_fill : NULL,
+    };
+    BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_rgb_panel_register_event_callbacks(panel, &cbs, NULL));
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_get_scanout_stats(bsp_display_scanout_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = s_scanout_stats;
+    return ESP_OK;
+}
+
+void bsp_display_reset_scanout_stats(void)
+{
+    const bsp_display_scanout_stats_t clean = {
+        .nominal_frame_us = s_scanout_stats.nominal_frame_us,
+    };
+    /* Restart interval measurement from the next vsync */
+    s_scanout_last  = 0;
+    s_scanout_stats = clean;
+}
+
 esp_err_t bsp_display_new(const bsp_display_config_t *config,
                            esp_lcd_panel_handle_t     *ret_panel,
                            esp_lcd_panel_io_handle_t  *ret_io)
@@ -87,6 +288,15 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config,
         *ret_io = NULL;
     }
 
+    const bool comp_mode = (config && config->comp_scene);
+
+    /* A vsync arriving more than 1.5 frame times after the previous one means scanout stalled */
+    memset(&s_scanout_stats, 0, sizeof(s_scanout_stats));
+    s_scanout_last = 0;
+    s_scanout_stats.nominal_frame_us = (uint32_t)((uint64_t)BSP_LCD_H_TOTAL * BSP_LCD_V_TOTAL * 1000000ULL
+                                                  / BSP_LCD_PIXEL_CLOCK_HZ);
+    s_scanout_late_cycles = s_scanout_stats.nominal_frame_us * 3 / 2 * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+
     BSP_ERROR_CHECK_RETURN_ERR(bsp_display_brightness_init());
 
     /* LCD reset pulse */
@@ -107,17 +317,17 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config,
             .pclk_hz           = BSP_LCD_PIXEL_CLOCK_HZ,
             .h_res             = BSP_LCD_H_RES,
             .v_res             = BSP_LCD_V_RES,
-            .hsync_pulse_width = 4,
-            .hsync_back_porch  = 8,
-            .hsync_front_porch = 8,
-            .vsync_pulse_width = 4,
-            .vsync_back_porch  = 16,
-            .vsync_front_porch = 16,
+            .hsync_pulse_width = BSP_LCD_HSYNC_PULSE_WIDTH,
+            .hsync_back_porch  = BSP_LCD_HSYNC_BACK_PORCH,
+            .hsync_front_porch = BSP_LCD_HSYNC_FRONT_PORCH,
+            .vsync_pulse_width = BSP_LCD_VSYNC_PULSE_WIDTH,
+            .vsync_back_porch  = BSP_LCD_VSYNC_BACK_PORCH,
+            .vsync_front_porch = BSP_LCD_VSYNC_FRONT_PORCH,
             .flags.pclk_active_neg = true,
         },
         .data_width             = 16,
         .in_color_format        = LCD_COLOR_FMT_RGB565,
-        .num_fbs                = 2,  /* double-buffer required for avoid_tearing */
+        .num_fbs                = comp_mode ? 0 : 2,  /* double-buffer required for avoid_tearing */
         .bounce_buffer_size_px  = BSP_LCD_H_RES * CONFIG_BSP_LCD_RGB_BOUNCE_BUF_HEIGHT,
         .hsync_gpio_num    = GPIO_NUM_NC,
         .vsync_gpio_num    = GPIO_NUM_NC,
@@ -142,9 +352,17 @@ esp_err_t bsp_display_new(const bsp_display_config_t *config,
             BSP_LCD_DATA15,  /* R7 */
         },
         .disp_gpio_num     = GPIO_NUM_NC,
-        .flags.fb_in_psram = true,
+        .flags.fb_in_psram = !comp_mode,
+        .flags.no_fb       = comp_mode,  /* compositor fills the bounce buffers itself */
     };
     BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_new_rgb_panel(&panel_conf, ret_panel));
+    if (comp_mode) {
+        BSP_ERROR_CHECK_RETURN_ERR(bsp_display_comp_attach(config->comp_scene));
+    } else {
+        s_comp_scene = NULL;
+    }
+    /* Must be registered before esp_lcd_panel_init(), which primes the bounce buffers */
+    BSP_ERROR_CHECK_RETURN_ERR(bsp_display_register_callbacks(*ret_panel));
     BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_panel_reset(*ret_panel));
     BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_panel_init(*ret_panel));
 
@@ -157,6 +375,13 @@ static lv_display_t          *s_display         = NULL;
 static lv_indev_t            *s_touch_indev     = NULL;
 static bool                   s_display_sleeping = false;
 
+/* Wake latency: written by the waking task and the flush callback, both under the display lock */
+static bool                     s_wake_pending = false;  /* no frame drawn since the wake */
+static bool                     s_wake_touch   = false;
+static int64_t                  s_wake_start   = 0;
+static uint64_t                 s_wake_total_us = 0;
+static bsp_display_wake_stats_t s_wake_stats;
+
 lv_display_t *bsp_display_start(void)
 {
     bsp_display_cfg_t cfg = {
@@ -222,6 +447,23 @@ lv_display_t *bsp_display_start_with_config(const bsp_display_cfg_t *cfg)
         return NULL;
     }
 
+    /* Take over flush and vsync handling so the render mode can be switched at runtime */
+    if (!bsp_display_lock(0)) {
+        return NULL;
+    }
+    esp_err_t mode_err = bsp_display_mode_init(s_display, s_panel_handle);
+    if (mode_err == ESP_OK) {
+        mode_err = bsp_display_post_init(s_display);
+    }
+    bsp_display_unlock();
+    BSP_ERROR_CHECK_RETURN_NULL(mode_err);
+
+#if CONFIG_BSP_DISPLAY_LOCK_STATS
+    if (bsp_display_lock_stats_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Display lock summary log timer not started");
+    }
+#endif
+
     /* Initialize touch input device */
     if (bsp_display_indev_init(s_display) != ESP_OK) {
         ESP_LOGW(TAG, "Touch indev init failed — continuing without touch");
@@ -242,12 +484,20 @@ void bsp_display_set_touch_indev(lv_indev_t *indev)
 
 bool bsp_display_lock(uint32_t timeout_ms)
 {
+#if CONFIG_BSP_DISPLAY_LOCK_STATS
+    return bsp_display_lock_stats_lock(timeout_ms);
+#else
     return lvgl_port_lock(timeout_ms);
+#endif
 }
 
 void bsp_display_unlock(void)
 {
+#if CONFIG_BSP_DISPLAY_LOCK_STATS
+    bsp_display_lock_stats_unlock();
+#else
     lvgl_port_unlock();
+#endif
 }
 
 void bsp_display_rotate(lv_display_t *disp, lv_disp_rotation_t rotation)
@@ -293,22 +543,31 @@ esp_err_t bsp_display_enter_sleep(void)
     }
 
     s_display_sleeping = true;
+    s_wake_pending = false;
 
     bsp_display_unlock();
 
-    BSP_ERROR_CHECK_RETURN_ERR(bsp_display_backlight_off());
+    /* Keeps s_brightness for the wake */
+    BSP_ERROR_CHECK_RETURN_ERR(bsp_display_brightness_write(0));
+
+    if (bsp_touch_set_sleep(true)) {
+        ESP_LOGI(TAG, "Display asleep, a touch wakes it");
+    }
 
     return ESP_OK;
 }
 
-esp_err_t bsp_display_exit_sleep(void)
+/*
+ * Resumes rendering; the backlight comes back with the first frame, in bsp_display_wake_frame(), so the
+ * black framebuffers are never seen. trigger_us is the time the wake was asked for: the INT edge of a
+ * waking touch.
+ */
+esp_err_t bsp_display_wake(int64_t trigger_us, bool touch)
 {
     if (!s_display) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    BSP_ERROR_CHECK_RETURN_ERR(bsp_display_backlight_on());
-
     if (!bsp_display_lock(0)) {
         return ESP_ERR_TIMEOUT;
     }
@@ -318,17 +577,78 @@ esp_err_t bsp_display_exit_sleep(void)
         return ESP_OK;
     }
 
+    /* Render at the next LVGL timer pass rather than a refresh period later */
     lv_timer_t *refr_timer = lv_display_get_refr_timer(s_display);
     if (refr_timer) {
         lv_timer_resume(refr_timer);
+        lv_timer_ready(refr_timer);
     }
 
     lv_obj_invalidate(lv_display_get_screen_active(s_display));
+    lv_display_trigger_activity(s_display);
 
     s_display_sleeping = false;
+    s_wake_pending = true;
+    s_wake_touch = touch;
+    s_wake_start = trigger_us;
 
     bsp_display_unlock();
 
+    bsp_touch_set_sleep(false);
+
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_exit_sleep(void)
+{
+    return bsp_display_wake(esp_timer_get_time(), false);
+}
+
+/* Called by the flush callback once a frame is complete; LVGL task */
+void bsp_display_wake_frame(void)
+{
+    if (!s_wake_pending) {
+        return;
+    }
+    s_wake_pending = false;
+
+    bsp_display_brightness_write(s_brightness ? s_brightness : 100);
+
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - s_wake_start);
+    s_wake_stats.wakes++;
+    if (s_wake_touch) {
+        s_wake_stats.touch_wakes++;
+    }
+    s_wake_stats.last_us = us;
+    s_wake_total_us += us;
+    s_wake_stats.avg_us = (uint32_t)(s_wake_total_us / s_wake_stats.wakes);
+    if (us > s_wake_stats.max_us) {
+        s_wake_stats.max_us = us;
+    }
+    if (us > CONFIG_BSP_DISPLAY_WAKE_TARGET_MS * 1000) {
+        s_wake_stats.over_target++;
+        ESP_LOGW(TAG, "Display wake took %" PRIu32 " us, over the %d ms target", us,
+                 CONFIG_BSP_DISPLAY_WAKE_TARGET_MS);
+    } else {
+        ESP_LOGI(TAG, "Display awake in %" PRIu32 " us%s", us, s_wake_touch ? " (touch)" : "");
+    }
+}
+
+bool bsp_display_is_sleeping(void)
+{
+    return s_display_sleeping;
+}
+
+esp_err_t bsp_display_get_wake_stats(bsp_display_wake_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!bsp_display_lock(0)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    *stats = s_wake_stats;
+    bsp_display_unlock();
     return ESP_OK;
 }
 #endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
@@ -0,0 +1,292 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Cached static background layer.
+ *
+ * Object tree built by bsp_display_bg_cache_create(parent):
+ *
+ *   parent
+ *   └── root          (transparent, full size of parent's content area)
+ *       ├── content   (returned to the caller — static objects go here)
+ *       └── img       (opaque RGB565 snapshot of content, hidden until valid)
+ *
+ * Once the snapshot is valid, img fully covers content. LVGL's refresh starts
+ * drawing from the top-most object covering an invalidated area, so redraws
+ * begin with a blit of img and never re-run content's draw tasks. Widgets the
+ * caller creates on parent afterwards are later siblings and draw on top.
+ */
+#include <string.h>
+#include <inttypes.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+
+static const char *TAG = "bsp_bg_cache";
+
+#if LV_USE_SNAPSHOT
+
+typedef struct {
+    lv_obj_t     *content;
+    lv_obj_t     *img;
+    lv_timer_t   *timer;
+    lv_draw_buf_t buf;
+    void         *buf_data;
+    size_t        buf_size;
+    bool          enabled;
+    bool          rebuilding;
+    bsp_display_bg_cache_stats_t stats;
+} bg_cache_t;
+
+static void bg_cache_event_cb(lv_event_t *e);
+
+static bg_cache_t *bg_cache_get(lv_obj_t *content)
+{
+    const uint32_t count = lv_obj_get_event_count(content);
+    for (uint32_t i = 0; i < count; i++) {
+        lv_event_dsc_t *dsc = lv_obj_get_event_dsc(content, i);
+        if (lv_event_dsc_get_cb(dsc) == bg_cache_event_cb) {
+            return lv_event_dsc_get_user_data(dsc);
+        }
+    }
+    return NULL;
+}
+
+static void bg_cache_mark_dirty(bg_cache_t *ctx)
+{
+    if (!ctx->enabled || ctx->rebuilding) {
+        return;
+    }
+    ctx->stats.valid = false;
+    lv_obj_add_flag(ctx->img, LV_OBJ_FLAG_HIDDEN);
+    lv_timer_resume(ctx->timer);
+    lv_timer_ready(ctx->timer);
+}
+
+/*
+ * LVGL only reports a change to the object that changed, and a new or deleted child to its direct
+ * parent: every object below content carries bg_cache_event_cb() to hear about them.
+ */
+static lv_obj_tree_walk_res_t bg_cache_hook_cb(lv_obj_t *obj, void *user_data)
+{
+    if (!bg_cache_get(obj)) {
+        lv_obj_add_event_cb(obj, bg_cache_event_cb, LV_EVENT_ALL, user_data);
+    }
+    return LV_OBJ_TREE_WALK_NEXT;
+}
+
+static lv_obj_tree_walk_res_t bg_cache_unhook_cb(lv_obj_t *obj, void *user_data)
+{
+    lv_obj_remove_event_cb_with_user_data(obj, bg_cache_event_cb, user_data);
+    return LV_OBJ_TREE_WALK_NEXT;
+}
+
+static bool bg_cache_contains(const bg_cache_t *ctx, lv_obj_t *obj)
+{
+    for (; obj; obj = lv_obj_get_parent(obj)) {
+        if (obj == ctx->content) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* child was created below, moved below or moved away from an object of the cache */
+static void bg_cache_child_changed(bg_cache_t *ctx, lv_obj_t *child)
+{
+    if (bg_cache_contains(ctx, child)) {
+        lv_obj_tree_walk(child, bg_cache_hook_cb, ctx);
+    } else {
+        lv_obj_tree_walk(child, bg_cache_unhook_cb, ctx);
+    }
+}
+
+static void bg_cache_rebuild(bg_cache_t *ctx)
+{
+    ctx->rebuilding = true;
+    lv_obj_update_layout(ctx->content);
+
+    const int64_t start = esp_timer_get_time();
+    const int32_t w = lv_obj_get_width(ctx->content);
+    const int32_t h = lv_obj_get_height(ctx->content);
+    const uint32_t stride = lv_draw_buf_width_to_stride(w, LV_COLOR_FORMAT_RGB565);
+    const size_t size = (size_t)stride * h;
+
+    if (size > ctx->buf_size) {
+        heap_caps_free(ctx->buf_data);
+        ctx->buf_data = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        ctx->buf_size = ctx->buf_data ? size : 0;
+        if (!ctx->buf_data) {
+            ESP_LOGE(TAG, "No memory for %" PRId32 "x%" PRId32 " background cache", w, h);
+            goto out;
+        }
+    }
+
+    lv_draw_buf_init(&ctx->buf, w, h, LV_COLOR_FORMAT_RGB565, stride, ctx->buf_data, ctx->buf_size);
+    if (lv_snapshot_take_to_draw_buf(ctx->content, LV_COLOR_FORMAT_RGB565, &ctx->buf) != LV_RESULT_OK) {
+        ESP_LOGE(TAG, "Background snapshot failed");
+        goto out;
+    }
+
+    /* Same buffer address on every rebuild: make sure nothing serves the old pixels */
+    lv_image_cache_drop(&ctx->buf);
+    lv_image_set_src(ctx->img, &ctx->buf);
+    lv_obj_set_size(ctx->img, w, h);
+
+    lv_obj_remove_flag(ctx->img, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_invalidate(ctx->img);
+
+    ctx->stats.valid = true;
+    ctx->stats.rebuilds++;
+    ctx->stats.last_rebuild_us = (uint32_t)(esp_timer_get_time() - start);
+    ESP_LOGD(TAG, "Rebuilt in %" PRIu32 " us", ctx->stats.last_rebuild_us);
+
+out:
+    ctx->rebuilding = false;
+}
+
+static void bg_cache_timer_cb(lv_timer_t *t)
+{
+    bg_cache_t *ctx = lv_timer_get_user_data(t);
+    lv_timer_pause(t);
+    if (ctx->enabled) {
+        bg_cache_rebuild(ctx);
+    }
+}
+
+static void bg_cache_event_cb(lv_event_t *e)
+{
+    bg_cache_t *ctx = lv_event_get_user_data(e);
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_CHILD_CHANGED:
+    case LV_EVENT_CHILD_CREATED:
+        if (lv_event_get_param(e)) {
+            bg_cache_child_changed(ctx, lv_event_get_param(e));
+        }
+        bg_cache_mark_dirty(ctx);
+        break;
+    case LV_EVENT_STYLE_CHANGED:
+    case LV_EVENT_SIZE_CHANGED:
+    case LV_EVENT_LAYOUT_CHANGED:
+    case LV_EVENT_STATE_CHANGED:
+    case LV_EVENT_VALUE_CHANGED:
+    case LV_EVENT_CHILD_DELETED:
+        bg_cache_mark_dirty(ctx);
+        break;
+    default:
+        break;
+    }
+}
+
+static void bg_cache_delete_cb(lv_event_t *e)
+{
+    bg_cache_t *ctx = lv_event_get_user_data(e);
+    lv_timer_delete(ctx->timer);
+    heap_caps_free(ctx->buf_data);
+    lv_free(ctx);
+}
+
+lv_obj_t *bsp_display_bg_cache_create(lv_obj_t *parent)
+{
+    BSP_NULL_CHECK(parent, NULL);
+
+    bg_cache_t *ctx = lv_malloc(sizeof(bg_cache_t));
+    BSP_NULL_CHECK(ctx, NULL);
+    lv_memzero(ctx, sizeof(bg_cache_t));
+    ctx->enabled = true;
+
+    lv_obj_t *root = lv_obj_create(parent);
+    lv_obj_remove_style_all(root);
+    lv_obj_add_flag(root, LV_OBJ_FLAG_IGNORE_LAYOUT);
+    lv_obj_remove_flag(root, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_size(root, lv_pct(100), lv_pct(100));
+
+    ctx->content = lv_obj_create(root);
+    lv_obj_remove_style_all(ctx->content);
+    lv_obj_remove_flag(ctx->content, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_size(ctx->content, lv_pct(100), lv_pct(100));
+
+    ctx->img = lv_image_create(root);
+    lv_obj_remove_style_all(ctx->img);
+    lv_obj_remove_flag(ctx->img, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(ctx->img, LV_OBJ_FLAG_HIDDEN);
+
+    /* First snapshot is taken on the next timer run, once the caller has populated content */
+    ctx->timer = lv_timer_create(bg_cache_timer_cb, 0, ctx);
+
+    lv_obj_add_event_cb(ctx->content, bg_cache_event_cb, LV_EVENT_ALL, ctx);
+    lv_obj_add_event_cb(root, bg_cache_delete_cb, LV_EVENT_DELETE, ctx);
+
+    return ctx->content;
+}
+
+void bsp_display_bg_cache_invalidate(lv_obj_t *cache)
+{
+    bg_cache_t *ctx = bg_cache_get(cache);
+    if (ctx) {
+        bg_cache_mark_dirty(ctx);
+    }
+}
+
+void bsp_display_bg_cache_set_enabled(lv_obj_t *cache, bool enabled)
+{
+    bg_cache_t *ctx = bg_cache_get(cache);
+    if (!ctx || ctx->enabled == enabled) {
+        return;
+    }
+
+    if (enabled) {
+        ctx->enabled = true;
+        bg_cache_mark_dirty(ctx);
+    } else {
+        bg_cache_mark_dirty(ctx);
+        ctx->enabled = false;
+        lv_timer_pause(ctx->timer);
+    }
+}
+
+esp_err_t bsp_display_bg_cache_get_stats(lv_obj_t *cache, bsp_display_bg_cache_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    bg_cache_t *ctx = bg_cache_get(cache);
+    if (!ctx) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = ctx->stats;
+    return ESP_OK;
+}
+
+#else // LV_USE_SNAPSHOT
+
+lv_obj_t *bsp_display_bg_cache_create(lv_obj_t *parent)
+{
+    ESP_LOGE(TAG, "Background cache needs CONFIG_LV_USE_SNAPSHOT");
+    return NULL;
+}
+
+void bsp_display_bg_cache_invalidate(lv_obj_t *cache)
+{
+}
+
+void bsp_display_bg_cache_set_enabled(lv_obj_t *cache, bool enabled)
+{
+}
+
+esp_err_t bsp_display_bg_cache_get_stats(lv_obj_t *cache, bsp_display_bg_cache_stats_t *stats)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // LV_USE_SNAPSHOT
+
+#endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
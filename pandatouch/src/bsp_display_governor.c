@@ -0,0 +1,257 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Frame-budget governor.
+ *
+ * Watches render time per frame and trades visual quality for frame rate while
+ * the system is loaded. Degradation is applied through LVGL itself: overlay
+ * styles on the governed objects, and a longer period for the animation timer.
+ * Everything is undone in reverse order on the way back up.
+ */
+#include <string.h>
+#include <inttypes.h>
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+
+static const char *TAG = "bsp_governor";
+
+#define GOV_MAX_OBJS                (16)
+#define GOV_DEFAULT_DEGRADE_FRAMES  (3)
+#define GOV_DEFAULT_RESTORE_FRAMES  (30)
+#define GOV_DEFAULT_RESTORE_PERCENT (60)
+
+static lv_display_t           *s_disp        = NULL;
+static bsp_display_gov_cfg_t   s_cfg;
+static bsp_display_gov_stats_t s_stats;
+static int64_t                 s_frame_start = 0;
+static uint8_t                 s_over_run    = 0;   /* consecutive frames over budget */
+static uint8_t                 s_under_run   = 0;   /* consecutive frames under restore threshold */
+static uint32_t                s_anim_period = 0;   /* animation timer period before SLOW_ANIM */
+static lv_obj_t               *s_objs[GOV_MAX_OBJS];
+static lv_style_t              s_style_no_effects;
+static lv_style_t              s_style_simple;
+static bool                    s_styles_init = false;
+
+static const lv_style_selector_t s_parts[] = { LV_PART_MAIN, LV_PART_INDICATOR, LV_PART_KNOB };
+
+static void gov_styles_init(void)
+{
+    if (s_styles_init) {
+        return;
+    }
+    lv_style_init(&s_style_no_effects);
+    lv_style_set_shadow_width(&s_style_no_effects, 0);
+    lv_style_set_shadow_opa(&s_style_no_effects, LV_OPA_TRANSP);
+    lv_style_set_opa_layered(&s_style_no_effects, LV_OPA_COVER);
+
+    lv_style_init(&s_style_simple);
+    lv_style_set_bg_grad_dir(&s_style_simple, LV_GRAD_DIR_NONE);
+    lv_style_set_radius(&s_style_simple, 0);
+    s_styles_init = true;
+}
+
+static void gov_obj_style(lv_obj_t *obj, lv_style_t *style, bool on)
+{
+    for (size_t i = 0; i < sizeof(s_parts) / sizeof(s_parts[0]); i++) {
+        if (on) {
+            lv_obj_add_style(obj, style, s_parts[i]);
+        } else {
+            lv_obj_remove_style(obj, style, s_parts[i]);
+        }
+    }
+}
+
+static void gov_apply_styles(lv_obj_t *obj, bsp_display_gov_level_t level)
+{
+    /* Remove first so a style is never added twice */
+    gov_obj_style(obj, &s_style_no_effects, false);
+    gov_obj_style(obj, &s_style_simple, false);
+    if (level >= BSP_DISPLAY_GOV_LEVEL_NO_EFFECTS) {
+        gov_obj_style(obj, &s_style_no_effects, true);
+    }
+    if (level >= BSP_DISPLAY_GOV_LEVEL_SIMPLE) {
+        gov_obj_style(obj, &s_style_simple, true);
+    }
+}
+
+static void gov_set_level(bsp_display_gov_level_t level)
+{
+    const bsp_display_gov_level_t prev = s_stats.level;
+    if (level == prev) {
+        return;
+    }
+
+    for (int i = 0; i < GOV_MAX_OBJS; i++) {
+        if (s_objs[i]) {
+            gov_apply_styles(s_objs[i], level);
+        }
+    }
+
+    lv_timer_t *anim_timer = lv_anim_get_timer();
+    if (anim_timer) {
+        if (level >= BSP_DISPLAY_GOV_LEVEL_SLOW_ANIM && prev < BSP_DISPLAY_GOV_LEVEL_SLOW_ANIM) {
+            s_anim_period = lv_timer_get_period(anim_timer);
+            lv_timer_set_period(anim_timer, s_anim_period * 2);
+        } else if (level < BSP_DISPLAY_GOV_LEVEL_SLOW_ANIM && prev >= BSP_DISPLAY_GOV_LEVEL_SLOW_ANIM) {
+            lv_timer_set_period(anim_timer, s_anim_period);
+        }
+    }
+
+    s_stats.level = level;
+    if (level > prev) {
+        s_stats.degrades++;
+    } else {
+        s_stats.restores++;
+    }
+    ESP_LOGD(TAG, "Level %d -> %d (frame %" PRIu32 " us)", prev, level, s_stats.frame_us);
+
+    if (s_cfg.on_level) {
+        s_cfg.on_level(level, s_cfg.user_ctx);
+    }
+}
+
+static void gov_render_cb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        s_frame_start = esp_timer_get_time();
+        return;
+    }
+    if (!s_frame_start) {
+        return;
+    }
+
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - s_frame_start);
+    s_frame_start = 0;
+
+    /* Exponential average over ~4 frames, only for reporting; decisions use raw frame times */
+    s_stats.frame_us = s_stats.frames ? (s_stats.frame_us * 3 + us) / 4 : us;
+    s_stats.frames++;
+
+    if (us > s_cfg.budget_us) {
+        s_stats.over_budget++;
+        s_under_run = 0;
+        if (++s_over_run >= s_cfg.degrade_frames) {
+            s_over_run = 0;
+            if (s_stats.level < s_cfg.max_level) {
+                gov_set_level(s_stats.level + 1);
+            }
+        }
+    } else if (us < (uint64_t)s_cfg.budget_us * s_cfg.restore_percent / 100) {
+        s_over_run = 0;
+        if (++s_under_run >= s_cfg.restore_frames) {
+            s_under_run = 0;
+            if (s_stats.level > BSP_DISPLAY_GOV_LEVEL_FULL) {
+                gov_set_level(s_stats.level - 1);
+            }
+        }
+    } else {
+        /* Inside the hysteresis band: hold the current level */
+        s_over_run  = 0;
+        s_under_run = 0;
+    }
+}
+
+static void gov_obj_delete_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_current_target(e);
+    for (int i = 0; i < GOV_MAX_OBJS; i++) {
+        if (s_objs[i] == obj) {
+            s_objs[i] = NULL;
+        }
+    }
+}
+
+esp_err_t bsp_display_governor_start(const bsp_display_gov_cfg_t *cfg)
+{
+    if (!cfg || !cfg->budget_us || cfg->max_level >= BSP_DISPLAY_GOV_LEVEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    lv_display_t *disp = lv_display_get_default();
+    if (!disp) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    bsp_display_governor_stop();
+
+    s_cfg = *cfg;
+    if (!s_cfg.degrade_frames) {
+        s_cfg.degrade_frames = GOV_DEFAULT_DEGRADE_FRAMES;
+    }
+    if (!s_cfg.restore_frames) {
+        s_cfg.restore_frames = GOV_DEFAULT_RESTORE_FRAMES;
+    }
+    if (!s_cfg.restore_percent) {
+        s_cfg.restore_percent = GOV_DEFAULT_RESTORE_PERCENT;
+    }
+    if (s_cfg.max_level == BSP_DISPLAY_GOV_LEVEL_FULL) {
+        s_cfg.max_level = BSP_DISPLAY_GOV_LEVEL_MAX - 1;
+    }
+
+    gov_styles_init();
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_frame_start = 0;
+    s_over_run    = 0;
+    s_under_run   = 0;
+
+    s_disp = disp;
+    lv_display_add_event_cb(s_disp, gov_render_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(s_disp, gov_render_cb, LV_EVENT_RENDER_READY, NULL);
+    return ESP_OK;
+}
+
+void bsp_display_governor_stop(void)
+{
+    if (!s_disp) {
+        return;
+    }
+    lv_display_remove_event_cb_with_user_data(s_disp, gov_render_cb, NULL);
+    gov_set_level(BSP_DISPLAY_GOV_LEVEL_FULL);
+    s_disp = NULL;
+}
+
+esp_err_t bsp_display_governor_add(lv_obj_t *obj)
+{
+    if (!obj) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < GOV_MAX_OBJS; i++) {
+        if (s_objs[i] == obj) {
+            return ESP_OK;
+        }
+        if (!s_objs[i] && slot < 0) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    gov_styles_init();
+    s_objs[slot] = obj;
+    lv_obj_add_event_cb(obj, gov_obj_delete_cb, LV_EVENT_DELETE, NULL);
+    if (s_stats.level != BSP_DISPLAY_GOV_LEVEL_FULL) {
+        gov_apply_styles(obj, s_stats.level);
+    }
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_governor_get_stats(bsp_display_gov_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = s_stats;
+    return ESP_OK;
+}
+
+#endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
@@ -0,0 +1,256 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Display lock contention statistics (CONFIG_BSP_DISPLAY_LOCK_STATS).
+ *
+ * bsp_display_lock() forwards here when enabled. The task holding the lock
+ * through bsp_display_lock() is tracked, so a long wait can be blamed on it;
+ * when nobody holds it that way, the LVGL task owns it for rendering and
+ * timers. Only the outermost lock/unlock pair of a recursive take is timed.
+ */
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+#include "esp_lvgl_port.h"
+
+#if CONFIG_BSP_DISPLAY_LOCK_STATS
+
+static const char *TAG = "bsp_lock";
+
+#define LOCK_MAX_CALLERS    (8)     /* the last entry collects every further task */
+#define LOCK_LONG_WAITS     (8)
+
+static bsp_display_lock_caller_stats_t s_callers[LOCK_MAX_CALLERS];
+static TaskHandle_t                    s_caller_task[LOCK_MAX_CALLERS];
+static size_t                          s_caller_count = 0;
+static bsp_display_lock_long_wait_t    s_long_waits[LOCK_LONG_WAITS];
+static size_t                          s_long_head    = 0;
+static size_t                          s_long_count   = 0;
+static portMUX_TYPE                    s_stats_lock   = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t              s_log_timer    = NULL;
+
+/* Written only by the task holding the lock */
+static TaskHandle_t volatile s_holder     = NULL;
+static volatile int          s_holder_idx = -1;
+static uint32_t              s_depth      = 0;
+static int64_t               s_hold_start = 0;
+
+static inline uint32_t lock_bucket(uint32_t us)
+{
+    const uint32_t b = 31 - __builtin_clz(us | 1);
+    return b < BSP_DISPLAY_LOCK_HIST_BUCKETS ? b : BSP_DISPLAY_LOCK_HIST_BUCKETS - 1;
+}
+
+/* Must be called with s_stats_lock held */
+static int lock_caller_index(TaskHandle_t task)
+{
+    for (size_t i = 0; i < s_caller_count; i++) {
+        if (s_caller_task[i] == task) {
+            return i;
+        }
+    }
+    if (s_caller_count < LOCK_MAX_CALLERS) {
+        const size_t i = s_caller_count++;
+        s_caller_task[i] = task;
+        strlcpy(s_callers[i].task, i == LOCK_MAX_CALLERS - 1 ? "(other)" : pcTaskGetName(task),
+                sizeof(s_callers[i].task));
+        return i;
+    }
+    return LOCK_MAX_CALLERS - 1;
+}
+
+bool bsp_display_lock_stats_lock(uint32_t timeout_ms)
+{
+    const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (s_holder == self) {
+        /* Recursive take: already accounted for by the outermost one */
+        const bool ok = lvgl_port_lock(timeout_ms);
+        if (ok) {
+            s_depth++;
+        }
+        return ok;
+    }
+
+    const int holder_idx = s_holder_idx;
+    const int64_t start = esp_timer_get_time();
+    const bool ok = lvgl_port_lock(timeout_ms);
+    const int64_t now = esp_timer_get_time();
+    const uint32_t wait_us = (uint32_t)(now - start);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    const int idx = lock_caller_index(self);
+    bsp_display_lock_caller_stats_t *c = &s_callers[idx];
+    if (ok) {
+        c->locks++;
+    } else {
+        c->timeouts++;
+    }
+    c->wait_us += wait_us;
+    c->wait_hist[lock_bucket(wait_us)]++;
+    if (wait_us > c->max_wait_us) {
+        c->max_wait_us = wait_us;
+    }
+    if (wait_us > CONFIG_BSP_DISPLAY_LOCK_STATS_LONG_WAIT_US) {
+        bsp_display_lock_long_wait_t *w = &s_long_waits[s_long_head];
+        strlcpy(w->waiter, c->task, sizeof(w->waiter));
+        strlcpy(w->holder, holder_idx >= 0 ? s_callers[holder_idx].task : "LVGL", sizeof(w->holder));
+        w->wait_us = wait_us;
+        w->time_us = now;
+        s_long_head = (s_long_head + 1) % LOCK_LONG_WAITS;
+        if (s_long_count < LOCK_LONG_WAITS) {
+            s_long_count++;
+        }
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    if (ok) {
+        s_depth = 1;
+        s_hold_start = now;
+        s_holder_idx = idx;
+        s_holder = self;
+    }
+    return ok;
+}
+
+void bsp_display_lock_stats_unlock(void)
+{
+    if (s_holder == xTaskGetCurrentTaskHandle() && --s_depth == 0) {
+        const uint32_t hold_us = (uint32_t)(esp_timer_get_time() - s_hold_start);
+        const int idx = s_holder_idx;
+        s_holder = NULL;
+        s_holder_idx = -1;
+
+        portENTER_CRITICAL(&s_stats_lock);
+        bsp_display_lock_caller_stats_t *c = &s_callers[idx];
+        c->hold_us += hold_us;
+        c->hold_hist[lock_bucket(hold_us)]++;
+        if (hold_us > c->max_hold_us) {
+            c->max_hold_us = hold_us;
+        }
+        portEXIT_CRITICAL(&s_stats_lock);
+    }
+    lvgl_port_unlock();
+}
+
+static void lock_log_timer_cb(void *arg)
+{
+    bsp_display_lock_log_stats();
+}
+
+esp_err_t bsp_display_lock_stats_init(void)
+{
+    if (CONFIG_BSP_DISPLAY_LOCK_STATS_LOG_PERIOD_MS == 0 || s_log_timer) {
+        return ESP_OK;
+    }
+    const esp_timer_create_args_t args = {
+        .callback = lock_log_timer_cb,
+        .name     = "bsp_lock_log",
+    };
+    BSP_ERROR_CHECK_RETURN_ERR(esp_timer_create(&args, &s_log_timer));
+    return esp_timer_start_periodic(s_log_timer, CONFIG_BSP_DISPLAY_LOCK_STATS_LOG_PERIOD_MS * 1000ULL);
+}
+
+esp_err_t bsp_display_lock_get_stats(bsp_display_lock_caller_stats_t *callers, size_t max, size_t *count)
+{
+    if (!callers || !count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_stats_lock);
+    const size_t n = s_caller_count < max ? s_caller_count : max;
+    memcpy(callers, s_callers, n * sizeof(callers[0]));
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    *count = n;
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_lock_get_long_waits(bsp_display_lock_long_wait_t *waits, size_t max, size_t *count)
+{
+    if (!waits || !count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_stats_lock);
+    const size_t n = s_long_count < max ? s_long_count : max;
+    /* The n most recent entries, oldest first */
+    for (size_t i = 0; i < n; i++) {
+        waits[i] = s_long_waits[(s_long_head + LOCK_LONG_WAITS - n + i) % LOCK_LONG_WAITS];
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    *count = n;
+    return ESP_OK;
+}
+
+void bsp_display_lock_reset_stats(void)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    for (size_t i = 0; i < s_caller_count; i++) {
+        char task[sizeof(s_callers[i].task)];
+        memcpy(task, s_callers[i].task, sizeof(task));
+        memset(&s_callers[i], 0, sizeof(s_callers[i]));
+        memcpy(s_callers[i].task, task, sizeof(task));
+    }
+    s_long_head  = 0;
+    s_long_count = 0;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void bsp_display_lock_log_stats(void)
+{
+    bsp_display_lock_caller_stats_t callers[LOCK_MAX_CALLERS];
+    bsp_display_lock_long_wait_t waits[LOCK_LONG_WAITS];
+    size_t n_callers = 0;
+    size_t n_waits = 0;
+    bsp_display_lock_get_stats(callers, LOCK_MAX_CALLERS, &n_callers);
+    bsp_display_lock_get_long_waits(waits, LOCK_LONG_WAITS, &n_waits);
+
+    for (size_t i = 0; i < n_callers; i++) {
+        const bsp_display_lock_caller_stats_t *c = &callers[i];
+        const uint32_t tries = c->locks + c->timeouts;
+        ESP_LOGI(TAG, "%-16s locks %" PRIu32 " timeouts %" PRIu32 " | wait avg %" PRIu32 " max %" PRIu32
+                 " us | hold avg %" PRIu32 " max %" PRIu32 " us", c->task, c->locks, c->timeouts,
+                 tries ? (uint32_t)(c->wait_us / tries) : 0, c->max_wait_us,
+                 c->locks ? (uint32_t)(c->hold_us / c->locks) : 0, c->max_hold_us);
+    }
+    for (size_t i = 0; i < n_waits; i++) {
+        ESP_LOGW(TAG, "long wait: %s waited %" PRIu32 " us while %s held the lock (at %" PRId64 " ms)",
+                 waits[i].waiter, waits[i].wait_us, waits[i].holder, waits[i].time_us / 1000);
+    }
+}
+
+#else // CONFIG_BSP_DISPLAY_LOCK_STATS
+
+esp_err_t bsp_display_lock_get_stats(bsp_display_lock_caller_stats_t *callers, size_t max, size_t *count)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t bsp_display_lock_get_long_waits(bsp_display_lock_long_wait_t *waits, size_t max, size_t *count)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void bsp_display_lock_reset_stats(void)
+{
+}
+
+void bsp_display_lock_log_stats(void)
+{
+}
+
+#endif // CONFIG_BSP_DISPLAY_LOCK_STATS
+
+#endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
@@ -0,0 +1,333 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Runtime-switchable LVGL render mode.
+ *
+ * esp_lvgl_port fixes the flush strategy when the display is added. The BSP
+ * takes over the flush callback and the panel's vsync callback right after
+ * that, so the mode can be changed later without recreating the display:
+ *
+ *  - DIRECT  : LVGL renders into the two panel framebuffers, only dirty areas
+ *              are redrawn; the framebuffers are swapped at vsync (default).
+ *  - FULL    : same framebuffers, but every frame is redrawn completely.
+ *  - PARTIAL : the front framebuffer stays on screen; LVGL renders into one or
+ *              two band buffers carved out of the back framebuffer's memory
+ *              and the flush copies them into the front framebuffer.
+ *
+ * No memory is allocated when switching.
+ *
+ * The vsync interrupt itself belongs to bsp_display.c, which forwards it to
+ * bsp_display_mode_on_vsync().
+ */
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_lcd_panel_rgb.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+
+static const char *TAG = "bsp_disp_mode";
+
+/* Forward declarations — implemented in bsp_display.c */
+esp_err_t bsp_display_register_callbacks(esp_lcd_panel_handle_t panel);
+void bsp_display_wake_frame(void);
+
+#if CONFIG_BSP_TOUCH_LATENCY
+/* Forward declaration — implemented in bsp_touch_latency.c */
+void bsp_touch_lat_mark(bsp_touch_lat_stage_t stage);
+#endif
+
+#define FB_SIZE         (BSP_LCD_H_RES * BSP_LCD_V_RES * sizeof(uint16_t))
+#define LINE_SIZE       (BSP_LCD_H_RES * sizeof(uint16_t))
+#define STATS_SCREENS   (8)
+
+typedef struct {
+    uint32_t frames;
+    uint64_t total_us;
+    uint32_t max_us;
+} mode_acc_t;
+
+typedef struct {
+    lv_obj_t  *screen;
+    mode_acc_t acc[BSP_DISPLAY_RENDER_MODE_MAX];
+} screen_stats_t;
+
+static esp_lcd_panel_handle_t    s_panel       = NULL;
+static lv_display_t             *s_disp        = NULL;
+static SemaphoreHandle_t         s_vsync_sem   = NULL;
+static uint8_t                  *s_fb[2]       = { NULL, NULL };
+static uint8_t                  *s_front       = NULL;   /* framebuffer currently scanned out */
+static bsp_display_render_mode_t s_mode        = BSP_DISPLAY_RENDER_DIRECT;
+static int64_t                   s_render_start = 0;
+static bool                      s_skip_frame  = false;  /* forced full redraw after a switch */
+static screen_stats_t            s_stats[STATS_SCREENS];
+
+static const char *const s_mode_names[BSP_DISPLAY_RENDER_MODE_MAX] = {
+    [BSP_DISPLAY_RENDER_DIRECT]  = "direct",
+    [BSP_DISPLAY_RENDER_PARTIAL] = "partial",
+    [BSP_DISPLAY_RENDER_FULL]    = "full",
+};
+
+/* Called from the vsync interrupt in bsp_display.c */
+IRAM_ATTR bool bsp_display_mode_on_vsync(void)
+{
+    BaseType_t need_yield = pdFALSE;
+    if (s_vsync_sem) {
+        xSemaphoreGiveFromISR(s_vsync_sem, &need_yield);
+    }
+    return need_yield == pdTRUE;
+}
+
+static uint8_t *back_fb(void)
+{
+    return (s_front == s_fb[0]) ? s_fb[1] : s_fb[0];
+}
+
+static void bsp_display_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    const uint32_t area_bytes = lv_area_get_size(area) * sizeof(uint16_t);
+    const bool last = lv_display_flush_is_last(disp);
+
+#if CONFIG_BSP_TOUCH_LATENCY
+    if (last) {
+        bsp_touch_lat_mark(BSP_TOUCH_LAT_STAGE_RENDER);
+    }
+#endif
+
+    if (s_mode == BSP_DISPLAY_RENDER_PARTIAL) {
+        /* Band buffers share the back framebuffer's PSRAM: rendered there, then read back and copied */
+        bsp_psram_monitor_account(BSP_PSRAM_CONSUMER_RENDER, area_bytes);
+        bsp_psram_monitor_account(BSP_PSRAM_CONSUMER_COPY, 2 * area_bytes);
+        /* Bounce-buffer mode reads the framebuffer through the CPU cache, so a plain copy is coherent */
+        const size_t row = (size_t)lv_area_get_width(area) * sizeof(uint16_t);
+        uint8_t *dst = s_front + ((size_t)area->y1 * BSP_LCD_H_RES + area->x1) * sizeof(uint16_t);
+        for (int32_t y = area->y1; y <= area->y2; y++) {
+            memcpy(dst, px_map, row);
+            dst    += LINE_SIZE;
+            px_map += row;
+        }
+    } else {
+        bsp_psram_monitor_account(BSP_PSRAM_CONSUMER_RENDER, area_bytes);
+        if (s_mode == BSP_DISPLAY_RENDER_DIRECT) {
+            /* LVGL copies each dirty area into the other framebuffer after the swap */
+            bsp_psram_monitor_account(BSP_PSRAM_CONSUMER_COPY, 2 * area_bytes);
+        }
+    }
+
+    if (s_mode != BSP_DISPLAY_RENDER_PARTIAL && last) {
+        /* px_map is one of the panel framebuffers: point scanout at it and wait until the
+         * panel has switched, so LVGL never draws into the buffer being scanned out */
+        xSemaphoreTake(s_vsync_sem, 0);
+        esp_lcd_panel_draw_bitmap(s_panel, 0, 0, BSP_LCD_H_RES, BSP_LCD_V_RES, px_map);
+        xSemaphoreTake(s_vsync_sem, pdMS_TO_TICKS(100));
+        s_front = px_map;
+    }
+
+#if CONFIG_BSP_TOUCH_LATENCY
+    if (last) {
+        bsp_touch_lat_mark(BSP_TOUCH_LAT_STAGE_SWAP);
+    }
+#endif
+    if (last) {
+        bsp_display_wake_frame();
+    }
+
+    lv_display_flush_ready(disp);
+}
+
+static void screen_stats_delete_cb(lv_event_t *e)
+{
+    screen_stats_t *st = lv_event_get_user_data(e);
+    memset(st, 0, sizeof(*st));
+}
+
+static screen_stats_t *screen_stats_get(lv_obj_t *screen, bool create)
+{
+    screen_stats_t *free_slot = NULL;
+    for (int i = 0; i < STATS_SCREENS; i++) {
+        if (s_stats[i].screen == screen) {
+            return &s_stats[i];
+        }
+        if (!s_stats[i].screen && !free_slot) {
+            free_slot = &s_stats[i];
+        }
+    }
+    if (create && free_slot) {
+        free_slot->screen = screen;
+        lv_obj_add_event_cb(screen, screen_stats_delete_cb, LV_EVENT_DELETE, free_slot);
+    }
+    return create ? free_slot : NULL;
+}
+
+static void render_time_cb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        s_render_start = esp_timer_get_time();
+        return;
+    }
+    if (!s_render_start) {
+        return;
+    }
+
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - s_render_start);
+    s_render_start = 0;
+    if (s_skip_frame) {
+        s_skip_frame = false;
+        return;
+    }
+
+    screen_stats_t *st = screen_stats_get(lv_display_get_screen_active(s_disp), true);
+    if (st) {
+        mode_acc_t *acc = &st->acc[s_mode];
+        acc->frames++;
+        acc->total_us += us;
+        if (us > acc->max_us) {
+            acc->max_us = us;
+        }
+    }
+}
+
+esp_err_t bsp_display_mode_init(lv_display_t *disp, esp_lcd_panel_handle_t panel)
+{
+    s_disp  = disp;
+    s_panel = panel;
+
+    void *fb0 = NULL;
+    void *fb1 = NULL;
+    BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_rgb_panel_get_frame_buffer(panel, 2, &fb0, &fb1));
+    s_fb[0] = fb0;
+    s_fb[1] = fb1;
+    s_front = fb0;
+
+    if (!s_vsync_sem) {
+        s_vsync_sem = xSemaphoreCreateBinary();
+        BSP_NULL_CHECK(s_vsync_sem, ESP_ERR_NO_MEM);
+    }
+
+    /* Replaces the callbacks esp_lvgl_port registered; its flush callback is replaced below */
+    BSP_ERROR_CHECK_RETURN_ERR(bsp_display_register_callbacks(panel));
+
+    lv_display_set_flush_cb(disp, bsp_display_flush_cb);
+    lv_display_set_buffers(disp, s_fb[1], s_fb[0], FB_SIZE, LV_DISPLAY_RENDER_MODE_DIRECT);
+    s_mode = BSP_DISPLAY_RENDER_DIRECT;
+
+    lv_display_add_event_cb(disp, render_time_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, render_time_cb, LV_EVENT_RENDER_READY, NULL);
+
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_set_render_mode(const bsp_display_render_cfg_t *cfg)
+{
+    if (!cfg || cfg->mode >= BSP_DISPLAY_RENDER_MODE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_disp) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    switch (cfg->mode) {
+    case BSP_DISPLAY_RENDER_PARTIAL: {
+        uint32_t lines = cfg->partial_lines ? cfg->partial_lines : CONFIG_BSP_LCD_DRAW_BUF_HEIGHT;
+        const uint32_t max_lines = cfg->partial_double ? BSP_LCD_V_RES / 2 : BSP_LCD_V_RES;
+        if (lines > max_lines) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        /* The front framebuffer already holds the last complete frame and stays on screen;
+         * the back framebuffer's memory is free to hold the band buffers */
+        uint8_t *band = back_fb();
+        const size_t size = lines * LINE_SIZE;
+        lv_display_set_buffers(s_disp, band, cfg->partial_double ? band + size : NULL, size,
+                               LV_DISPLAY_RENDER_MODE_PARTIAL);
+        break;
+    }
+    case BSP_DISPLAY_RENDER_FULL:
+        lv_display_set_buffers(s_disp, back_fb(), s_front, FB_SIZE, LV_DISPLAY_RENDER_MODE_FULL);
+        break;
+    case BSP_DISPLAY_RENDER_DIRECT:
+    default:
+        /* The forced full redraw below brings the back buffer up to date; LVGL keeps the two
+         * buffers in sync from then on */
+        lv_display_set_buffers(s_disp, back_fb(), s_front, FB_SIZE, LV_DISPLAY_RENDER_MODE_DIRECT);
+        break;
+    }
+
+    s_mode = cfg->mode;
+    s_render_start = 0;
+    s_skip_frame = true;
+    lv_obj_invalidate(lv_display_get_screen_active(s_disp));
+
+    ESP_LOGI(TAG, "Render mode: %s", s_mode_names[s_mode]);
+    return ESP_OK;
+}
+
+bsp_display_render_mode_t bsp_display_get_render_mode(void)
+{
+    return s_mode;
+}
+
+esp_err_t bsp_display_get_mode_stats(lv_obj_t *screen, bsp_display_render_mode_t mode,
+                                     bsp_display_mode_stats_t *stats)
+{
+    if (!screen || !stats || mode >= BSP_DISPLAY_RENDER_MODE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    const screen_stats_t *st = screen_stats_get(screen, false);
+    if (!st) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const mode_acc_t *acc = &st->acc[mode];
+    stats->frames = acc->frames;
+    stats->avg_us = acc->frames ? (uint32_t)(acc->total_us / acc->frames) : 0;
+    stats->max_us = acc->max_us;
+    return ESP_OK;
+}
+
+bsp_display_render_mode_t bsp_display_get_best_render_mode(lv_obj_t *screen)
+{
+    bsp_display_render_mode_t best = BSP_DISPLAY_RENDER_MODE_MAX;
+    uint32_t best_us = UINT32_MAX;
+
+    for (int m = 0; m < BSP_DISPLAY_RENDER_MODE_MAX; m++) {
+        bsp_display_mode_stats_t st;
+        if (bsp_display_get_mode_stats(screen, m, &st) == ESP_OK && st.frames && st.avg_us < best_us) {
+            best_us = st.avg_us;
+            best = m;
+        }
+    }
+    return best;
+}
+
+void bsp_display_log_mode_stats(void)
+{
+    for (int i = 0; i < STATS_SCREENS; i++) {
+        if (!s_stats[i].screen) {
+            continue;
+        }
+        for (int m = 0; m < BSP_DISPLAY_RENDER_MODE_MAX; m++) {
+            const mode_acc_t *acc = &s_stats[i].acc[m];
+            if (!acc->frames) {
+                continue;
+            }
+            ESP_LOGI(TAG, "screen %p %-7s: %" PRIu32 " frames, avg %" PRIu32 " us, max %" PRIu32 " us",
+                     s_stats[i].screen, s_mode_names[m], acc->frames,
+                     (uint32_t)(acc->total_us / acc->frames), acc->max_us);
+        }
+    }
+}
+
+#endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
@@ -0,0 +1,136 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Batched UI update queue.
+ *
+ * The slots, their coalescing and their seqlock live in the IDF-free core bsp_post_table.c. Producers
+ * write a slot inside a critical section: a producer preempted halfway through its write would otherwise
+ * keep a higher priority producer of the same key waiting on it on the same core. The critical section
+ * covers a copy of at most BSP_DISPLAY_POST_DATA_MAX bytes; the LVGL task never enters it.
+ *
+ * The table is drained by an LVGL timer running at the display refresh period.
+ * It is created after the display's refresh timer and LVGL runs the newest
+ * timers first, so updates land in the refresh of the same timer pass. The
+ * refresh timer itself cannot be used: LVGL pauses it while nothing is
+ * invalidated, and the BSP pauses it during display sleep.
+ */
+#include <stdatomic.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+#include "bsp_post_table.h"
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+
+static const char *TAG = "bsp_post";
+
+#define POST_SLOTS      CONFIG_BSP_DISPLAY_POST_SLOTS
+
+_Static_assert(BSP_POST_DATA_MAX == BSP_DISPLAY_POST_DATA_MAX, "payload size of the slot table");
+
+static bsp_post_slot_t  s_slots[POST_SLOTS];
+static bsp_post_table_t s_table = { .slots = s_slots, .count = POST_SLOTS };
+static portMUX_TYPE     s_write_lock = portMUX_INITIALIZER_UNLOCKED;
+static atomic_uint      s_posted;
+static atomic_uint      s_coalesced;
+static atomic_uint      s_dropped;
+static uint32_t         s_applied;          /* LVGL task only */
+static uint32_t         s_max_drain_us;     /* LVGL task only */
+
+esp_err_t bsp_display_post(uintptr_t key, bsp_display_post_cb_t cb, void *user_ctx, const void *data, size_t len)
+{
+    if (key == BSP_POST_KEY_FREE || key == BSP_POST_KEY_GONE || !cb || len > BSP_DISPLAY_POST_DATA_MAX ||
+        (len && !data)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bsp_post_slot_t *slot = bsp_post_table_claim(&s_table, key);
+    if (!slot) {
+        atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+        return ESP_ERR_NO_MEM;
+    }
+
+    portENTER_CRITICAL(&s_write_lock);
+    const bool coalesced = bsp_post_slot_write(slot, cb, user_ctx, data, len);
+    portEXIT_CRITICAL(&s_write_lock);
+
+    atomic_fetch_add_explicit(&s_posted, 1, memory_order_relaxed);
+    if (coalesced) {
+        atomic_fetch_add_explicit(&s_coalesced, 1, memory_order_relaxed);
+    }
+    return ESP_OK;
+}
+
+static void post_apply(bsp_post_slot_t *slot)
+{
+    bsp_post_cb_t cb;
+    void *user_ctx;
+    uint32_t data[BSP_DISPLAY_POST_DATA_MAX / sizeof(uint32_t)];    /* aligned for any payload struct */
+    if (bsp_post_slot_take(slot, &cb, &user_ctx, data)) {
+        cb(data, user_ctx);
+        s_applied++;
+    }
+}
+
+static void post_timer_cb(lv_timer_t *t)
+{
+    const int64_t start = esp_timer_get_time();
+    bool any = false;
+
+    for (uint32_t i = 0; i < POST_SLOTS; i++) {
+        bsp_post_slot_t *slot = &s_slots[i];
+        if (atomic_load_explicit(&slot->pending, memory_order_relaxed)) {
+            post_apply(slot);
+            any = true;
+        }
+    }
+
+    if (any) {
+        const uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+        if (us > s_max_drain_us) {
+            s_max_drain_us = us;
+        }
+    }
+}
+
+esp_err_t bsp_display_post_init(lv_display_t *disp)
+{
+    BSP_NULL_CHECK(disp, ESP_ERR_INVALID_ARG);
+    lv_timer_t *refr_timer = lv_display_get_refr_timer(disp);
+    const uint32_t period = refr_timer ? lv_timer_get_period(refr_timer) : LV_DEF_REFR_PERIOD;
+    BSP_NULL_CHECK(lv_timer_create(post_timer_cb, period, NULL), ESP_ERR_NO_MEM);
+    ESP_LOGD(TAG, "%d update slots, drained every %" PRIu32 " ms", POST_SLOTS, period);
+    return ESP_OK;
+}
+
+void bsp_display_post_forget(uintptr_t key)
+{
+    if (key != BSP_POST_KEY_FREE && key != BSP_POST_KEY_GONE) {
+        bsp_post_table_forget(&s_table, key);
+    }
+}
+
+esp_err_t bsp_display_post_get_stats(bsp_display_post_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stats->posted       = atomic_load(&s_posted);
+    stats->coalesced    = atomic_load(&s_coalesced);
+    stats->applied      = s_applied;
+    stats->dropped      = atomic_load(&s_dropped);
+    stats->max_drain_us = s_max_drain_us;
+    stats->slots_used   = atomic_load(&s_table.used);
+    return ESP_OK;
+}
+
+#endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
@@ -0,0 +1,610 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Expansion I2C bus (I2C1): device registry, bus sessions, batches and the poll scheduler.
+ *
+ * The bus lock is a recursive mutex; one hold of it is a session. Statistics of transfers and sessions
+ * are only written with the bus lock held, and devices are validated with it held, so a device removed
+ * by another task is never used. The registry and the poll table are guarded by a second lock that is
+ * never held across a transfer, and never taken with the bus lock held.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp/ext_i2c.h"
+#include "bsp_err_check.h"
+
+static const char *TAG = "bsp_ext_i2c";
+
+#define EXT_I2C_TIMEOUT_MS  (50)
+#define EXT_I2C_TASK_STACK  (3072)
+
+struct bsp_ext_i2c_dev_s {
+    bool                    in_use;
+    i2c_master_dev_handle_t handle;
+    char                    name[16];
+    uint16_t                addr;
+    uint32_t                scl_speed_hz;
+    int                     timeout_ms;
+    uint32_t                transfers;      /* statistics, bus lock held */
+    uint32_t                errors;
+    uint32_t                bytes;
+    uint64_t                busy_us;
+};
+
+struct bsp_ext_i2c_poll_s {
+    bool                      in_use;
+    uint32_t                  gen;          /* bumped on removal, so a late callback is dropped */
+    bsp_ext_i2c_poll_config_t cfg;
+    int64_t                   due_us;
+};
+
+/* One poll of the batch being run by the task; the configuration is copied so the slot may be reused */
+typedef struct {
+    uint8_t  slot;
+    uint32_t gen;
+    uint8_t  write[BSP_EXT_I2C_POLL_MAX_WRITE];
+    uint8_t  read[BSP_EXT_I2C_POLL_MAX_READ];
+} ext_i2c_pending_t;
+
+static i2c_master_bus_handle_t   s_bus           = NULL;
+static bool                      s_initialized   = false;
+static SemaphoreHandle_t         s_bus_lock      = NULL;    /* recursive, one hold is a session */
+static SemaphoreHandle_t         s_reg_lock      = NULL;    /* registry and poll table */
+static SemaphoreHandle_t         s_dispatch_lock = NULL;    /* held by the task while calling poll callbacks */
+static TaskHandle_t              s_task          = NULL;
+static SemaphoreHandle_t         s_task_exited   = NULL;    /* given by the task when it stops */
+static volatile bool             s_task_stop     = false;
+static struct bsp_ext_i2c_dev_s  s_devs[CONFIG_BSP_EXT_I2C_MAX_DEVICES];
+static struct bsp_ext_i2c_poll_s s_polls[CONFIG_BSP_EXT_I2C_MAX_POLLS];
+
+/* Session state and statistics, bus lock held */
+static UBaseType_t s_depth;
+static int64_t     s_session_start;
+static uint32_t    s_sessions;
+static uint32_t    s_batches;
+static uint32_t    s_transfers;
+static uint32_t    s_errors;
+static uint64_t    s_busy_us;
+static uint32_t    s_session_max_us;
+static uint32_t    s_wait_max_us;
+static int64_t     s_stats_since;
+static uint32_t    s_polls_late;        /* poll task only */
+
+esp_err_t bsp_ext_i2c_init(void)
+{
+    if (s_initialized) {
+        return ESP_OK;
+    }
+    if (s_bus_lock == NULL) {
+        s_bus_lock      = xSemaphoreCreateRecursiveMutex();
+        s_reg_lock      = xSemaphoreCreateMutex();
+        s_dispatch_lock = xSemaphoreCreateMutex();
+        s_task_exited   = xSemaphoreCreateBinary();
+        if (s_bus_lock == NULL || s_reg_lock == NULL || s_dispatch_lock == NULL || s_task_exited == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    const i2c_master_bus_config_t i2c_config = {
+        .i2c_port = BSP_EXT_I2C_NUM,
+        .sda_io_num = BSP_EXT_I2C_SDA,
+        .scl_io_num = BSP_EXT_I2C_SCL,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = true,
+    };
+    BSP_ERROR_CHECK_RETURN_ERR(i2c_new_master_bus(&i2c_config, &s_bus));
+    s_stats_since = esp_timer_get_time();
+    s_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t bsp_ext_i2c_deinit(void)
+{
+    if (!s_initialized) {
+        return ESP_OK;
+    }
+    if (s_task != NULL && xTaskGetCurrentTaskHandle() == s_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_reg_lock, portMAX_DELAY);
+    for (size_t i = 0; i < CONFIG_BSP_EXT_I2C_MAX_DEVICES; i++) {
+        if (s_devs[i].in_use) {
+            xSemaphoreGive(s_reg_lock);
+            ESP_LOGW(TAG, "Device 0x%02x still registered", s_devs[i].addr);
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    TaskHandle_t task = s_task;
+    s_task = NULL;
+    xSemaphoreGive(s_reg_lock);
+
+    /* The task may still be dispatching its last batch: it stops at the top of its loop, holding no lock */
+    if (task != NULL) {
+        s_task_stop = true;
+        xTaskNotifyGive(task);
+        xSemaphoreTake(s_task_exited, portMAX_DELAY);
+        s_task_stop = false;
+    }
+
+    xSemaphoreTakeRecursive(s_bus_lock, portMAX_DELAY);
+    const esp_err_t ret = i2c_del_master_bus(s_bus);
+    if (ret == ESP_OK) {
+        s_bus = NULL;
+        s_initialized = false;
+    }
+    xSemaphoreGiveRecursive(s_bus_lock);
+    BSP_ERROR_CHECK_RETURN_ERR(ret);
+    return ESP_OK;
+}
+
+i2c_master_bus_handle_t bsp_ext_i2c_get_handle(void)
+{
+    if (bsp_ext_i2c_init() != ESP_OK) {
+        return NULL;
+    }
+    return s_bus;
+}
+
+static bool ext_i2c_dev_valid(const struct bsp_ext_i2c_dev_s *dev)
+{
+    return dev >= &s_devs[0] && dev < &s_devs[CONFIG_BSP_EXT_I2C_MAX_DEVICES] && dev->in_use;
+}
+
+esp_err_t bsp_ext_i2c_add_device(const bsp_ext_i2c_dev_config_t *config, bsp_ext_i2c_dev_handle_t *ret_dev)
+{
+    BSP_NULL_CHECK(config, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(ret_dev, ESP_ERR_INVALID_ARG);
+    if (config->addr > 0x7f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    BSP_ERROR_CHECK_RETURN_ERR(bsp_ext_i2c_init());
+
+    xSemaphoreTake(s_reg_lock, portMAX_DELAY);
+    struct bsp_ext_i2c_dev_s *dev = NULL;
+    for (size_t i = 0; i < CONFIG_BSP_EXT_I2C_MAX_DEVICES; i++) {
+        if (s_devs[i].in_use && s_devs[i].addr == config->addr) {
+            xSemaphoreGive(s_reg_lock);
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (!s_devs[i].in_use && dev == NULL) {
+            dev = &s_devs[i];
+        }
+    }
+    if (dev == NULL) {
+        xSemaphoreGive(s_reg_lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    const i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = config->addr,
+        .scl_speed_hz = config->scl_speed_hz ? config->scl_speed_hz : CONFIG_BSP_EXT_I2C_CLK_SPEED_HZ,
+    };
+    i2c_master_dev_handle_t handle = NULL;
+    const esp_err_t ret = i2c_master_bus_add_device(s_bus, &dev_cfg, &handle);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(s_reg_lock);
+        return ret;
+    }
+
+    memset(dev, 0, sizeof(*dev));
+    dev->handle = handle;
+    dev->addr = config->addr;
+    dev->scl_speed_hz = dev_cfg.scl_speed_hz;
+    dev->timeout_ms = config->timeout_ms ? (int)config->timeout_ms : EXT_I2C_TIMEOUT_MS;
+    if (config->name != NULL) {
+        strlcpy(dev->name, config->name, sizeof(dev->name));
+    }
+    dev->in_use = true;
+    xSemaphoreGive(s_reg_lock);
+
+    ESP_LOGI(TAG, "Device 0x%02x (%s) at %" PRIu32 " Hz", dev->addr, dev->name, dev->scl_speed_hz);
+    *ret_dev = dev;
+    return ESP_OK;
+}
+
+esp_err_t bsp_ext_i2c_remove_device(bsp_ext_i2c_dev_handle_t dev)
+{
+    if (s_reg_lock == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(s_reg_lock, portMAX_DELAY);
+    if (!ext_i2c_dev_valid(dev)) {
+        xSemaphoreGive(s_reg_lock);
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < CONFIG_BSP_EXT_I2C_MAX_POLLS; i++) {
+        if (s_polls[i].in_use && s_polls[i].cfg.dev == dev) {
+            xSemaphoreGive(s_reg_lock);
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    i2c_master_dev_handle_t handle = dev->handle;
+    dev->in_use = false;
+    xSemaphoreGive(s_reg_lock);
+
+    /* Sessions check the device with the bus lock held: once it is taken, none can still use it */
+    xSemaphoreTakeRecursive(s_bus_lock, portMAX_DELAY);
+    const esp_err_t ret = i2c_master_bus_rm_device(handle);
+    xSemaphoreGiveRecursive(s_bus_lock);
+    return ret;
+}
+
+bool bsp_ext_i2c_lock(uint32_t timeout_ms)
+{
+    if (bsp_ext_i2c_init() != ESP_OK) {
+        return false;
+    }
+    const int64_t t0 = esp_timer_get_time();
+    const TickType_t ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    if (xSemaphoreTakeRecursive(s_bus_lock, ticks) != pdTRUE) {
+        return false;
+    }
+    if (s_depth++ == 0) {
+        const int64_t now = esp_timer_get_time();
+        const uint32_t wait_us = (uint32_t)(now - t0);
+        if (wait_us > s_wait_max_us) {
+            s_wait_max_us = wait_us;
+        }
+        s_sessions++;
+        s_session_start = now;
+    }
+    return true;
+}
+
+void bsp_ext_i2c_unlock(void)
+{
+    if (s_bus_lock == NULL || xSemaphoreGetMutexHolder(s_bus_lock) != xTaskGetCurrentTaskHandle()) {
+        return;
+    }
+    if (--s_depth == 0) {
+        const uint32_t len_us = (uint32_t)(esp_timer_get_time() - s_session_start);
+        if (len_us > s_session_max_us) {
+            s_session_max_us = len_us;
+        }
+    }
+    xSemaphoreGiveRecursive(s_bus_lock);
+}
+
+esp_err_t bsp_ext_i2c_probe(uint16_t addr)
+{
+    if (!bsp_ext_i2c_lock(0)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const esp_err_t ret = i2c_master_probe(s_bus, addr, EXT_I2C_TIMEOUT_MS);
+    bsp_ext_i2c_unlock();
+    return ret;
+}
+
+/* One transfer, bus lock held */
+static esp_err_t ext_i2c_transfer(struct bsp_ext_i2c_dev_s *dev, const uint8_t *write, size_t write_len,
+                                  uint8_t *read, size_t read_len)
+{
+    const int64_t t0 = esp_timer_get_time();
+    esp_err_t ret;
+    if (write_len > 0 && read_len > 0) {
+        ret = i2c_master_transmit_receive(dev->handle, write, write_len, read, read_len, dev->timeout_ms);
+    } else if (write_len > 0) {
+        ret = i2c_master_transmit(dev->handle, write, write_len, dev->timeout_ms);
+    } else {
+        ret = i2c_master_receive(dev->handle, read, read_len, dev->timeout_ms);
+    }
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+
+    dev->busy_us += us;
+    dev->transfers++;
+    dev->bytes += write_len + read_len;
+    s_busy_us += us;
+    s_transfers++;
+    if (ret != ESP_OK) {
+        dev->errors++;
+        s_errors++;
+    }
+    return ret;
+}
+
+static bool ext_i2c_op_valid(const struct bsp_ext_i2c_dev_s *dev, const uint8_t *write, size_t write_len,
+                             const uint8_t *read, size_t read_len)
+{
+    return ext_i2c_dev_valid(dev)
+           && (write != NULL || write_len == 0)
+           && (read != NULL || read_len == 0)
+           && (write_len + read_len) > 0;
+}
+
+static esp_err_t ext_i2c_locked_transfer(bsp_ext_i2c_dev_handle_t dev, const uint8_t *write, size_t write_len,
+                                         uint8_t *read, size_t read_len)
+{
+    if (!bsp_ext_i2c_lock(0)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = ESP_ERR_INVALID_ARG;
+    if (ext_i2c_op_valid(dev, write, write_len, read, read_len)) {
+        ret = ext_i2c_transfer(dev, write, write_len, read, read_len);
+    }
+    bsp_ext_i2c_unlock();
+    return ret;
+}
+
+esp_err_t bsp_ext_i2c_write(bsp_ext_i2c_dev_handle_t dev, const uint8_t *data, size_t len)
+{
+    return ext_i2c_locked_transfer(dev, data, len, NULL, 0);
+}
+
+esp_err_t bsp_ext_i2c_read(bsp_ext_i2c_dev_handle_t dev, uint8_t *data, size_t len)
+{
+    return ext_i2c_locked_transfer(dev, NULL, 0, data, len);
+}
+
+esp_err_t bsp_ext_i2c_write_read(bsp_ext_i2c_dev_handle_t dev, const uint8_t *write, size_t write_len,
+                                 uint8_t *read, size_t read_len)
+{
+    if (write_len == 0 || read_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ext_i2c_locked_transfer(dev, write, write_len, read, read_len);
+}
+
+esp_err_t bsp_ext_i2c_run_batch(bsp_ext_i2c_op_t *ops, size_t count)
+{
+    BSP_NULL_CHECK(ops, ESP_ERR_INVALID_ARG);
+    if (count == 0) {
+        return ESP_OK;
+    }
+    if (!bsp_ext_i2c_lock(0)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const bool valid = ext_i2c_op_valid(ops[i].dev, ops[i].write, ops[i].write_len, ops[i].read,
+                                            ops[i].read_len);
+        ops[i].result = valid ? ESP_ERR_NOT_FINISHED : ESP_ERR_INVALID_ARG;
+    }
+    s_batches++;
+    /* Runs of equal clock speed: the driver reprograms the clock only when the speed changes.
+     * Ops to one device share its speed, so their relative order is kept. */
+    for (size_t i = 0; i < count; i++) {
+        if (ops[i].result != ESP_ERR_NOT_FINISHED) {
+            continue;
+        }
+        const uint32_t speed = ops[i].dev->scl_speed_hz;
+        for (size_t j = i; j < count; j++) {
+            bsp_ext_i2c_op_t *op = &ops[j];
+            if (op->result == ESP_ERR_NOT_FINISHED && op->dev->scl_speed_hz == speed) {
+                op->result = ext_i2c_transfer(op->dev, op->write, op->write_len, op->read, op->read_len);
+            }
+        }
+    }
+    bsp_ext_i2c_unlock();
+
+    for (size_t i = 0; i < count; i++) {
+        if (ops[i].result != ESP_OK) {
+            return ops[i].result;
+        }
+    }
+    return ESP_OK;
+}
+
+static void ext_i2c_poll_task(void *arg)
+{
+    (void)arg;
+    static bsp_ext_i2c_op_t  ops[CONFIG_BSP_EXT_I2C_MAX_POLLS];
+    static ext_i2c_pending_t pending[CONFIG_BSP_EXT_I2C_MAX_POLLS];
+    const int64_t window_us = (int64_t)CONFIG_BSP_EXT_I2C_BATCH_WINDOW_MS * 1000;
+
+    while (!s_task_stop) {
+        /* Collect every poll due now or within the batch window */
+        const int64_t now = esp_timer_get_time();
+        int64_t next = INT64_MAX;
+        size_t n = 0;
+        xSemaphoreTake(s_reg_lock, portMAX_DELAY);
+        for (size_t i = 0; i < CONFIG_BSP_EXT_I2C_MAX_POLLS; i++) {
+            struct bsp_ext_i2c_poll_s *p = &s_polls[i];
+            if (!p->in_use) {
+                continue;
+            }
+            if (p->due_us <= now + window_us) {
+                const int64_t period_us = (int64_t)p->cfg.period_ms * 1000;
+                ext_i2c_pending_t *pd = &pending[n];
+                pd->slot = (uint8_t)i;
+                pd->gen = p->gen;
+                memcpy(pd->write, p->cfg.write, sizeof(pd->write));
+                ops[n] = (bsp_ext_i2c_op_t) {
+                    .dev = p->cfg.dev,
+                    .write = pd->write,
+                    .write_len = p->cfg.write_len,
+                    .read = pd->read,
+                    .read_len = p->cfg.read_len,
+                };
+                n++;
+                if (now - p->due_us > period_us) {
+                    s_polls_late++;
+                }
+                p->due_us += period_us;
+                if (p->due_us <= now) {
+                    p->due_us = now + period_us;
+                }
+            }
+            if (p->due_us < next) {
+                next = p->due_us;
+            }
+        }
+        xSemaphoreGive(s_reg_lock);
+
+        if (n == 0) {
+            TickType_t ticks = portMAX_DELAY;
+            if (next != INT64_MAX) {
+                const int64_t tick_us = 1000000 / configTICK_RATE_HZ;
+                ticks = (TickType_t)((next - now + tick_us - 1) / tick_us);
+            }
+            /* Notified by bsp_ext_i2c_poll_add() so a new poll runs at once */
+            ulTaskNotifyTake(pdTRUE, ticks);
+            continue;
+        }
+
+        bsp_ext_i2c_run_batch(ops, n);
+        const int64_t done = esp_timer_get_time();
+
+        xSemaphoreTake(s_dispatch_lock, portMAX_DELAY);
+        for (size_t k = 0; k < n; k++) {
+            xSemaphoreTake(s_reg_lock, portMAX_DELAY);
+            const struct bsp_ext_i2c_poll_s *p = &s_polls[pending[k].slot];
+            const bool live = p->in_use && p->gen == pending[k].gen;
+            const bsp_ext_i2c_poll_cb_t cb = p->cfg.cb;
+            void *const user_ctx = p->cfg.user_ctx;
+            xSemaphoreGive(s_reg_lock);
+            if (live) {
+                cb(ops[k].dev, ops[k].result, pending[k].read, ops[k].read_len, done, user_ctx);
+            }
+        }
+        xSemaphoreGive(s_dispatch_lock);
+    }
+    xSemaphoreGive(s_task_exited);
+    vTaskDelete(NULL);
+}
+
+esp_err_t bsp_ext_i2c_poll_add(const bsp_ext_i2c_poll_config_t *config, bsp_ext_i2c_poll_handle_t *ret_poll)
+{
+    BSP_NULL_CHECK(config, ESP_ERR_INVALID_ARG);
+    if (config->cb == NULL || config->period_ms == 0
+            || config->write_len > BSP_EXT_I2C_POLL_MAX_WRITE
+            || config->read_len == 0 || config->read_len > BSP_EXT_I2C_POLL_MAX_READ) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    BSP_ERROR_CHECK_RETURN_ERR(bsp_ext_i2c_init());
+
+    xSemaphoreTake(s_reg_lock, portMAX_DELAY);
+    if (!ext_i2c_dev_valid(config->dev)) {
+        xSemaphoreGive(s_reg_lock);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task == NULL
+            && xTaskCreate(ext_i2c_poll_task, "bsp_ext_i2c", EXT_I2C_TASK_STACK, NULL,
+                           CONFIG_BSP_EXT_I2C_TASK_PRIORITY, &s_task) != pdPASS) {
+        s_task = NULL;
+        xSemaphoreGive(s_reg_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    struct bsp_ext_i2c_poll_s *poll = NULL;
+    for (size_t i = 0; i < CONFIG_BSP_EXT_I2C_MAX_POLLS; i++) {
+        if (!s_polls[i].in_use) {
+            poll = &s_polls[i];
+            break;
+        }
+    }
+    if (poll == NULL) {
+        xSemaphoreGive(s_reg_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    poll->cfg = *config;
+    poll->due_us = esp_timer_get_time();
+    poll->in_use = true;
+    xSemaphoreGive(s_reg_lock);
+
+    xTaskNotifyGive(s_task);
+    if (ret_poll != NULL) {
+        *ret_poll = poll;
+    }
+    return ESP_OK;
+}
+
+esp_err_t bsp_ext_i2c_poll_remove(bsp_ext_i2c_poll_handle_t poll)
+{
+    if (s_reg_lock == NULL || poll < &s_polls[0] || poll >= &s_polls[CONFIG_BSP_EXT_I2C_MAX_POLLS]) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(s_reg_lock, portMAX_DELAY);
+    if (!poll->in_use) {
+        xSemaphoreGive(s_reg_lock);
+        return ESP_ERR_INVALID_ARG;
+    }
+    poll->in_use = false;
+    poll->gen++;
+    xSemaphoreGive(s_reg_lock);
+
+    /* Wait out a callback in progress, unless called from one */
+    if (xTaskGetCurrentTaskHandle() != s_task) {
+        xSemaphoreTake(s_dispatch_lock, portMAX_DELAY);
+        xSemaphoreGive(s_dispatch_lock);
+    }
+    return ESP_OK;
+}
+
+esp_err_t bsp_ext_i2c_get_stats(bsp_ext_i2c_stats_t *stats, bsp_ext_i2c_dev_stats_t *devs, size_t max_devs,
+                                size_t *ret_count)
+{
+    BSP_NULL_CHECK(stats, ESP_ERR_INVALID_ARG);
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    size_t count = 0;
+
+    /* Not a session: taken directly so reading the statistics does not change them */
+    xSemaphoreTakeRecursive(s_bus_lock, portMAX_DELAY);
+    const int64_t elapsed_us = esp_timer_get_time() - s_stats_since;
+    const uint64_t elapsed = elapsed_us > 0 ? (uint64_t)elapsed_us : 1;
+    *stats = (bsp_ext_i2c_stats_t) {
+        .sessions = s_sessions,
+        .batches = s_batches,
+        .transfers = s_transfers,
+        .errors = s_errors,
+        .busy_us_per_s = (uint32_t)(s_busy_us * 1000000ULL / elapsed),
+        .session_max_us = s_session_max_us,
+        .wait_max_us = s_wait_max_us,
+        .polls_late = s_polls_late,
+    };
+    for (size_t i = 0; i < CONFIG_BSP_EXT_I2C_MAX_DEVICES && devs != NULL && count < max_devs; i++) {
+        const struct bsp_ext_i2c_dev_s *dev = &s_devs[i];
+        if (!dev->in_use) {
+            continue;
+        }
+        bsp_ext_i2c_dev_stats_t *d = &devs[count++];
+        memcpy(d->name, dev->name, sizeof(d->name));
+        d->addr = dev->addr;
+        d->scl_speed_hz = dev->scl_speed_hz;
+        d->transfers = dev->transfers;
+        d->errors = dev->errors;
+        d->bytes = dev->bytes;
+        d->busy_us_per_s = (uint32_t)(dev->busy_us * 1000000ULL / elapsed);
+    }
+    xSemaphoreGiveRecursive(s_bus_lock);
+
+    if (ret_count != NULL) {
+        *ret_count = count;
+    }
+    return ESP_OK;
+}
+
+void bsp_ext_i2c_reset_stats(void)
+{
+    if (!s_initialized) {
+        return;
+    }
+    xSemaphoreTakeRecursive(s_bus_lock, portMAX_DELAY);
+    for (size_t i = 0; i < CONFIG_BSP_EXT_I2C_MAX_DEVICES; i++) {
+        s_devs[i].transfers = 0;
+        s_devs[i].errors = 0;
+        s_devs[i].bytes = 0;
+        s_devs[i].busy_us = 0;
+    }
+    s_sessions = 0;
+    s_batches = 0;
+    s_transfers = 0;
+    s_errors = 0;
+    s_busy_us = 0;
+    s_session_max_us = 0;
+    s_wait_max_us = 0;
+    s_polls_late = 0;
+    s_stats_since = esp_timer_get_time();
+    xSemaphoreGiveRecursive(s_bus_lock);
+}
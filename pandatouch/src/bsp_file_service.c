@@ -0,0 +1,487 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * File service core: prioritized request queue and stepwise execution.
+ *
+ * Each priority has a FIFO list of slots. A request taken by bsp_fs_queue_next() is out of the lists
+ * while it runs; if it needs another step, bsp_fs_queue_finish() puts it back at the head of its list,
+ * so it goes on as soon as nothing of higher priority waits. A cancelled request moves to the head of
+ * the interactive list: its completion only closes what it opened, and callers waiting for it, such as
+ * the unplug handler, should not wait behind a copy.
+ *
+ * The file table lives under the queue lock. A step only reads the entry of its own file, and the
+ * entry is only closed by cancellation when no step uses it; bsp_fs_queue_finish() closes it otherwise.
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/file_service_test.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "bsp/file_service.h"
+
+#define SLOT_NONE   (UINT16_MAX)
+
+enum {
+    SLOT_FREE,
+    SLOT_QUEUED,
+    SLOT_RUNNING,
+};
+
+/* prefix matches itself and what lies below it, on a path component boundary */
+static bool path_under(const char *path, const char *prefix)
+{
+    size_t n = strlen(prefix);
+    while (n > 1 && prefix[n - 1] == '/') {
+        n--;
+    }
+    if (n == 1 && prefix[0] == '/') {
+        return path[0] == '/';
+    }
+    return n > 0 && strncmp(path, prefix, n) == 0 && (path[n] == '\0' || path[n] == '/');
+}
+
+/* A handle holds the generation of its entry above the index, so a reused entry ignores old handles */
+static bsp_fs_file_t *file_get(const bsp_fs_queue_t *q, int32_t file)
+{
+    if (file < 0 || (file & 0xFF) >= q->file_count) {
+        return NULL;
+    }
+    bsp_fs_file_t *f = &q->files[file & 0xFF];
+    return (f->used && f->gen == (uint16_t)(file >> 8)) ? f : NULL;
+}
+
+static bool op_has_file(bsp_fs_op_t op)
+{
+    return op == BSP_FS_OP_CLOSE || op == BSP_FS_OP_READ || op == BSP_FS_OP_WRITE;
+}
+
+static void list_push(bsp_fs_queue_t *q, uint16_t i, bool front)
+{
+    bsp_fs_slot_t *s = &q->slots[i];
+    const uint8_t p = s->req.prio;
+    if (front) {
+        s->next = q->head[p];
+        q->head[p] = i;
+        if (q->tail[p] == SLOT_NONE) {
+            q->tail[p] = i;
+        }
+        return;
+    }
+    s->next = SLOT_NONE;
+    if (q->tail[p] == SLOT_NONE) {
+        q->head[p] = i;
+    } else {
+        q->slots[q->tail[p]].next = i;
+    }
+    q->tail[p] = i;
+}
+
+static void list_unlink(bsp_fs_queue_t *q, uint16_t i)
+{
+    const uint8_t p = q->slots[i].req.prio;
+    uint16_t prev = SLOT_NONE;
+    for (uint16_t j = q->head[p]; j != SLOT_NONE; prev = j, j = q->slots[j].next) {
+        if (j != i) {
+            continue;
+        }
+        if (prev == SLOT_NONE) {
+            q->head[p] = q->slots[j].next;
+        } else {
+            q->slots[prev].next = q->slots[j].next;
+        }
+        if (q->tail[p] == j) {
+            q->tail[p] = prev;
+        }
+        return;
+    }
+}
+
+static void slot_cancel(bsp_fs_queue_t *q, bsp_fs_slot_t *s)
+{
+    const uint16_t i = (uint16_t)(s - q->slots);
+    const bool queued = (s->state == SLOT_QUEUED);
+    if (queued) {
+        list_unlink(q, i);
+    }
+    s->cancel = true;
+    s->req.prio = BSP_FS_PRIO_INTERACTIVE;
+    if (queued) {
+        list_push(q, i, true);
+    }
+}
+
+bool bsp_fs_queue_init(bsp_fs_queue_t *queue, bsp_fs_slot_t *slots, uint16_t slot_count, bsp_fs_file_t *files,
+                       uint16_t file_count, size_t slice)
+{
+    if (!queue || !slots || !files || slot_count == 0 || slot_count == SLOT_NONE || file_count == 0 ||
+            file_count > 0xFF) {
+        return false;
+    }
+    memset(queue, 0, sizeof(*queue));
+    memset(slots, 0, slot_count * sizeof(bsp_fs_slot_t));
+    memset(files, 0, file_count * sizeof(bsp_fs_file_t));
+    for (uint16_t i = 0; i < file_count; i++) {
+        files[i].fd = -1;
+    }
+    for (int p = 0; p < BSP_FS_PRIO_COUNT; p++) {
+        queue->head[p] = SLOT_NONE;
+        queue->tail[p] = SLOT_NONE;
+    }
+    queue->slots = slots;
+    queue->slot_count = slot_count;
+    queue->files = files;
+    queue->file_count = file_count;
+    queue->slice = slice;
+    return true;
+}
+
+int bsp_fs_queue_submit(bsp_fs_queue_t *queue, const bsp_fs_request_t *req, int64_t now_us, uint32_t *ret_id)
+{
+    if (!queue || !req || (unsigned)req->prio >= BSP_FS_PRIO_COUNT) {
+        return EINVAL;
+    }
+
+    const char *path;
+    switch (req->op) {
+    case BSP_FS_OP_LIST:
+        if (!req->on_entry) {
+            return EINVAL;
+        }
+    /* fall through */
+    case BSP_FS_OP_OPEN:
+    case BSP_FS_OP_STAT:
+    case BSP_FS_OP_MKDIR:
+        if (!req->path || strlen(req->path) >= BSP_FS_PATH_MAX) {
+            return EINVAL;
+        }
+        path = req->path;
+        break;
+    case BSP_FS_OP_READ:
+    case BSP_FS_OP_WRITE:
+        if (req->len && !(req->op == BSP_FS_OP_READ ? req->buf : req->data)) {
+            return EINVAL;
+        }
+    /* fall through */
+    case BSP_FS_OP_CLOSE: {
+        /* The path of the file, for cancellation by path; an unknown file fails with EBADF */
+        const bsp_fs_file_t *f = file_get(queue, req->file);
+        path = f ? f->path : "";
+        break;
+    }
+    default:
+        return EINVAL;
+    }
+
+    uint16_t i = 0;
+    while (i < queue->slot_count && queue->slots[i].state != SLOT_FREE) {
+        i++;
+    }
+    if (i == queue->slot_count) {
+        queue->stats.rejected++;
+        return EAGAIN;
+    }
+
+    bsp_fs_slot_t *s = &queue->slots[i];
+    memset(s, 0, sizeof(*s));
+    s->req = *req;
+    strcpy(s->path, path);
+    s->req.path = s->path;
+    if (++queue->next_id == 0) {
+        queue->next_id = 1;
+    }
+    s->id = queue->next_id;
+    s->fd = -1;
+    s->submit_us = now_us;
+    s->result.id = s->id;
+    s->result.op = req->op;
+    s->result.file = op_has_file(req->op) ? req->file : BSP_FS_FILE_NONE;
+    s->state = SLOT_QUEUED;
+    list_push(queue, i, false);
+
+    queue->stats.submitted++;
+    queue->stats.queued++;
+    if (queue->stats.queued > queue->stats.queued_max) {
+        queue->stats.queued_max = queue->stats.queued;
+    }
+    if (ret_id) {
+        *ret_id = s->id;
+    }
+    return 0;
+}
+
+bsp_fs_slot_t *bsp_fs_queue_next(bsp_fs_queue_t *queue, int64_t now_us)
+{
+    for (int p = 0; p < BSP_FS_PRIO_COUNT; p++) {
+        const uint16_t i = queue->head[p];
+        if (i == SLOT_NONE) {
+            continue;
+        }
+        bsp_fs_slot_t *s = &queue->slots[i];
+        queue->head[p] = s->next;
+        if (queue->head[p] == SLOT_NONE) {
+            queue->tail[p] = SLOT_NONE;
+        }
+        if (s->steps == 0 && !s->cancel && now_us - s->submit_us > queue->stats.wait_max_us[p]) {
+            queue->stats.wait_max_us[p] = now_us - s->submit_us;
+        }
+        s->state = SLOT_RUNNING;
+        queue->running = s;
+        return s;
+    }
+    return NULL;
+}
+
+/* One read() or write() of at most a slice; the first step seeks */
+static bool step_transfer(bsp_fs_queue_t *q, bsp_fs_slot_t *s, bsp_fs_file_t *f)
+{
+    bsp_fs_result_t *r = &s->result;
+    if (s->steps == 1 && s->req.offset >= 0 && lseek(f->fd, (off_t)s->req.offset, SEEK_SET) < 0) {
+        r->err = errno;
+        return true;
+    }
+    if (r->len == s->req.len) {
+        return true;
+    }
+
+    size_t n = s->req.len - r->len;
+    if (q->slice && n > q->slice) {
+        n = q->slice;
+    }
+    const ssize_t ret = (s->req.op == BSP_FS_OP_READ) ? read(f->fd, (uint8_t *)s->req.buf + r->len, n)
+                        : write(f->fd, (const uint8_t *)s->req.data + r->len, n);
+    if (ret < 0) {
+        r->err = errno;
+        return true;
+    }
+    if (ret == 0) {
+        /* End of the file; a write that makes no progress has run out of space */
+        r->err = (s->req.op == BSP_FS_OP_WRITE) ? ENOSPC : 0;
+        return true;
+    }
+    r->len += ret;
+    return r->len == s->req.len;
+}
+
+/* Up to BSP_FS_LIST_BATCH entries */
+static bool step_list(bsp_fs_slot_t *s)
+{
+    bsp_fs_result_t *r = &s->result;
+    if (!s->dir) {
+        s->dir = opendir(s->path);
+        if (!s->dir) {
+            r->err = errno;
+            return true;
+        }
+    }
+    for (int listed = 0; listed < BSP_FS_LIST_BATCH;) {
+        errno = 0;
+        const struct dirent *ent = readdir(s->dir);
+        if (!ent) {
+            r->err = errno;
+            return true;
+        }
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            continue;
+        }
+        listed++;
+        r->len++;
+        if (!s->req.on_entry(ent->d_name, ent->d_type == DT_DIR, s->req.user_ctx)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool step_run(bsp_fs_queue_t *q, bsp_fs_slot_t *s)
+{
+    bsp_fs_result_t *r = &s->result;
+    bsp_fs_file_t *f = op_has_file(s->req.op) ? file_get(q, s->req.file) : NULL;
+    if (op_has_file(s->req.op) && !f) {
+        r->err = EBADF;
+        return true;
+    }
+
+    switch (s->req.op) {
+    case BSP_FS_OP_OPEN:
+        s->fd = open(s->path, s->req.flags, 0666);
+        if (s->fd < 0) {
+            r->err = errno;
+        }
+        return true;
+    case BSP_FS_OP_CLOSE:
+        /* The entry itself is freed by bsp_fs_queue_finish() */
+        if (f->fd >= 0 && close(f->fd) != 0) {
+            r->err = errno;
+        }
+        f->fd = -1;
+        return true;
+    case BSP_FS_OP_READ:
+    case BSP_FS_OP_WRITE:
+        if (f->stale) {
+            r->err = ECANCELED;
+            return true;
+        }
+        return step_transfer(q, s, f);
+    case BSP_FS_OP_STAT: {
+        struct stat st;
+        if (stat(s->path, &st) != 0) {
+            r->err = errno;
+        } else {
+            r->size = (uint64_t)st.st_size;
+            r->mtime = (int64_t)st.st_mtime;
+            r->is_dir = S_ISDIR(st.st_mode);
+        }
+        return true;
+    }
+    case BSP_FS_OP_LIST:
+        return step_list(s);
+    case BSP_FS_OP_MKDIR:
+        if (mkdir(s->path, 0777) != 0) {
+            r->err = errno;
+        }
+        return true;
+    default:
+        r->err = EINVAL;
+        return true;
+    }
+}
+
+void bsp_fs_queue_step(bsp_fs_queue_t *queue, bsp_fs_slot_t *slot)
+{
+    slot->steps++;
+    bool done;
+    if (slot->cancel) {
+        slot->result.err = ECANCELED;
+        done = true;
+    } else {
+        done = step_run(queue, slot);
+    }
+    if (done && slot->dir) {
+        closedir(slot->dir);
+        slot->dir = NULL;
+    }
+    slot->done = done;
+}
+
+bool bsp_fs_queue_finish(bsp_fs_queue_t *queue, bsp_fs_slot_t *slot, bsp_fs_completion_t *out)
+{
+    queue->running = NULL;
+    bsp_fs_file_t *f = op_has_file(slot->req.op) ? file_get(queue, slot->req.file) : NULL;
+    if (f && f->stale && f->fd >= 0) {
+        /* Invalidated while this step used it */
+        close(f->fd);
+        f->fd = -1;
+    }
+    if (!slot->done) {
+        slot->state = SLOT_QUEUED;
+        list_push(queue, (uint16_t)(slot - queue->slots), true);
+        return false;
+    }
+
+    bsp_fs_result_t *r = &slot->result;
+    if (slot->req.op == BSP_FS_OP_OPEN && slot->fd >= 0) {
+        uint16_t i = 0;
+        while (i < queue->file_count && queue->files[i].used) {
+            i++;
+        }
+        if (slot->cancel || i == queue->file_count) {
+            close(slot->fd);
+            r->err = slot->cancel ? ECANCELED : EMFILE;
+        } else {
+            f = &queue->files[i];
+            if (++f->gen == 0) {
+                f->gen = 1;
+            }
+            f->used = true;
+            f->stale = false;
+            f->fd = slot->fd;
+            strcpy(f->path, slot->path);
+            r->file = (int32_t)f->gen << 8 | i;
+        }
+    } else if (slot->req.op == BSP_FS_OP_CLOSE && f) {
+        f->used = false;
+    }
+
+    if (slot->req.op == BSP_FS_OP_READ) {
+        queue->stats.bytes_read += r->len;
+    } else if (slot->req.op == BSP_FS_OP_WRITE) {
+        queue->stats.bytes_written += r->len;
+    }
+    queue->stats.completed++;
+    if (r->err == ECANCELED) {
+        queue->stats.cancelled++;
+    } else if (r->err) {
+        queue->stats.failed++;
+    }
+    queue->stats.queued--;
+
+    out->on_done = slot->req.on_done;
+    out->user_ctx = slot->req.user_ctx;
+    out->result = *r;
+    slot->id = 0;
+    slot->state = SLOT_FREE;
+    return true;
+}
+
+bool bsp_fs_queue_cancel(bsp_fs_queue_t *queue, uint32_t id)
+{
+    for (uint16_t i = 0; id && i < queue->slot_count; i++) {
+        bsp_fs_slot_t *s = &queue->slots[i];
+        if (s->state != SLOT_FREE && s->id == id) {
+            slot_cancel(queue, s);
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t bsp_fs_queue_cancel_path(bsp_fs_queue_t *queue, const char *prefix)
+{
+    uint32_t cancelled = 0;
+    for (uint16_t i = 0; i < queue->slot_count; i++) {
+        bsp_fs_slot_t *s = &queue->slots[i];
+        if (s->state != SLOT_FREE && !s->cancel && path_under(s->path, prefix)) {
+            slot_cancel(queue, s);
+            cancelled++;
+        }
+    }
+
+    const bsp_fs_slot_t *run = queue->running;
+    const bsp_fs_file_t *in_use = (run && op_has_file(run->req.op)) ? file_get(queue, run->req.file) : NULL;
+    for (uint16_t i = 0; i < queue->file_count; i++) {
+        bsp_fs_file_t *f = &queue->files[i];
+        if (!f->used || f->stale || !path_under(f->path, prefix)) {
+            continue;
+        }
+        f->stale = true;
+        if (f != in_use && f->fd >= 0) {
+            close(f->fd);
+            f->fd = -1;
+        }
+    }
+    return cancelled;
+}
+
+bool bsp_fs_queue_busy(const bsp_fs_queue_t *queue, const char *prefix)
+{
+    for (uint16_t i = 0; i < queue->slot_count; i++) {
+        const bsp_fs_slot_t *s = &queue->slots[i];
+        if (s->state != SLOT_FREE && path_under(s->path, prefix)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void bsp_fs_queue_get_stats(const bsp_fs_queue_t *queue, bsp_fs_stats_t *stats)
+{
+    *stats = queue->stats;
+}
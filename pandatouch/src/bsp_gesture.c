@@ -0,0 +1,295 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Multi-touch gesture recognizer — core.
+ *
+ * Integer math only (no FPU state to save in the touch task) and no ESP-IDF
+ * includes, so traces can be replayed on the host. The LVGL glue lives in
+ * bsp_touch.c.
+ *
+ * Two-finger gestures follow the first two points reported after the second
+ * finger lands, by track ID. Distance, angle and centre are compared with
+ * their values at that moment; whichever crosses its threshold first (relative
+ * to the threshold) decides the gesture, which then keeps its type until one
+ * of the two fingers is lifted.
+ */
+#include <stddef.h>
+#include <string.h>
+#include "bsp/gesture.h"
+
+#define GESTURE_DEF_LONG_PRESS_MS   (600)
+#define GESTURE_DEF_SLOP_PX         (12)
+#define GESTURE_DEF_PINCH_PX        (24)
+#define GESTURE_DEF_ROTATE_DDEG     (150)
+#define GESTURE_DEF_SCROLL_PX       (16)
+
+static inline int32_t iabs(int32_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+static uint32_t isqrt(uint32_t v)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/* atan(z) for z in [0, 1] as Q15, in 0.1 degrees; error below 0.1 degree */
+static int32_t atan_unit_ddeg(int32_t z)
+{
+    /* atan(z) ~ 45 z + z (1 - z) (14.02 + 3.80 z) degrees */
+    const int64_t poly = (int64_t)1402 * 32768 + (int64_t)380 * z;             /* Q15, 0.01 degree */
+    const int64_t quad = ((int64_t)z * (32768 - z)) >> 15;                      /* Q15 */
+    const int64_t ddeg = (int64_t)450 * z + ((quad * poly) >> 15) / 10;        /* Q15, 0.1 degree */
+    return (int32_t)((ddeg + 16384) >> 15);
+}
+
+/* Angle of (x, y) in 0.1 degrees, in [-1800, 1800]; y grows downwards, so positive is clockwise */
+static int16_t iatan2_ddeg(int32_t y, int32_t x)
+{
+    const int32_t ax = iabs(x);
+    const int32_t ay = iabs(y);
+    if (!ax && !ay) {
+        return 0;
+    }
+    int32_t a = (ax >= ay) ? atan_unit_ddeg((ay << 15) / ax) : 900 - atan_unit_ddeg((ax << 15) / ay);
+    if (x < 0) {
+        a = 1800 - a;
+    }
+    return (int16_t)(y < 0 ? -a : a);
+}
+
+/* Difference of two angles, wrapped to [-1800, 1800) */
+static int16_t angle_diff(int32_t a, int32_t b)
+{
+    int32_t d = a - b;
+    if (d >= 1800) {
+        d -= 3600;
+    } else if (d < -1800) {
+        d += 3600;
+    }
+    return (int16_t)d;
+}
+
+static void gesture_emit(bsp_gesture_t *g, bsp_gesture_phase_t phase, uint32_t time_ms)
+{
+    g->last.type = g->active;
+    g->last.phase = phase;
+    g->last.time_ms = time_ms;
+    if (g->cb) {
+        g->cb(&g->last, g->user_ctx);
+    }
+    if (phase == BSP_GESTURE_END) {
+        g->active = BSP_GESTURE_NONE;
+    }
+}
+
+static void gesture_end(bsp_gesture_t *g, uint32_t time_ms)
+{
+    if (g->active != BSP_GESTURE_NONE) {
+        g->last.dx = 0;
+        g->last.dy = 0;
+        gesture_emit(g, BSP_GESTURE_END, time_ms);
+    }
+}
+
+static const bsp_gesture_point_t *gesture_find(const bsp_gesture_point_t *points, uint8_t count, uint8_t id)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (points[i].id == id) {
+            return &points[i];
+        }
+    }
+    return NULL;
+}
+
+static void gesture_one_finger(bsp_gesture_t *g, const bsp_gesture_point_t *p, uint32_t time_ms)
+{
+    if (g->active != BSP_GESTURE_NONE && g->active != BSP_GESTURE_LONG_PRESS) {
+        /* Back from two fingers: no long press until every finger is lifted */
+        gesture_end(g, time_ms);
+        g->blocked = true;
+    }
+
+    if (g->fingers == 0) {
+        g->down_ms = time_ms;
+        g->down_x = p->x;
+        g->down_y = p->y;
+    }
+
+    if (g->active == BSP_GESTURE_LONG_PRESS) {
+        /* Keep reporting the finger, e.g. to drag what was long-pressed */
+        if (p->x != g->last.x || p->y != g->last.y) {
+            g->last.x = p->x;
+            g->last.y = p->y;
+            gesture_emit(g, BSP_GESTURE_UPDATE, time_ms);
+        }
+    } else if (!g->blocked) {
+        if (iabs(p->x - g->down_x) > g->cfg.slop_px || iabs(p->y - g->down_y) > g->cfg.slop_px) {
+            g->blocked = true;      /* a drag, not a long press */
+        } else if (time_ms - g->down_ms >= g->cfg.long_press_ms) {
+            memset(&g->last, 0, sizeof(g->last));
+            g->last.x = p->x;
+            g->last.y = p->y;
+            g->active = BSP_GESTURE_LONG_PRESS;
+            gesture_emit(g, BSP_GESTURE_BEGIN, time_ms);
+        }
+    }
+}
+
+static void gesture_two_fingers(bsp_gesture_t *g, const bsp_gesture_point_t *points, uint8_t count,
+                                uint32_t time_ms)
+{
+    const bsp_gesture_point_t *a = NULL;
+    const bsp_gesture_point_t *b = NULL;
+    if (g->fingers >= 2) {
+        a = gesture_find(points, count, g->id[0]);
+        b = gesture_find(points, count, g->id[1]);
+    }
+
+    const bool start = !a || !b;
+    if (start) {
+        /* Second finger landed, or one of the tracked ones was lifted: follow the first two points */
+        gesture_end(g, time_ms);
+        g->blocked = true;
+        a = &points[0];
+        b = &points[1];
+        g->id[0] = a->id;
+        g->id[1] = b->id;
+    }
+
+    const int32_t vx = b->x - a->x;
+    const int32_t vy = b->y - a->y;
+    const int32_t dist = (int32_t)isqrt((uint32_t)(vx * vx + vy * vy));
+    const int16_t angle = iatan2_ddeg(vy, vx);
+    const int16_t cx = (int16_t)((a->x + b->x) / 2);
+    const int16_t cy = (int16_t)((a->y + b->y) / 2);
+
+    if (start) {
+        g->dist0 = dist;
+        g->angle0 = angle;
+        g->cx0 = cx;
+        g->cy0 = cy;
+        return;
+    }
+
+    const int32_t d_dist = dist - g->dist0;
+    const int16_t d_angle = angle_diff(angle, g->angle0);
+    const int32_t tx = cx - g->cx0;
+    const int32_t ty = cy - g->cy0;
+
+    bsp_gesture_event_t ev = {
+        .x          = cx,
+        .y          = cy,
+        .scale_q16  = (int32_t)(((int64_t)dist << 16) / (g->dist0 ? g->dist0 : 1)),
+        .angle_ddeg = d_angle,
+        .total_dx   = (int16_t)tx,
+        .total_dy   = (int16_t)ty,
+    };
+
+    if (g->active == BSP_GESTURE_NONE) {
+        /* Largest movement relative to its threshold, in 1/256 of the threshold */
+        const uint32_t pinch = ((uint32_t)iabs(d_dist) << 8) / g->cfg.pinch_px;
+        const uint32_t rotate = ((uint32_t)iabs(d_angle) << 8) / g->cfg.rotate_ddeg;
+        const uint32_t scroll = (isqrt((uint32_t)(tx * tx + ty * ty)) << 8) / g->cfg.scroll_px;
+
+        bsp_gesture_type_t type = BSP_GESTURE_PINCH;
+        uint32_t best = pinch;
+        if (rotate > best) {
+            type = BSP_GESTURE_ROTATE;
+            best = rotate;
+        }
+        if (scroll > best) {
+            type = BSP_GESTURE_SCROLL;
+            best = scroll;
+        }
+        if (best < 256) {
+            return;
+        }
+
+        ev.dx = ev.total_dx;
+        ev.dy = ev.total_dy;
+        g->last = ev;
+        g->active = type;
+        gesture_emit(g, BSP_GESTURE_BEGIN, time_ms);
+        return;
+    }
+
+    if (ev.x == g->last.x && ev.y == g->last.y && ev.scale_q16 == g->last.scale_q16 &&
+            ev.angle_ddeg == g->last.angle_ddeg) {
+        return;
+    }
+    ev.dx = ev.total_dx - g->last.total_dx;
+    ev.dy = ev.total_dy - g->last.total_dy;
+    g->last = ev;
+    gesture_emit(g, BSP_GESTURE_UPDATE, time_ms);
+}
+
+void bsp_gesture_init(bsp_gesture_t *g, const bsp_gesture_cfg_t *cfg, bsp_gesture_cb_t cb, void *user_ctx)
+{
+    memset(g, 0, sizeof(*g));
+    if (cfg) {
+        g->cfg = *cfg;
+    }
+    if (!g->cfg.long_press_ms) {
+        g->cfg.long_press_ms = GESTURE_DEF_LONG_PRESS_MS;
+    }
+    if (!g->cfg.slop_px) {
+        g->cfg.slop_px = GESTURE_DEF_SLOP_PX;
+    }
+    if (!g->cfg.pinch_px) {
+        g->cfg.pinch_px = GESTURE_DEF_PINCH_PX;
+    }
+    if (!g->cfg.rotate_ddeg) {
+        g->cfg.rotate_ddeg = GESTURE_DEF_ROTATE_DDEG;
+    }
+    if (!g->cfg.scroll_px) {
+        g->cfg.scroll_px = GESTURE_DEF_SCROLL_PX;
+    }
+    g->cb = cb;
+    g->user_ctx = user_ctx;
+}
+
+void bsp_gesture_feed(bsp_gesture_t *g, const bsp_gesture_point_t *points, uint8_t count, uint32_t time_ms)
+{
+    if (count > BSP_GESTURE_MAX_POINTS) {
+        count = BSP_GESTURE_MAX_POINTS;
+    }
+
+    if (count == 0) {
+        gesture_end(g, time_ms);
+        g->blocked = false;
+    } else if (count == 1) {
+        gesture_one_finger(g, &points[0], time_ms);
+    } else {
+        if (g->active == BSP_GESTURE_LONG_PRESS) {
+            gesture_end(g, time_ms);
+        }
+        gesture_two_fingers(g, points, count, time_ms);
+    }
+    g->fingers = count;
+}
+
+void bsp_gesture_reset(bsp_gesture_t *g, uint32_t time_ms)
+{
+    gesture_end(g, time_ms);
+    g->fingers = 0;
+    g->blocked = false;
+}
@@ -0,0 +1,404 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Pre-rasterized vector icon cache.
+ *
+ * Icons are drawn once through LVGL's normal draw pipeline into an ARGB8888
+ * scratch canvas, then converted to a compact A8 mask (single-color icons,
+ * colored at blit time through image recolor) or ARGB8565 (multicolor icons)
+ * in PSRAM. Entries sit on an LRU list; objects created with bsp_icon_create()
+ * pin their entry so it is never evicted while displayed.
+ */
+#include <string.h>
+#include <inttypes.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+
+static const char *TAG = "bsp_icon";
+
+#define ICON_WARM_UP_PERIOD_MS  (10)
+#define ICON_WARM_UP_BUDGET_US  (4000)
+
+typedef struct icon_entry {
+    struct icon_entry *prev;        /* towards most recently used */
+    struct icon_entry *next;        /* towards least recently used */
+    const bsp_icon_t  *icon;
+    int32_t            size;
+    uint32_t           color;       /* 0 for A8 entries, which are color independent */
+    uint32_t           pins;
+    lv_draw_buf_t      buf;
+    void              *data;
+    size_t             data_size;
+} icon_entry_t;
+
+static bool                   s_init       = false;
+static icon_entry_t          *s_head       = NULL;
+static icon_entry_t          *s_tail       = NULL;
+static bsp_icon_cache_stats_t s_stats;
+static lv_obj_t              *s_canvas     = NULL;
+static lv_draw_buf_t          s_scratch;
+static void                  *s_scratch_data = NULL;
+static size_t                 s_scratch_size = 0;
+static bsp_icon_req_t        *s_warm       = NULL;
+static size_t                 s_warm_count = 0;
+static size_t                 s_warm_pos   = 0;
+static lv_timer_t            *s_warm_timer = NULL;
+
+static void icon_obj_delete_cb(lv_event_t *e);
+
+/* ── LRU list ─────────────────────────────────────────────────────────── */
+
+static void lru_unlink(icon_entry_t *e)
+{
+    if (e->prev) {
+        e->prev->next = e->next;
+    } else {
+        s_head = e->next;
+    }
+    if (e->next) {
+        e->next->prev = e->prev;
+    } else {
+        s_tail = e->prev;
+    }
+    e->prev = e->next = NULL;
+}
+
+static void lru_push_front(icon_entry_t *e)
+{
+    e->prev = NULL;
+    e->next = s_head;
+    if (s_head) {
+        s_head->prev = e;
+    }
+    s_head = e;
+    if (!s_tail) {
+        s_tail = e;
+    }
+}
+
+static size_t entry_cost(const icon_entry_t *e)
+{
+    return e->data_size + sizeof(*e);
+}
+
+static void entry_free(icon_entry_t *e)
+{
+    lru_unlink(e);
+    s_stats.bytes_used -= entry_cost(e);
+    s_stats.entries--;
+    lv_image_cache_drop(&e->buf);
+    heap_caps_free(e->data);
+    lv_free(e);
+}
+
+/* Evicts unpinned entries, least recently used first, until need more bytes fit under the cap */
+static bool evict_for(size_t need)
+{
+    icon_entry_t *e = s_tail;
+    while (e && s_stats.bytes_used + need > s_stats.bytes_cap) {
+        icon_entry_t *prev = e->prev;
+        if (!e->pins) {
+            entry_free(e);
+            s_stats.evictions++;
+        }
+        e = prev;
+    }
+    return s_stats.bytes_used + need <= s_stats.bytes_cap;
+}
+
+/* ── Rasterization ────────────────────────────────────────────────────── */
+
+static void icon_draw_src(lv_layer_t *layer, int32_t size, lv_color_t color, const bsp_icon_t *icon)
+{
+    lv_image_header_t header;
+    if (!icon->src || lv_image_decoder_get_info(icon->src, &header) != LV_RESULT_OK || !header.w || !header.h) {
+        return;
+    }
+
+    lv_draw_image_dsc_t dsc;
+    lv_draw_image_dsc_init(&dsc);
+    dsc.src     = icon->src;
+    dsc.scale_x = size * LV_SCALE_NONE / LV_MAX(header.w, header.h);
+    dsc.scale_y = dsc.scale_x;
+    dsc.pivot.x = 0;
+    dsc.pivot.y = 0;
+
+    const lv_area_t area = { 0, 0, header.w - 1, header.h - 1 };
+    lv_draw_image(layer, &dsc, &area);
+}
+
+static bool scratch_prepare(int32_t size)
+{
+    const uint32_t stride = lv_draw_buf_width_to_stride(size, LV_COLOR_FORMAT_ARGB8888);
+    const size_t need = (size_t)stride * size;
+
+    if (need > s_scratch_size) {
+        heap_caps_free(s_scratch_data);
+        s_scratch_data = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, need, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        s_scratch_size = s_scratch_data ? need : 0;
+        if (!s_scratch_data) {
+            return false;
+        }
+    }
+    lv_draw_buf_init(&s_scratch, size, size, LV_COLOR_FORMAT_ARGB8888, stride, s_scratch_data, s_scratch_size);
+
+    if (!s_canvas) {
+        s_canvas = lv_canvas_create(lv_layer_top());
+        lv_obj_add_flag(s_canvas, LV_OBJ_FLAG_HIDDEN);
+    }
+    lv_canvas_set_draw_buf(s_canvas, &s_scratch);
+    return true;
+}
+
+static void scratch_convert(icon_entry_t *e)
+{
+    const int32_t size = e->size;
+    for (int32_t y = 0; y < size; y++) {
+        const uint8_t *src = s_scratch.data + (size_t)y * s_scratch.header.stride;
+        uint8_t *dst = e->buf.data + (size_t)y * e->buf.header.stride;
+        for (int32_t x = 0; x < size; x++, src += 4) {
+            /* ARGB8888 is stored B, G, R, A */
+            if (e->buf.header.cf == LV_COLOR_FORMAT_A8) {
+                *dst++ = src[3];
+            } else {
+                const uint16_t c = lv_color_to_u16(lv_color_make(src[2], src[1], src[0]));
+                *dst++ = c & 0xff;
+                *dst++ = c >> 8;
+                *dst++ = src[3];
+            }
+        }
+    }
+}
+
+static icon_entry_t *icon_rasterize(const bsp_icon_t *icon, int32_t size, lv_color_t color, uint32_t color_key)
+{
+    const lv_color_format_t cf = icon->multicolor ? LV_COLOR_FORMAT_ARGB8565 : LV_COLOR_FORMAT_A8;
+    const uint32_t stride = lv_draw_buf_width_to_stride(size, cf);
+    const size_t data_size = (size_t)stride * size;
+
+    if (!evict_for(data_size + sizeof(icon_entry_t))) {
+        ESP_LOGW(TAG, "%" PRId32 " px icon does not fit in the %u byte cap", size, (unsigned)s_stats.bytes_cap);
+        return NULL;
+    }
+
+    icon_entry_t *e = lv_malloc_zeroed(sizeof(icon_entry_t));
+    BSP_NULL_CHECK(e, NULL);
+    e->data = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, data_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!e->data || !scratch_prepare(size)) {
+        ESP_LOGE(TAG, "No memory for %" PRId32 " px icon", size);
+        heap_caps_free(e->data);
+        lv_free(e);
+        return NULL;
+    }
+
+    const int64_t start = esp_timer_get_time();
+
+    lv_canvas_fill_bg(s_canvas, lv_color_black(), LV_OPA_TRANSP);
+    lv_layer_t layer;
+    lv_canvas_init_layer(s_canvas, &layer);
+    if (icon->draw) {
+        icon->draw(&layer, size, color, icon->user_data);
+    } else {
+        icon_draw_src(&layer, size, color, icon);
+    }
+    lv_canvas_finish_layer(s_canvas, &layer);
+
+    e->icon      = icon;
+    e->size      = size;
+    e->color     = color_key;
+    e->data_size = data_size;
+    lv_draw_buf_init(&e->buf, size, size, cf, stride, e->data, data_size);
+    scratch_convert(e);
+
+    s_stats.raster_us += (uint32_t)(esp_timer_get_time() - start);
+    s_stats.bytes_used += entry_cost(e);
+    s_stats.entries++;
+    lru_push_front(e);
+    return e;
+}
+
+static icon_entry_t *icon_lookup(const bsp_icon_t *icon, int32_t size, lv_color_t color)
+{
+    if (!s_init || !icon || size <= 0) {
+        s_stats.failures++;
+        return NULL;
+    }
+
+    const uint32_t color_key = icon->multicolor ? lv_color_to_u32(color) : 0;
+    for (icon_entry_t *e = s_head; e; e = e->next) {
+        if (e->icon == icon && e->size == size && e->color == color_key) {
+            s_stats.hits++;
+            lru_unlink(e);
+            lru_push_front(e);
+            return e;
+        }
+    }
+
+    s_stats.misses++;
+    icon_entry_t *e = icon_rasterize(icon, size, color, color_key);
+    if (!e) {
+        s_stats.failures++;
+    }
+    return e;
+}
+
+/* ── Image objects ────────────────────────────────────────────────────── */
+
+static icon_entry_t *icon_obj_entry(lv_obj_t *obj)
+{
+    const uint32_t count = lv_obj_get_event_count(obj);
+    for (uint32_t i = 0; i < count; i++) {
+        lv_event_dsc_t *dsc = lv_obj_get_event_dsc(obj, i);
+        if (lv_event_dsc_get_cb(dsc) == icon_obj_delete_cb) {
+            return lv_event_dsc_get_user_data(dsc);
+        }
+    }
+    return NULL;
+}
+
+static void icon_obj_delete_cb(lv_event_t *e)
+{
+    icon_entry_t *entry = lv_event_get_user_data(e);
+    entry->pins--;
+}
+
+static void icon_obj_bind(lv_obj_t *obj, icon_entry_t *entry, lv_color_t color)
+{
+    entry->pins++;
+    lv_obj_add_event_cb(obj, icon_obj_delete_cb, LV_EVENT_DELETE, entry);
+    lv_image_set_src(obj, &entry->buf);
+
+    /* A8 icons take their color from the recolor style; multicolor icons are shown as rasterized */
+    const bool mask = entry->buf.header.cf == LV_COLOR_FORMAT_A8;
+    lv_obj_set_style_image_recolor(obj, color, 0);
+    lv_obj_set_style_image_recolor_opa(obj, mask ? LV_OPA_COVER : LV_OPA_TRANSP, 0);
+}
+
+lv_obj_t *bsp_icon_create(lv_obj_t *parent, const bsp_icon_t *icon, int32_t size, lv_color_t color)
+{
+    icon_entry_t *entry = icon_lookup(icon, size, color);
+    if (!entry) {
+        return NULL;
+    }
+
+    lv_obj_t *obj = lv_image_create(parent);
+    icon_obj_bind(obj, entry, color);
+    return obj;
+}
+
+esp_err_t bsp_icon_set(lv_obj_t *obj, const bsp_icon_t *icon, int32_t size, lv_color_t color)
+{
+    icon_entry_t *old = obj ? icon_obj_entry(obj) : NULL;
+    if (!old) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Keep the old raster pinned while looking up the new one, it is still on screen */
+    icon_entry_t *entry = icon_lookup(icon, size, color);
+    if (!entry) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    lv_obj_remove_event_cb_with_user_data(obj, icon_obj_delete_cb, old);
+    old->pins--;
+    icon_obj_bind(obj, entry, color);
+    return ESP_OK;
+}
+
+/* ── Warm-up ──────────────────────────────────────────────────────────── */
+
+static void warm_up_timer_cb(lv_timer_t *t)
+{
+    const int64_t start = esp_timer_get_time();
+    while (s_warm_pos < s_warm_count && esp_timer_get_time() - start < ICON_WARM_UP_BUDGET_US) {
+        const bsp_icon_req_t *req = &s_warm[s_warm_pos++];
+        icon_lookup(req->icon, req->size, req->color);
+    }
+
+    if (s_warm_pos >= s_warm_count) {
+        lv_free(s_warm);
+        s_warm = NULL;
+        s_warm_count = s_warm_pos = 0;
+        lv_timer_pause(t);
+    }
+}
+
+esp_err_t bsp_icon_cache_warm_up(const bsp_icon_req_t *reqs, size_t count)
+{
+    if (!s_init) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!reqs || !count) {
+        return ESP_OK;
+    }
+
+    /* Append to whatever is still pending */
+    const size_t pending = s_warm_count - s_warm_pos;
+    bsp_icon_req_t *queue = lv_malloc((pending + count) * sizeof(bsp_icon_req_t));
+    BSP_NULL_CHECK(queue, ESP_ERR_NO_MEM);
+    if (pending) {
+        memcpy(queue, &s_warm[s_warm_pos], pending * sizeof(bsp_icon_req_t));
+    }
+    memcpy(&queue[pending], reqs, count * sizeof(bsp_icon_req_t));
+
+    lv_free(s_warm);
+    s_warm = queue;
+    s_warm_count = pending + count;
+    s_warm_pos = 0;
+
+    lv_timer_resume(s_warm_timer);
+    return ESP_OK;
+}
+
+/* ── Lifecycle ────────────────────────────────────────────────────────── */
+
+esp_err_t bsp_icon_cache_init(size_t mem_cap)
+{
+    if (!mem_cap) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_init) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_warm_timer = lv_timer_create(warm_up_timer_cb, ICON_WARM_UP_PERIOD_MS, NULL);
+    BSP_NULL_CHECK(s_warm_timer, ESP_ERR_NO_MEM);
+    lv_timer_pause(s_warm_timer);
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.bytes_cap = mem_cap;
+    s_init = true;
+    return ESP_OK;
+}
+
+void bsp_icon_cache_clear(void)
+{
+    icon_entry_t *e = s_head;
+    while (e) {
+        icon_entry_t *next = e->next;
+        if (!e->pins) {
+            entry_free(e);
+        }
+        e = next;
+    }
+}
+
+esp_err_t bsp_icon_cache_get_stats(bsp_icon_cache_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = s_stats;
+    return ESP_OK;
+}
+
+#endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Slot table of the UI update queue: see bsp_post_table.h.
+ *
+ * A producer that finds the slot being written must not drop its update as if the write in progress
+ * replaced it: that write is older, and the UI would keep its value until the next post of the key.
+ * Producers take turns on the sequence number instead; a write is a copy of at most BSP_POST_DATA_MAX
+ * bytes, so the turn comes quickly.
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/display_post_test.
+ */
+
+#include <string.h>
+#include "bsp_post_table.h"
+
+static inline uint32_t post_hash(const bsp_post_table_t *table, uintptr_t key)
+{
+    /* Widget pointers share their low bits: mix before reducing */
+    return ((uint32_t)key * 2654435761u) % table->count;
+}
+
+void bsp_post_table_init(bsp_post_table_t *table, bsp_post_slot_t *slots, uint32_t count)
+{
+    table->slots = slots;
+    table->count = count;
+    atomic_init(&table->used, 0);
+}
+
+bsp_post_slot_t *bsp_post_table_claim(bsp_post_table_t *table, uintptr_t key)
+{
+    const uint32_t start = post_hash(table, key);
+
+    while (true) {
+        bsp_post_slot_t *free_slot = NULL;
+        uintptr_t free_key = BSP_POST_KEY_FREE;
+
+        for (uint32_t n = 0; n < table->count; n++) {
+            bsp_post_slot_t *slot = &table->slots[(start + n) % table->count];
+            const uintptr_t k = atomic_load_explicit(&slot->key, memory_order_acquire);
+            if (k == key) {
+                return slot;
+            }
+            if (k == BSP_POST_KEY_GONE && !free_slot) {
+                free_slot = slot;
+                free_key = k;
+            }
+            if (k == BSP_POST_KEY_FREE) {
+                /* End of the probe chain: key is not in the table */
+                if (!free_slot) {
+                    free_slot = slot;
+                    free_key = k;
+                }
+                break;
+            }
+        }
+        if (!free_slot) {
+            return NULL;
+        }
+        if (atomic_compare_exchange_strong(&free_slot->key, &free_key, key)) {
+            atomic_fetch_add_explicit(&table->used, 1, memory_order_relaxed);
+            return free_slot;
+        }
+        /* Another producer claimed it first, possibly for this very key: scan again */
+    }
+}
+
+void bsp_post_table_forget(bsp_post_table_t *table, uintptr_t key)
+{
+    const uint32_t start = post_hash(table, key);
+    for (uint32_t n = 0; n < table->count; n++) {
+        bsp_post_slot_t *slot = &table->slots[(start + n) % table->count];
+        const uintptr_t k = atomic_load_explicit(&slot->key, memory_order_acquire);
+        if (k == BSP_POST_KEY_FREE) {
+            return;
+        }
+        if (k == key) {
+            atomic_store_explicit(&slot->pending, false, memory_order_relaxed);
+            atomic_store_explicit(&slot->key, BSP_POST_KEY_GONE, memory_order_release);
+            atomic_fetch_sub_explicit(&table->used, 1, memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+unsigned bsp_post_slot_begin(bsp_post_slot_t *slot)
+{
+    unsigned seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    while ((seq & 1) || !atomic_compare_exchange_weak_explicit(&slot->seq, &seq, seq + 1,
+                                                               memory_order_acquire, memory_order_relaxed)) {
+        seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    }
+    return seq + 1;
+}
+
+void bsp_post_slot_fill(bsp_post_slot_t *slot, bsp_post_cb_t cb, void *user_ctx, const void *data, size_t len)
+{
+    slot->cb = cb;
+    slot->user_ctx = user_ctx;
+    slot->len = (uint8_t)len;
+    if (len) {
+        memcpy(slot->data, data, len);
+    }
+}
+
+bool bsp_post_slot_end(bsp_post_slot_t *slot, unsigned seq)
+{
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_release);
+    return atomic_exchange_explicit(&slot->pending, true, memory_order_acq_rel);
+}
+
+bool bsp_post_slot_write(bsp_post_slot_t *slot, bsp_post_cb_t cb, void *user_ctx, const void *data, size_t len)
+{
+    const unsigned seq = bsp_post_slot_begin(slot);
+    bsp_post_slot_fill(slot, cb, user_ctx, data, len);
+    return bsp_post_slot_end(slot, seq);
+}
+
+bool bsp_post_slot_take(bsp_post_slot_t *slot, bsp_post_cb_t *cb, void **user_ctx, void *data)
+{
+    if (!atomic_exchange_explicit(&slot->pending, false, memory_order_acq_rel)) {
+        return false;
+    }
+
+    const unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (seq & 1) {
+        return false;   /* the writer sets pending again when it is done */
+    }
+    *cb = slot->cb;
+    *user_ctx = slot->user_ctx;
+    memcpy(data, slot->data, slot->len);
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq;   /* else overwritten, same as above */
+}
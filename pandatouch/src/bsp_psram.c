@@ -0,0 +1,260 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * PSRAM bandwidth monitor.
+ *
+ * Consumers add the bytes they move to per-consumer counters; scanout is
+ * computed once per window from the frames the panel actually scanned out.
+ * The headroom probe invalidates a PSRAM buffer from the data cache and
+ * touches one word per cache line, so every access is a line fill over the
+ * PSRAM bus competing with everything else. It runs in short chunks so it
+ * never holds the CPU long enough to delay the LCD interrupt, and keeps the
+ * faster half of the chunks to filter out preemption.
+ */
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_cache.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+static const char *TAG = "bsp_psram";
+
+#define PSRAM_MON_DEFAULT_PERIOD_MS   (1000)
+#define PSRAM_MON_DEFAULT_PROBE_SIZE  (32 * 1024)
+#define PSRAM_MON_CHUNK_SIZE          (4 * 1024)
+#define PSRAM_MON_MAX_PROBE_SIZE      (256 * 1024)
+#define PSRAM_MON_TASK_PRIO           (1)
+#define PSRAM_MON_TASK_STACK          (3072)
+
+/* Octal DDR moves 2 bytes per clock, quad SDR half a byte */
+#if CONFIG_SPIRAM_MODE_OCT
+#define PSRAM_BUS_BYTES_PER_CLK_X2    (4)
+#else
+#define PSRAM_BUS_BYTES_PER_CLK_X2    (1)
+#endif
+
+static const char *const s_consumer_names[BSP_PSRAM_CONSUMER_MAX] = {
+    [BSP_PSRAM_CONSUMER_SCANOUT] = "scanout",
+    [BSP_PSRAM_CONSUMER_RENDER]  = "render",
+    [BSP_PSRAM_CONSUMER_COPY]    = "copy",
+    [BSP_PSRAM_CONSUMER_APP]     = "app",
+};
+
+static atomic_uint              s_bytes[BSP_PSRAM_CONSUMER_MAX];
+static volatile bool            s_running     = false;
+static TaskHandle_t             s_task        = NULL;
+static uint8_t                 *s_probe_buf   = NULL;
+static size_t                   s_line_size   = 64;
+static bsp_psram_monitor_cfg_t  s_cfg;
+static bsp_psram_report_t       s_report;
+static bool                     s_report_valid = false;
+static portMUX_TYPE             s_report_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void bsp_psram_monitor_account(bsp_psram_consumer_t consumer, uint32_t bytes)
+{
+    if (s_running && consumer < BSP_PSRAM_CONSUMER_MAX) {
+        atomic_fetch_add_explicit(&s_bytes[consumer], bytes, memory_order_relaxed);
+    }
+}
+
+static uint32_t psram_probe_chunk(const uint8_t *buf)
+{
+    /* Drop the chunk from the cache so every touched line is fetched from PSRAM */
+    esp_cache_msync((void *)buf, PSRAM_MON_CHUNK_SIZE, ESP_CACHE_MSYNC_FLAG_DIR_M2C);
+
+    volatile uint32_t sink = 0;
+    const uint32_t start = esp_cpu_get_cycle_count();
+    for (size_t off = 0; off < PSRAM_MON_CHUNK_SIZE; off += s_line_size) {
+        sink += *(const volatile uint32_t *)(buf + off);
+    }
+    (void)sink;
+    return esp_cpu_get_cycle_count() - start;
+}
+
+static int cycles_cmp(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Streaming read bandwidth in bytes per second */
+static uint32_t psram_probe(void)
+{
+    uint32_t cycles[s_cfg.probe_size / PSRAM_MON_CHUNK_SIZE];
+    const size_t chunks = sizeof(cycles) / sizeof(cycles[0]);
+
+    for (size_t i = 0; i < chunks; i++) {
+        cycles[i] = psram_probe_chunk(s_probe_buf + i * PSRAM_MON_CHUNK_SIZE);
+        taskYIELD();
+    }
+
+    qsort(cycles, chunks, sizeof(cycles[0]), cycles_cmp);
+    const size_t kept = (chunks + 1) / 2;
+    uint64_t total = 0;
+    for (size_t i = 0; i < kept; i++) {
+        total += cycles[i];
+    }
+    if (!total) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)kept * PSRAM_MON_CHUNK_SIZE * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000ULL / total);
+}
+
+/* Framebuffer bytes the panel read during the window, from the frames it actually scanned out */
+static uint32_t psram_scanout_bytes(uint32_t *last_frames)
+{
+    bsp_display_scanout_stats_t scanout;
+    bsp_display_comp_stats_t comp;
+    if (bsp_display_get_scanout_stats(&scanout) != ESP_OK) {
+        return 0;
+    }
+
+    const uint32_t frames = scanout.frames - *last_frames;
+    *last_frames = scanout.frames;
+    /* Compositor mode has no framebuffer; its scene data is too small to matter */
+    if (bsp_display_comp_get_stats(&comp) == ESP_OK) {
+        return 0;
+    }
+    return frames * (BSP_LCD_H_RES * BSP_LCD_V_RES * (BSP_LCD_BITS_PER_PIXEL / 8));
+}
+
+static void psram_monitor_task(void *arg)
+{
+    uint32_t last_frames = 0;
+    psram_scanout_bytes(&last_frames);
+    for (int i = 0; i < BSP_PSRAM_CONSUMER_MAX; i++) {
+        atomic_store(&s_bytes[i], 0);
+    }
+    int64_t window_start = esp_timer_get_time();
+
+    while (!ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(s_cfg.period_ms))) {
+        bsp_psram_report_t report = {0};
+
+        report.headroom_bps = psram_probe();
+
+        const int64_t now = esp_timer_get_time();
+        const uint64_t window_us = now - window_start;
+        window_start = now;
+        report.window_ms = window_us / 1000;
+
+        atomic_store(&s_bytes[BSP_PSRAM_CONSUMER_SCANOUT], psram_scanout_bytes(&last_frames));
+        for (int i = 0; i < BSP_PSRAM_CONSUMER_MAX; i++) {
+            const uint32_t bytes = atomic_exchange(&s_bytes[i], 0);
+            report.consumer_bps[i] = window_us ? (uint32_t)(bytes * 1000000ULL / window_us) : 0;
+            report.consumed_bps += report.consumer_bps[i];
+        }
+
+        report.bus_bps = (uint32_t)((uint64_t)CONFIG_SPIRAM_SPEED * 1000000ULL * PSRAM_BUS_BYTES_PER_CLK_X2 / 2);
+        const uint64_t capacity = (uint64_t)report.consumed_bps + report.headroom_bps;
+        report.utilization = capacity ? (uint8_t)(report.consumed_bps * 100ULL / capacity) : 0;
+
+        portENTER_CRITICAL(&s_report_lock);
+        s_report = report;
+        s_report_valid = true;
+        portEXIT_CRITICAL(&s_report_lock);
+
+        if (s_cfg.log_report) {
+            bsp_psram_monitor_log_report();
+        }
+    }
+
+    s_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t bsp_psram_monitor_start(const bsp_psram_monitor_cfg_t *cfg)
+{
+    if (s_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_cfg = cfg ? *cfg : (bsp_psram_monitor_cfg_t) {0};
+    if (!s_cfg.period_ms) {
+        s_cfg.period_ms = PSRAM_MON_DEFAULT_PERIOD_MS;
+    }
+    if (!s_cfg.probe_size) {
+        s_cfg.probe_size = PSRAM_MON_DEFAULT_PROBE_SIZE;
+    }
+    if (s_cfg.period_ms < 100 || s_cfg.period_ms > 10000 || s_cfg.probe_size < PSRAM_MON_CHUNK_SIZE
+            || s_cfg.probe_size > PSRAM_MON_MAX_PROBE_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_cfg.probe_size -= s_cfg.probe_size % PSRAM_MON_CHUNK_SIZE;
+
+    BSP_ERROR_CHECK_RETURN_ERR(esp_cache_get_alignment(MALLOC_CAP_SPIRAM, &s_line_size));
+    s_probe_buf = heap_caps_aligned_alloc(s_line_size, s_cfg.probe_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    BSP_NULL_CHECK(s_probe_buf, ESP_ERR_NO_MEM);
+    memset(s_probe_buf, 0, s_cfg.probe_size);
+    /* Write the zeroes back now, so later invalidations never discard dirty lines */
+    esp_cache_msync(s_probe_buf, s_cfg.probe_size, ESP_CACHE_MSYNC_FLAG_DIR_C2M);
+
+    s_report_valid = false;
+    s_running = true;
+    if (xTaskCreate(psram_monitor_task, "bsp_psram_mon", PSRAM_MON_TASK_STACK, NULL,
+                    PSRAM_MON_TASK_PRIO, &s_task) != pdPASS) {
+        s_running = false;
+        heap_caps_free(s_probe_buf);
+        s_probe_buf = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void bsp_psram_monitor_stop(void)
+{
+    if (!s_task) {
+        return;
+    }
+    s_running = false;
+    xTaskNotifyGive(s_task);
+    while (s_task) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    heap_caps_free(s_probe_buf);
+    s_probe_buf = NULL;
+}
+
+esp_err_t bsp_psram_monitor_get_report(bsp_psram_report_t *report)
+{
+    if (!report) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_report_lock);
+    const bool valid = s_report_valid;
+    *report = s_report;
+    portEXIT_CRITICAL(&s_report_lock);
+
+    return valid ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+void bsp_psram_monitor_log_report(void)
+{
+    bsp_psram_report_t r;
+    if (bsp_psram_monitor_get_report(&r) != ESP_OK) {
+        return;
+    }
+
+    char consumers[96];
+    int len = 0;
+    for (int i = 0; i < BSP_PSRAM_CONSUMER_MAX && len < (int)sizeof(consumers); i++) {
+        len += snprintf(consumers + len, sizeof(consumers) - len, " %s %" PRIu32,
+                        s_consumer_names[i], r.consumer_bps[i] / 1024);
+    }
+    ESP_LOGI(TAG, "KB/s:%s | used %" PRIu32 ", headroom %" PRIu32 " (%u%% busy), bus %" PRIu32,
+             consumers, r.consumed_bps / 1024, r.headroom_bps / 1024, r.utilization, r.bus_bps / 1024);
+}
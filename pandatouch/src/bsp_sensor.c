@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Sensor hub core: sample rings and the scheduler of the sensor state machines.
+ *
+ * The rings are the seqlock ring shared with the touch ring (bsp_seq_ring.h): a reader never blocks the hub.
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/sensor_hub_test.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "bsp/sensor.h"
+#include "bsp_seq_ring.h"
+
+#define HUB_MAX_STEPS       (4)     /* steps of one sensor per run, for drivers asking for no delay */
+#define RING_LATEST_TRIES   (4)
+
+_Static_assert(offsetof(bsp_sensor_slot_t, seq) == 0, "slot starts with its sequence number");
+
+static const bsp_seq_ring_layout_t s_layout = {
+    .slot_size     = sizeof(bsp_sensor_slot_t),
+    .sample_offset = offsetof(bsp_sensor_slot_t, sample),
+    .sample_size   = sizeof(bsp_sensor_sample_t),
+    .seq_offset    = offsetof(bsp_sensor_sample_t, seq),
+};
+
+void bsp_sensor_ring_init(bsp_sensor_ring_t *ring, bsp_sensor_slot_t *slots, uint32_t capacity)
+{
+    ring->slots = slots;
+    ring->mask = capacity - 1;
+    ring->head = 0;
+}
+
+void bsp_sensor_ring_push(bsp_sensor_ring_t *ring, const bsp_sensor_sample_t *sample)
+{
+    bsp_seq_ring_push(&s_layout, ring->slots, ring->mask, &ring->head, sample);
+}
+
+bool bsp_sensor_ring_latest(const bsp_sensor_ring_t *ring, bsp_sensor_sample_t *out)
+{
+    for (int i = 0; i < RING_LATEST_TRIES; i++) {
+        const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (head == 0) {
+            return false;
+        }
+        if (bsp_seq_ring_copy(&s_layout, ring->slots, ring->mask, head - 1, out)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t bsp_sensor_ring_read(const bsp_sensor_ring_t *ring, uint32_t *cursor, bsp_sensor_sample_t *out,
+                            size_t max, uint32_t *lost)
+{
+    return bsp_seq_ring_read(&s_layout, ring->slots, ring->mask, &ring->head, cursor, out, max, lost);
+}
+
+void bsp_sensor_init(bsp_sensor_t *sensor, const bsp_sensor_driver_t *driver, const bsp_sensor_io_t *io,
+                     uint32_t period_ms, bsp_sensor_slot_t *slots, uint32_t capacity)
+{
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->driver = driver;
+    sensor->io = *io;
+    sensor->period_ms = period_ms;
+    sensor->status = BSP_SENSOR_PENDING;
+    bsp_sensor_ring_init(&sensor->ring, slots, capacity);
+}
+
+void bsp_sensor_hub_init(bsp_sensor_hub_t *hub)
+{
+    hub->first = NULL;
+}
+
+void bsp_sensor_hub_add(bsp_sensor_hub_t *hub, bsp_sensor_t *sensor, int64_t now_us)
+{
+    sensor->state = 0;
+    sensor->retries = 0;
+    sensor->cycle_start = true;
+    sensor->due_us = now_us;
+    sensor->next = hub->first;
+    hub->first = sensor;
+}
+
+bool bsp_sensor_hub_remove(bsp_sensor_hub_t *hub, bsp_sensor_t *sensor)
+{
+    for (bsp_sensor_t **p = &hub->first; *p != NULL; p = &(*p)->next) {
+        if (*p == sensor) {
+            *p = sensor->next;
+            sensor->next = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* The next conversion starts one period after the previous one, or now if that is already past */
+static void sensor_next_cycle(bsp_sensor_t *s, int64_t now_us)
+{
+    s->cycle_start = true;
+    s->due_us = s->cycle_us + (int64_t)s->period_ms * 1000;
+    if (s->due_us < now_us) {
+        s->due_us = now_us;
+    }
+}
+
+static void sensor_step(bsp_sensor_t *s, int64_t now_us)
+{
+    if (s->cycle_start) {
+        s->cycle_start = false;
+        s->cycle_us = now_us;
+    }
+
+    bsp_sensor_sample_t sample = { .time_us = now_us };
+    uint32_t delay_ms = 0;
+    bool done = false;
+    const int err = s->driver->step(s, sample.value, &delay_ms, &done);
+
+    if (err != 0) {
+        s->status = err;
+        s->errors++;
+        s->state = 0;
+        s->retries = 0;
+        sensor_next_cycle(s, now_us);
+    } else if (done) {
+        bsp_sensor_ring_push(&s->ring, &sample);
+        s->status = 0;
+        sensor_next_cycle(s, now_us);
+    } else {
+        s->due_us = now_us + (int64_t)delay_ms * 1000;
+    }
+}
+
+int64_t bsp_sensor_hub_run(bsp_sensor_hub_t *hub, int64_t now_us)
+{
+    int64_t next = INT64_MAX;
+
+    for (bsp_sensor_t *s = hub->first; s != NULL; s = s->next) {
+        for (int i = 0; i < HUB_MAX_STEPS && s->due_us <= now_us; i++) {
+            sensor_step(s, now_us);
+        }
+        if (s->due_us < next) {
+            next = s->due_us;
+        }
+    }
+    return next;
+}
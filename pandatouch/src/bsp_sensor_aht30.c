@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * AHT30 state machine for the sensor hub.
+ *
+ * start: read the status byte; a sensor without its calibration bit gets the init command
+ * trigger: send the measure command; the conversion takes about 80 ms
+ * read: read status, 5 data bytes and CRC; while the busy bit is set, come back 10 ms later
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/sensor_hub_test.
+ */
+
+#include "bsp/sensor.h"
+
+#define AHT30_STATUS_BUSY       (0x80)
+#define AHT30_STATUS_CALIBRATED (0x08)
+#define AHT30_INIT_MS           (10)
+#define AHT30_CONVERSION_MS     (80)
+#define AHT30_BUSY_MS           (10)
+#define AHT30_BUSY_RETRIES      (5)
+
+enum {
+    AHT30_STATE_START = 0,
+    AHT30_STATE_CALIBRATING,
+    AHT30_STATE_TRIGGER,
+    AHT30_STATE_READ,
+};
+
+/* CRC-8, polynomial 0x31, initial value 0xff */
+static uint8_t aht30_crc8(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0xff;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static int aht30_step(bsp_sensor_t *sensor, int32_t *values, uint32_t *delay_ms, bool *done)
+{
+    static const uint8_t init_cmd[] = { 0xbe, 0x08, 0x00 };
+    static const uint8_t measure_cmd[] = { 0xac, 0x33, 0x00 };
+    const bsp_sensor_io_t *io = &sensor->io;
+    uint8_t buf[7];
+    int err;
+
+    switch (sensor->state) {
+    case AHT30_STATE_START:
+        err = io->read(io->ctx, buf, 1);
+        if (err != 0) {
+            return err;
+        }
+        if (buf[0] & AHT30_STATUS_CALIBRATED) {
+            sensor->state = AHT30_STATE_TRIGGER;
+            *delay_ms = 0;
+            return 0;
+        }
+        err = io->write(io->ctx, init_cmd, sizeof(init_cmd));
+        if (err != 0) {
+            return err;
+        }
+        sensor->state = AHT30_STATE_CALIBRATING;
+        *delay_ms = AHT30_INIT_MS;
+        return 0;
+
+    case AHT30_STATE_CALIBRATING:
+    case AHT30_STATE_TRIGGER:
+        err = io->write(io->ctx, measure_cmd, sizeof(measure_cmd));
+        if (err != 0) {
+            return err;
+        }
+        sensor->state = AHT30_STATE_READ;
+        sensor->retries = 0;
+        *delay_ms = AHT30_CONVERSION_MS;
+        return 0;
+
+    case AHT30_STATE_READ:
+        err = io->read(io->ctx, buf, sizeof(buf));
+        if (err != 0) {
+            return err;
+        }
+        if (buf[0] & AHT30_STATUS_BUSY) {
+            if (++sensor->retries > AHT30_BUSY_RETRIES) {
+                return BSP_SENSOR_ERR_TIMEOUT;
+            }
+            *delay_ms = AHT30_BUSY_MS;
+            return 0;
+        }
+        if (aht30_crc8(buf, 6) != buf[6]) {
+            return BSP_SENSOR_ERR_CRC;
+        }
+        {
+            const uint32_t hum_raw = ((uint32_t)buf[1] << 12) | ((uint32_t)buf[2] << 4) | (buf[3] >> 4);
+            const uint32_t temp_raw = ((uint32_t)(buf[3] & 0x0f) << 16) | ((uint32_t)buf[4] << 8) | buf[5];
+            /* 20-bit fractions of 200 °C (from -50 °C) and of 100 %RH, rounded to the nearest milli-unit */
+            values[0] = (int32_t)((((uint64_t)temp_raw * 200000) + (1u << 19)) >> 20) - 50000;
+            values[1] = (int32_t)((((uint64_t)hum_raw * 100000) + (1u << 19)) >> 20);
+        }
+        sensor->state = AHT30_STATE_TRIGGER;
+        *done = true;
+        return 0;
+
+    default:
+        sensor->state = AHT30_STATE_START;
+        *delay_ms = 0;
+        return 0;
+    }
+}
+
+const bsp_sensor_driver_t bsp_sensor_aht30 = {
+    .name = "aht30",
+    .value_count = 2,
+    .step = aht30_step,
+};
@@ -0,0 +1,206 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Sensor history chart.
+ *
+ * The chart is split into time slots, one per point, and slot 0 starts at a fixed time: a page. Each
+ * slot shows the point bsp_sensor_series_pick() chooses among the samples of its time, so peaks survive
+ * however long a slot is. When a slot completes, only that point is set; in circular update mode
+ * lv_chart invalidates just the two line segments next to it, instead of the whole plot as a scrolling
+ * chart would. When the page is full, it moves by half a span and is drawn again in one pass.
+ */
+#include <inttypes.h>
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+
+static const char *TAG = "bsp_sensor_chart";
+
+#define CHART_MIN_PERIOD_MS  (100)
+#define CHART_MAX_PERIOD_MS  (1000)
+
+typedef struct {
+    bsp_sensor_chart_cfg_t   cfg;
+    lv_obj_t                *chart;
+    lv_chart_series_t       *ser;
+    lv_timer_t              *timer;
+    uint32_t                 points;    /* slots across the chart */
+    int64_t                  slot_us;
+    bool                     paged;     /* page_us is set */
+    int64_t                  page_us;   /* start of slot 0 */
+    uint32_t                 next_slot; /* first slot not drawn yet */
+    bsp_sensor_xy_t          prev;      /* point of the last slot holding one */
+    bool                     has_prev;
+    bsp_sensor_chart_stats_t stats;
+} sensor_chart_t;
+
+static void sensor_chart_event_cb(lv_event_t *e);
+
+static sensor_chart_t *sensor_chart_get(lv_obj_t *chart)
+{
+    if (!chart) {
+        return NULL;
+    }
+    const uint32_t count = lv_obj_get_event_count(chart);
+    for (uint32_t i = 0; i < count; i++) {
+        lv_event_dsc_t *dsc = lv_obj_get_event_dsc(chart, i);
+        if (lv_event_dsc_get_cb(dsc) == sensor_chart_event_cb) {
+            return lv_event_dsc_get_user_data(dsc);
+        }
+    }
+    return NULL;
+}
+
+/* Point of slot i, or LV_CHART_POINT_NONE if no sample fell into it */
+static int32_t sensor_chart_slot(sensor_chart_t *ctx, uint32_t i)
+{
+    const int64_t from_us = ctx->page_us + (int64_t)i * ctx->slot_us;
+    bsp_sensor_xy_t xy;
+    if (!bsp_sensor_series_pick(ctx->cfg.series, ctx->cfg.index, from_us, from_us + ctx->slot_us,
+                                ctx->has_prev ? &ctx->prev : NULL, &xy)) {
+        return LV_CHART_POINT_NONE;
+    }
+    ctx->prev = xy;
+    ctx->has_prev = true;
+    return xy.value;
+}
+
+static bool sensor_chart_slot_done(const sensor_chart_t *ctx, int64_t last_us)
+{
+    return ctx->page_us + (int64_t)(ctx->next_slot + 1) * ctx->slot_us <= last_us;
+}
+
+/* Start a page with the newest sample in the middle of the chart and draw its complete slots */
+static void sensor_chart_rebuild(sensor_chart_t *ctx)
+{
+    int64_t first_us;
+    int64_t last_us;
+    ctx->paged = bsp_sensor_series_span(ctx->cfg.series, &first_us, &last_us);
+    if (!ctx->paged) {
+        return;
+    }
+
+    uint32_t points = ctx->cfg.points ? ctx->cfg.points : (uint32_t)LV_MAX(lv_obj_get_content_width(ctx->chart), 0);
+    points = LV_MAX(points, 2);
+    if (points != lv_chart_get_point_count(ctx->chart)) {
+        lv_chart_set_point_count(ctx->chart, points);
+    }
+    ctx->points = points;
+    ctx->slot_us = LV_MAX((int64_t)ctx->cfg.span_s * 1000000 / points, 1);
+    ctx->page_us = LV_MAX(last_us - (int64_t)(points / 2) * ctx->slot_us, first_us);
+    lv_timer_set_period(ctx->timer, LV_CLAMP(CHART_MIN_PERIOD_MS, (uint32_t)(ctx->slot_us / 1000),
+                                             CHART_MAX_PERIOD_MS));
+
+    int32_t *y = lv_chart_get_y_array(ctx->chart, ctx->ser);
+    ctx->has_prev = false;
+    for (ctx->next_slot = 0; ctx->next_slot < points && sensor_chart_slot_done(ctx, last_us); ctx->next_slot++) {
+        y[ctx->next_slot] = sensor_chart_slot(ctx, ctx->next_slot);
+    }
+    for (uint32_t i = ctx->next_slot; i < points; i++) {
+        y[i] = LV_CHART_POINT_NONE;
+    }
+    lv_chart_refresh(ctx->chart);
+    ctx->stats.rebuilds++;
+    ESP_LOGD(TAG, "Page of %" PRIu32 " slots of %" PRId64 " ms, %" PRIu32 " drawn", points,
+             ctx->slot_us / 1000, ctx->next_slot);
+}
+
+/* Draw the slots completed since the last call; each one invalidates only its own segments */
+static void sensor_chart_update(sensor_chart_t *ctx)
+{
+    int64_t last_us;
+    if (!ctx->paged) {
+        sensor_chart_rebuild(ctx);
+        return;
+    }
+    if (!bsp_sensor_series_span(ctx->cfg.series, NULL, &last_us)) {
+        return;
+    }
+    while (sensor_chart_slot_done(ctx, last_us)) {
+        if (ctx->next_slot >= ctx->points) {
+            sensor_chart_rebuild(ctx);
+            return;
+        }
+        lv_chart_set_value_by_id(ctx->chart, ctx->ser, ctx->next_slot, sensor_chart_slot(ctx, ctx->next_slot));
+        ctx->next_slot++;
+        ctx->stats.slots++;
+    }
+}
+
+static void sensor_chart_timer_cb(lv_timer_t *t)
+{
+    sensor_chart_t *ctx = lv_timer_get_user_data(t);
+    if (ctx->cfg.ring) {
+        uint32_t lost = 0;
+        bsp_sensor_series_drain(ctx->cfg.series, ctx->cfg.ring, &lost);
+        ctx->stats.lost += lost;
+    }
+    sensor_chart_update(ctx);
+}
+
+static void sensor_chart_event_cb(lv_event_t *e)
+{
+    sensor_chart_t *ctx = lv_event_get_user_data(e);
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_SIZE_CHANGED:
+        if (ctx->cfg.points == 0) {
+            sensor_chart_rebuild(ctx);
+        }
+        break;
+    case LV_EVENT_DELETE:
+        lv_timer_delete(ctx->timer);
+        lv_free(ctx);
+        break;
+    default:
+        break;
+    }
+}
+
+lv_obj_t *bsp_sensor_chart_create(lv_obj_t *parent, const bsp_sensor_chart_cfg_t *cfg)
+{
+    BSP_NULL_CHECK(parent, NULL);
+    BSP_NULL_CHECK(cfg, NULL);
+    BSP_NULL_CHECK(cfg->series, NULL);
+    if (cfg->index >= BSP_SENSOR_MAX_VALUES || cfg->span_s == 0 || cfg->max <= cfg->min) {
+        ESP_LOGE(TAG, "Invalid chart configuration");
+        return NULL;
+    }
+
+    sensor_chart_t *ctx = lv_malloc_zeroed(sizeof(sensor_chart_t));
+    BSP_NULL_CHECK(ctx, NULL);
+    ctx->cfg = *cfg;
+    ctx->timer = lv_timer_create(sensor_chart_timer_cb, CHART_MAX_PERIOD_MS, ctx);
+    if (!ctx->timer) {
+        lv_free(ctx);
+        return NULL;
+    }
+
+    ctx->chart = lv_chart_create(parent);
+    lv_chart_set_type(ctx->chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_update_mode(ctx->chart, LV_CHART_UPDATE_MODE_CIRCULAR);
+    lv_chart_set_range(ctx->chart, LV_CHART_AXIS_PRIMARY_Y, cfg->min, cfg->max);
+    lv_obj_set_style_width(ctx->chart, 0, LV_PART_INDICATOR);
+    lv_obj_set_style_height(ctx->chart, 0, LV_PART_INDICATOR);
+    ctx->ser = lv_chart_add_series(ctx->chart, cfg->color, LV_CHART_AXIS_PRIMARY_Y);
+    lv_obj_add_event_cb(ctx->chart, sensor_chart_event_cb, LV_EVENT_ALL, ctx);
+    sensor_chart_update(ctx);
+    return ctx->chart;
+}
+
+esp_err_t bsp_sensor_chart_get_stats(lv_obj_t *chart, bsp_sensor_chart_stats_t *stats)
+{
+    sensor_chart_t *ctx = sensor_chart_get(chart);
+    if (!ctx || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = ctx->stats;
+    return ESP_OK;
+}
+
+#endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
@@ -0,0 +1,150 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Sensor hub task: runs the sensor state machines of bsp/sensor.h on the expansion I2C bus.
+ *
+ * The task wakes when a step is due, runs every due step in one bus session and sleeps until the next.
+ * Lock order: hub lock, then the bus; the bus registry is never touched with the hub lock held.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "bsp/ext_i2c.h"
+#include "bsp_err_check.h"
+
+static const char *TAG = "bsp_sensor";
+
+#define HUB_TASK_STACK      (3072)
+#define HUB_PERIOD_MS       (1000)
+#define HUB_RING_LEN        (16)
+
+/* One allocation per sensor; sensor first so the public pointer is the allocation */
+typedef struct {
+    bsp_sensor_t             sensor;
+    bsp_ext_i2c_dev_handle_t dev;
+    bsp_sensor_slot_t        slots[];
+} hub_sensor_t;
+
+static bsp_sensor_hub_t  s_hub;
+static SemaphoreHandle_t s_hub_lock = NULL;
+static TaskHandle_t      s_hub_task = NULL;
+
+static int hub_io_write(void *ctx, const uint8_t *data, size_t len)
+{
+    return bsp_ext_i2c_write((bsp_ext_i2c_dev_handle_t)ctx, data, len);
+}
+
+static int hub_io_read(void *ctx, uint8_t *data, size_t len)
+{
+    return bsp_ext_i2c_read((bsp_ext_i2c_dev_handle_t)ctx, data, len);
+}
+
+static void sensor_hub_task(void *arg)
+{
+    (void)arg;
+    const int64_t tick_us = 1000000 / configTICK_RATE_HZ;
+
+    while (1) {
+        xSemaphoreTake(s_hub_lock, portMAX_DELAY);
+        /* One bus session for all the steps that are due */
+        bsp_ext_i2c_lock(0);
+        const int64_t next = bsp_sensor_hub_run(&s_hub, esp_timer_get_time());
+        bsp_ext_i2c_unlock();
+        xSemaphoreGive(s_hub_lock);
+
+        TickType_t ticks = portMAX_DELAY;
+        if (next != INT64_MAX) {
+            const int64_t wait_us = next - esp_timer_get_time();
+            ticks = (wait_us <= 0) ? 0 : (TickType_t)((wait_us + tick_us - 1) / tick_us);
+        }
+        /* Notified by bsp_ext_i2c_sensor_add() so a new sensor starts at once */
+        ulTaskNotifyTake(pdTRUE, ticks);
+    }
+}
+
+esp_err_t bsp_ext_i2c_sensor_add(const bsp_ext_i2c_sensor_config_t *config, bsp_sensor_t **ret_sensor)
+{
+    BSP_NULL_CHECK(config, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(ret_sensor, ESP_ERR_INVALID_ARG);
+    if (config->driver == NULL || config->driver->step == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_hub_lock == NULL) {
+        s_hub_lock = xSemaphoreCreateMutex();
+        if (s_hub_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        bsp_sensor_hub_init(&s_hub);
+    }
+    if (s_hub_task == NULL
+            && xTaskCreate(sensor_hub_task, "bsp_sensors", HUB_TASK_STACK, NULL,
+                           CONFIG_BSP_EXT_I2C_TASK_PRIORITY, &s_hub_task) != pdPASS) {
+        s_hub_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t ring_len = 1;
+    while (ring_len < (config->ring_len ? config->ring_len : HUB_RING_LEN)) {
+        ring_len <<= 1;
+    }
+    hub_sensor_t *hs = heap_caps_calloc(1, sizeof(*hs) + ring_len * sizeof(bsp_sensor_slot_t), MALLOC_CAP_DEFAULT);
+    if (hs == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    bsp_ext_i2c_dev_config_t dev_cfg = config->dev;
+    if (dev_cfg.name == NULL) {
+        dev_cfg.name = config->driver->name;
+    }
+    const esp_err_t ret = bsp_ext_i2c_add_device(&dev_cfg, &hs->dev);
+    if (ret != ESP_OK) {
+        heap_caps_free(hs);
+        return ret;
+    }
+
+    const bsp_sensor_io_t io = {
+        .write = hub_io_write,
+        .read = hub_io_read,
+        .ctx = hs->dev,
+    };
+    bsp_sensor_init(&hs->sensor, config->driver, &io, config->period_ms ? config->period_ms : HUB_PERIOD_MS,
+                    hs->slots, ring_len);
+
+    xSemaphoreTake(s_hub_lock, portMAX_DELAY);
+    bsp_sensor_hub_add(&s_hub, &hs->sensor, esp_timer_get_time());
+    xSemaphoreGive(s_hub_lock);
+    xTaskNotifyGive(s_hub_task);
+
+    ESP_LOGI(TAG, "%s at 0x%02x every %" PRIu32 " ms", config->driver->name, dev_cfg.addr,
+             hs->sensor.period_ms);
+    *ret_sensor = &hs->sensor;
+    return ESP_OK;
+}
+
+esp_err_t bsp_ext_i2c_sensor_remove(bsp_sensor_t *sensor)
+{
+    if (s_hub_lock == NULL || sensor == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(s_hub_lock, portMAX_DELAY);
+    const bool found = bsp_sensor_hub_remove(&s_hub, sensor);
+    xSemaphoreGive(s_hub_lock);
+    if (!found) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    hub_sensor_t *hs = (hub_sensor_t *)sensor;
+    bsp_ext_i2c_remove_device(hs->dev);
+    heap_caps_free(hs);
+    return ESP_OK;
+}
@@ -0,0 +1,334 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Sensor time series: multi-resolution rings and LTTB decimation.
+ *
+ * Level k + 1 accumulates the points of level k and appends their average every factor points. A level
+ * only overwrites its oldest points once the next level holds their average, so going from level 0 to
+ * the coarser ones, each level covers the time before the oldest point of the previous one. A query
+ * reads a time-ordered view of those runs: the finest points kept for each part of its range.
+ *
+ * LTTB runs over that view in place, without copying it: each output bucket keeps the point forming the
+ * largest triangle with the point kept before it and the average of the next bucket. Times are taken in
+ * [ms] from the start of the range and computed in float, which is exact enough to compare areas and
+ * runs on the ESP32-S3 FPU.
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/sensor_series_test.
+ */
+
+#include <string.h>
+#include "bsp/sensor_series.h"
+
+#define DRAIN_CHUNK     (16)
+
+/* Points of one level, in time order, as a contiguous run of its sequence numbers */
+typedef struct {
+    const bsp_sensor_level_t *level;
+    uint32_t                  first;
+    uint32_t                  count;
+} series_run_t;
+
+/* Time-ordered view of a range: a run of each level, from the coarsest one needed to level 0 */
+typedef struct {
+    series_run_t run[BSP_SENSOR_SERIES_MAX_LEVELS];
+    uint8_t      runs;
+    uint32_t     total;
+    uint32_t     capacity;
+} series_view_t;
+
+bool bsp_sensor_series_init(bsp_sensor_series_t *series, bsp_sensor_point_t *storage, uint32_t capacity,
+                            uint8_t levels, uint16_t factor)
+{
+    if (!series || !storage || levels == 0 || levels > BSP_SENSOR_SERIES_MAX_LEVELS || factor < 2 ||
+            capacity < factor) {
+        return false;
+    }
+    memset(series, 0, sizeof(*series));
+    for (uint8_t k = 0; k < levels; k++) {
+        series->level[k].points = storage + (size_t)k * capacity;
+    }
+    series->capacity = capacity;
+    series->factor = factor;
+    series->levels = levels;
+    return true;
+}
+
+static int32_t div_round(int64_t sum, int64_t count)
+{
+    return (int32_t)((sum + (sum < 0 ? -count / 2 : count / 2)) / count);
+}
+
+static void level_push(bsp_sensor_series_t *series, uint8_t k, const bsp_sensor_point_t *point)
+{
+    bsp_sensor_level_t *level = &series->level[k];
+    level->points[level->head % series->capacity] = *point;
+    level->head++;
+    if (k + 1 >= series->levels) {
+        return;
+    }
+
+    bsp_sensor_level_t *next = &series->level[k + 1];
+    next->sum_time += point->time_us;
+    for (int i = 0; i < BSP_SENSOR_MAX_VALUES; i++) {
+        next->sum_value[i] += point->value[i];
+    }
+    if (++next->pending < series->factor) {
+        return;
+    }
+
+    bsp_sensor_point_t avg;
+    avg.time_us = next->sum_time / next->pending;
+    for (int i = 0; i < BSP_SENSOR_MAX_VALUES; i++) {
+        avg.value[i] = div_round(next->sum_value[i], next->pending);
+        next->sum_value[i] = 0;
+    }
+    next->sum_time = 0;
+    next->pending = 0;
+    level_push(series, k + 1, &avg);
+}
+
+void bsp_sensor_series_add(bsp_sensor_series_t *series, int64_t time_us, const int32_t *values)
+{
+    bsp_sensor_point_t point;
+    point.time_us = time_us;
+    memcpy(point.value, values, sizeof(point.value));
+    level_push(series, 0, &point);
+}
+
+size_t bsp_sensor_series_drain(bsp_sensor_series_t *series, const bsp_sensor_ring_t *ring, uint32_t *lost)
+{
+    bsp_sensor_sample_t samples[DRAIN_CHUNK];
+    uint32_t skipped = 0;
+    size_t added = 0;
+    size_t n;
+
+    do {
+        uint32_t l = 0;
+        n = bsp_sensor_ring_read(ring, &series->cursor, samples, DRAIN_CHUNK, &l);
+        skipped += l;
+        for (size_t i = 0; i < n; i++) {
+            bsp_sensor_series_add(series, samples[i].time_us, samples[i].value);
+        }
+        added += n;
+    } while (n == DRAIN_CHUNK);
+
+    if (lost) {
+        *lost = skipped;
+    }
+    return added;
+}
+
+static const bsp_sensor_point_t *level_at(const bsp_sensor_level_t *level, uint32_t capacity, uint32_t seq)
+{
+    return &level->points[seq % capacity];
+}
+
+static uint32_t level_oldest(const bsp_sensor_level_t *level, uint32_t capacity)
+{
+    return level->head > capacity ? level->head - capacity : 0;
+}
+
+bool bsp_sensor_series_span(const bsp_sensor_series_t *series, int64_t *first_us, int64_t *last_us)
+{
+    const bsp_sensor_level_t *raw = &series->level[0];
+    if (raw->head == 0) {
+        return false;
+    }
+    if (first_us) {
+        /* The coarsest level holding a point reaches furthest back */
+        for (int k = series->levels - 1; k >= 0; k--) {
+            const bsp_sensor_level_t *level = &series->level[k];
+            if (level->head) {
+                *first_us = level_at(level, series->capacity, level_oldest(level, series->capacity))->time_us;
+                break;
+            }
+        }
+    }
+    if (last_us) {
+        *last_us = level_at(raw, series->capacity, raw->head - 1)->time_us;
+    }
+    return true;
+}
+
+/* First sequence number in [first, end) whose point is at or after time_us */
+static uint32_t level_lower_bound(const bsp_sensor_level_t *level, uint32_t capacity, uint32_t first,
+                                  uint32_t end, int64_t time_us)
+{
+    while (first < end) {
+        const uint32_t mid = first + (end - first) / 2;
+        if (level_at(level, capacity, mid)->time_us < time_us) {
+            first = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    return first;
+}
+
+static void view_add(series_view_t *view, const bsp_sensor_level_t *level, uint32_t first, uint32_t end,
+                     int64_t from_us, int64_t to_us)
+{
+    const uint32_t lo = level_lower_bound(level, view->capacity, first, end, from_us);
+    const uint32_t hi = level_lower_bound(level, view->capacity, lo, end, to_us);
+    if (hi > lo) {
+        view->run[view->runs++] = (series_run_t) {
+            .level = level, .first = lo, .count = hi - lo
+        };
+        view->total += hi - lo;
+    }
+}
+
+static void view_build(const bsp_sensor_series_t *series, int64_t from_us, int64_t to_us, series_view_t *view)
+{
+    const uint32_t capacity = series->capacity;
+    series_view_t rev;
+    memset(&rev, 0, sizeof(rev));
+    rev.capacity = capacity;
+
+    /* Newest part first: each level fills in the time before the oldest point of the finer one */
+    int64_t end_us = to_us;
+    for (uint8_t k = 0; k < series->levels && end_us > from_us; k++) {
+        const bsp_sensor_level_t *level = &series->level[k];
+        const uint32_t oldest = level_oldest(level, capacity);
+        view_add(&rev, level, oldest, level->head, from_us, end_us);
+        if (oldest == 0) {
+            break;              /* nothing was dropped from this level yet */
+        }
+        end_us = level_at(level, capacity, oldest)->time_us;
+    }
+
+    memset(view, 0, sizeof(*view));
+    view->capacity = capacity;
+    view->total = rev.total;
+    for (uint8_t r = 0; r < rev.runs; r++) {
+        view->run[view->runs++] = rev.run[rev.runs - 1 - r];
+    }
+}
+
+static const bsp_sensor_point_t *view_at(const series_view_t *view, uint32_t i)
+{
+    for (uint8_t r = 0; r < view->runs; r++) {
+        const series_run_t *run = &view->run[r];
+        if (i < run->count) {
+            return level_at(run->level, view->capacity, run->first + i);
+        }
+        i -= run->count;
+    }
+    return NULL;
+}
+
+static float point_x(const bsp_sensor_point_t *p, int64_t origin_us)
+{
+    return (float)((p->time_us - origin_us) / 1000);
+}
+
+static void xy_set(bsp_sensor_xy_t *out, const bsp_sensor_point_t *p, uint8_t index)
+{
+    out->time_us = p->time_us;
+    out->value = p->value[index];
+}
+
+/* Point of [lo, hi) forming the largest triangle with (ax, ay) and (cx, cy); later points win ties */
+static uint32_t view_largest(const series_view_t *view, uint8_t index, int64_t origin_us, uint32_t lo,
+                             uint32_t hi, float ax, float ay, float cx, float cy)
+{
+    uint32_t best = lo;
+    float best_area = -1.0f;
+    for (uint32_t j = lo; j < hi; j++) {
+        const bsp_sensor_point_t *p = view_at(view, j);
+        float area = (ax - cx) * ((float)p->value[index] - ay) - (ax - point_x(p, origin_us)) * (cy - ay);
+        if (area < 0) {
+            area = -area;
+        }
+        if (area >= best_area) {
+            best_area = area;
+            best = j;
+        }
+    }
+    return best;
+}
+
+size_t bsp_sensor_series_query(const bsp_sensor_series_t *series, uint8_t index, int64_t from_us,
+                               int64_t to_us, bsp_sensor_xy_t *out, size_t n)
+{
+    if (!series || !out || n == 0 || index >= BSP_SENSOR_MAX_VALUES) {
+        return 0;
+    }
+    series_view_t view;
+    view_build(series, from_us, to_us, &view);
+    const uint32_t total = view.total;
+    if (total == 0) {
+        return 0;
+    }
+    if (total <= n) {
+        for (uint32_t i = 0; i < total; i++) {
+            xy_set(&out[i], view_at(&view, i), index);
+        }
+        return total;
+    }
+    if (n == 1) {
+        xy_set(&out[0], view_at(&view, total - 1), index);
+        return 1;
+    }
+
+    /* Bucket b (1..n-2) is [edge(b - 1), edge(b)) of the points between the first and the last one */
+    const int64_t origin_us = view_at(&view, 0)->time_us;
+    const uint64_t inner = total - 2;
+    const uint64_t buckets = n - 2;
+    uint32_t a = 0;
+    xy_set(&out[0], view_at(&view, 0), index);
+    for (uint64_t b = 0; b < buckets; b++) {
+        const uint32_t lo = 1 + (uint32_t)(b * inner / buckets);
+        const uint32_t hi = 1 + (uint32_t)((b + 1) * inner / buckets);
+        const uint32_t next_hi = b + 1 < buckets ? 1 + (uint32_t)((b + 2) * inner / buckets) : total;
+
+        float cx = 0.0f;
+        float cy = 0.0f;
+        for (uint32_t j = hi; j < next_hi; j++) {
+            const bsp_sensor_point_t *p = view_at(&view, j);
+            cx += point_x(p, origin_us);
+            cy += (float)p->value[index];
+        }
+        cx /= (float)(next_hi - hi);
+        cy /= (float)(next_hi - hi);
+
+        const bsp_sensor_point_t *pa = view_at(&view, a);
+        a = view_largest(&view, index, origin_us, lo, hi, point_x(pa, origin_us), (float)pa->value[index], cx, cy);
+        xy_set(&out[b + 1], view_at(&view, a), index);
+    }
+    xy_set(&out[n - 1], view_at(&view, total - 1), index);
+    return n;
+}
+
+bool bsp_sensor_series_pick(const bsp_sensor_series_t *series, uint8_t index, int64_t from_us, int64_t to_us,
+                            const bsp_sensor_xy_t *prev, bsp_sensor_xy_t *out)
+{
+    if (!series || !out || index >= BSP_SENSOR_MAX_VALUES) {
+        return false;
+    }
+    series_view_t view;
+    view_build(series, from_us, to_us, &view);
+    if (view.total == 0) {
+        return false;
+    }
+
+    const bsp_sensor_point_t *first = view_at(&view, 0);
+    const int64_t origin_us = prev ? prev->time_us : first->time_us;
+    float cx = 0.0f;
+    float cy = 0.0f;
+    for (uint32_t j = 0; j < view.total; j++) {
+        const bsp_sensor_point_t *p = view_at(&view, j);
+        cx += point_x(p, origin_us);
+        cy += (float)p->value[index];
+    }
+    cx /= (float)view.total;
+    cy /= (float)view.total;
+
+    const float ay = (float)(prev ? prev->value : first->value[index]);
+    xy_set(out, view_at(&view, view_largest(&view, index, origin_us, 0, view.total, 0.0f, ay, cx, cy)), index);
+    return true;
+}
@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Seqlock ring shared by the sensor and touch rings: see bsp_seq_ring.h.
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/sensor_hub_test and tools/touch_ring_test.
+ */
+
+#include <string.h>
+#include "bsp_seq_ring.h"
+
+static inline volatile uint32_t *slot_seq(const bsp_seq_ring_layout_t *layout, const void *slots, uint32_t index)
+{
+    return (volatile uint32_t *)((uintptr_t)slots + (size_t)index * layout->slot_size);
+}
+
+static inline uint8_t *slot_sample(const bsp_seq_ring_layout_t *layout, const void *slots, uint32_t index)
+{
+    return (uint8_t *)((uintptr_t)slots + (size_t)index * layout->slot_size + layout->sample_offset);
+}
+
+void bsp_seq_ring_push(const bsp_seq_ring_layout_t *layout, void *slots, uint32_t mask,
+                       volatile uint32_t *head, const void *sample)
+{
+    const uint32_t seq = *head;
+    volatile uint32_t *slot = slot_seq(layout, slots, seq & mask);
+    uint8_t *dst = slot_sample(layout, slots, seq & mask);
+
+    __atomic_store_n(slot, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(dst, sample, layout->sample_size);
+    memcpy(dst + layout->seq_offset, &seq, sizeof(seq));
+    __atomic_store_n(slot, seq + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(head, seq + 1, __ATOMIC_RELEASE);
+}
+
+bool bsp_seq_ring_copy(const bsp_seq_ring_layout_t *layout, const void *slots, uint32_t mask,
+                       uint32_t seq, void *out)
+{
+    volatile uint32_t *slot = slot_seq(layout, slots, seq & mask);
+
+    if (__atomic_load_n(slot, __ATOMIC_ACQUIRE) != seq + 1) {
+        return false;
+    }
+    memcpy(out, slot_sample(layout, slots, seq & mask), layout->sample_size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(slot, __ATOMIC_RELAXED) == seq + 1;
+}
+
+size_t bsp_seq_ring_read(const bsp_seq_ring_layout_t *layout, const void *slots, uint32_t mask,
+                         const volatile uint32_t *head, uint32_t *cursor, void *out, size_t max, uint32_t *lost)
+{
+    const uint32_t end = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+    const uint32_t capacity = mask + 1;
+    uint8_t *dst = out;
+    uint32_t cur = *cursor;
+    uint32_t skipped = 0;
+    size_t n = 0;
+
+    if ((int32_t)(end - cur) < 0) {
+        cur = end;                      /* cursor from a ring that was reset */
+    } else if (end - cur > capacity) {
+        skipped = end - capacity - cur;
+        cur = end - capacity;
+    }
+    while (cur != end && n < max) {
+        if (bsp_seq_ring_copy(layout, slots, mask, cur, dst + n * layout->sample_size)) {
+            n++;
+        } else {
+            skipped++;                  /* overwritten while we were reading */
+        }
+        cur++;
+    }
+
+    *cursor = cur;
+    if (lost != NULL) {
+        *lost = skipped;
+    }
+    return n;
+}
@@ -3,6 +3,9 @@
  *
  * SPDX-License-Identifier: MIT
  */
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "driver/i2c_master.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_touch_gt911.h"
@@ -12,6 +15,19 @@
 #include "bsp/display.h"
 #include "bsp_err_check.h"
 
+static const char *TAG = "bsp_touch";
+
+/* GT911 configuration block: 184 bytes, then its checksum and the "config fresh" flag */
+#define GT911_REG_CONFIG        (0x8047)
+#define GT911_CONFIG_LEN        (184)
+#define GT911_CFG_FILTER        (0x8050 - GT911_REG_CONFIG)    /* bits 0-5 */
+#define GT911_CFG_NOISE         (0x8052 - GT911_REG_CONFIG)    /* bits 0-3 */
+#define GT911_CFG_TOUCH_LEVEL   (0x8053 - GT911_REG_CONFIG)
+#define GT911_CFG_LEAVE_LEVEL   (0x8054 - GT911_REG_CONFIG)
+#define GT911_CFG_LOW_POWER     (0x8055 - GT911_REG_CONFIG)    /* bits 0-3: idle seconds before low power */
+#define GT911_CFG_REFRESH_RATE  (0x8056 - GT911_REG_CONFIG)    /* bits 0-3: report period - 5 ms */
+#define GT911_APPLY_MS          (20)
+
 static i2c_master_bus_handle_t i2c_handle = NULL;
 static bool i2c_initialized = false;
 
@@ -84,30 +100,878 @@ esp_err_t bsp_touch_new(const bsp_touch_config_t *config,
         .driver_data = &tp_gt911_config,
     };
     BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_touch_new_i2c_gt911(tp_io_handle, &tp_cfg, ret_touch));
+    if (config) {
+        BSP_ERROR_CHECK_RETURN_ERR(bsp_touch_set_config(*ret_touch, config));
+    }
+    return ESP_OK;
+}
+
+static uint8_t gt911_checksum(const uint8_t *block)
+{
+    uint8_t sum = 0;
+    for (int i = 0; i < GT911_CONFIG_LEN; i++) {
+        sum += block[i];
+    }
+    return (uint8_t)(~sum + 1);
+}
+
+/* Sets the masked bits of one register to value; returns whether it changed */
+static bool gt911_set(uint8_t *block, int offset, uint8_t mask, uint8_t value)
+{
+    const uint8_t reg = (block[offset] & ~mask) | (value & mask);
+    const bool changed = (reg != block[offset]);
+    block[offset] = reg;
+    return changed;
+}
+
+esp_err_t bsp_touch_set_config(esp_lcd_touch_handle_t tp, const bsp_touch_config_t *config)
+{
+    BSP_NULL_CHECK(tp, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(config, ESP_ERR_INVALID_ARG);
+    if ((config->report_period_ms && (config->report_period_ms < 5 || config->report_period_ms > 20)) ||
+            config->noise_reduction > 15 || config->filter > 63 || config->low_power_s > 15 ||
+            (config->touch_level && config->leave_level && config->leave_level >= config->touch_level)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!config->report_period_ms && !config->touch_level && !config->leave_level &&
+            !config->noise_reduction && !config->filter && !config->low_power_s) {
+        return ESP_OK;
+    }
+
+    uint8_t block[GT911_CONFIG_LEN + 2];
+    BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_panel_io_rx_param(tp->io, GT911_REG_CONFIG, block, GT911_CONFIG_LEN + 1));
+    if (gt911_checksum(block) != block[GT911_CONFIG_LEN]) {
+        ESP_LOGE(TAG, "GT911 config checksum mismatch — leaving it untouched");
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    bool changed = false;
+    if (config->report_period_ms) {
+        changed |= gt911_set(block, GT911_CFG_REFRESH_RATE, 0x0F, config->report_period_ms - 5);
+    }
+    if (config->touch_level) {
+        changed |= gt911_set(block, GT911_CFG_TOUCH_LEVEL, 0xFF, config->touch_level);
+    }
+    if (config->leave_level) {
+        changed |= gt911_set(block, GT911_CFG_LEAVE_LEVEL, 0xFF, config->leave_level);
+    }
+    if (config->noise_reduction) {
+        changed |= gt911_set(block, GT911_CFG_NOISE, 0x0F, config->noise_reduction);
+    }
+    if (config->filter) {
+        changed |= gt911_set(block, GT911_CFG_FILTER, 0x3F, config->filter);
+    }
+    if (config->low_power_s) {
+        changed |= gt911_set(block, GT911_CFG_LOW_POWER, 0x0F, config->low_power_s);
+    }
+    if (!changed) {
+        return ESP_OK;
+    }
+
+    /* One transfer ending with the "config fresh" flag: the GT911 takes all of it or none */
+    block[GT911_CONFIG_LEN] = gt911_checksum(block);
+    block[GT911_CONFIG_LEN + 1] = 1;
+    BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_panel_io_tx_param(tp->io, GT911_REG_CONFIG, block, sizeof(block)));
+    vTaskDelay(pdMS_TO_TICKS(GT911_APPLY_MS));
+
+    uint8_t check[GT911_CONFIG_LEN + 1];
+    BSP_ERROR_CHECK_RETURN_ERR(esp_lcd_panel_io_rx_param(tp->io, GT911_REG_CONFIG, check, sizeof(check)));
+    if (memcmp(check, block, sizeof(check)) != 0) {
+        ESP_LOGE(TAG, "GT911 config read back does not match the one written");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    ESP_LOGI(TAG, "GT911 config updated: report period %d ms, touch/leave level %d/%d, noise %d, filter %d, "
+             "low power after %d s", (block[GT911_CFG_REFRESH_RATE] & 0x0F) + 5, block[GT911_CFG_TOUCH_LEVEL],
+             block[GT911_CFG_LEAVE_LEVEL], block[GT911_CFG_NOISE] & 0x0F, block[GT911_CFG_FILTER] & 0x3F,
+             block[GT911_CFG_LOW_POWER] & 0x0F);
     return ESP_OK;
 }
 
 #if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
-#include "esp_lvgl_port.h"
+#include "freertos/queue.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
 
-/* Forward declaration — implemented in bsp_display.c */
+/* Forward declarations — implemented in bsp_display.c */
 void bsp_display_set_touch_indev(lv_indev_t *indev);
+esp_err_t bsp_display_wake(int64_t trigger_us, bool touch);
+
+#if CONFIG_BSP_TOUCH_LATENCY
+/* Forward declarations — implemented in bsp_touch_latency.c */
+void bsp_touch_lat_begin(int64_t int_time, int64_t read_time);
+void bsp_touch_lat_mark(bsp_touch_lat_stage_t stage);
+#endif
+
+#define TOUCH_TASK_STACK    (3072)
+#define GESTURE_QUEUE_LEN   (16)
+#define INJECT_QUEUE_LEN    (16)
+#define INJECT_DRAIN_MS     (200)
+#define WAKE_LIFT_POLL_MS   (20)
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    bool     pressed;
+    int64_t  int_time;      /* INT edge this sample answers, 0 if none */
+} touch_sample_t;
+
+static esp_lcd_touch_handle_t s_tp            = NULL;
+static lv_indev_t            *s_indev         = NULL;
+static TaskHandle_t           s_reader        = NULL;
+static bool                   s_irq_mode      = false;
+static bool                   s_int_ok        = false;  /* touch_isr() is registered */
+static volatile bool          s_sleeping      = false;  /* the display sleeps: a touch wakes it */
+static bool                   s_bg_read       = false;  /* reads run on s_reader, never on the LVGL task */
+static touch_sample_t         s_sample;                 /* latest sample, not yet seen by LVGL if int_time != 0 */
+static int64_t                s_int_time      = 0;      /* first INT edge not answered by a read yet */
+static bool                   s_lvgl_pressed  = false;  /* last state handed to LVGL; LVGL task only */
+static bsp_touch_stats_t      s_stats;
+static uint64_t               s_latency_total = 0;
+static uint64_t               s_i2c_wait_us   = 0;
+static uint64_t               s_lvgl_wait_us  = 0;
+static int64_t                s_stats_since   = 0;      /* time of the last statistics reset */
+static portMUX_TYPE           s_touch_lock    = portMUX_INITIALIZER_UNLOCKED;
+
+/* Gestures: s_gesture is only touched by the context running touch_fetch() */
+static bsp_gesture_t                s_gesture;
+static bsp_gesture_cfg_t            s_gesture_cfg;
+static bool                         s_gesture_on      = false;
+static volatile bool                s_gesture_enabled = false;  /* requested state */
+static volatile bool                s_gesture_restart = false;  /* s_gesture_cfg or the requested state changed */
+static QueueHandle_t                s_gesture_q       = NULL;
+static uint32_t                     s_gesture_code    = 0;
+static lv_obj_t                    *s_gesture_target  = NULL;   /* LVGL task only */
+static bsp_display_gesture_stats_t  s_gesture_stats;
+static uint64_t                     s_gesture_cycles  = 0;
+
+/* Point filter: s_filter is only touched by the context running touch_fetch() */
+static bsp_touch_filter_t           s_filter;
+static bsp_touch_filter_cfg_t       s_filter_cfg;
+static bool                         s_filter_on       = false;
+static uint8_t                      s_filter_id       = 0;      /* track ID of the filtered finger */
+static volatile bool                s_filter_enabled  = false;  /* requested state */
+static volatile bool                s_filter_restart  = false;  /* s_filter_cfg or the requested state changed */
+
+/* Sample ring: written by the context running touch_fetch(), replayed into LVGL by touch_read_cb() */
+static bsp_touch_ring_t             s_ring;
+static bool                         s_ring_on         = false;
+static uint32_t                     s_replay_cursor   = 0;      /* LVGL task only */
+static bool                         s_replay_on       = false;  /* LVGL task only */
+static bool                         s_replay_more     = false;  /* LVGL is reading back missed samples; LVGL task only */
+static volatile bool                s_replay_enabled  = false;  /* requested state */
+static volatile bool                s_replay_restart  = false;  /* the requested state changed */
+
+/* Touch player: while s_inject_on, touch_fetch() takes its samples from s_inject_q */
+static QueueHandle_t                s_inject_q        = NULL;
+static volatile bool                s_inject_on       = false;
+
+static void touch_isr(esp_lcd_touch_handle_t tp)
+{
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_ISR(&s_touch_lock);
+    s_stats.interrupts++;
+    if (!s_int_time) {
+        s_int_time = now;
+    }
+    portEXIT_CRITICAL_ISR(&s_touch_lock);
+
+    if ((s_irq_mode || s_sleeping) && s_reader) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(s_reader, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+static void gesture_queue_cb(const bsp_gesture_event_t *event, void *user_ctx)
+{
+    const bool ok = (xQueueSend(s_gesture_q, event, 0) == pdTRUE);
+    portENTER_CRITICAL(&s_touch_lock);
+    if (ok) {
+        s_gesture_stats.events++;
+    } else {
+        s_gesture_stats.dropped++;
+    }
+    portEXIT_CRITICAL(&s_touch_lock);
+}
+
+/* Sends queued gesture events to their target; LVGL task */
+static void gesture_drain_cb(const void *data, void *user_ctx)
+{
+    bsp_gesture_event_t ev;
+    while (xQueueReceive(s_gesture_q, &ev, 0) == pdTRUE) {
+        if (ev.phase == BSP_GESTURE_BEGIN) {
+            lv_obj_t *scr = lv_display_get_screen_active(lv_indev_get_display(s_indev));
+            lv_point_t pt = { .x = ev.x, .y = ev.y };
+            s_gesture_target = lv_indev_search_obj(scr, &pt);
+            if (!s_gesture_target) {
+                s_gesture_target = scr;
+            }
+            if (ev.type != BSP_GESTURE_LONG_PRESS) {
+                /* Cancel the press of the first finger, so the gesture does not click or drag too */
+                lv_indev_reset(s_indev, NULL);
+                lv_indev_wait_release(s_indev);
+            }
+        }
+        if (s_gesture_target && lv_obj_is_valid(s_gesture_target)) {
+            lv_obj_send_event(s_gesture_target, s_gesture_code, &ev);
+        }
+        if (ev.phase == BSP_GESTURE_END) {
+            s_gesture_target = NULL;
+        }
+    }
+}
+
+static void touch_gesture_feed(const esp_lcd_touch_point_data_t *pts, uint8_t count)
+{
+    const uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    if (s_gesture_restart) {
+        s_gesture_restart = false;
+        if (s_gesture_on) {
+            bsp_gesture_reset(&s_gesture, now_ms);
+        }
+        bsp_gesture_init(&s_gesture, &s_gesture_cfg, gesture_queue_cb, NULL);
+        s_gesture_on = s_gesture_enabled;
+    }
+    if (!s_gesture_on) {
+        return;
+    }
+
+    bsp_gesture_point_t points[BSP_GESTURE_MAX_POINTS];
+    for (uint8_t i = 0; i < count; i++) {
+        points[i].x = pts[i].x;
+        points[i].y = pts[i].y;
+        points[i].id = pts[i].track_id;
+    }
+
+    const uint32_t start = esp_cpu_get_cycle_count();
+    bsp_gesture_feed(&s_gesture, points, count, now_ms);
+    const uint32_t cycles = esp_cpu_get_cycle_count() - start;
+
+    portENTER_CRITICAL(&s_touch_lock);
+    s_gesture_stats.samples++;
+    s_gesture_cycles += cycles;
+    if (cycles > s_gesture_stats.cycles_max) {
+        s_gesture_stats.cycles_max = cycles;
+    }
+    portEXIT_CRITICAL(&s_touch_lock);
+
+    if (uxQueueMessagesWaiting(s_gesture_q)) {
+        bsp_display_post((uintptr_t)&s_gesture_q, gesture_drain_cb, NULL, NULL, 0);
+    }
+}
+
+/* Filters the point handed to LVGL, in place */
+static void touch_filter_point(const esp_lcd_touch_point_data_t *pt, bool pressed, uint16_t *x, uint16_t *y)
+{
+    if (s_filter_restart) {
+        s_filter_restart = false;
+        bsp_touch_filter_init(&s_filter, &s_filter_cfg);
+        s_filter_on = s_filter_enabled;
+    }
+    if (!s_filter_on) {
+        return;
+    }
+    if (!pressed) {
+        bsp_touch_filter_reset(&s_filter);
+        return;
+    }
+    if (pt->track_id != s_filter_id) {
+        /* The first finger was lifted and another one now comes first: do not blend the two */
+        bsp_touch_filter_reset(&s_filter);
+        s_filter_id = pt->track_id;
+    }
+
+    int16_t fx;
+    int16_t fy;
+    bsp_touch_filter_apply(&s_filter, pt->x, pt->y, (uint32_t)esp_timer_get_time(), &fx, &fy);
+    *x = (uint16_t)(fx < 0 ? 0 : fx >= BSP_LCD_H_RES ? BSP_LCD_H_RES - 1 : fx);
+    *y = (uint16_t)(fy < 0 ? 0 : fy >= BSP_LCD_V_RES ? BSP_LCD_V_RES - 1 : fy);
+}
+
+/* Records a sample; on release, x and y are the last pressed position handed to LVGL */
+static void touch_ring_push(const esp_lcd_touch_point_data_t *pts, uint8_t count, uint16_t x, uint16_t y,
+                            int64_t time_us)
+{
+    bsp_touch_sample_t smp = {
+        .time_us = time_us,
+        .x = count ? x : s_sample.x,
+        .y = count ? y : s_sample.y,
+        .count = count,
+    };
+    for (uint8_t i = 0; i < count; i++) {
+        smp.points[i].x = pts[i].x;
+        smp.points[i].y = pts[i].y;
+        smp.points[i].strength = pts[i].strength;
+        smp.points[i].id = pts[i].track_id;
+    }
+    bsp_touch_ring_push(&s_ring, &smp);
+}
+
+/* Hands one report to the filter, the ring, s_sample and the gestures; returns whether a finger is down */
+static bool touch_process(const esp_lcd_touch_point_data_t *pts, uint8_t count, int64_t int_time, int64_t time_us)
+{
+    const bool pressed = count > 0;
+    uint16_t x = pressed ? pts[0].x : 0;
+    uint16_t y = pressed ? pts[0].y : 0;
+    touch_filter_point(&pts[0], pressed, &x, &y);
+
+#if CONFIG_BSP_TOUCH_LATENCY
+    if (pressed && !s_sample.pressed && int_time) {
+        bsp_touch_lat_begin(int_time, esp_timer_get_time());
+    }
+#endif
+
+    if (s_ring_on && (pressed || s_sample.pressed)) {
+        touch_ring_push(pts, count, x, y, time_us);
+    }
+
+    portENTER_CRITICAL(&s_touch_lock);
+    if (pressed) {
+        s_sample.x = x;
+        s_sample.y = y;
+    }
+    s_sample.pressed = pressed;
+    /* Keep the oldest unanswered edge if LVGL has not consumed the previous sample */
+    if (int_time && (!s_sample.int_time || int_time < s_sample.int_time)) {
+        s_sample.int_time = int_time;
+    }
+    portEXIT_CRITICAL(&s_touch_lock);
+
+    if (s_gesture_q) {
+        touch_gesture_feed(pts, count);
+    }
+    return pressed;
+}
+
+/* Takes the samples queued by the touch player instead of reading the controller */
+static bool touch_fetch_injected(void)
+{
+    portENTER_CRITICAL(&s_touch_lock);
+    s_int_time = 0;                 /* edges of the real panel answer nothing during playback */
+    portEXIT_CRITICAL(&s_touch_lock);
+
+    bool pressed = s_sample.pressed;
+    bsp_touch_sample_t smp;
+    while (xQueueReceive(s_inject_q, &smp, 0) == pdTRUE) {
+        esp_lcd_touch_point_data_t pts[BSP_TOUCH_RING_MAX_POINTS] = {0};
+        for (uint8_t i = 0; i < smp.count; i++) {
+            pts[i].x = smp.points[i].x;
+            pts[i].y = smp.points[i].y;
+            pts[i].strength = smp.points[i].strength;
+            pts[i].track_id = smp.points[i].id;
+        }
+        pressed = touch_process(pts, smp.count, 0, esp_timer_get_time());
+    }
+    return pressed;
+}
+
+/* Reads the controller over I2C into s_sample; returns whether a finger is down */
+static bool touch_fetch(void)
+{
+    if (s_inject_on) {
+        return touch_fetch_injected();
+    }
+
+    portENTER_CRITICAL(&s_touch_lock);
+    const int64_t int_time = s_int_time;
+    s_int_time = 0;
+    portEXIT_CRITICAL(&s_touch_lock);
+
+    esp_lcd_touch_point_data_t pts[BSP_GESTURE_MAX_POINTS];
+    uint8_t count = 0;
+    const int64_t read_start = esp_timer_get_time();
+    esp_lcd_touch_read_data(s_tp);
+    const uint32_t wait_us = (uint32_t)(esp_timer_get_time() - read_start);
+    if (esp_lcd_touch_get_data(s_tp, pts, &count, BSP_GESTURE_MAX_POINTS) != ESP_OK) {
+        count = 0;
+    }
+    const bool was_pressed = s_sample.pressed;
+    const bool pressed = touch_process(pts, count, int_time, int_time ? int_time : read_start);
+
+    portENTER_CRITICAL(&s_touch_lock);
+    s_stats.i2c_reads++;
+    s_i2c_wait_us += wait_us;
+    if (!s_bg_read) {
+        s_lvgl_wait_us += wait_us;
+    }
+    if (!pressed && !was_pressed) {
+        s_stats.idle_reads++;
+    }
+    portEXIT_CRITICAL(&s_touch_lock);
+    return pressed;
+}
+
+/*
+ * Takes the next recorded sample LVGL has not seen into *sample; false when replay is off or LVGL is up
+ * to date. Sets *more if further samples are waiting.
+ */
+static bool touch_replay_next(touch_sample_t *sample, bool *more)
+{
+    if (s_replay_restart) {
+        s_replay_restart = false;
+        s_replay_on = s_replay_enabled;
+        s_replay_cursor = bsp_touch_ring_head(&s_ring);
+    }
+    if (!s_replay_on) {
+        return false;
+    }
+
+    bsp_touch_sample_t smp;
+    uint32_t lost = 0;
+    const size_t n = bsp_touch_ring_read(&s_ring, &s_replay_cursor, &smp, 1, &lost);
+    if (lost) {
+        portENTER_CRITICAL(&s_touch_lock);
+        s_stats.samples_lost += lost;
+        portEXIT_CRITICAL(&s_touch_lock);
+    }
+    if (n == 0) {
+        return false;
+    }
+    sample->x = smp.x;
+    sample->y = smp.y;
+    sample->pressed = smp.count > 0;
+    *more = (s_replay_cursor != bsp_touch_ring_head(&s_ring));
+    return true;
+}
+
+static void touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    if (!s_bg_read && !s_replay_more) {
+        touch_fetch();
+    }
+
+    portENTER_CRITICAL(&s_touch_lock);
+    touch_sample_t sample = s_sample;
+    s_sample.int_time = 0;
+    s_stats.samples++;
+    if (sample.int_time) {
+        const uint32_t us = (uint32_t)(esp_timer_get_time() - sample.int_time);
+        s_stats.latency_samples++;
+        s_latency_total += us;
+        if (us > s_stats.latency_max_us) {
+            s_stats.latency_max_us = us;
+        }
+    }
+    portEXIT_CRITICAL(&s_touch_lock);
+
+    /* With replay, LVGL calls back at once for each sample it missed since its last read */
+    bool more = false;
+    if (s_ring_on && touch_replay_next(&sample, &more)) {
+        data->continue_reading = more;
+    }
+    s_replay_more = more;
+
+#if CONFIG_BSP_TOUCH_LATENCY
+    if (sample.pressed && !s_lvgl_pressed) {
+        bsp_touch_lat_mark(BSP_TOUCH_LAT_STAGE_DISPATCH);
+    }
+#endif
+    s_lvgl_pressed = sample.pressed;
+
+    data->point.x = sample.x;
+    data->point.y = sample.y;
+    data->state = sample.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+#if CONFIG_BSP_TOUCH_BACKGROUND_READ
+static void touch_dispatch_cb(const void *data, void *user_ctx)
+{
+    lv_indev_read(s_indev);
+}
+
+static void touch_dispatch(void)
+{
+    /* Dispatch now if LVGL is idle, else right before its next refresh: never wait for a render */
+    if (bsp_display_lock(1)) {
+        lv_indev_read(s_indev);
+        bsp_display_unlock();
+    } else {
+        bsp_display_post((uintptr_t)s_indev, touch_dispatch_cb, NULL, NULL, 0);
+    }
+}
+
+#if CONFIG_BSP_TOUCH_WAKE
+/* Reads the controller without handing the points on; returns whether a finger is down */
+static bool touch_peek(void)
+{
+    esp_lcd_touch_point_data_t pts[BSP_GESTURE_MAX_POINTS];
+    uint8_t count = 0;
+    const int64_t read_start = esp_timer_get_time();
+    esp_lcd_touch_read_data(s_tp);
+    const uint32_t wait_us = (uint32_t)(esp_timer_get_time() - read_start);
+    if (esp_lcd_touch_get_data(s_tp, pts, &count, BSP_GESTURE_MAX_POINTS) != ESP_OK) {
+        count = 0;
+    }
+
+    portENTER_CRITICAL(&s_touch_lock);
+    s_stats.i2c_reads++;
+    s_i2c_wait_us += wait_us;
+    if (!count) {
+        s_stats.idle_reads++;
+    }
+    portEXIT_CRITICAL(&s_touch_lock);
+    return count > 0;
+}
+
+/*
+ * Runs while the display sleeps. Waits for a finger to land and wakes the display; nothing reaches LVGL
+ * until that finger lifts, so it does not click the UI it woke. With INT the controller is only read
+ * when it signals, else it is polled slowly. A finger already down when the display went to sleep must
+ * lift before a touch can wake it.
+ */
+static void touch_sleep(bool pressed)
+{
+    if (pressed) {
+        const esp_lcd_touch_point_data_t none[1] = {0};
+        touch_process(none, 0, 0, esp_timer_get_time());
+        touch_dispatch();
+    }
+
+    bool armed = false;
+    while (s_sleeping) {
+        const TickType_t wait = (s_int_ok && armed) ? portMAX_DELAY : pdMS_TO_TICKS(CONFIG_BSP_TOUCH_WAKE_POLL_MS);
+        ulTaskNotifyTake(pdTRUE, wait);
+        portENTER_CRITICAL(&s_touch_lock);
+        const int64_t int_time = s_int_time;
+        s_int_time = 0;
+        portEXIT_CRITICAL(&s_touch_lock);
+        if (!s_sleeping) {
+            break;
+        }
+        if (!touch_peek()) {
+            armed = true;
+            continue;
+        }
+        if (!armed) {
+            continue;
+        }
+
+        armed = false;
+        if (bsp_display_wake(int_time ? int_time : esp_timer_get_time(), true) != ESP_OK) {
+            continue;   /* try again at the next touch */
+        }
+        while (touch_peek()) {
+            vTaskDelay(pdMS_TO_TICKS(WAKE_LIFT_POLL_MS));
+        }
+        armed = true;
+    }
+
+    portENTER_CRITICAL(&s_touch_lock);
+    s_int_time = 0;                 /* the edges of the waking touch answer nothing */
+    portEXIT_CRITICAL(&s_touch_lock);
+}
+#endif
+
+/*
+ * Reads the GT911 so the LVGL task never waits on I2C, and hands every
+ * completed sample to LVGL. Interrupt mode sleeps until the GT911 signals new
+ * data, and only polls while a finger is down so a lost release edge cannot
+ * leave a stuck press; otherwise the controller is polled.
+ */
+static void touch_reader_task(void *arg)
+{
+    bool pressed = false;
+    while (1) {
+#if CONFIG_BSP_TOUCH_WAKE
+        if (s_sleeping) {
+            touch_sleep(pressed);
+            pressed = false;
+            continue;
+        }
+#endif
+        TickType_t wait = pdMS_TO_TICKS(CONFIG_BSP_TOUCH_POLL_MS);
+#if CONFIG_BSP_TOUCH_INTERRUPT
+        if (s_irq_mode) {
+            wait = pressed ? pdMS_TO_TICKS(CONFIG_BSP_TOUCH_PRESSED_POLL_MS) : portMAX_DELAY;
+        }
+#endif
+        ulTaskNotifyTake(pdTRUE, wait);
+        const bool was_pressed = pressed;
+        pressed = touch_fetch();
+        if (!pressed && !was_pressed && !s_irq_mode) {
+            continue;   /* idle poll: nothing for LVGL */
+        }
+        touch_dispatch();
+    }
+}
+#endif // CONFIG_BSP_TOUCH_BACKGROUND_READ
 
 esp_err_t bsp_display_indev_init(lv_display_t *disp)
 {
-    esp_lcd_touch_handle_t tp = NULL;
-    const bsp_touch_config_t tp_cfg = { .dummy = NULL };
-    BSP_ERROR_CHECK_RETURN_ERR(bsp_touch_new(&tp_cfg, &tp));
+    const bsp_touch_config_t tp_cfg = {
+        .dummy            = NULL,
+#if CONFIG_BSP_TOUCH_SET_REPORT_PERIOD
+        .report_period_ms = CONFIG_BSP_TOUCH_REPORT_PERIOD_MS,
+#endif
+        .low_power_s      = CONFIG_BSP_TOUCH_LOW_POWER_S,
+    };
+    BSP_ERROR_CHECK_RETURN_ERR(bsp_touch_new(&tp_cfg, &s_tp));
+
+    /* INT edges are timestamped in both modes, for the latency statistics */
+    const bool irq = (esp_lcd_touch_register_interrupt_callback(s_tp, touch_isr) == ESP_OK);
+    s_int_ok = irq;
+    if (!irq) {
+        ESP_LOGW(TAG, "Touch INT not available — polling, no latency statistics");
+    }
+
+    if (!bsp_display_lock(0)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    s_indev = lv_indev_create();
+    if (s_indev) {
+        lv_indev_set_type(s_indev, LV_INDEV_TYPE_POINTER);
+        lv_indev_set_read_cb(s_indev, touch_read_cb);
+        lv_indev_set_display(s_indev, disp);
+    }
+    bsp_display_unlock();
+    BSP_NULL_CHECK(s_indev, ESP_ERR_NO_MEM);
 
-    const lvgl_port_touch_cfg_t touch_cfg = {
-        .disp    = disp,
-        .handle  = tp,
+#if CONFIG_BSP_TOUCH_SAMPLE_RING
+    /* Before the reader task starts: s_ring_on never changes under a running touch_fetch() */
+    uint32_t ring_len = 1;
+    while (ring_len < CONFIG_BSP_TOUCH_SAMPLE_RING_LEN) {
+        ring_len <<= 1;
+    }
+    bsp_touch_slot_t *slots = heap_caps_calloc(ring_len, sizeof(bsp_touch_slot_t), MALLOC_CAP_DEFAULT);
+    if (slots) {
+        bsp_touch_ring_init(&s_ring, slots, ring_len);
+        s_ring_on = true;
+#if CONFIG_BSP_TOUCH_SAMPLE_REPLAY
+        s_replay_enabled = true;
+        s_replay_restart = true;
+#endif
+    } else {
+        ESP_LOGW(TAG, "Touch sample ring unavailable — LVGL only sees the latest sample");
+    }
+#endif
+
+#if CONFIG_BSP_TOUCH_BACKGROUND_READ
+#if CONFIG_BSP_TOUCH_INTERRUPT
+    s_irq_mode = irq;
+    if (!irq) {
+        ESP_LOGW(TAG, "Interrupt-driven touch unavailable — falling back to polling");
+    }
+#endif
+    /* Set first: from now on only the reader task may run touch_fetch() */
+    s_bg_read = true;
+    if (xTaskCreate(touch_reader_task, "bsp_touch", TOUCH_TASK_STACK, NULL,
+                    CONFIG_BSP_TOUCH_TASK_PRIORITY, &s_reader) == pdPASS) {
+        bsp_display_lock(0);
+        lv_indev_set_mode(s_indev, LV_INDEV_MODE_EVENT);
+        bsp_display_unlock();
+    } else {
+        s_bg_read = false;
+        s_irq_mode = false;
+        ESP_LOGW(TAG, "Touch reader task unavailable — reading from the LVGL task");
+    }
+#endif
+    s_stats.interrupt_mode = s_irq_mode;
+    s_stats.background_read = s_bg_read;
+    s_stats_since = esp_timer_get_time();
+
+#if CONFIG_BSP_TOUCH_FILTER
+    const bsp_touch_filter_cfg_t filter_cfg = {
+        .min_cutoff_mhz = CONFIG_BSP_TOUCH_FILTER_MIN_CUTOFF_MHZ,
+        .beta           = CONFIG_BSP_TOUCH_FILTER_BETA,
+        .predict_ms     = CONFIG_BSP_TOUCH_FILTER_PREDICT_MS,
     };
-    lv_indev_t *indev = lvgl_port_add_touch(&touch_cfg);
-    BSP_NULL_CHECK(indev, ESP_FAIL);
+    bsp_display_touch_filter_enable(&filter_cfg);
+#endif
 
     /* Store in bsp_display.c's s_touch_indev via the setter */
-    bsp_display_set_touch_indev(indev);
+    bsp_display_set_touch_indev(s_indev);
+    return ESP_OK;
+}
+
+esp_err_t bsp_touch_get_stats(bsp_touch_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_indev) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_touch_lock);
+    *stats = s_stats;
+    stats->latency_avg_us = s_stats.latency_samples ? (uint32_t)(s_latency_total / s_stats.latency_samples) : 0;
+    const uint64_t window_us = (uint64_t)(now - s_stats_since);
+    if (window_us) {
+        stats->i2c_wait_us_per_s  = (uint32_t)(s_i2c_wait_us * 1000000 / window_us);
+        stats->lvgl_wait_us_per_s = (uint32_t)(s_lvgl_wait_us * 1000000 / window_us);
+    }
+    portEXIT_CRITICAL(&s_touch_lock);
+    return ESP_OK;
+}
+
+void bsp_touch_reset_stats(void)
+{
+    portENTER_CRITICAL(&s_touch_lock);
+    const bool interrupt_mode = s_stats.interrupt_mode;
+    const bool background_read = s_stats.background_read;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.interrupt_mode = interrupt_mode;
+    s_stats.background_read = background_read;
+    s_latency_total = 0;
+    s_i2c_wait_us = 0;
+    s_lvgl_wait_us = 0;
+    s_stats_since = esp_timer_get_time();
+    portEXIT_CRITICAL(&s_touch_lock);
+}
+
+esp_err_t bsp_display_gesture_enable(const bsp_gesture_cfg_t *cfg)
+{
+    BSP_NULL_CHECK(s_indev, ESP_ERR_INVALID_STATE);
+    if (!s_gesture_q) {
+        s_gesture_q = xQueueCreate(GESTURE_QUEUE_LEN, sizeof(bsp_gesture_event_t));
+        BSP_NULL_CHECK(s_gesture_q, ESP_ERR_NO_MEM);
+        s_gesture_code = lv_event_register_id();
+    }
+
+    /* Applied by touch_fetch(), so the recognizer is never re-initialized under a running feed */
+    if (cfg) {
+        s_gesture_cfg = *cfg;
+    } else {
+        memset(&s_gesture_cfg, 0, sizeof(s_gesture_cfg));
+    }
+    s_gesture_enabled = true;
+    s_gesture_restart = true;
+    return ESP_OK;
+}
+
+void bsp_display_gesture_disable(void)
+{
+    s_gesture_enabled = false;
+    s_gesture_restart = true;
+}
+
+uint32_t bsp_display_gesture_event_code(void)
+{
+    return s_gesture_code;
+}
+
+esp_err_t bsp_display_touch_set_config(const bsp_touch_config_t *config)
+{
+    BSP_NULL_CHECK(s_tp, ESP_ERR_INVALID_STATE);
+    return bsp_touch_set_config(s_tp, config);
+}
+
+esp_err_t bsp_display_touch_filter_enable(const bsp_touch_filter_cfg_t *cfg)
+{
+    BSP_NULL_CHECK(s_indev, ESP_ERR_INVALID_STATE);
+
+    /* Applied by touch_fetch(), so the filter is never re-initialized under a running sample */
+    if (cfg) {
+        s_filter_cfg = *cfg;
+    } else {
+        memset(&s_filter_cfg, 0, sizeof(s_filter_cfg));
+    }
+    s_filter_enabled = true;
+    s_filter_restart = true;
+    return ESP_OK;
+}
+
+void bsp_display_touch_filter_disable(void)
+{
+    s_filter_enabled = false;
+    s_filter_restart = true;
+}
+
+esp_err_t bsp_display_touch_read_samples(uint32_t *cursor, bsp_touch_sample_t *samples, size_t max,
+                                         size_t *count, uint32_t *lost)
+{
+    if (!cursor || !samples || !count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_ring_on) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *count = bsp_touch_ring_read(&s_ring, cursor, samples, max, lost);
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_touch_replay_enable(void)
+{
+    if (!s_ring_on) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    /* Applied by touch_read_cb(), which owns the replay cursor */
+    s_replay_enabled = true;
+    s_replay_restart = true;
+    return ESP_OK;
+}
+
+void bsp_display_touch_replay_disable(void)
+{
+    s_replay_enabled = false;
+    s_replay_restart = true;
+}
+
+bool bsp_touch_set_sleep(bool sleep)
+{
+#if CONFIG_BSP_TOUCH_WAKE
+    if (!s_reader) {
+        return false;
+    }
+    /* The reader task switches between serving LVGL and waiting for a waking touch */
+    s_sleeping = sleep;
+    xTaskNotifyGive(s_reader);
+    return true;
+#else
+    return false;
+#endif
+}
+
+const bsp_touch_ring_t *bsp_touch_get_ring(void)
+{
+    return s_ring_on ? &s_ring : NULL;
+}
+
+esp_err_t bsp_touch_inject_start(void)
+{
+    BSP_NULL_CHECK(s_indev, ESP_ERR_INVALID_STATE);
+    if (!s_inject_q) {
+        s_inject_q = xQueueCreate(INJECT_QUEUE_LEN, sizeof(bsp_touch_sample_t));
+        BSP_NULL_CHECK(s_inject_q, ESP_ERR_NO_MEM);
+    }
+    xQueueReset(s_inject_q);
+    s_inject_on = true;
+    return ESP_OK;
+}
+
+bool bsp_touch_inject(const bsp_touch_sample_t *sample, TickType_t wait)
+{
+    if (xQueueSend(s_inject_q, sample, wait) != pdTRUE) {
+        return false;
+    }
+    /* Read at once, like an INT edge; without the reader task LVGL takes it at its next read */
+    if (s_reader) {
+        xTaskNotifyGive(s_reader);
+    }
+    return true;
+}
+
+void bsp_touch_inject_stop(void)
+{
+    /* Leave the player's last samples to touch_fetch() before the real reads resume */
+    for (int i = 0; i < INJECT_DRAIN_MS / 10 && uxQueueMessagesWaiting(s_inject_q); i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    s_inject_on = false;
+}
+
+esp_err_t bsp_display_gesture_get_stats(bsp_display_gesture_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_touch_lock);
+    *stats = s_gesture_stats;
+    stats->cycles_avg = s_gesture_stats.samples ? (uint32_t)(s_gesture_cycles / s_gesture_stats.samples) : 0;
+    portEXIT_CRITICAL(&s_touch_lock);
     return ESP_OK;
 }
 #endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
@@ -0,0 +1,172 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Touch point filter — core.
+ *
+ * 1-euro filter (Casiez et al.) in fixed point: positions in 1/16 px, speeds
+ * in 1/16 px/s, cutoffs in mHz. The cutoff follows the speed magnitude, so
+ * both axes are smoothed alike. No ESP-IDF includes, so traces can be
+ * replayed on the host; the LVGL glue lives in bsp_touch.c.
+ */
+#include <string.h>
+#include "bsp/touch_filter.h"
+
+#define FILTER_DEF_MIN_CUTOFF_MHZ   (1500)
+#define FILTER_DEF_BETA             (20)
+#define FILTER_DEF_D_CUTOFF_MHZ     (2000)
+#define FILTER_DEF_PREDICT_MAX_PX   (24)
+
+#define FILTER_MAX_DT_US            (100000)    /* longer gaps are treated as this long */
+#define FILTER_PREDICT_FROM_PXS     (60)        /* no prediction below this speed, whose estimate is mostly noise */
+#define FILTER_PREDICT_FULL_PXS     (240)       /* full prediction from this speed */
+#define FILTER_MAX_SPEED_Q4         (100000000) /* 6250 px/ms, keeps the fixed-point math in range */
+
+static uint32_t isqrt64(uint64_t v)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+/*
+ * Smoothing factor of a first-order low-pass with cutoff fc for a step dt, Q16:
+ * alpha = 1 / (1 + tau / dt), tau = 1 / (2 pi fc)  =>  alpha = k / (k + 1), k = 2 pi fc dt
+ */
+static uint32_t filter_alpha_q16(uint32_t fc_mhz, uint32_t dt_us)
+{
+    /* k scaled by 1e9 (mHz * us) */
+    const uint64_t k = (uint64_t)fc_mhz * dt_us * 6283 / 1000;
+    if (k >= 1000000000000ULL) {
+        return 65536;
+    }
+    return (uint32_t)((k << 16) / (k + 1000000000ULL));
+}
+
+static inline int32_t clamp_speed(int64_t v)
+{
+    if (v > FILTER_MAX_SPEED_Q4) {
+        return FILTER_MAX_SPEED_Q4;
+    }
+    if (v < -FILTER_MAX_SPEED_Q4) {
+        return -FILTER_MAX_SPEED_Q4;
+    }
+    return (int32_t)v;
+}
+
+static inline int32_t lowpass(int32_t prev, int32_t value, uint32_t alpha_q16)
+{
+    return prev + (int32_t)(((int64_t)(value - prev) * alpha_q16) >> 16);
+}
+
+/* 1/16 px to px, rounded to nearest */
+static inline int16_t q4_to_px(int32_t v)
+{
+    return (int16_t)((v + (v >= 0 ? 8 : -8)) / 16);
+}
+
+void bsp_touch_filter_init(bsp_touch_filter_t *f, const bsp_touch_filter_cfg_t *cfg)
+{
+    memset(f, 0, sizeof(*f));
+    if (cfg) {
+        f->cfg = *cfg;
+    }
+    if (!f->cfg.min_cutoff_mhz) {
+        f->cfg.min_cutoff_mhz = FILTER_DEF_MIN_CUTOFF_MHZ;
+    }
+    if (!f->cfg.beta) {
+        f->cfg.beta = FILTER_DEF_BETA;
+    }
+    if (!f->cfg.d_cutoff_mhz) {
+        f->cfg.d_cutoff_mhz = FILTER_DEF_D_CUTOFF_MHZ;
+    }
+    if (!f->cfg.predict_max_px) {
+        f->cfg.predict_max_px = FILTER_DEF_PREDICT_MAX_PX;
+    }
+}
+
+void bsp_touch_filter_apply(bsp_touch_filter_t *f, int16_t x, int16_t y, uint32_t time_us,
+                            int16_t *out_x, int16_t *out_y)
+{
+    const int32_t x_q4 = (int32_t)x * 16;
+    const int32_t y_q4 = (int32_t)y * 16;
+
+    if (!f->active) {
+        f->active = true;
+        f->time_us = time_us;
+        f->x_q4 = x_q4;
+        f->y_q4 = y_q4;
+        f->vx_q4 = 0;
+        f->vy_q4 = 0;
+        f->speed_pxs = 0;
+        *out_x = x;
+        *out_y = y;
+        return;
+    }
+
+    uint32_t dt_us = time_us - f->time_us;
+    if (dt_us) {
+        f->time_us = time_us;
+        if (dt_us > FILTER_MAX_DT_US) {
+            dt_us = FILTER_MAX_DT_US;
+        }
+
+        /* Speed of the raw sample relative to the previous estimate, smoothed at the fixed cutoff */
+        const uint32_t alpha_d = filter_alpha_q16(f->cfg.d_cutoff_mhz, dt_us);
+        const int32_t raw_vx = clamp_speed((int64_t)(x_q4 - f->x_q4) * 1000000 / dt_us);
+        const int32_t raw_vy = clamp_speed((int64_t)(y_q4 - f->y_q4) * 1000000 / dt_us);
+        f->vx_q4 = lowpass(f->vx_q4, raw_vx, alpha_d);
+        f->vy_q4 = lowpass(f->vy_q4, raw_vy, alpha_d);
+
+        /* Cutoff rises with the speed: smooth at rest, responsive when moving */
+        const uint64_t v2 = (uint64_t)((int64_t)f->vx_q4 * f->vx_q4 + (int64_t)f->vy_q4 * f->vy_q4);
+        f->speed_pxs = isqrt64(v2) / 16;
+        const uint64_t fc_mhz = f->cfg.min_cutoff_mhz + (uint64_t)f->cfg.beta * f->speed_pxs;
+        const uint32_t alpha = filter_alpha_q16(fc_mhz > UINT32_MAX ? UINT32_MAX : (uint32_t)fc_mhz, dt_us);
+        f->x_q4 = lowpass(f->x_q4, x_q4, alpha);
+        f->y_q4 = lowpass(f->y_q4, y_q4, alpha);
+    }
+
+    int32_t px = f->x_q4;
+    int32_t py = f->y_q4;
+    const uint32_t speed = f->speed_pxs;
+    if (f->cfg.predict_ms && speed > FILTER_PREDICT_FROM_PXS) {
+        /* Fade the prediction in with the speed, so resting jitter is not extrapolated */
+        int64_t ms_q8 = (int64_t)f->cfg.predict_ms * 256;
+        if (speed < FILTER_PREDICT_FULL_PXS) {
+            ms_q8 = ms_q8 * (speed - FILTER_PREDICT_FROM_PXS) / (FILTER_PREDICT_FULL_PXS - FILTER_PREDICT_FROM_PXS);
+        }
+        int32_t ox = (int32_t)((int64_t)f->vx_q4 * ms_q8 / 256000);
+        int32_t oy = (int32_t)((int64_t)f->vy_q4 * ms_q8 / 256000);
+        const uint32_t len = isqrt64((uint64_t)((int64_t)ox * ox + (int64_t)oy * oy));
+        const uint32_t max = (uint32_t)f->cfg.predict_max_px * 16;
+        if (len > max) {
+            ox = (int32_t)((int64_t)ox * max / len);
+            oy = (int32_t)((int64_t)oy * max / len);
+        }
+        px += ox;
+        py += oy;
+    }
+    *out_x = q4_to_px(px);
+    *out_y = q4_to_px(py);
+}
+
+void bsp_touch_filter_reset(bsp_touch_filter_t *f)
+{
+    f->active = false;
+}
@@ -0,0 +1,230 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Touch-to-photon latency harness (CONFIG_BSP_TOUCH_LATENCY).
+ *
+ * One landing is followed at a time. bsp_touch.c starts it when a read finds
+ * a finger that was not down before, giving the INT edge and read times; the
+ * flush callback and the vsync interrupt then mark the later stages, each one
+ * accepted only right after the previous one. A landing that is still in
+ * flight when the next one starts (nothing was redrawn) counts as dropped.
+ *
+ * The vsync mark runs in IRAM and only stores a timestamp: complete
+ * measurements are moved into the sample ring later, from task context.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+
+#if CONFIG_BSP_TOUCH_LATENCY
+
+#define LAT_SAMPLES     CONFIG_BSP_TOUCH_LATENCY_SAMPLES
+#define LAT_DELTAS      (BSP_TOUCH_LAT_STAGE_MAX - 1)   /* every stage but the INT origin */
+
+static const char *const s_stage_names[BSP_TOUCH_LAT_STAGE_MAX] = {
+    [BSP_TOUCH_LAT_STAGE_INT]      = "int",
+    [BSP_TOUCH_LAT_STAGE_I2C]      = "i2c",
+    [BSP_TOUCH_LAT_STAGE_DISPATCH] = "dispatch",
+    [BSP_TOUCH_LAT_STAGE_RENDER]   = "render",
+    [BSP_TOUCH_LAT_STAGE_SWAP]     = "swap",
+    [BSP_TOUCH_LAT_STAGE_VSYNC]    = "vsync",
+};
+
+/* Landing in flight; s_next == BSP_TOUCH_LAT_STAGE_MAX means complete, waiting to be committed */
+static int64_t                        s_t[BSP_TOUCH_LAT_STAGE_MAX];
+static volatile bsp_touch_lat_stage_t s_next    = BSP_TOUCH_LAT_STAGE_INT;
+static portMUX_TYPE                   s_lat_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Committed measurements: LAT_DELTAS times per sample, relative to the INT edge; under s_lat_lock */
+static uint32_t (*s_ring)[LAT_DELTAS] = NULL;
+static uint32_t  s_head    = 0;
+static uint32_t  s_count   = 0;
+static uint32_t  s_dropped = 0;
+
+/* Moves a complete measurement into the ring; task context only */
+static void lat_commit(void)
+{
+    int64_t t[BSP_TOUCH_LAT_STAGE_MAX];
+    bool complete = false;
+
+    portENTER_CRITICAL(&s_lat_lock);
+    if (s_next == BSP_TOUCH_LAT_STAGE_MAX) {
+        memcpy(t, s_t, sizeof(t));
+        s_next = BSP_TOUCH_LAT_STAGE_INT;
+        complete = true;
+    }
+    portEXIT_CRITICAL(&s_lat_lock);
+
+    if (!complete) {
+        return;
+    }
+    if (!s_ring) {
+        /* Allocated outside the critical section; a concurrent commit may install its ring first */
+        uint32_t (*ring)[LAT_DELTAS] = heap_caps_calloc(LAT_SAMPLES, sizeof(ring[0]), MALLOC_CAP_DEFAULT);
+        if (!ring) {
+            return;
+        }
+        portENTER_CRITICAL(&s_lat_lock);
+        if (!s_ring) {
+            s_ring = ring;
+            ring = NULL;
+        }
+        portEXIT_CRITICAL(&s_lat_lock);
+        heap_caps_free(ring);
+    }
+
+    uint32_t row[LAT_DELTAS];
+    for (int i = 0; i < LAT_DELTAS; i++) {
+        row[i] = (uint32_t)(t[i + 1] - t[BSP_TOUCH_LAT_STAGE_INT]);
+    }
+    portENTER_CRITICAL(&s_lat_lock);
+    memcpy(s_ring[s_head], row, sizeof(row));
+    s_head = (s_head + 1) % LAT_SAMPLES;
+    if (s_count < LAT_SAMPLES) {
+        s_count++;
+    }
+    portEXIT_CRITICAL(&s_lat_lock);
+}
+
+/* Called by bsp_touch.c when a read finds a finger landing */
+void bsp_touch_lat_begin(int64_t int_time, int64_t read_time)
+{
+    lat_commit();
+
+    portENTER_CRITICAL(&s_lat_lock);
+    if (s_next != BSP_TOUCH_LAT_STAGE_INT) {
+        s_dropped++;
+    }
+    s_t[BSP_TOUCH_LAT_STAGE_INT] = int_time;
+    s_t[BSP_TOUCH_LAT_STAGE_I2C] = read_time;
+    s_next = BSP_TOUCH_LAT_STAGE_DISPATCH;
+    portEXIT_CRITICAL(&s_lat_lock);
+}
+
+/* Called from the LVGL task and from the vsync interrupt */
+IRAM_ATTR void bsp_touch_lat_mark(bsp_touch_lat_stage_t stage)
+{
+    if (s_next != stage) {
+        return;
+    }
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_SAFE(&s_lat_lock);
+    if (s_next == stage) {
+        s_t[stage] = now;
+        s_next = stage + 1;
+    }
+    portEXIT_CRITICAL_SAFE(&s_lat_lock);
+}
+
+static int u32_cmp(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+esp_err_t bsp_touch_latency_get_report(bsp_touch_lat_report_t *report)
+{
+    if (!report) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    lat_commit();
+
+    memset(report, 0, sizeof(*report));
+    portENTER_CRITICAL(&s_lat_lock);
+    uint32_t count = s_count;
+    report->dropped = s_dropped;
+    portEXIT_CRITICAL(&s_lat_lock);
+    if (!count) {
+        return ESP_OK;
+    }
+
+    /* Snapshot the ring under the lock, sort outside of it */
+    uint32_t (*rows)[LAT_DELTAS] = malloc(count * sizeof(rows[0]));
+    uint32_t *sorted = malloc(count * sizeof(uint32_t));
+    if (!rows || !sorted) {
+        free(rows);
+        free(sorted);
+        return ESP_ERR_NO_MEM;
+    }
+    portENTER_CRITICAL(&s_lat_lock);
+    if (s_count < count) {
+        count = s_count;            /* a reset emptied the ring since */
+    }
+    memcpy(rows, s_ring, count * sizeof(rows[0]));
+    portEXIT_CRITICAL(&s_lat_lock);
+
+    report->samples = count;
+    for (int i = 0; i < LAT_DELTAS && count; i++) {
+        for (uint32_t n = 0; n < count; n++) {
+            sorted[n] = rows[n][i];
+        }
+        qsort(sorted, count, sizeof(uint32_t), u32_cmp);
+
+        const int stage = i + 1;
+        report->p50_us[stage] = sorted[(count - 1) * 50 / 100];
+        report->p90_us[stage] = sorted[(count - 1) * 90 / 100];
+        report->p99_us[stage] = sorted[(count - 1) * 99 / 100];
+        report->max_us[stage] = sorted[count - 1];
+    }
+    free(rows);
+    free(sorted);
+    return ESP_OK;
+}
+
+void bsp_touch_latency_print_report(void)
+{
+    bsp_touch_lat_report_t r;
+    if (bsp_touch_latency_get_report(&r) != ESP_OK) {
+        return;
+    }
+
+    for (int stage = BSP_TOUCH_LAT_STAGE_I2C; stage < BSP_TOUCH_LAT_STAGE_MAX; stage++) {
+        printf("TOUCH_LAT stage=%s samples=%" PRIu32 " p50_us=%" PRIu32 " p90_us=%" PRIu32 " p99_us=%" PRIu32
+               " max_us=%" PRIu32 "\n", s_stage_names[stage], r.samples, r.p50_us[stage], r.p90_us[stage],
+               r.p99_us[stage], r.max_us[stage]);
+    }
+    printf("TOUCH_LAT_SUMMARY samples=%" PRIu32 " dropped=%" PRIu32 "\n", r.samples, r.dropped);
+}
+
+void bsp_touch_latency_reset(void)
+{
+    portENTER_CRITICAL(&s_lat_lock);
+    s_next    = BSP_TOUCH_LAT_STAGE_INT;
+    s_head    = 0;
+    s_count   = 0;
+    s_dropped = 0;
+    portEXIT_CRITICAL(&s_lat_lock);
+}
+
+#else // CONFIG_BSP_TOUCH_LATENCY
+
+esp_err_t bsp_touch_latency_get_report(bsp_touch_lat_report_t *report)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void bsp_touch_latency_print_report(void)
+{
+}
+
+void bsp_touch_latency_reset(void)
+{
+}
+
+#endif // CONFIG_BSP_TOUCH_LATENCY
+
+#endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
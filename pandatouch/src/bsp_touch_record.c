@@ -0,0 +1,378 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Touch record and playback, in the trace format of bsp/touch_trace.h.
+ *
+ * The recorder drains the touch sample ring of bsp_touch.c into a file every RECORD_PERIOD_MS, so it
+ * never slows the touch reads down; the ring only has to cover one period.
+ *
+ * The player injects samples where bsp_touch.c would read the GT911: from then on they take the path of
+ * real reports (point filter, sample ring, gestures, LVGL dispatch). Each sample is due at its trace time
+ * relative to the first one. The player sleeps until a tick before that and spins the rest, so with a
+ * 1 kHz tick a sample is injected within a few tens of microseconds of its due time; the delays are
+ * reported in bsp_touch_play_stats_t.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp/touch_trace.h"
+#include "bsp_err_check.h"
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+
+static const char *TAG = "bsp_touch_rec";
+
+/* Forward declarations — implemented in bsp_touch.c */
+const bsp_touch_ring_t *bsp_touch_get_ring(void);
+esp_err_t bsp_touch_inject_start(void);
+bool bsp_touch_inject(const bsp_touch_sample_t *sample, TickType_t wait);
+void bsp_touch_inject_stop(void);
+
+#define RECORD_TASK_STACK   (4096)
+#define RECORD_TASK_PRIO    (2)
+#define RECORD_PERIOD_MS    (50)
+#define RECORD_BATCH        (16)
+#define PLAY_TASK_STACK     (4096)
+#ifdef CONFIG_BSP_TOUCH_TASK_PRIORITY
+#define PLAY_TASK_PRIO      CONFIG_BSP_TOUCH_TASK_PRIORITY
+#else
+#define PLAY_TASK_PRIO      (5)
+#endif
+#define PLAY_STREAM_LEN     (64)
+#define PLAY_LINE_MAX       (160)   /* trace lines with a console log prefix */
+#define PLAY_POLL_MS        (50)    /* how often a waiting player checks for a stop */
+#define PLAY_SPIN_MAX_US    (2000)  /* longest busy wait for the part of a delay below one tick */
+
+/* Recorder; the statistics are written by the recorder task only */
+static TaskHandle_t             s_rec_task = NULL;
+static SemaphoreHandle_t        s_rec_done = NULL;
+static FILE                    *s_rec_file = NULL;
+static volatile bool            s_rec_stop = false;
+static bsp_touch_record_stats_t s_rec_stats;
+
+/* Player; the statistics are written by the player task only */
+static TaskHandle_t             s_play_task   = NULL;
+static SemaphoreHandle_t        s_play_done   = NULL;
+static FILE                    *s_play_file   = NULL;     /* NULL: samples come from s_play_stream */
+static QueueHandle_t            s_play_stream = NULL;
+static volatile bool            s_play_stop   = false;
+static volatile bool            s_play_eos    = false;    /* no more bsp_touch_play_feed() lines */
+static bsp_touch_play_stats_t   s_play_stats;
+static uint64_t                 s_play_late_total = 0;
+
+/* Writes the samples recorded since *cursor; false after a write error */
+static bool record_drain(const bsp_touch_ring_t *ring, uint32_t *cursor, int64_t start_us)
+{
+    bsp_touch_sample_t batch[RECORD_BATCH];
+    char line[BSP_TOUCH_TRACE_LINE_MAX];
+    size_t n;
+    do {
+        uint32_t lost = 0;
+        n = bsp_touch_ring_read(ring, cursor, batch, RECORD_BATCH, &lost);
+        s_rec_stats.lost += lost;
+        for (size_t i = 0; i < n; i++) {
+            const size_t len = bsp_touch_trace_format(&batch[i], start_us, line, sizeof(line));
+            if (len == 0 || fwrite(line, 1, len, s_rec_file) != len) {
+                return false;
+            }
+            s_rec_stats.samples++;
+        }
+    } while (n == RECORD_BATCH);
+    return true;
+}
+
+static void record_task(void *arg)
+{
+    const bsp_touch_ring_t *ring = arg;
+    const int64_t start_us = esp_timer_get_time();
+    uint32_t cursor = bsp_touch_ring_head(ring);
+    bool ok = fputs("# touch trace: <time_ms> <count> [<x> <y> <id>]...\n", s_rec_file) >= 0;
+
+    while (ok && !s_rec_stop) {
+        vTaskDelay(pdMS_TO_TICKS(RECORD_PERIOD_MS));
+        ok = record_drain(ring, &cursor, start_us);
+    }
+    if (fclose(s_rec_file) != 0) {
+        ok = false;
+    }
+    s_rec_file = NULL;
+    if (!ok) {
+        s_rec_stats.error = ESP_FAIL;
+        ESP_LOGE(TAG, "Touch recording stopped: write error");
+    }
+    s_rec_stats.recording = false;
+    xSemaphoreGive(s_rec_done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t bsp_touch_record_start(const char *path)
+{
+    BSP_NULL_CHECK(path, ESP_ERR_INVALID_ARG);
+    const bsp_touch_ring_t *ring = bsp_touch_get_ring();
+    if (ring == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;   /* no input device, or CONFIG_BSP_TOUCH_SAMPLE_RING disabled */
+    }
+    if (s_rec_task) {
+        if (s_rec_stats.recording) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        xSemaphoreTake(s_rec_done, portMAX_DELAY);  /* stopped by a write error, never collected */
+        s_rec_task = NULL;
+    }
+    if (!s_rec_done) {
+        s_rec_done = xSemaphoreCreateBinary();
+        BSP_NULL_CHECK(s_rec_done, ESP_ERR_NO_MEM);
+    }
+
+    s_rec_file = fopen(path, "w");
+    if (!s_rec_file) {
+        ESP_LOGE(TAG, "Cannot create %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+    memset(&s_rec_stats, 0, sizeof(s_rec_stats));
+    s_rec_stats.recording = true;
+    s_rec_stop = false;
+    if (xTaskCreate(record_task, "bsp_touch_rec", RECORD_TASK_STACK, (void *)ring, RECORD_TASK_PRIO,
+                    &s_rec_task) != pdPASS) {
+        fclose(s_rec_file);
+        s_rec_file = NULL;
+        s_rec_task = NULL;
+        s_rec_stats.recording = false;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Recording touch to %s", path);
+    return ESP_OK;
+}
+
+esp_err_t bsp_touch_record_stop(bsp_touch_record_stats_t *stats)
+{
+    if (!s_rec_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_rec_stop = true;
+    xSemaphoreTake(s_rec_done, portMAX_DELAY);
+    s_rec_task = NULL;
+    ESP_LOGI(TAG, "Touch recording: %" PRIu32 " samples, %" PRIu32 " lost", s_rec_stats.samples, s_rec_stats.lost);
+    if (stats) {
+        *stats = s_rec_stats;
+    }
+    return s_rec_stats.error;
+}
+
+esp_err_t bsp_touch_record_get_stats(bsp_touch_record_stats_t *stats)
+{
+    BSP_NULL_CHECK(stats, ESP_ERR_INVALID_ARG);
+    *stats = s_rec_stats;
+    return ESP_OK;
+}
+
+/* Next sample to play; false at the end of the trace or on a stop */
+static bool play_next(bsp_touch_sample_t *sample)
+{
+    if (s_play_file) {
+        char line[PLAY_LINE_MAX];
+        while (!s_play_stop && fgets(line, sizeof(line), s_play_file)) {
+            if (!strchr(line, '\n') && !feof(s_play_file)) {
+                /* Longer than any trace line: skip it, so its tail is not taken for a sample */
+                int c;
+                do {
+                    c = fgetc(s_play_file);
+                } while (c != '\n' && c != EOF);
+                continue;
+            }
+            if (bsp_touch_trace_parse(line, sample)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    while (!s_play_stop) {
+        if (xQueueReceive(s_play_stream, sample, pdMS_TO_TICKS(PLAY_POLL_MS)) == pdTRUE) {
+            return true;
+        }
+        if (s_play_eos && uxQueueMessagesWaiting(s_play_stream) == 0) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/* Sleeps whole ticks, then spins the rest of the delay */
+static void play_wait_until(int64_t due_us)
+{
+    const int64_t tick_us = 1000000 / configTICK_RATE_HZ;
+    int64_t wait_us = due_us - esp_timer_get_time();
+    while (wait_us > tick_us && !s_play_stop) {
+        const int64_t ticks = wait_us / tick_us - 1;
+        const int64_t max_ticks = pdMS_TO_TICKS(PLAY_POLL_MS);
+        vTaskDelay((TickType_t)(ticks < 1 ? 1 : ticks > max_ticks ? max_ticks : ticks));
+        wait_us = due_us - esp_timer_get_time();
+    }
+    if (wait_us > 0 && wait_us <= PLAY_SPIN_MAX_US) {
+        esp_rom_delay_us((uint32_t)wait_us);
+    } else if (wait_us > 0) {
+        vTaskDelay(1);
+    }
+}
+
+static void play_task(void *arg)
+{
+    bsp_touch_sample_t sample;
+    bool pressed = false;
+    bool first = true;
+    int64_t origin_us = 0;
+
+    while (play_next(&sample)) {
+        if (first) {
+            first = false;
+            origin_us = esp_timer_get_time() - sample.time_us;
+        }
+        const int64_t due_us = origin_us + sample.time_us;
+        play_wait_until(due_us);
+        if (s_play_stop) {
+            break;
+        }
+        const int64_t late_us = esp_timer_get_time() - due_us;
+        bool queued = false;
+        while (!queued && !s_play_stop) {
+            queued = bsp_touch_inject(&sample, pdMS_TO_TICKS(PLAY_POLL_MS));
+        }
+        pressed = sample.count > 0;
+
+        s_play_stats.samples++;
+        if (late_us > 0) {
+            s_play_late_total += (uint64_t)late_us;
+            if (late_us > s_play_stats.late_max_us) {
+                s_play_stats.late_max_us = (uint32_t)late_us;
+            }
+        }
+        s_play_stats.late_avg_us = (uint32_t)(s_play_late_total / s_play_stats.samples);
+    }
+
+    /* Never leave LVGL with a finger down */
+    if (pressed) {
+        const bsp_touch_sample_t release = { .count = 0 };
+        bsp_touch_inject(&release, pdMS_TO_TICKS(PLAY_POLL_MS));
+    }
+    bsp_touch_inject_stop();
+    if (s_play_file) {
+        fclose(s_play_file);
+        s_play_file = NULL;
+    }
+    ESP_LOGI(TAG, "Touch playback done: %" PRIu32 " samples, late avg %" PRIu32 " us max %" PRIu32 " us",
+             s_play_stats.samples, s_play_stats.late_avg_us, s_play_stats.late_max_us);
+    s_play_stats.playing = false;
+    xSemaphoreGive(s_play_done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t bsp_touch_play_start(const char *path)
+{
+    if (s_play_task) {
+        if (s_play_stats.playing) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        xSemaphoreTake(s_play_done, portMAX_DELAY);  /* previous trace ended, never waited for */
+        s_play_task = NULL;
+    }
+    if (!s_play_done) {
+        s_play_done = xSemaphoreCreateBinary();
+        BSP_NULL_CHECK(s_play_done, ESP_ERR_NO_MEM);
+    }
+    if (path) {
+        s_play_file = fopen(path, "r");
+        if (!s_play_file) {
+            ESP_LOGE(TAG, "Cannot open %s", path);
+            return ESP_ERR_NOT_FOUND;
+        }
+    } else {
+        if (!s_play_stream) {
+            s_play_stream = xQueueCreate(PLAY_STREAM_LEN, sizeof(bsp_touch_sample_t));
+            BSP_NULL_CHECK(s_play_stream, ESP_ERR_NO_MEM);
+        }
+        xQueueReset(s_play_stream);
+    }
+
+    esp_err_t ret = bsp_touch_inject_start();
+    if (ret == ESP_OK) {
+        memset(&s_play_stats, 0, sizeof(s_play_stats));
+        s_play_stats.playing = true;
+        s_play_late_total = 0;
+        s_play_stop = false;
+        s_play_eos = false;
+        if (xTaskCreate(play_task, "bsp_touch_play", PLAY_TASK_STACK, NULL, PLAY_TASK_PRIO,
+                        &s_play_task) != pdPASS) {
+            s_play_task = NULL;
+            s_play_stats.playing = false;
+            bsp_touch_inject_stop();
+            ret = ESP_ERR_NO_MEM;
+        }
+    }
+    if (ret != ESP_OK && s_play_file) {
+        fclose(s_play_file);
+        s_play_file = NULL;
+    }
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Playing touch from %s", path ? path : "stream");
+    }
+    return ret;
+}
+
+esp_err_t bsp_touch_play_feed(const char *line, uint32_t timeout_ms)
+{
+    if (!s_play_task || s_play_file) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!line) {
+        s_play_eos = true;
+        return ESP_OK;
+    }
+    bsp_touch_sample_t sample;
+    if (!bsp_touch_trace_parse(line, &sample)) {
+        return ESP_OK;                  /* comment or empty line */
+    }
+    const TickType_t wait = timeout_ms ? pdMS_TO_TICKS(timeout_ms) : portMAX_DELAY;
+    return xQueueSend(s_play_stream, &sample, wait) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t bsp_touch_play_wait(uint32_t timeout_ms)
+{
+    if (!s_play_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const TickType_t wait = timeout_ms ? pdMS_TO_TICKS(timeout_ms) : portMAX_DELAY;
+    if (xSemaphoreTake(s_play_done, wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    s_play_task = NULL;
+    return ESP_OK;
+}
+
+esp_err_t bsp_touch_play_stop(void)
+{
+    if (!s_play_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_play_stop = true;
+    return bsp_touch_play_wait(0);
+}
+
+esp_err_t bsp_touch_play_get_stats(bsp_touch_play_stats_t *stats)
+{
+    BSP_NULL_CHECK(stats, ESP_ERR_INVALID_ARG);
+    *stats = s_play_stats;
+    return ESP_OK;
+}
+#endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
@@ -0,0 +1,48 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Touch sample ring, on the seqlock ring shared with the sensor rings (bsp_seq_ring.h): a reader never
+ * blocks the touch task.
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/touch_ring_test.
+ */
+
+#include <stddef.h>
+#include "bsp/touch_ring.h"
+#include "bsp_seq_ring.h"
+
+_Static_assert(offsetof(bsp_touch_slot_t, seq) == 0, "slot starts with its sequence number");
+
+static const bsp_seq_ring_layout_t s_layout = {
+    .slot_size     = sizeof(bsp_touch_slot_t),
+    .sample_offset = offsetof(bsp_touch_slot_t, sample),
+    .sample_size   = sizeof(bsp_touch_sample_t),
+    .seq_offset    = offsetof(bsp_touch_sample_t, seq),
+};
+
+void bsp_touch_ring_init(bsp_touch_ring_t *ring, bsp_touch_slot_t *slots, uint32_t capacity)
+{
+    ring->slots = slots;
+    ring->mask = capacity - 1;
+    ring->head = 0;
+}
+
+void bsp_touch_ring_push(bsp_touch_ring_t *ring, const bsp_touch_sample_t *sample)
+{
+    bsp_seq_ring_push(&s_layout, ring->slots, ring->mask, &ring->head, sample);
+}
+
+uint32_t bsp_touch_ring_head(const bsp_touch_ring_t *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+size_t bsp_touch_ring_read(const bsp_touch_ring_t *ring, uint32_t *cursor, bsp_touch_sample_t *out,
+                           size_t max, uint32_t *lost)
+{
+    return bsp_seq_ring_read(&s_layout, ring->slots, ring->mask, &ring->head, cursor, out, max, lost);
+}
@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Touch trace lines, written by the touch recorder and read back by the touch player and the host tools.
+ *
+ * No ESP-IDF dependencies: also built on the host by tools/touch_ring_test, tools/gesture_replay and
+ * tools/touch_filter_replay.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bsp/touch_trace.h"
+
+size_t bsp_touch_trace_format(const bsp_touch_sample_t *sample, int64_t start_us, char *buf, size_t len)
+{
+    const int64_t t_ms = (sample->time_us - start_us) / 1000;
+    const uint8_t count = sample->count > BSP_TOUCH_RING_MAX_POINTS ? BSP_TOUCH_RING_MAX_POINTS : sample->count;
+    int r = snprintf(buf, len, "%lld %u", (long long)(t_ms < 0 ? 0 : t_ms), (unsigned)count);
+    if (r < 0 || (size_t)r >= len) {
+        return 0;
+    }
+    size_t n = (size_t)r;
+    for (uint8_t i = 0; i < count; i++) {
+        const bsp_touch_point_t *pt = &sample->points[i];
+        r = snprintf(buf + n, len - n, " %u %u %u", (unsigned)pt->x, (unsigned)pt->y, (unsigned)pt->id);
+        if (r < 0 || (size_t)r >= len - n) {
+            return 0;
+        }
+        n += (size_t)r;
+    }
+    if (n + 2 > len) {
+        return 0;
+    }
+    buf[n++] = '\n';
+    buf[n] = '\0';
+    return n;
+}
+
+bool bsp_touch_trace_parse(const char *line, bsp_touch_sample_t *sample)
+{
+    const char *p = strstr(line, "TRACE ");
+    p = p ? p + 6 : line;
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+    if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+        return false;
+    }
+
+    char *end;
+    const unsigned long long t_ms = strtoull(p, &end, 10);
+    if (end == p) {
+        return false;
+    }
+    const char *q = end;
+    const unsigned long count = strtoul(q, &end, 10);
+    if (end == q) {
+        return false;
+    }
+
+    memset(sample, 0, sizeof(*sample));
+    sample->time_us = (int64_t)t_ms * 1000;
+    for (unsigned long i = 0; i < count; i++) {
+        long v[3];
+        for (int k = 0; k < 3; k++) {
+            q = end;
+            v[k] = strtol(q, &end, 10);
+            if (end == q) {
+                return false;           /* truncated line */
+            }
+        }
+        if (i < BSP_TOUCH_RING_MAX_POINTS) {
+            bsp_touch_point_t *pt = &sample->points[sample->count++];
+            pt->x = (uint16_t)(v[0] < 0 ? 0 : v[0] > UINT16_MAX ? UINT16_MAX : v[0]);
+            pt->y = (uint16_t)(v[1] < 0 ? 0 : v[1] > UINT16_MAX ? UINT16_MAX : v[1]);
+            pt->id = (uint8_t)v[2];
+        }
+    }
+    if (sample->count) {
+        sample->x = sample->points[0].x;
+        sample->y = sample->points[0].y;
+    }
+    return true;
+}
@@ -3,6 +3,7 @@
  *
  * SPDX-License-Identifier: MIT
  */
+#include <inttypes.h>
 #include <stdbool.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
@@ -10,6 +11,9 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "ff.h"
+#include "diskio_impl.h"
 #include "usb/usb_host.h"
 #include "usb/msc_host_vfs.h"
 #include "bsp/pandatouch.h"
@@ -39,12 +43,22 @@ typedef struct {
     };
 } usb_msc_evt_t;
 
+/* Forward declarations — implemented in bsp_usb_fs.c */
+esp_err_t bsp_usb_fs_start(void);
+void bsp_usb_fs_unplug(const char *prefix);
+
+/* Configuration, set by bsp_usb_start_with_config() */
+static bsp_usb_cfg_t s_cfg;
+
 /* Registered callbacks */
 static bsp_usb_event_cb_t s_on_mount   = NULL;
 static bsp_usb_event_cb_t s_on_unmount = NULL;
 
 /* State */
 static volatile bool             s_mounted                 = false;
+static volatile bool             s_serial_ok               = false;
+static uint32_t                  s_volume_serial           = 0;
+static size_t                    s_cluster_size            = 0;     /* 0 if unknown */
 static volatile bool             s_usb_host_shutdown       = false;
 /* s_msc_evt_handler_running has a single writer (msc_evt_handler_task).
  * volatile is sufficient for cross-core visibility on ESP32-S3.
@@ -134,6 +148,44 @@ static esp_err_t start_msc_evt_handler_task(void)
     return ESP_OK;
 }
 
+/* -------------------------------------------------------------------------
+ * Volume serial number and cluster size
+ * FATFS only keeps the serial number when volume labels are enabled, which
+ * they are not by default, so it is read from the boot sector of the mounted
+ * volume. The cluster size comes from the FATFS object: the VFS does not
+ * report it through stat(). Runs before the mount callback, while nothing
+ * else uses the drive.
+ * -------------------------------------------------------------------------*/
+static bool usb_read_volume_info(BYTE pdrv, uint32_t *serial, size_t *cluster_size)
+{
+    const char drive[3] = {(char)('0' + pdrv), ':', 0};
+    FF_DIR dir;
+    if (f_opendir(&dir, drive) != FR_OK) {
+        return false;
+    }
+    FATFS *fs = dir.obj.fs;
+    f_closedir(&dir);
+
+#if FF_MAX_SS != FF_MIN_SS
+    *cluster_size = (size_t)fs->csize * fs->ssize;
+#else
+    *cluster_size = (size_t)fs->csize * FF_MAX_SS;
+#endif
+
+    uint8_t *sector = heap_caps_malloc(FF_MAX_SS, MALLOC_CAP_DMA);
+    if (!sector) {
+        return false;
+    }
+    const bool ok = ff_disk_read(fs->pdrv, sector, fs->volbase, 1) == RES_OK;
+    if (ok) {
+        /* BS_VolID, at its place in the FAT12/16, FAT32 or exFAT boot sector */
+        const size_t off = (fs->fs_type == FS_EXFAT) ? 100 : (fs->fs_type == FS_FAT32) ? 67 : 39;
+        *serial = sector[off] | (sector[off + 1] << 8) | (sector[off + 2] << 16) | ((uint32_t)sector[off + 3] << 24);
+    }
+    heap_caps_free(sector);
+    return ok;
+}
+
 /* -------------------------------------------------------------------------
  * MSC application task
  * Installs the MSC device and mounts the VFS on connect;
@@ -158,11 +210,15 @@ static void msc_app_task(void *arg)
                 continue;
             }
 
+            /* allocation_unit_size only applies when formatting, which the BSP never does */
             const esp_vfs_fat_mount_config_t mount_config = {
                 .format_if_mount_failed = false,
-                .max_files              = 3,
+                .max_files              = s_cfg.max_files,
                 .allocation_unit_size   = 8192,
             };
+            /* The VFS takes the first free FATFS drive; note which one it is for the serial number */
+            BYTE pdrv = 0xFF;
+            ff_diskio_get_drive(&pdrv);
             ret = msc_host_vfs_register(s_msc_device, "/usb", &mount_config, &s_vfs_handle);
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "msc_host_vfs_register failed: %s", esp_err_to_name(ret));
@@ -171,6 +227,14 @@ static void msc_app_task(void *arg)
                 s_vfs_handle = NULL;
                 continue;
             }
+            s_cluster_size = 0;
+            s_serial_ok = pdrv != 0xFF && usb_read_volume_info(pdrv, &s_volume_serial, &s_cluster_size);
+            if (s_serial_ok) {
+                ESP_LOGI(TAG, "Volume serial %04" PRIX32 "-%04" PRIX32 ", %u byte clusters", s_volume_serial >> 16,
+                         s_volume_serial & 0xFFFF, (unsigned)s_cluster_size);
+            } else {
+                ESP_LOGW(TAG, "Volume serial unknown: directory indexes will not be cached");
+            }
 
             s_mounted = true;
             ESP_LOGI(TAG, "USB MSC mounted at /usb");
@@ -186,6 +250,10 @@ static void msc_app_task(void *arg)
             }
 
             s_mounted = false;
+            s_serial_ok = false;
+            s_cluster_size = 0;
+            /* File service requests on the drive complete, cancelled, before the application hears of it */
+            bsp_usb_fs_unplug("/usb");
             if (s_on_unmount && evt.type == USB_MSC_EVT_DISCONNECTED) {
                 s_on_unmount();
             }
@@ -225,6 +293,27 @@ static void msc_app_task(void *arg)
 
 esp_err_t bsp_usb_start(void)
 {
+    return bsp_usb_start_with_config(NULL);
+}
+
+esp_err_t bsp_usb_start_with_config(const bsp_usb_cfg_t *cfg)
+{
+    s_cfg = cfg ? *cfg : (bsp_usb_cfg_t) {0};
+    if (s_cfg.max_files == 0) {
+        s_cfg.max_files = CONFIG_BSP_USB_MAX_FILES;
+    }
+    if (s_cfg.stream_chunk_size == 0) {
+        s_cfg.stream_chunk_size = CONFIG_BSP_USB_STREAM_CHUNK_KB * 1024;
+    }
+    if (s_cfg.stream_buffers == 0) {
+        s_cfg.stream_buffers = CONFIG_BSP_USB_STREAM_BUFFERS;
+    }
+
+    esp_err_t ret = bsp_usb_fs_start();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
     s_usb_host_shutdown = false;
     s_usb_event_queue = xQueueCreate(5, sizeof(usb_msc_evt_t));
     if (!s_usb_event_queue) {
@@ -236,7 +325,7 @@ esp_err_t bsp_usb_start(void)
         .skip_phy_setup = false,
         .intr_flags     = ESP_INTR_FLAG_LEVEL1,
     };
-    esp_err_t ret = usb_host_install(&host_config);
+    ret = usb_host_install(&host_config);
     if (ret != ESP_OK) {
         vQueueDelete(s_usb_event_queue);
         s_usb_event_queue = NULL;
@@ -333,6 +422,16 @@ bool bsp_usb_is_mounted(void)
     return s_mounted;
 }
 
+esp_err_t bsp_usb_get_volume_serial(uint32_t *serial)
+{
+    BSP_NULL_CHECK(serial, ESP_ERR_INVALID_ARG);
+    if (!s_mounted || !s_serial_ok) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *serial = s_volume_serial;
+    return ESP_OK;
+}
+
 void bsp_usb_on_mount(bsp_usb_event_cb_t cb)
 {
     s_on_mount = cb;
@@ -342,3 +441,16 @@ void bsp_usb_on_unmount(bsp_usb_event_cb_t cb)
 {
     s_on_unmount = cb;
 }
+
+/* Stream defaults, for bsp_usb_stream.c; the Kconfig ones before bsp_usb_start_with_config() */
+void bsp_usb_stream_defaults(size_t *chunk_size, uint8_t *buffers)
+{
+    *chunk_size = s_cfg.stream_chunk_size ? s_cfg.stream_chunk_size : CONFIG_BSP_USB_STREAM_CHUNK_KB * 1024;
+    *buffers = s_cfg.stream_buffers ? s_cfg.stream_buffers : CONFIG_BSP_USB_STREAM_BUFFERS;
+}
+
+/* Cluster size of the mounted volume, for bsp_usb_stream.c; 0 if unknown */
+size_t bsp_usb_cluster_size(void)
+{
+    return s_mounted ? s_cluster_size : 0;
+}
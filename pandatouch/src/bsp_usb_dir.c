@@ -0,0 +1,546 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * USB directories: sorted indexes of directories on the drive (bsp/dir_index.h), listed and cached
+ * through the file service.
+ *
+ * Opening a directory starts a chain of file service requests, one at a time, each submitted by the
+ * completion of the previous one:
+ *
+ *   STAT the directory, for its time
+ *   STAT, OPEN, READ and CLOSE its cached index, BSPIDX/<hash>.IDX    interactive: the user waits
+ *   LIST the directory, if the cached index is missing or stale       normal: UI requests go first
+ *   MKDIR BSPIDX, OPEN, WRITE and CLOSE the new cached index          bulk
+ *
+ * The root of a FAT volume has no time, so its cached index is shown, then listed again into the second
+ * index and replaced if the listing differs. Cache files have 8.3 names, as FATFS may be built without
+ * long names: a hash of the path, which the file holds in full and checks on load.
+ *
+ * A recursive mutex protects a directory: the entry callback holds it while it adds an entry, readers
+ * while they copy entries, and the chain around on_change, which may read entries. A closed directory
+ * is freed by bsp_usb_dir_close(), or by the completion of the request that was running then.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+static const char *TAG = "bsp_usb_dir";
+
+#define DIR_ROOT            "/usb"
+#define DIR_CACHE_NAME      "BSPIDX"
+#define DIR_CACHE_MAX       (4 * 1024 * 1024)   /* larger cache files are not read */
+#define DIR_COPY_PAGE       (8)
+
+typedef enum {
+    DIR_STAT,
+    DIR_CACHE_STAT,
+    DIR_CACHE_OPEN,
+    DIR_CACHE_READ,
+    DIR_CACHE_CLOSE,
+    DIR_LIST,
+    DIR_SAVE_MKDIR,     /* the saving steps go on when the directory is closed */
+    DIR_SAVE_OPEN,
+    DIR_SAVE_WRITE,
+    DIR_SAVE_CLOSE,
+    DIR_IDLE,
+} dir_step_t;
+
+struct bsp_usb_dir_s {
+    SemaphoreHandle_t   lock;
+    bsp_usb_dir_cfg_t   cfg;
+    char                path[BSP_FS_PATH_MAX];
+    char                cache_path[BSP_FS_PATH_MAX];
+    bool                at_root;
+    bool                caching;
+    bsp_dir_index_key_t key;            /* path points to path */
+    bsp_dir_index_t     index[2];
+    bsp_dir_index_t    *shown;          /* read by bsp_usb_dir_read() */
+    bsp_dir_index_t    *listing;        /* filled by the listing: shown, or the other one to check shown */
+    dir_step_t          step;
+    bool                running;        /* a request of the chain has not completed */
+    bool                closed;
+    bool                cancelled;      /* a request completed with ECANCELED */
+    uint32_t            req_id;
+    int32_t             file;
+    uint8_t            *buf;            /* cache file contents */
+    size_t              buf_len;
+    int                 io_err;         /* of the cache file, kept until it is closed */
+    int                 list_err;       /* of the entry callback */
+    uint32_t            notified;       /* entries at the last on_change */
+    int64_t             list_start_us;
+    bsp_usb_dir_info_t  info;
+};
+
+typedef struct bsp_usb_dir_s bsp_usb_dir_t;
+
+static void dir_on_done(const bsp_fs_result_t *result, void *user_ctx);
+static bool dir_on_entry(const char *name, bool is_dir, void *user_ctx);
+
+/* Indexes go to PSRAM, which holds thousands of names easily */
+static void *dir_mem(void *ptr, size_t size)
+{
+    if (size == 0) {
+        heap_caps_free(ptr);
+        return NULL;
+    }
+    return heap_caps_realloc_prefer(ptr, size, 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+}
+
+/* FNV-1a */
+static uint32_t dir_hash(const char *path)
+{
+    uint32_t h = 2166136261u;
+    while (*path) {
+        h = (h ^ (uint8_t)*path++) * 16777619u;
+    }
+    return h;
+}
+
+static void dir_free(bsp_usb_dir_t *d)
+{
+    bsp_dir_index_clear(&d->index[0]);
+    bsp_dir_index_clear(&d->index[1]);
+    heap_caps_free(d->buf);
+    vSemaphoreDelete(d->lock);
+    free(d);
+}
+
+/* Submit the next request of the chain, with the lock held; false if the queue refused it */
+static bool dir_submit(bsp_usb_dir_t *d, dir_step_t step, bsp_fs_request_t *req)
+{
+    req->on_done = dir_on_done;
+    req->user_ctx = d;
+    d->step = step;
+    d->running = bsp_usb_fs_submit(req, &d->req_id) == ESP_OK;
+    return d->running;
+}
+
+static void dir_notify(bsp_usb_dir_t *d)
+{
+    d->notified = bsp_dir_index_count(d->shown);
+    if (!d->closed && d->cfg.on_change) {
+        d->cfg.on_change(d, d->cfg.user_ctx);
+    }
+}
+
+/* The entries are final */
+static void dir_end(bsp_usb_dir_t *d, int err)
+{
+    if (d->listing && d->listing != d->shown) {
+        bsp_dir_index_clear(d->listing);
+    }
+    d->listing = NULL;
+    d->step = DIR_IDLE;
+    d->info.complete = true;
+    d->info.err = err;
+    dir_notify(d);
+}
+
+static bool dir_close_file(bsp_usb_dir_t *d, dir_step_t step)
+{
+    bsp_fs_request_t req = {
+        .op   = BSP_FS_OP_CLOSE,
+        .prio = (step == DIR_SAVE_CLOSE) ? BSP_FS_PRIO_BULK : BSP_FS_PRIO_INTERACTIVE,
+        .file = d->file,
+    };
+    if (!dir_submit(d, step, &req)) {
+        ESP_LOGW(TAG, "Cannot close %s", d->cache_path);
+        d->file = BSP_FS_FILE_NONE;
+        return false;
+    }
+    return true;
+}
+
+static void dir_list(bsp_usb_dir_t *d, bsp_dir_index_t *into)
+{
+    d->listing = into;
+    d->list_err = 0;
+    d->list_start_us = esp_timer_get_time();
+    bsp_fs_request_t req = {
+        .op       = BSP_FS_OP_LIST,
+        .prio     = BSP_FS_PRIO_NORMAL,
+        .path     = d->path,
+        .on_entry = dir_on_entry,
+    };
+    if (!dir_submit(d, DIR_LIST, &req)) {
+        dir_end(d, EAGAIN);
+    }
+}
+
+static void dir_save(bsp_usb_dir_t *d)
+{
+    const size_t size = bsp_dir_index_save(d->shown, &d->key, NULL, 0);
+    d->buf = size ? heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT) : NULL;
+    if (!d->buf) {
+        return;
+    }
+    d->buf_len = bsp_dir_index_save(d->shown, &d->key, d->buf, size);
+    d->io_err = 0;
+
+    /* The cache file is at DIR_ROOT "/" DIR_CACHE_NAME "/XXXXXXXX.IDX" */
+    char dir[sizeof(DIR_ROOT "/" DIR_CACHE_NAME)];
+    memcpy(dir, d->cache_path, sizeof(dir) - 1);
+    dir[sizeof(dir) - 1] = 0;
+    bsp_fs_request_t req = {
+        .op   = BSP_FS_OP_MKDIR,
+        .prio = BSP_FS_PRIO_BULK,
+        .path = dir,
+    };
+    if (!dir_submit(d, DIR_SAVE_MKDIR, &req)) {
+        heap_caps_free(d->buf);
+        d->buf = NULL;
+        d->step = DIR_IDLE;
+    }
+}
+
+static void dir_save_end(bsp_usb_dir_t *d, int err)
+{
+    heap_caps_free(d->buf);
+    d->buf = NULL;
+    d->step = DIR_IDLE;
+    if (err == 0) {
+        ESP_LOGD(TAG, "%s: index saved to %s (%u bytes)", d->path, d->cache_path, (unsigned)d->buf_len);
+    } else if (err == EROFS || err == EACCES) {
+        ESP_LOGD(TAG, "%s: drive is read-only, index not saved", d->path);
+    } else {
+        ESP_LOGW(TAG, "%s: cannot save the index to %s: %s", d->path, d->cache_path, strerror(err));
+    }
+}
+
+/* The cached index was read, or could not be */
+static void dir_cache_loaded(bsp_usb_dir_t *d)
+{
+    if (d->io_err != 0) {
+        ESP_LOGD(TAG, "%s: no valid cached index (%d), listing", d->path, d->io_err);
+        dir_list(d, d->shown);
+        return;
+    }
+
+    d->info.cached = true;
+    ESP_LOGD(TAG, "%s: %" PRIu32 " entries from %s", d->path, bsp_dir_index_count(d->shown), d->cache_path);
+    if (d->key.dir_mtime != 0) {
+        dir_end(d, 0);
+        return;
+    }
+    /* No directory time to trust: show the cached entries now and check them with a listing */
+    dir_notify(d);
+    dir_list(d, (d->shown == &d->index[0]) ? &d->index[1] : &d->index[0]);
+}
+
+static void dir_listed(bsp_usb_dir_t *d, const bsp_fs_result_t *r)
+{
+    d->info.list_ms = (uint32_t)((esp_timer_get_time() - d->list_start_us) / 1000);
+    const int err = r->err ? r->err : d->list_err;
+    if (err != 0) {
+        dir_end(d, err);
+        return;
+    }
+
+    bool changed = true;
+    if (d->listing != d->shown) {
+        changed = !bsp_dir_index_equal(d->listing, d->shown);
+        if (changed) {
+            bsp_dir_index_t *old = d->shown;
+            d->shown = d->listing;
+            d->listing = old;       /* cleared by dir_end() */
+            d->info.cached = false;
+        }
+    }
+    ESP_LOGD(TAG, "%s: %" PRIu32 " entries listed in %" PRIu32 " ms%s", d->path, bsp_dir_index_count(d->shown),
+             d->info.list_ms, changed ? "" : ", cached index up to date");
+    dir_end(d, 0);
+    if (changed && d->caching && !d->closed) {
+        dir_save(d);
+    }
+}
+
+/* Runs the chain, with the lock held */
+static void dir_advance(bsp_usb_dir_t *d, const bsp_fs_result_t *r)
+{
+    if (r->op == BSP_FS_OP_OPEN && r->err == 0) {
+        d->file = r->file;
+    } else if (r->op == BSP_FS_OP_CLOSE) {
+        d->file = BSP_FS_FILE_NONE;
+    }
+
+    d->cancelled = d->cancelled || r->err == ECANCELED;
+    if ((d->closed || d->cancelled) && d->step < DIR_SAVE_MKDIR) {
+        /* Closed, or the drive went away: close the cache file if it is open, then stop */
+        if (d->file == BSP_FS_FILE_NONE || !dir_close_file(d, DIR_CACHE_CLOSE)) {
+            dir_end(d, ECANCELED);
+        }
+        return;
+    }
+
+    bsp_fs_request_t req = { .prio = BSP_FS_PRIO_INTERACTIVE };
+    switch (d->step) {
+    case DIR_STAT:
+        /* The root has no time; a missing directory fails again in the listing */
+        d->key.dir_mtime = (r->err == 0 && !d->at_root) ? r->mtime : 0;
+        if (r->err == 0 && !r->is_dir) {
+            dir_end(d, ENOTDIR);
+            break;
+        }
+        req.op = BSP_FS_OP_STAT;
+        req.path = d->cache_path;
+        if (!d->caching || !dir_submit(d, DIR_CACHE_STAT, &req)) {
+            dir_list(d, d->shown);
+        }
+        break;
+
+    case DIR_CACHE_STAT:
+        d->buf_len = (size_t)r->size;
+        d->buf = (r->err == 0 && !r->is_dir && r->size > 0 && r->size <= DIR_CACHE_MAX) ?
+                 heap_caps_malloc_prefer(d->buf_len, 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT) : NULL;
+        req.op = BSP_FS_OP_OPEN;
+        req.path = d->cache_path;
+        req.flags = O_RDONLY;
+        if (!d->buf || !dir_submit(d, DIR_CACHE_OPEN, &req)) {
+            heap_caps_free(d->buf);
+            d->buf = NULL;
+            dir_list(d, d->shown);
+        }
+        break;
+
+    case DIR_CACHE_OPEN:
+        req.op = BSP_FS_OP_READ;
+        req.file = d->file;
+        req.offset = 0;
+        req.buf = d->buf;
+        req.len = d->buf_len;
+        d->io_err = r->err ? r->err : EAGAIN;
+        if (r->err == 0 && dir_submit(d, DIR_CACHE_READ, &req)) {
+            break;
+        }
+        heap_caps_free(d->buf);
+        d->buf = NULL;
+        if (d->file == BSP_FS_FILE_NONE || !dir_close_file(d, DIR_CACHE_CLOSE)) {
+            dir_cache_loaded(d);
+        }
+        break;
+
+    case DIR_CACHE_READ:
+        d->io_err = r->err ? r->err : (r->len != d->buf_len) ? EILSEQ :
+                    bsp_dir_index_load(d->shown, &d->key, d->buf, d->buf_len);
+        heap_caps_free(d->buf);
+        d->buf = NULL;
+        if (!dir_close_file(d, DIR_CACHE_CLOSE)) {
+            dir_cache_loaded(d);
+        }
+        break;
+
+    case DIR_CACHE_CLOSE:
+        dir_cache_loaded(d);
+        break;
+
+    case DIR_LIST:
+        dir_listed(d, r);
+        break;
+
+    case DIR_SAVE_MKDIR:
+        req.op = BSP_FS_OP_OPEN;
+        req.prio = BSP_FS_PRIO_BULK;
+        req.path = d->cache_path;
+        req.flags = O_WRONLY | O_CREAT | O_TRUNC;
+        if (r->err != 0 && r->err != EEXIST) {
+            dir_save_end(d, r->err);
+        } else if (!dir_submit(d, DIR_SAVE_OPEN, &req)) {
+            dir_save_end(d, EAGAIN);
+        }
+        break;
+
+    case DIR_SAVE_OPEN:
+        req.op = BSP_FS_OP_WRITE;
+        req.prio = BSP_FS_PRIO_BULK;
+        req.file = d->file;
+        req.offset = 0;
+        req.data = d->buf;
+        req.len = d->buf_len;
+        if (r->err != 0) {
+            dir_save_end(d, r->err);
+        } else if (!dir_submit(d, DIR_SAVE_WRITE, &req)) {
+            d->io_err = EAGAIN;
+            if (!dir_close_file(d, DIR_SAVE_CLOSE)) {
+                dir_save_end(d, EAGAIN);
+            }
+        }
+        break;
+
+    case DIR_SAVE_WRITE:
+        /* A short cached index fails its check when read, so the directory is listed again */
+        d->io_err = r->err ? r->err : (r->len != d->buf_len) ? ENOSPC : 0;
+        if (!dir_close_file(d, DIR_SAVE_CLOSE)) {
+            dir_save_end(d, d->io_err);
+        }
+        break;
+
+    case DIR_SAVE_CLOSE:
+        dir_save_end(d, d->io_err ? d->io_err : r->err);
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void dir_on_done(const bsp_fs_result_t *result, void *user_ctx)
+{
+    bsp_usb_dir_t *d = user_ctx;
+
+    xSemaphoreTakeRecursive(d->lock, portMAX_DELAY);
+    d->running = false;
+    dir_advance(d, result);
+    const bool release = d->closed && !d->running;
+    xSemaphoreGiveRecursive(d->lock);
+    if (release) {
+        dir_free(d);
+    }
+}
+
+static bool dir_on_entry(const char *name, bool is_dir, void *user_ctx)
+{
+    bsp_usb_dir_t *d = user_ctx;
+    if ((d->cfg.skip_hidden && name[0] == '.') || strlen(name) >= BSP_DIR_NAME_MAX ||
+        (d->at_root && is_dir && strcasecmp(name, DIR_CACHE_NAME) == 0)) {
+        return true;
+    }
+
+    xSemaphoreTakeRecursive(d->lock, portMAX_DELAY);
+    bool go = !d->closed;
+    if (go && !bsp_dir_index_add(d->listing, name, is_dir)) {
+        d->list_err = ENOMEM;
+        go = false;
+    }
+    /* Once per listing step, while the listing fills the shown index */
+    if (go && d->listing == d->shown && bsp_dir_index_count(d->shown) - d->notified >= BSP_FS_LIST_BATCH) {
+        dir_notify(d);
+    }
+    xSemaphoreGiveRecursive(d->lock);
+    return go;
+}
+
+esp_err_t bsp_usb_dir_open(const bsp_usb_dir_cfg_t *cfg, bsp_usb_dir_handle_t *ret_dir)
+{
+    BSP_NULL_CHECK(cfg, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(cfg->path, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(ret_dir, ESP_ERR_INVALID_ARG);
+
+    const size_t root_len = strlen(DIR_ROOT);
+    size_t len = strlen(cfg->path);
+    while (len > root_len && cfg->path[len - 1] == '/') {
+        len--;
+    }
+    if (len >= BSP_FS_PATH_MAX || strncmp(cfg->path, DIR_ROOT, root_len) != 0 ||
+        (len > root_len && cfg->path[root_len] != '/')) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!bsp_usb_is_mounted()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    bsp_usb_dir_t *d = calloc(1, sizeof(bsp_usb_dir_t));
+    if (!d || !(d->lock = xSemaphoreCreateRecursiveMutex())) {
+        free(d);
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(d->path, cfg->path, len);
+    d->cfg = *cfg;
+    d->cfg.path = d->path;
+    d->at_root = len == root_len;
+    d->file = BSP_FS_FILE_NONE;
+    bsp_dir_index_init(&d->index[0], dir_mem);
+    bsp_dir_index_init(&d->index[1], dir_mem);
+    d->shown = &d->index[0];
+    d->key.path = d->path;
+    d->caching = !cfg->no_cache && bsp_usb_get_volume_serial(&d->key.volume_serial) == ESP_OK;
+    snprintf(d->cache_path, sizeof(d->cache_path), DIR_ROOT "/" DIR_CACHE_NAME "/%08" PRIX32 ".IDX",
+             dir_hash(d->path));
+
+    /* Under the lock: the completion may run before bsp_usb_fs_submit() returns */
+    bsp_fs_request_t req = {
+        .op   = BSP_FS_OP_STAT,
+        .prio = BSP_FS_PRIO_INTERACTIVE,
+        .path = d->path,
+    };
+    xSemaphoreTakeRecursive(d->lock, portMAX_DELAY);
+    const bool ok = dir_submit(d, DIR_STAT, &req);
+    xSemaphoreGiveRecursive(d->lock);
+    if (!ok) {
+        dir_free(d);
+        return ESP_ERR_NO_MEM;
+    }
+    *ret_dir = d;
+    return ESP_OK;
+}
+
+uint32_t bsp_usb_dir_read(bsp_usb_dir_handle_t dir, uint32_t first, uint32_t count, bsp_usb_dir_entry_t *out)
+{
+    if (!dir || !out) {
+        return 0;
+    }
+
+    bsp_dir_entry_t page[DIR_COPY_PAGE];
+    uint32_t copied = 0;
+    xSemaphoreTakeRecursive(dir->lock, portMAX_DELAY);
+    while (copied < count) {
+        const uint32_t want = (count - copied < DIR_COPY_PAGE) ? count - copied : DIR_COPY_PAGE;
+        const uint32_t n = bsp_dir_index_page(dir->shown, first + copied, want, page);
+        for (uint32_t i = 0; i < n; i++) {
+            strlcpy(out[copied + i].name, page[i].name, BSP_DIR_NAME_MAX);
+            out[copied + i].is_dir = page[i].is_dir;
+        }
+        copied += n;
+        if (n < want) {
+            break;
+        }
+    }
+    xSemaphoreGiveRecursive(dir->lock);
+    return copied;
+}
+
+esp_err_t bsp_usb_dir_get_info(bsp_usb_dir_handle_t dir, bsp_usb_dir_info_t *info)
+{
+    BSP_NULL_CHECK(dir, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(info, ESP_ERR_INVALID_ARG);
+
+    xSemaphoreTakeRecursive(dir->lock, portMAX_DELAY);
+    *info = dir->info;
+    info->count = bsp_dir_index_count(dir->shown);
+    xSemaphoreGiveRecursive(dir->lock);
+    return ESP_OK;
+}
+
+void bsp_usb_dir_close(bsp_usb_dir_handle_t dir)
+{
+    if (!dir) {
+        return;
+    }
+
+    xSemaphoreTakeRecursive(dir->lock, portMAX_DELAY);
+    dir->closed = true;
+    /* A CLOSE must run, and an index being saved is finished */
+    if (dir->running && dir->step != DIR_CACHE_CLOSE && dir->step < DIR_SAVE_MKDIR) {
+        bsp_usb_fs_cancel(dir->req_id);
+    }
+    const bool release = !dir->running;
+    xSemaphoreGiveRecursive(dir->lock);
+    if (release) {
+        dir_free(dir);
+    }
+}
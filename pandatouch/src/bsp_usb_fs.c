@@ -0,0 +1,179 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * File service task: runs the request queue of bsp/file_service.h.
+ *
+ * The task sleeps until a request is queued, then steps the queue until it is empty. The queue lock is
+ * only held to pick, finish and cancel requests: the file system calls and the callbacks run without
+ * it, so submitting, from the UI or from a callback, never waits for the drive.
+ *
+ * When the drive goes away, bsp_usb.c calls bsp_usb_fs_unplug() before it tells the application and
+ * unregisters the VFS: the requests on /usb complete with ECANCELED and their files are closed first.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+static const char *TAG = "bsp_usb_fs";
+
+#define FS_TASK_STACK       (4096)
+#define FS_UNPLUG_WAIT_MS   (2000)
+#define FS_UNPLUG_POLL_MS   (10)
+
+static bsp_fs_queue_t    s_fs;
+static SemaphoreHandle_t s_fs_lock       = NULL;
+static TaskHandle_t      s_fs_task       = NULL;
+static volatile bool     s_fs_completing = false;   /* a completion callback runs */
+
+static void usb_fs_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        xSemaphoreTake(s_fs_lock, portMAX_DELAY);
+        bsp_fs_slot_t *slot = bsp_fs_queue_next(&s_fs, esp_timer_get_time());
+        xSemaphoreGive(s_fs_lock);
+        if (!slot) {
+            /* Notified by bsp_usb_fs_submit() and by cancellations */
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        bsp_fs_queue_step(&s_fs, slot);
+
+        bsp_fs_completion_t done;
+        xSemaphoreTake(s_fs_lock, portMAX_DELAY);
+        const bool complete = bsp_fs_queue_finish(&s_fs, slot, &done);
+        s_fs_completing = complete;
+        xSemaphoreGive(s_fs_lock);
+        if (complete) {
+            if (done.on_done) {
+                done.on_done(&done.result, done.user_ctx);
+            }
+            s_fs_completing = false;
+        }
+    }
+}
+
+/* Called by bsp_usb_start_with_config(); the task stays when USB is stopped */
+esp_err_t bsp_usb_fs_start(void)
+{
+    if (s_fs_task) {
+        return ESP_OK;
+    }
+
+    bsp_fs_slot_t *slots = calloc(CONFIG_BSP_USB_FS_QUEUE_LEN, sizeof(bsp_fs_slot_t));
+    bsp_fs_file_t *files = calloc(CONFIG_BSP_USB_FS_MAX_FILES, sizeof(bsp_fs_file_t));
+    s_fs_lock = s_fs_lock ? s_fs_lock : xSemaphoreCreateMutex();
+    if (!slots || !files || !s_fs_lock) {
+        free(slots);
+        free(files);
+        return ESP_ERR_NO_MEM;
+    }
+    bsp_fs_queue_init(&s_fs, slots, CONFIG_BSP_USB_FS_QUEUE_LEN, files, CONFIG_BSP_USB_FS_MAX_FILES,
+                      CONFIG_BSP_USB_FS_SLICE_KB * 1024);
+
+    if (xTaskCreate(usb_fs_task, "usb_fs", FS_TASK_STACK, NULL, CONFIG_BSP_USB_FS_TASK_PRIORITY,
+                    &s_fs_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create file service task");
+        s_fs_task = NULL;
+        free(slots);
+        free(files);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/* Called by msc_app_task when the drive goes away, before the VFS is unregistered */
+void bsp_usb_fs_unplug(const char *prefix)
+{
+    if (!s_fs_task) {
+        return;
+    }
+
+    xSemaphoreTake(s_fs_lock, portMAX_DELAY);
+    const uint32_t cancelled = bsp_fs_queue_cancel_path(&s_fs, prefix);
+    xSemaphoreGive(s_fs_lock);
+    xTaskNotifyGive(s_fs_task);
+
+    /* At most the step in progress, then the cancelled requests complete one after the other */
+    const int64_t deadline = esp_timer_get_time() + FS_UNPLUG_WAIT_MS * 1000LL;
+    bool busy;
+    while (1) {
+        xSemaphoreTake(s_fs_lock, portMAX_DELAY);
+        busy = bsp_fs_queue_busy(&s_fs, prefix) || s_fs_completing;
+        xSemaphoreGive(s_fs_lock);
+        if (!busy || esp_timer_get_time() >= deadline) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(FS_UNPLUG_POLL_MS));
+    }
+
+    if (busy) {
+        ESP_LOGW(TAG, "Requests on %s still running after %d ms", prefix, FS_UNPLUG_WAIT_MS);
+    } else if (cancelled) {
+        ESP_LOGI(TAG, "%" PRIu32 " requests on %s cancelled", cancelled, prefix);
+    }
+}
+
+esp_err_t bsp_usb_fs_submit(const bsp_fs_request_t *req, uint32_t *ret_id)
+{
+    BSP_NULL_CHECK(req, ESP_ERR_INVALID_ARG);
+    if (!s_fs_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_fs_lock, portMAX_DELAY);
+    const int ret = bsp_fs_queue_submit(&s_fs, req, esp_timer_get_time(), ret_id);
+    xSemaphoreGive(s_fs_lock);
+    if (ret == EINVAL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ret != 0) {
+        ESP_LOGW(TAG, "Request queue full");
+        return ESP_ERR_NO_MEM;
+    }
+    xTaskNotifyGive(s_fs_task);
+    return ESP_OK;
+}
+
+esp_err_t bsp_usb_fs_cancel(uint32_t id)
+{
+    if (!s_fs_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_fs_lock, portMAX_DELAY);
+    const bool found = bsp_fs_queue_cancel(&s_fs, id);
+    xSemaphoreGive(s_fs_lock);
+    if (!found) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    xTaskNotifyGive(s_fs_task);
+    return ESP_OK;
+}
+
+esp_err_t bsp_usb_fs_get_stats(bsp_fs_stats_t *stats)
+{
+    BSP_NULL_CHECK(stats, ESP_ERR_INVALID_ARG);
+    if (!s_fs_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_fs_lock, portMAX_DELAY);
+    bsp_fs_queue_get_stats(&s_fs, stats);
+    xSemaphoreGive(s_fs_lock);
+    return ESP_OK;
+}
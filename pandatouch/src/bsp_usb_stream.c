@@ -0,0 +1,312 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Streaming reads from the USB drive.
+ *
+ * A reader task owns the file descriptor and cycles the stream buffers through two queues: it takes a
+ * buffer from free_q, fills it with one read() of chunk_size bytes and posts it to full_q; the
+ * application takes it from full_q and gives it back to free_q once used. With two buffers or more the
+ * drive is busy while the application works on the previous chunk.
+ *
+ * read() is called on the raw descriptor, not through stdio, so nothing is copied through a FILE
+ * buffer. FATFS transfers the whole clusters of a cluster-aligned read straight into the caller's
+ * buffer, one multi-sector command per cluster, so the chunk size is a multiple of the cluster size and
+ * the file is read from offset 0.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+static const char *TAG = "bsp_usb_stream";
+
+#define STREAM_TASK_STACK       (3072)
+#define STREAM_BUF_ALIGN        (64)        /* cache line, for buffers in PSRAM */
+#define STREAM_DEFAULT_CLUSTER  (4096)      /* when the cluster size of the volume is unknown */
+
+/* Forward declarations — implemented in bsp_usb.c */
+void bsp_usb_stream_defaults(size_t *chunk_size, uint8_t *buffers);
+size_t bsp_usb_cluster_size(void);
+
+/* A filled buffer; len is 0 at the end of the file, -errno on error */
+typedef struct {
+    uint8_t index;
+    int32_t len;
+} stream_chunk_t;
+
+struct bsp_usb_stream_s {
+    int                    fd;
+    size_t                 chunk_size;
+    size_t                 cluster_size;
+    uint8_t                count;
+    bool                   dma;
+    uint8_t               *buf[BSP_USB_STREAM_MAX_BUFFERS];
+    QueueHandle_t          free_q;      /* buffer indexes to fill */
+    QueueHandle_t          full_q;      /* stream_chunk_t, in file order */
+    SemaphoreHandle_t      exited;      /* given by the reader task when it ends */
+    volatile bool          stop;
+    portMUX_TYPE           lock;        /* stats */
+    bsp_usb_stream_stats_t stats;
+
+    /* Application side */
+    stream_chunk_t         cur;         /* chunk being used */
+    bool                   held;        /* cur is set */
+    bool                   acquired;    /* cur is handed out by bsp_usb_stream_acquire() */
+    size_t                 cur_off;     /* bytes of cur already copied by bsp_usb_stream_read() */
+    bool                   done;        /* end of the file or error was reached */
+    esp_err_t              err;
+};
+
+static void stream_task(void *arg)
+{
+    bsp_usb_stream_handle_t s = arg;
+    uint8_t index;
+
+    while (!s->stop && xQueueReceive(s->free_q, &index, portMAX_DELAY) == pdTRUE && !s->stop) {
+        const int64_t t0 = esp_timer_get_time();
+        const ssize_t n = read(s->fd, s->buf[index], s->chunk_size);
+        const int64_t dt = esp_timer_get_time() - t0;
+
+        const stream_chunk_t chunk = { .index = index, .len = n < 0 ? -errno : (int32_t)n };
+        portENTER_CRITICAL(&s->lock);
+        s->stats.reads++;
+        s->stats.read_us += dt;
+        if (n > 0) {
+            s->stats.bytes += n;
+        }
+        portEXIT_CRITICAL(&s->lock);
+
+        /* Never blocks: there are as many slots as buffers */
+        xQueueSend(s->full_q, &chunk, portMAX_DELAY);
+        if (n <= 0) {
+            break;
+        }
+    }
+    xSemaphoreGive(s->exited);
+    vTaskDelete(NULL);
+}
+
+static void stream_free(bsp_usb_stream_handle_t s)
+{
+    for (int i = 0; i < BSP_USB_STREAM_MAX_BUFFERS; i++) {
+        heap_caps_free(s->buf[i]);
+    }
+    if (s->free_q) {
+        vQueueDelete(s->free_q);
+    }
+    if (s->full_q) {
+        vQueueDelete(s->full_q);
+    }
+    if (s->exited) {
+        vSemaphoreDelete(s->exited);
+    }
+    if (s->fd >= 0) {
+        close(s->fd);
+    }
+    free(s);
+}
+
+esp_err_t bsp_usb_stream_open(const char *path, const bsp_usb_stream_cfg_t *cfg, bsp_usb_stream_handle_t *ret_stream)
+{
+    BSP_NULL_CHECK(path, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(ret_stream, ESP_ERR_INVALID_ARG);
+
+    size_t chunk_size;
+    uint8_t count;
+    bsp_usb_stream_defaults(&chunk_size, &count);
+    if (cfg && cfg->chunk_size) {
+        chunk_size = cfg->chunk_size;
+    }
+    if (cfg && cfg->buffers) {
+        count = cfg->buffers;
+    }
+    count = count < 2 ? 2 : count > BSP_USB_STREAM_MAX_BUFFERS ? BSP_USB_STREAM_MAX_BUFFERS : count;
+
+    bsp_usb_stream_handle_t s = calloc(1, sizeof(struct bsp_usb_stream_s));
+    BSP_NULL_CHECK(s, ESP_ERR_NO_MEM);
+    portMUX_INITIALIZE(&s->lock);
+    s->fd = open(path, O_RDONLY);
+    if (s->fd < 0) {
+        ESP_LOGE(TAG, "Cannot open %s: %s", path, strerror(errno));
+        stream_free(s);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /* Read from the FATFS volume at mount: the FAT VFS reports a fixed block size in st_blksize */
+    s->cluster_size = bsp_usb_cluster_size();
+    if (s->cluster_size == 0) {
+        s->cluster_size = STREAM_DEFAULT_CLUSTER;
+        ESP_LOGW(TAG, "Cluster size unknown, reads may not cover whole clusters");
+    }
+    s->chunk_size = (chunk_size + s->cluster_size - 1) / s->cluster_size * s->cluster_size;
+    s->count = count;
+
+    s->dma = true;
+    for (uint8_t i = 0; i < count; i++) {
+        s->buf[i] = heap_caps_aligned_alloc(STREAM_BUF_ALIGN, s->chunk_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!s->buf[i]) {
+            s->buf[i] = heap_caps_aligned_alloc(STREAM_BUF_ALIGN, s->chunk_size, MALLOC_CAP_SPIRAM);
+            s->dma = false;
+        }
+        if (!s->buf[i]) {
+            ESP_LOGE(TAG, "No memory for %u buffers of %u bytes", count, (unsigned)s->chunk_size);
+            stream_free(s);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (!s->dma) {
+        ESP_LOGW(TAG, "Internal RAM short, stream buffers partly in PSRAM");
+    }
+
+    s->free_q = xQueueCreate(count + 1, sizeof(uint8_t));   /* + 1 for the wake-up of close */
+    s->full_q = xQueueCreate(count, sizeof(stream_chunk_t));
+    s->exited = xSemaphoreCreateBinary();
+    if (!s->free_q || !s->full_q || !s->exited) {
+        stream_free(s);
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        xQueueSend(s->free_q, &i, 0);
+    }
+
+    s->stats.chunk_size = s->chunk_size;
+    s->stats.cluster_size = s->cluster_size;
+    s->stats.dma = s->dma;
+    if (xTaskCreate(stream_task, "usb_stream", STREAM_TASK_STACK, s, CONFIG_BSP_USB_STREAM_TASK_PRIORITY,
+                    NULL) != pdPASS) {
+        stream_free(s);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGD(TAG, "%s: %u x %u bytes, cluster %u", path, count, (unsigned)s->chunk_size,
+             (unsigned)s->cluster_size);
+    *ret_stream = s;
+    return ESP_OK;
+}
+
+esp_err_t bsp_usb_stream_acquire(bsp_usb_stream_handle_t stream, const void **data, size_t *len,
+                                 uint32_t timeout_ms)
+{
+    BSP_NULL_CHECK(stream, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(data, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(len, ESP_ERR_INVALID_ARG);
+    if (stream->acquired) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *data = NULL;
+    *len = 0;
+    if (!stream->held) {
+        if (stream->done) {
+            return stream->err;
+        }
+
+        stream_chunk_t chunk;
+        const int64_t t0 = esp_timer_get_time();
+        if (xQueueReceive(stream->full_q, &chunk, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+            return ESP_ERR_TIMEOUT;
+        }
+        portENTER_CRITICAL(&stream->lock);
+        stream->stats.stall_us += esp_timer_get_time() - t0;
+        portEXIT_CRITICAL(&stream->lock);
+
+        if (chunk.len <= 0) {
+            stream->done = true;
+            if (chunk.len < 0) {
+                ESP_LOGE(TAG, "Read failed: %s", strerror(-chunk.len));
+                stream->err = ESP_FAIL;
+            }
+            return stream->err;
+        }
+        stream->cur = chunk;
+        stream->cur_off = 0;
+        stream->held = true;
+    }
+
+    /* The rest of a chunk partly copied by bsp_usb_stream_read() comes first */
+    stream->acquired = true;
+    *data = stream->buf[stream->cur.index] + stream->cur_off;
+    *len = stream->cur.len - stream->cur_off;
+    return ESP_OK;
+}
+
+void bsp_usb_stream_release(bsp_usb_stream_handle_t stream)
+{
+    if (stream && stream->held) {
+        stream->held = false;
+        stream->acquired = false;
+        xQueueSend(stream->free_q, &stream->cur.index, 0);
+    }
+}
+
+esp_err_t bsp_usb_stream_read(bsp_usb_stream_handle_t stream, void *dst, size_t len, size_t *out_len,
+                              uint32_t timeout_ms)
+{
+    BSP_NULL_CHECK(stream, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(dst, ESP_ERR_INVALID_ARG);
+    if (stream->acquired) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    size_t copied = 0;
+    while (copied < len) {
+        if (!stream->held) {
+            const void *data;
+            size_t n;
+            ret = bsp_usb_stream_acquire(stream, &data, &n, timeout_ms);
+            stream->acquired = false;
+            if (ret != ESP_OK || n == 0) {
+                break;
+            }
+        }
+        const size_t avail = stream->cur.len - stream->cur_off;
+        const size_t n = len - copied < avail ? len - copied : avail;
+        memcpy((uint8_t *)dst + copied, stream->buf[stream->cur.index] + stream->cur_off, n);
+        copied += n;
+        stream->cur_off += n;
+        if (stream->cur_off == (size_t)stream->cur.len) {
+            bsp_usb_stream_release(stream);
+        }
+    }
+    if (out_len) {
+        *out_len = copied;
+    }
+    return ret;
+}
+
+esp_err_t bsp_usb_stream_get_stats(bsp_usb_stream_handle_t stream, bsp_usb_stream_stats_t *stats)
+{
+    BSP_NULL_CHECK(stream, ESP_ERR_INVALID_ARG);
+    BSP_NULL_CHECK(stats, ESP_ERR_INVALID_ARG);
+    portENTER_CRITICAL(&stream->lock);
+    *stats = stream->stats;
+    portEXIT_CRITICAL(&stream->lock);
+    return ESP_OK;
+}
+
+void bsp_usb_stream_close(bsp_usb_stream_handle_t stream)
+{
+    if (!stream) {
+        return;
+    }
+    /* Wake the reader if it waits for a buffer; a read in progress finishes first */
+    stream->stop = true;
+    const uint8_t wake = 0;
+    xQueueSend(stream->free_q, &wake, 0);
+    xSemaphoreTake(stream->exited, portMAX_DELAY);
+    stream_free(stream);
+}
@@ -0,0 +1,244 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Virtualized, row-recycling list.
+ *
+ * Object tree built by bsp_vlist_create(parent):
+ *
+ *   parent
+ *   └── list          (scrollable container, returned to the caller)
+ *       ├── spacer    (transparent, row_height * count tall: gives the list its scroll range)
+ *       └── row 0..n  (pool of visible rows + 2, absolutely positioned at index * row_height)
+ *
+ * Entry i is always shown by pool slot i % n, so after a scroll only the slots
+ * whose entry changed are moved and re-bound.
+ */
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "bsp/pandatouch.h"
+#include "bsp_err_check.h"
+
+#if (BSP_CONFIG_NO_GRAPHIC_LIB == 0)
+
+static const char *TAG = "bsp_vlist";
+
+#define VLIST_SPARE_ROWS  (2)
+
+typedef struct {
+    bsp_vlist_cfg_t cfg;
+    lv_obj_t       *list;
+    lv_obj_t       *spacer;
+    lv_obj_t      **rows;
+    int32_t        *index;      /* entry bound to each slot, -1 if none */
+    uint32_t        slots;
+} vlist_t;
+
+static void vlist_event_cb(lv_event_t *e);
+
+static vlist_t *vlist_get(lv_obj_t *list)
+{
+    if (!list) {
+        return NULL;
+    }
+    const uint32_t count = lv_obj_get_event_count(list);
+    for (uint32_t i = 0; i < count; i++) {
+        lv_event_dsc_t *dsc = lv_obj_get_event_dsc(list, i);
+        if (lv_event_dsc_get_cb(dsc) == vlist_event_cb) {
+            return lv_event_dsc_get_user_data(dsc);
+        }
+    }
+    return NULL;
+}
+
+static lv_obj_t *vlist_default_row(lv_obj_t *parent, void *user_ctx)
+{
+    lv_obj_t *row = lv_obj_create(parent);
+    lv_obj_remove_style_all(row);
+    lv_obj_set_style_pad_hor(row, 12, 0);
+
+    lv_obj_t *label = lv_label_create(row);
+    lv_label_set_long_mode(label, LV_LABEL_LONG_MODE_DOTS);
+    lv_obj_set_width(label, lv_pct(100));
+    lv_obj_align(label, LV_ALIGN_LEFT_MID, 0, 0);
+    return row;
+}
+
+static void vlist_sync(vlist_t *ctx, bool force)
+{
+    const int32_t h = ctx->cfg.row_height;
+    const int32_t scroll = LV_MAX(lv_obj_get_scroll_y(ctx->list), 0);
+    const uint32_t first = scroll / h;
+
+    for (uint32_t k = 0; k < ctx->slots; k++) {
+        const uint32_t i = first + k;
+        const uint32_t slot = i % ctx->slots;
+        lv_obj_t *row = ctx->rows[slot];
+
+        if (i >= ctx->cfg.count) {
+            if (ctx->index[slot] >= 0) {
+                ctx->index[slot] = -1;
+                lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+            }
+            continue;
+        }
+        if (!force && ctx->index[slot] == (int32_t)i) {
+            continue;
+        }
+
+        ctx->index[slot] = i;
+        lv_obj_set_y(row, (int32_t)i * h);
+        lv_obj_remove_flag(row, LV_OBJ_FLAG_HIDDEN);
+        ctx->cfg.bind_row(row, i, ctx->cfg.user_ctx);
+    }
+}
+
+static lv_obj_t *vlist_new_row(vlist_t *ctx)
+{
+    lv_obj_t *row = ctx->cfg.create_row(ctx->list, ctx->cfg.user_ctx);
+    lv_obj_set_size(row, lv_pct(100), ctx->cfg.row_height);
+    lv_obj_add_flag(row, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_EVENT_BUBBLE | LV_OBJ_FLAG_HIDDEN);
+    lv_obj_remove_flag(row, LV_OBJ_FLAG_SCROLLABLE);
+    return row;
+}
+
+/* Grows the row pool to cover the visible height; it never shrinks, spare rows just stay hidden */
+static void vlist_resize_pool(vlist_t *ctx)
+{
+    lv_obj_update_layout(ctx->list);
+    const uint32_t need = lv_obj_get_content_height(ctx->list) / ctx->cfg.row_height + 1 + VLIST_SPARE_ROWS;
+    if (need <= ctx->slots) {
+        return;
+    }
+
+    lv_obj_t **rows = lv_realloc(ctx->rows, need * sizeof(lv_obj_t *));
+    int32_t *index = lv_realloc(ctx->index, need * sizeof(int32_t));
+    if (rows) {
+        ctx->rows = rows;
+    }
+    if (index) {
+        ctx->index = index;
+    }
+    if (!rows || !index) {
+        ESP_LOGE(TAG, "No memory for %" PRIu32 " rows", need);
+        return;
+    }
+
+    for (uint32_t k = ctx->slots; k < need; k++) {
+        ctx->rows[k] = vlist_new_row(ctx);
+    }
+    ctx->slots = need;
+
+    /* Slot assignment depends on the pool size: rebind everything */
+    for (uint32_t k = 0; k < ctx->slots; k++) {
+        ctx->index[k] = -1;
+        lv_obj_add_flag(ctx->rows[k], LV_OBJ_FLAG_HIDDEN);
+    }
+    vlist_sync(ctx, true);
+}
+
+static void vlist_event_cb(lv_event_t *e)
+{
+    vlist_t *ctx = lv_event_get_user_data(e);
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_SCROLL:
+        vlist_sync(ctx, false);
+        break;
+    case LV_EVENT_SIZE_CHANGED:
+        vlist_resize_pool(ctx);
+        break;
+    case LV_EVENT_DELETE:
+        lv_free(ctx->rows);
+        lv_free(ctx->index);
+        lv_free(ctx);
+        break;
+    default:
+        break;
+    }
+}
+
+lv_obj_t *bsp_vlist_create(lv_obj_t *parent, const bsp_vlist_cfg_t *cfg)
+{
+    BSP_NULL_CHECK(parent, NULL);
+    BSP_NULL_CHECK(cfg, NULL);
+    BSP_NULL_CHECK(cfg->bind_row, NULL);
+    if (cfg->row_height <= 0) {
+        return NULL;
+    }
+
+    vlist_t *ctx = lv_malloc_zeroed(sizeof(vlist_t));
+    BSP_NULL_CHECK(ctx, NULL);
+    ctx->cfg = *cfg;
+    if (!ctx->cfg.create_row) {
+        ctx->cfg.create_row = vlist_default_row;
+    }
+
+    ctx->list = lv_obj_create(parent);
+    lv_obj_set_scroll_dir(ctx->list, LV_DIR_VER);
+
+    ctx->spacer = lv_obj_create(ctx->list);
+    lv_obj_remove_style_all(ctx->spacer);
+    lv_obj_remove_flag(ctx->spacer, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(ctx->spacer, 1, (int32_t)ctx->cfg.count * ctx->cfg.row_height);
+
+    lv_obj_add_event_cb(ctx->list, vlist_event_cb, LV_EVENT_ALL, ctx);
+    vlist_resize_pool(ctx);
+    return ctx->list;
+}
+
+void bsp_vlist_set_count(lv_obj_t *list, uint32_t count)
+{
+    vlist_t *ctx = vlist_get(list);
+    if (!ctx) {
+        return;
+    }
+
+    ctx->cfg.count = count;
+    lv_obj_set_height(ctx->spacer, (int32_t)count * ctx->cfg.row_height);
+    /* Shrinking may have clamped the scroll position */
+    lv_obj_update_layout(ctx->list);
+    lv_obj_readjust_scroll(ctx->list, LV_ANIM_OFF);
+    vlist_sync(ctx, true);
+}
+
+void bsp_vlist_refresh(lv_obj_t *list)
+{
+    vlist_t *ctx = vlist_get(list);
+    if (ctx) {
+        vlist_sync(ctx, true);
+    }
+}
+
+void bsp_vlist_scroll_to(lv_obj_t *list, uint32_t index, lv_anim_enable_t anim)
+{
+    vlist_t *ctx = vlist_get(list);
+    if (ctx) {
+        lv_obj_scroll_to_y(list, (int32_t)index * ctx->cfg.row_height, anim);
+    }
+}
+
+int32_t bsp_vlist_get_index(lv_obj_t *list, lv_obj_t *obj)
+{
+    vlist_t *ctx = vlist_get(list);
+    if (!ctx) {
+        return -1;
+    }
+
+    /* Walk up to the direct child of the list */
+    while (obj && lv_obj_get_parent(obj) != list) {
+        obj = lv_obj_get_parent(obj);
+    }
+    for (uint32_t k = 0; obj && k < ctx->slots; k++) {
+        if (ctx->rows[k] == obj) {
+            return ctx->index[k];
+        }
+    }
+    return -1;
+}
+
+#endif // BSP_CONFIG_NO_GRAPHIC_LIB == 0
@@ -0,0 +1,33 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Checks shared by the host tools.
+ *
+ * check() prints and counts a failed check; check_report() prints the verdict and returns the exit code
+ * of main(), non-zero when any check failed. Header only, included by the tool's single source file as
+ * "../common/check.h", so the build commands need nothing more.
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+static int s_failures;
+
+static inline void check(int ok, const char *name, const char *what)
+{
+    if (!ok) {
+        printf("FAIL %s: %s\n", name, what);
+        s_failures++;
+    }
+}
+
+static inline int check_report(void)
+{
+    printf("%s (%d failures)\n", s_failures ? "FAILED" : "OK", s_failures);
+    return s_failures ? 1 : 0;
+}
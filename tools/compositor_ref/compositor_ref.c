@@ -0,0 +1,142 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file compositor_ref.c
+ * @brief Host-side diff of the BSP scanline compositor against its reference renderer
+ * @details Builds randomised tilemap/sprite scenes, renders every line with bsp_comp_render_line()
+ *          and bsp_comp_render_line_ref(), and reports any pixel that differs. Optionally writes the
+ *          last frame as a PPM image for visual inspection.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bsp/compositor.h"
+
+#define WIDTH       800
+#define HEIGHT      480
+#define NUM_TILES   16
+#define NUM_SPRITES 8
+
+static uint32_t s_rng = 1;
+
+static uint32_t rnd(void)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return s_rng >> 8;
+}
+
+static void make_layer(bsp_comp_layer_t *layer, uint16_t *tiles, uint8_t *map, uint8_t shift, bool transparent)
+{
+    const int size = 1 << shift;
+    for (int i = 0; i < NUM_TILES * size * size; i++) {
+        /* Sprinkle key-coloured pixels so transparency is exercised */
+        tiles[i] = (rnd() % 4 == 0) ? 0xF81F : (uint16_t)rnd();
+    }
+
+    layer->tiles       = tiles;
+    layer->map         = map;
+    layer->map_w       = 8 + rnd() % 64;
+    layer->map_h       = 8 + rnd() % 40;
+    layer->tile_shift  = shift;
+    layer->transparent = transparent;
+    layer->key         = 0xF81F;
+    layer->scroll_x    = (int16_t)(rnd() % 4000) - 2000;
+    layer->scroll_y    = (int16_t)(rnd() % 4000) - 2000;
+
+    for (int i = 0; i < layer->map_w * layer->map_h; i++) {
+        map[i] = rnd() % NUM_TILES;
+    }
+}
+
+static void write_ppm(const char *path, const uint16_t *frame)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", WIDTH, HEIGHT);
+    for (int i = 0; i < WIDTH * HEIGHT; i++) {
+        const uint16_t c = frame[i];
+        const unsigned char rgb[3] = {
+            (unsigned char)(((c >> 11) & 0x1F) << 3),
+            (unsigned char)(((c >> 5) & 0x3F) << 2),
+            (unsigned char)((c & 0x1F) << 3),
+        };
+        fwrite(rgb, 1, sizeof(rgb), f);
+    }
+    fclose(f);
+}
+
+int main(int argc, char **argv)
+{
+    const int scenes = (argc > 1) ? atoi(argv[1]) : 100;
+    const char *ppm  = (argc > 2) ? argv[2] : NULL;
+
+    static uint16_t tiles[2][NUM_TILES * 16 * 16];
+    static uint8_t  maps[2][72 * 48];
+    static uint16_t sprite_px[NUM_SPRITES][64 * 64];
+    static uint16_t frame[WIDTH * HEIGHT];
+    uint16_t fast[WIDTH];
+    uint16_t ref[WIDTH];
+    long mismatches = 0;
+
+    for (int n = 0; n < scenes; n++) {
+        s_rng = (uint32_t)n + 1;
+
+        bsp_comp_layer_t layers[2];
+        make_layer(&layers[0], tiles[0], maps[0], 4, rnd() % 2);
+        make_layer(&layers[1], tiles[1], maps[1], 3, true);
+
+        bsp_comp_sprite_t sprites[NUM_SPRITES];
+        for (int i = 0; i < NUM_SPRITES; i++) {
+            sprites[i] = (bsp_comp_sprite_t) {
+                .pixels  = sprite_px[i],
+                .w       = 1 + rnd() % 64,
+                .h       = 1 + rnd() % 64,
+                .x       = (int16_t)(rnd() % (WIDTH + 128)) - 64,
+                .y       = (int16_t)(rnd() % (HEIGHT + 128)) - 64,
+                .key     = 0x0000,
+                .visible = (rnd() % 8) != 0,
+            };
+            for (int p = 0; p < sprites[i].w * sprites[i].h; p++) {
+                sprite_px[i][p] = (rnd() % 3 == 0) ? 0x0000 : (uint16_t)rnd();
+            }
+        }
+
+        const bsp_comp_scene_t scene = {
+            .bg           = (uint16_t)rnd(),
+            .layers       = layers,
+            .layer_count  = rnd() % 3,
+            .sprites      = sprites,
+            .sprite_count = NUM_SPRITES,
+        };
+
+        for (int y = 0; y < HEIGHT; y++) {
+            bsp_comp_render_line(&scene, y, fast, WIDTH);
+            bsp_comp_render_line_ref(&scene, y, ref, WIDTH);
+            for (int x = 0; x < WIDTH; x++) {
+                if (fast[x] != ref[x]) {
+                    if (mismatches < 10) {
+                        fprintf(stderr, "scene %d: (%d,%d) fast=%04x ref=%04x\n", n, x, y, fast[x], ref[x]);
+                    }
+                    mismatches++;
+                }
+            }
+            memcpy(&frame[y * WIDTH], fast, sizeof(fast));
+        }
+    }
+
+    if (ppm) {
+        write_ppm(ppm, frame);
+    }
+
+    printf("%d scenes, %ld mismatching pixels\n", scenes, mismatches);
+    return mismatches ? 1 : 0;
+}
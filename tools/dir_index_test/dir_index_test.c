@@ -0,0 +1,272 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Host-side check for the BSP directory index.
+ *
+ * Checks the display order (directories first, names without case), name
+ * limits, pages read while entries keep coming in against a reference sort,
+ * comparison of indexes, and the saved form: a round trip, a key mismatch
+ * per key field, damaged and truncated buffers, and that every block is
+ * freed. Then times a listing of 10000 names paged as a UI would read it.
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include "bsp/dir_index.h"
+#include "../common/check.h"
+
+#define BIG_COUNT       (10000)
+#define BATCH           (16)            /* entries per listing step of the file service */
+#define PAGE            (12)            /* rows of a file browser */
+
+static int s_allocs;                    /* blocks allocated and not freed by the counting hook */
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *counting_mem(void *ptr, size_t size)
+{
+    if (size == 0) {
+        s_allocs -= ptr != NULL;
+        free(ptr);
+        return NULL;
+    }
+    s_allocs += ptr == NULL;
+    return realloc(ptr, size);
+}
+
+/* Reference order of the index, on "D" or "F" prefixed names */
+static int ref_order(const void *a, const void *b)
+{
+    const char *x = *(const char *const *)a;
+    const char *y = *(const char *const *)b;
+    if (x[0] != y[0]) {
+        return x[0] == 'D' ? -1 : 1;
+    }
+    const int d = strcasecmp(x + 1, y + 1);
+    return d ? d : strcmp(x + 1, y + 1);
+}
+
+/* Every entry of index in order, and matching sorted[0, n) */
+static int matches(bsp_dir_index_t *index, char **sorted, uint32_t n)
+{
+    bsp_dir_entry_t e[PAGE];
+    uint32_t pos = 0;
+    uint32_t got;
+    while ((got = bsp_dir_index_page(index, pos, PAGE, e)) > 0) {
+        for (uint32_t i = 0; i < got; i++, pos++) {
+            if (pos >= n || e[i].is_dir != (sorted[pos][0] == 'D') || strcmp(e[i].name, sorted[pos] + 1)) {
+                return 0;
+            }
+        }
+    }
+    return pos == n;
+}
+
+static void random_name(char *buf, size_t size, uint32_t i)
+{
+    static const char chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-.";
+    const size_t len = 4 + rand() % 24;
+    size_t n = (size_t)snprintf(buf, size, "%c", (i % 10 == 0) ? 'D' : 'F');
+    for (size_t k = 0; k < len && n + 1 < size; k++) {
+        buf[n++] = chars[rand() % (sizeof(chars) - 1)];
+    }
+    n += (size_t)snprintf(buf + n, size - n, "%u", i);     /* unique */
+    buf[n] = 0;
+}
+
+static void test_order(void)
+{
+    const char *name = "order";
+    bsp_dir_index_t index;
+    bsp_dir_index_init(&index, NULL);
+
+    const char *names[] = { "beta", "Alpha", "alpha", "zeta", "src", "Docs", "a", "ALPHA2", "_x", "10" };
+    const bool dirs[] = { false, false, false, false, true, true, false, false, false, false };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        bsp_dir_index_add(&index, names[i], dirs[i]);
+    }
+    const char *expect[] = { "Docs", "src", "10", "_x", "a", "Alpha", "alpha", "ALPHA2", "beta", "zeta" };
+    bsp_dir_entry_t e[16];
+    const uint32_t n = bsp_dir_index_page(&index, 0, 16, e);
+    check(n == 10 && bsp_dir_index_count(&index) == 10, name, "count");
+    bool ok = n == 10;
+    for (uint32_t i = 0; i < n && ok; i++) {
+        ok = strcmp(e[i].name, expect[i]) == 0 && e[i].is_dir == (i < 2);
+    }
+    check(ok, name, "directories first, then names without case, then case");
+
+    check(bsp_dir_index_page(&index, 8, 16, e) == 2 && strcmp(e[0].name, "beta") == 0, name, "last page");
+    check(bsp_dir_index_page(&index, 10, 16, e) == 0, name, "page past the end");
+
+    char longest[BSP_DIR_NAME_MAX + 1];
+    memset(longest, 'x', sizeof(longest));
+    longest[BSP_DIR_NAME_MAX] = 0;
+    check(!bsp_dir_index_add(&index, longest, false), name, "name too long accepted");
+    longest[BSP_DIR_NAME_MAX - 1] = 0;
+    check(bsp_dir_index_add(&index, longest, false), name, "longest name refused");
+    check(!bsp_dir_index_add(&index, "", false), name, "empty name accepted");
+    check(bsp_dir_index_count(&index) == 11, name, "count after refused names");
+    bsp_dir_index_clear(&index);
+    check(bsp_dir_index_count(&index) == 0 && bsp_dir_index_page(&index, 0, 16, e) == 0, name, "clear");
+}
+
+/* Pages read between listing steps, as a UI reads them while the file service lists */
+static void test_paging(void)
+{
+    const char *name = "paging";
+    static char  storage[BIG_COUNT][40];
+    static char *sorted[BIG_COUNT];
+    srand(1);
+    for (uint32_t i = 0; i < BIG_COUNT; i++) {
+        random_name(storage[i], sizeof(storage[i]), i);
+    }
+
+    bsp_dir_index_t index;
+    bsp_dir_index_init(&index, counting_mem);
+    bool ok = true;
+    for (uint32_t i = 0; i < BIG_COUNT && ok; i++) {
+        ok = bsp_dir_index_add(&index, storage[i] + 1, storage[i][0] == 'D');
+        sorted[i] = storage[i];
+        if (i % (4 * BATCH) == 4 * BATCH - 1 || i == 37) {
+            qsort(sorted, i + 1, sizeof(sorted[0]), ref_order);
+            ok = matches(&index, sorted, i + 1);
+        }
+    }
+    check(ok, name, "pages while adding differ from a full sort");
+    qsort(sorted, BIG_COUNT, sizeof(sorted[0]), ref_order);
+    check(matches(&index, sorted, BIG_COUNT), name, "final order");
+
+    bsp_dir_index_t copy;
+    bsp_dir_index_init(&copy, counting_mem);
+    for (uint32_t i = BIG_COUNT; i-- > 0;) {
+        bsp_dir_index_add(&copy, storage[i] + 1, storage[i][0] == 'D');
+    }
+    check(bsp_dir_index_equal(&index, &copy), name, "same entries in another order differ");
+    bsp_dir_index_add(&copy, "extra", false);
+    check(!bsp_dir_index_equal(&index, &copy), name, "extra entry not noticed");
+    bsp_dir_index_clear(&copy);
+    for (uint32_t i = 0; i < BIG_COUNT; i++) {
+        bsp_dir_index_add(&copy, storage[i] + 1, storage[i][0] == 'D' ? i != 0 : false);
+    }
+    check(!bsp_dir_index_equal(&index, &copy), name, "changed directory flag not noticed");
+
+    bsp_dir_index_clear(&index);
+    bsp_dir_index_clear(&copy);
+    check(s_allocs == 0, name, "blocks left after clear");
+}
+
+static void test_save(void)
+{
+    const char *name = "save";
+    bsp_dir_index_t index;
+    bsp_dir_index_t loaded;
+    bsp_dir_index_init(&index, NULL);
+    bsp_dir_index_init(&loaded, NULL);
+    srand(2);
+    char buf[40];
+    for (uint32_t i = 0; i < 500; i++) {
+        random_name(buf, sizeof(buf), i);
+        bsp_dir_index_add(&index, buf + 1, buf[0] == 'D');
+    }
+
+    const bsp_dir_index_key_t key = { .volume_serial = 0x1234abcd, .dir_mtime = 1700000000, .path = "/usb/music" };
+    const size_t size = bsp_dir_index_save(&index, &key, NULL, 0);
+    uint8_t *data = malloc(size);
+    check(bsp_dir_index_save(&index, &key, data, size - 1) == size, name, "size with a short buffer");
+    check(bsp_dir_index_save(&index, &key, data, size) == size, name, "size");
+
+    bsp_dir_index_add(&loaded, "replaced", false);
+    check(bsp_dir_index_load(&loaded, &key, data, size) == 0 && bsp_dir_index_equal(&index, &loaded), name,
+          "round trip");
+
+    bsp_dir_index_key_t other = key;
+    other.volume_serial++;
+    check(bsp_dir_index_load(&loaded, &other, data, size) == ESTALE, name, "other volume");
+    other = key;
+    other.dir_mtime += 2;
+    check(bsp_dir_index_load(&loaded, &other, data, size) == ESTALE, name, "directory changed");
+    other = key;
+    other.path = "/usb/Music";
+    check(bsp_dir_index_load(&loaded, &other, data, size) == ESTALE, name, "other directory");
+    check(bsp_dir_index_count(&loaded) == 0, name, "index not empty after a failed load");
+
+    int damaged = 0;
+    for (size_t pos = 0; pos < size; pos += 7) {
+        data[pos] ^= 0x20;
+        damaged += bsp_dir_index_load(&loaded, &key, data, size) == EILSEQ;
+        data[pos] ^= 0x20;
+    }
+    check(damaged == (int)((size + 6) / 7), name, "damaged byte accepted");
+    check(bsp_dir_index_load(&loaded, &key, data, size / 2) == EILSEQ, name, "truncated index accepted");
+    check(bsp_dir_index_load(&loaded, &key, data, 3) == EILSEQ, name, "short buffer accepted");
+    check(bsp_dir_index_load(&loaded, &key, data, size) == 0, name, "load after failures");
+
+    bsp_dir_index_t empty;
+    bsp_dir_index_init(&empty, NULL);
+    const size_t empty_size = bsp_dir_index_save(&empty, &key, data, size);
+    check(bsp_dir_index_load(&loaded, &key, data, empty_size) == 0 && bsp_dir_index_count(&loaded) == 0, name,
+          "empty directory");
+
+    free(data);
+    bsp_dir_index_clear(&index);
+    bsp_dir_index_clear(&loaded);
+}
+
+/* A listing of BIG_COUNT names, BATCH per step, with the first page read after every step */
+static void bench(void)
+{
+    static char storage[BIG_COUNT][40];
+    srand(3);
+    for (uint32_t i = 0; i < BIG_COUNT; i++) {
+        random_name(storage[i], sizeof(storage[i]), i);
+    }
+
+    bsp_dir_index_t index;
+    bsp_dir_index_init(&index, NULL);
+    bsp_dir_entry_t e[PAGE];
+    const double t0 = now_s();
+    for (uint32_t i = 0; i < BIG_COUNT; i++) {
+        bsp_dir_index_add(&index, storage[i] + 1, storage[i][0] == 'D');
+        if (i % BATCH == BATCH - 1) {
+            bsp_dir_index_page(&index, 0, PAGE, e);
+        }
+    }
+    const double paged_s = now_s() - t0;
+
+    bsp_dir_index_clear(&index);
+    const double t1 = now_s();
+    for (uint32_t i = 0; i < BIG_COUNT; i++) {
+        bsp_dir_index_add(&index, storage[i] + 1, storage[i][0] == 'D');
+    }
+    bsp_dir_index_sort(&index);
+    const double once_s = now_s() - t1;
+
+    const size_t bytes = index.capacity * 2 * sizeof(uint32_t) + index.block_count * (size_t)BSP_DIR_INDEX_BLOCK;
+    const bsp_dir_index_key_t key = { .volume_serial = 1, .path = "/usb" };
+    printf("%u names: %.1f ms paged every %d, %.1f ms sorted once, %zu KiB in memory, %zu KiB saved\n",
+           BIG_COUNT, paged_s * 1e3, BATCH, once_s * 1e3, bytes / 1024,
+           bsp_dir_index_save(&index, &key, NULL, 0) / 1024);
+    bsp_dir_index_clear(&index);
+}
+
+int main(void)
+{
+    test_order();
+    test_paging();
+    test_save();
+    bench();
+
+    return check_report();
+}
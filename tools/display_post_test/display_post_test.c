@@ -0,0 +1,193 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Host-side check for the slot table of the BSP UI update queue.
+ *
+ * Checks claiming, coalescing and forgetting keys, then that a post racing
+ * another post of the same key is not lost: the second poster waits for the
+ * first one's write and its newer payload is the one delivered. Last, two
+ * posters and a consumer race on real threads to look for torn payloads.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "bsp_post_table.h"
+#include "../common/check.h"
+
+#define SLOTS       (8)
+#define RACE_POSTS  (200000)
+
+typedef struct {
+    uint32_t poster;
+    uint32_t n;
+    uint32_t check;         /* ~n, to spot torn payloads */
+    uint32_t pad;
+} payload_t;
+
+_Static_assert(sizeof(payload_t) == BSP_POST_DATA_MAX, "payload fills the slot");
+
+static bsp_post_slot_t  s_slots[SLOTS];
+static bsp_post_table_t s_table;
+
+static void noop_cb(const void *data, void *user_ctx)
+{
+    (void)data;
+    (void)user_ctx;
+}
+
+static void reset(void)
+{
+    memset(s_slots, 0, sizeof(s_slots));
+    bsp_post_table_init(&s_table, s_slots, SLOTS);
+}
+
+static bool post(uintptr_t key, uint32_t poster, uint32_t n)
+{
+    const payload_t p = { .poster = poster, .n = n, .check = ~n };
+    bsp_post_slot_t *slot = bsp_post_table_claim(&s_table, key);
+    return slot && (bsp_post_slot_write(slot, noop_cb, NULL, &p, sizeof(p)), true);
+}
+
+/* Payload delivered for key, false if nothing is pending */
+static bool take(uintptr_t key, payload_t *out)
+{
+    bsp_post_cb_t cb;
+    void *user_ctx;
+    uint32_t data[BSP_POST_DATA_MAX / sizeof(uint32_t)];
+    bsp_post_slot_t *slot = bsp_post_table_claim(&s_table, key);
+    if (!slot || !bsp_post_slot_take(slot, &cb, &user_ctx, data)) {
+        return false;
+    }
+    memcpy(out, data, sizeof(*out));
+    return true;
+}
+
+static void test_table(void)
+{
+    const char *name = "table";
+    reset();
+    payload_t p;
+
+    check(!take(0x1000, &p), name, "nothing pending");
+    check(post(0x1000, 0, 1) && post(0x1000, 0, 2) && take(0x1000, &p) && p.n == 2, name, "coalesced");
+    check(!take(0x1000, &p), name, "applied twice");
+    check(s_table.used == 1, name, "one slot per key");
+    bsp_post_table_forget(&s_table, 0x1000);
+
+    for (uintptr_t key = 1; key <= SLOTS; key++) {
+        post(key * 0x40, 0, (uint32_t)key);
+    }
+    check(!post(0x2000, 0, 1), name, "post accepted with every slot in use");
+    bsp_post_table_forget(&s_table, 0x40);
+    check(post(0x2000, 0, 99) && take(0x2000, &p) && p.n == 99, name, "forgotten slot not reused");
+    bool kept = true;
+    for (uintptr_t key = 2; key <= SLOTS; key++) {
+        kept = kept && take(key * 0x40, &p) && p.n == key;
+    }
+    check(kept, name, "other keys lost by forget");
+    check(s_table.used == SLOTS, name, "slot count");
+}
+
+typedef struct {
+    bsp_post_slot_t *slot;
+    volatile int     done;
+} poster_t;
+
+static void *late_poster(void *arg)
+{
+    poster_t *w = arg;
+    const payload_t p = { .poster = 1, .n = 2, .check = ~2u };
+    bsp_post_slot_write(w->slot, noop_cb, NULL, &p, sizeof(p));
+    __atomic_store_n(&w->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/* A post that starts while an older one is being written must not be dropped in its favour */
+static void test_overlap(void)
+{
+    const char *name = "overlap";
+    reset();
+    payload_t p;
+    poster_t w = { .slot = bsp_post_table_claim(&s_table, 0x1000) };
+
+    const unsigned seq = bsp_post_slot_begin(w.slot);
+    const payload_t older = { .poster = 0, .n = 1, .check = ~1u };
+    bsp_post_slot_fill(w.slot, noop_cb, NULL, &older, sizeof(older));
+
+    pthread_t t;
+    pthread_create(&t, NULL, late_poster, &w);
+    usleep(20000);
+    check(!__atomic_load_n(&w.done, __ATOMIC_ACQUIRE), name, "second post did not wait for the first");
+    check(!take(0x1000, &p), name, "payload delivered while being written");
+
+    bsp_post_slot_end(w.slot, seq);
+    pthread_join(t, NULL);
+    check(take(0x1000, &p) && p.poster == 1 && p.n == 2, name, "newer payload lost");
+    check(!take(0x1000, &p), name, "applied twice");
+}
+
+static volatile int s_stop;
+
+static void *race_poster(void *arg)
+{
+    const uint32_t poster = (uint32_t)(uintptr_t)arg;
+    for (uint32_t n = 1; n <= RACE_POSTS; n++) {
+        post(0x1000, poster, n);
+    }
+    return NULL;
+}
+
+static void *race_consumer(void *arg)
+{
+    uint32_t *torn = arg;
+    payload_t p;
+    uint32_t last[2] = { 0, 0 };
+    while (!__atomic_load_n(&s_stop, __ATOMIC_ACQUIRE)) {
+        if (take(0x1000, &p)) {
+            if (p.poster > 1 || p.check != ~p.n || p.n < last[p.poster]) {
+                (*torn)++;
+            } else {
+                last[p.poster] = p.n;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void test_race(void)
+{
+    const char *name = "race";
+    reset();
+    uint32_t torn = 0;
+    pthread_t posters[2];
+    pthread_t consumer;
+    pthread_create(&consumer, NULL, race_consumer, &torn);
+    for (uintptr_t i = 0; i < 2; i++) {
+        pthread_create(&posters[i], NULL, race_poster, (void *)i);
+    }
+    for (int i = 0; i < 2; i++) {
+        pthread_join(posters[i], NULL);
+    }
+    __atomic_store_n(&s_stop, 1, __ATOMIC_RELEASE);
+    pthread_join(consumer, NULL);
+    check(torn == 0, name, "torn or out of order payloads");
+
+    /* Whoever wrote last, its final post is pending, or was just applied */
+    payload_t p;
+    check(!take(0x1000, &p) || p.n == RACE_POSTS, name, "final payload lost");
+    printf("%d posts from 2 threads of one key\n", 2 * RACE_POSTS);
+}
+
+int main(void)
+{
+    test_table();
+    test_overlap();
+    test_race();
+
+    return check_report();
+}
@@ -0,0 +1,716 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Host-side check for the BSP file service core.
+ *
+ * Runs requests against a temporary directory: open, write, read, stat,
+ * list, mkdir and close, sliced transfers, the priority order and the wait
+ * of an interactive request behind a bulk copy, cancellation of single requests
+ * and of everything under a path, stale and reused file handles, and a full
+ * queue. Then runs a worker thread the way the board's service task does,
+ * with submitters and an unplug racing it, and checks that every accepted
+ * request completes exactly once.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "bsp/file_service.h"
+#include "../common/check.h"
+
+#define SLOTS           (16)
+#define FILES           (4)
+#define SLICE           (4096)
+#define STEP_US         (1000)          /* simulated time of one step */
+#define BIG_SIZE        (256 * 1024)
+
+static int64_t s_now;                   /* simulated clock in [us] */
+static char    s_root[64];
+
+static bsp_fs_queue_t s_q;
+static bsp_fs_slot_t  s_slots[SLOTS];
+static bsp_fs_file_t  s_files[FILES];
+
+/* ── Completions ──────────────────────────────────────────────────────── */
+
+#define LOG_MAX     (256)
+
+static bsp_fs_result_t s_log[LOG_MAX];  /* completions in order */
+static int             s_logged;
+
+static void on_done(const bsp_fs_result_t *result, void *user_ctx)
+{
+    (void)user_ctx;
+    if (s_logged < LOG_MAX) {
+        s_log[s_logged] = *result;
+    }
+    s_logged++;
+}
+
+static const bsp_fs_result_t *find(uint32_t id)
+{
+    for (int i = 0; i < s_logged && i < LOG_MAX; i++) {
+        if (s_log[i].id == id) {
+            return &s_log[i];
+        }
+    }
+    return NULL;
+}
+
+static int position(uint32_t id)
+{
+    for (int i = 0; i < s_logged && i < LOG_MAX; i++) {
+        if (s_log[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* One step of the worker; false when the queue is empty */
+static bool run_step(void)
+{
+    bsp_fs_slot_t *slot = bsp_fs_queue_next(&s_q, s_now);
+    if (!slot) {
+        return false;
+    }
+    bsp_fs_queue_step(&s_q, slot);
+    s_now += STEP_US;
+    bsp_fs_completion_t c;
+    if (bsp_fs_queue_finish(&s_q, slot, &c) && c.on_done) {
+        c.on_done(&c.result, c.user_ctx);
+    }
+    return true;
+}
+
+static int run_all(void)
+{
+    int steps = 0;
+    while (run_step()) {
+        steps++;
+    }
+    return steps;
+}
+
+static void reset(size_t slice)
+{
+    bsp_fs_queue_init(&s_q, s_slots, SLOTS, s_files, FILES, slice);
+    s_logged = 0;
+    s_now = 0;
+}
+
+static uint32_t submit(const bsp_fs_request_t *req)
+{
+    uint32_t id = 0;
+    bsp_fs_request_t r = *req;
+    r.on_done = on_done;
+    return bsp_fs_queue_submit(&s_q, &r, s_now, &id) == 0 ? id : 0;
+}
+
+static uint32_t submit_open(const char *path, int flags, bsp_fs_prio_t prio)
+{
+    return submit(&(bsp_fs_request_t) {
+        .op = BSP_FS_OP_OPEN, .prio = prio, .path = path, .flags = flags,
+    });
+}
+
+static uint32_t submit_io(bsp_fs_op_t op, int32_t file, int64_t offset, void *buf, size_t len, bsp_fs_prio_t prio)
+{
+    return submit(&(bsp_fs_request_t) {
+        .op = op, .prio = prio, .file = file, .offset = offset, .buf = buf, .data = buf, .len = len,
+    });
+}
+
+static uint32_t submit_close(int32_t file)
+{
+    return submit(&(bsp_fs_request_t) {
+        .op = BSP_FS_OP_CLOSE, .prio = BSP_FS_PRIO_INTERACTIVE, .file = file,
+    });
+}
+
+static uint32_t submit_stat(const char *path, bsp_fs_prio_t prio)
+{
+    return submit(&(bsp_fs_request_t) {
+        .op = BSP_FS_OP_STAT, .prio = prio, .path = path,
+    });
+}
+
+/* Open synchronously through the queue */
+static int32_t open_now(const char *path, int flags)
+{
+    const uint32_t id = submit_open(path, flags, BSP_FS_PRIO_INTERACTIVE);
+    run_all();
+    const bsp_fs_result_t *r = find(id);
+    return (r && r->err == 0) ? r->file : BSP_FS_FILE_NONE;
+}
+
+static void fill(uint8_t *buf, size_t len, uint32_t seed)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)((i + seed) * 2654435761u >> 24);
+    }
+}
+
+/* ── Directory listing ────────────────────────────────────────────────── */
+
+typedef struct {
+    int  entries;
+    int  dirs;
+    int  dots;
+    int  stop_after;                    /* 0 to list everything */
+    bool seen[64];
+} list_ctx_t;
+
+static bool on_entry(const char *name, bool is_dir, void *user_ctx)
+{
+    list_ctx_t *ctx = user_ctx;
+    int n;
+    ctx->entries++;
+    ctx->dirs += is_dir;
+    if (name[0] == '.') {
+        ctx->dots++;
+    } else if (sscanf(name, "f%d", &n) == 1 && n >= 0 && n < 64) {
+        ctx->seen[n] = true;
+    }
+    return ctx->stop_after == 0 || ctx->entries < ctx->stop_after;
+}
+
+static uint32_t submit_list(const char *path, list_ctx_t *ctx, bsp_fs_prio_t prio)
+{
+    bsp_fs_request_t req = {
+        .op = BSP_FS_OP_LIST, .prio = prio, .path = path, .on_entry = on_entry, .user_ctx = ctx,
+    };
+    return submit(&req);
+}
+
+/* ── Tests ────────────────────────────────────────────────────────────── */
+
+static void test_init(void)
+{
+    const char *name = "init";
+    check(!bsp_fs_queue_init(&s_q, s_slots, 0, s_files, FILES, 0), name, "accepted 0 slots");
+    check(!bsp_fs_queue_init(&s_q, s_slots, SLOTS, s_files, 256, 0), name, "accepted 256 files");
+    check(!bsp_fs_queue_init(&s_q, NULL, SLOTS, s_files, FILES, 0), name, "accepted NULL slots");
+    check(bsp_fs_queue_init(&s_q, s_slots, SLOTS, s_files, FILES, 0), name, "valid queue refused");
+    check(bsp_fs_queue_next(&s_q, 0) == NULL, name, "empty queue returned a slot");
+
+    char long_path[BSP_FS_PATH_MAX + 8];
+    memset(long_path, 'a', sizeof(long_path) - 1);
+    long_path[sizeof(long_path) - 1] = '\0';
+    bsp_fs_request_t req = { .op = BSP_FS_OP_STAT, .path = long_path };
+    check(bsp_fs_queue_submit(&s_q, &req, 0, NULL) == EINVAL, name, "path too long accepted");
+    req = (bsp_fs_request_t) { .op = BSP_FS_OP_LIST, .path = s_root };
+    check(bsp_fs_queue_submit(&s_q, &req, 0, NULL) == EINVAL, name, "list without on_entry accepted");
+    req = (bsp_fs_request_t) { .op = BSP_FS_OP_READ, .file = 0, .len = 16 };
+    check(bsp_fs_queue_submit(&s_q, &req, 0, NULL) == EINVAL, name, "read without buffer accepted");
+    req = (bsp_fs_request_t) { .op = BSP_FS_OP_STAT, .prio = BSP_FS_PRIO_COUNT, .path = s_root };
+    check(bsp_fs_queue_submit(&s_q, &req, 0, NULL) == EINVAL, name, "bad priority accepted");
+    check(s_q.stats.submitted == 0, name, "rejected requests counted as submitted");
+}
+
+static void test_file_io(void)
+{
+    const char *name = "file_io";
+    static uint8_t data[BIG_SIZE];
+    static uint8_t back[BIG_SIZE];
+    char path[128];
+    snprintf(path, sizeof(path), "%s/big.bin", s_root);
+    fill(data, sizeof(data), 7);
+    reset(SLICE);
+
+    const int32_t wf = open_now(path, O_WRONLY | O_CREAT | O_TRUNC);
+    check(wf != BSP_FS_FILE_NONE, name, "open for writing");
+    const uint32_t w = submit_io(BSP_FS_OP_WRITE, wf, 0, data, sizeof(data), BSP_FS_PRIO_BULK);
+    const int steps = run_all();
+    check(steps == BIG_SIZE / SLICE, name, "write not sliced");
+    check(find(w) && find(w)->err == 0 && find(w)->len == BIG_SIZE, name, "write result");
+    const uint32_t c = submit_close(wf);
+    run_all();
+    check(find(c) && find(c)->err == 0, name, "close");
+
+    const uint32_t st = submit_stat(path, BSP_FS_PRIO_INTERACTIVE);
+    run_all();
+    const bsp_fs_result_t *r = find(st);
+    check(r && r->err == 0 && r->size == BIG_SIZE && !r->is_dir && r->mtime > 0, name, "stat of the file");
+
+    /* Read at an offset, then on from there, then past the end */
+    const int32_t rf = open_now(path, O_RDONLY);
+    const uint32_t r1 = submit_io(BSP_FS_OP_READ, rf, 1000, back, 5000, BSP_FS_PRIO_INTERACTIVE);
+    const uint32_t r2 = submit_io(BSP_FS_OP_READ, rf, BSP_FS_POS_CURRENT, back + 5000, 3000, BSP_FS_PRIO_INTERACTIVE);
+    const uint32_t r3 = submit_io(BSP_FS_OP_READ, rf, BIG_SIZE - 100, back, 4096, BSP_FS_PRIO_INTERACTIVE);
+    run_all();
+    check(find(r1) && find(r1)->err == 0 && find(r1)->len == 5000, name, "read at an offset");
+    check(find(r2) && find(r2)->err == 0 && find(r2)->len == 3000, name, "read on");
+    check(memcmp(back + 5000, data + 6000, 3000) == 0, name, "data read on");
+    check(find(r3) && find(r3)->err == 0 && find(r3)->len == 100, name, "short read at the end");
+    check(memcmp(back, data + BIG_SIZE - 100, 100) == 0, name, "data at the end");
+
+    /* Whole file back, in slices */
+    const uint32_t all = submit_io(BSP_FS_OP_READ, rf, 0, back, sizeof(back), BSP_FS_PRIO_BULK);
+    run_all();
+    check(find(all) && find(all)->len == BIG_SIZE && memcmp(back, data, BIG_SIZE) == 0, name, "whole file");
+    submit_close(rf);
+    run_all();
+
+    bsp_fs_stats_t stats;
+    bsp_fs_queue_get_stats(&s_q, &stats);
+    check(stats.bytes_written == BIG_SIZE, name, "bytes written");
+    check(stats.bytes_read == 5000 + 3000 + 100 + BIG_SIZE, name, "bytes read");
+    check(stats.failed == 0 && stats.queued == 0, name, "stats");
+
+    /* Errors are reported, not raised */
+    snprintf(path, sizeof(path), "%s/missing", s_root);
+    const uint32_t e1 = submit_stat(path, BSP_FS_PRIO_INTERACTIVE);
+    const uint32_t e2 = submit_open(path, O_RDONLY, BSP_FS_PRIO_INTERACTIVE);
+    const uint32_t e3 = submit_io(BSP_FS_OP_READ, rf, 0, back, 16, BSP_FS_PRIO_INTERACTIVE);
+    run_all();
+    check(find(e1) && find(e1)->err == ENOENT, name, "stat of a missing file");
+    check(find(e2) && find(e2)->err == ENOENT, name, "open of a missing file");
+    check(find(e3) && find(e3)->err == EBADF, name, "read of a closed file");
+    bsp_fs_queue_get_stats(&s_q, &stats);
+    check(stats.failed == 3, name, "failures counted");
+}
+
+static void test_handles(void)
+{
+    const char *name = "handles";
+    char path[128];
+    snprintf(path, sizeof(path), "%s/big.bin", s_root);
+    reset(0);
+
+    int32_t f[FILES];
+    for (int i = 0; i < FILES; i++) {
+        f[i] = open_now(path, O_RDONLY);
+        check(f[i] != BSP_FS_FILE_NONE, name, "open");
+    }
+    const uint32_t extra = submit_open(path, O_RDONLY, BSP_FS_PRIO_INTERACTIVE);
+    run_all();
+    check(find(extra) && find(extra)->err == EMFILE, name, "open beyond the file table");
+
+    /* The entry of a closed file is reused; the old handle must not reach the new file */
+    submit_close(f[1]);
+    run_all();
+    const int32_t again = open_now(path, O_RDONLY);
+    check(again != BSP_FS_FILE_NONE && again != f[1], name, "reopened file has a new handle");
+    uint8_t buf[16];
+    const uint32_t old = submit_io(BSP_FS_OP_READ, f[1], 0, buf, sizeof(buf), BSP_FS_PRIO_INTERACTIVE);
+    const uint32_t cur = submit_io(BSP_FS_OP_READ, again, 0, buf, sizeof(buf), BSP_FS_PRIO_INTERACTIVE);
+    run_all();
+    check(find(old) && find(old)->err == EBADF, name, "old handle accepted");
+    check(find(cur) && find(cur)->err == 0 && find(cur)->len == sizeof(buf), name, "new handle refused");
+    for (int i = 0; i < FILES; i++) {
+        submit_close(i == 1 ? again : f[i]);
+    }
+    run_all();
+}
+
+static void test_list(void)
+{
+    const char *name = "list";
+    char dir[128];
+    char path[192];
+    snprintf(dir, sizeof(dir), "%s/list", s_root);
+    mkdir(dir, 0755);
+    for (int i = 0; i < 40; i++) {
+        snprintf(path, sizeof(path), "%s/f%d", dir, i);
+        close(open(path, O_WRONLY | O_CREAT, 0644));
+    }
+    for (int i = 40; i < 43; i++) {
+        snprintf(path, sizeof(path), "%s/f%d", dir, i);
+        mkdir(path, 0755);
+    }
+    reset(0);
+
+    list_ctx_t ctx = {0};
+    const uint32_t id = submit_list(dir, &ctx, BSP_FS_PRIO_INTERACTIVE);
+    const int steps = run_all();
+    const bsp_fs_result_t *r = find(id);
+    check(r && r->err == 0 && r->len == 43, name, "entry count");
+    check(ctx.entries == 43 && ctx.dirs == 3 && ctx.dots == 0, name, "entries, directories, dot entries");
+    bool all = true;
+    for (int i = 0; i < 43; i++) {
+        all = all && ctx.seen[i];
+    }
+    check(all, name, "every entry listed");
+    check(steps == 43 / BSP_FS_LIST_BATCH + 1, name, "listing not batched");
+
+    list_ctx_t part = { .stop_after = 5 };
+    const uint32_t stopped = submit_list(dir, &part, BSP_FS_PRIO_INTERACTIVE);
+    run_all();
+    check(part.entries == 5 && find(stopped) && find(stopped)->len == 5 && find(stopped)->err == 0, name,
+          "listing stopped by the callback");
+
+    const uint32_t st = submit_stat(dir, BSP_FS_PRIO_INTERACTIVE);
+    run_all();
+    check(find(st) && find(st)->is_dir, name, "stat of a directory");
+
+    snprintf(path, sizeof(path), "%s/none", dir);
+    list_ctx_t none = {0};
+    const uint32_t missing = submit_list(path, &none, BSP_FS_PRIO_INTERACTIVE);
+    run_all();
+    check(find(missing) && find(missing)->err == ENOENT && none.entries == 0, name, "missing directory");
+
+    bsp_fs_request_t req = { .op = BSP_FS_OP_MKDIR, .prio = BSP_FS_PRIO_INTERACTIVE, .path = path };
+    const uint32_t made = submit(&req);
+    const uint32_t again = submit(&req);
+    run_all();
+    struct stat made_st;
+    check(find(made) && find(made)->err == 0 && stat(path, &made_st) == 0 && S_ISDIR(made_st.st_mode), name,
+          "mkdir");
+    check(find(again) && find(again)->err == EEXIST, name, "mkdir of an existing directory");
+}
+
+static void test_priority(void)
+{
+    const char *name = "priority";
+    static uint8_t buf[BIG_SIZE];
+    char path[128];
+    snprintf(path, sizeof(path), "%s/big.bin", s_root);
+    reset(SLICE);
+
+    const int32_t f = open_now(path, O_RDONLY);
+    s_logged = 0;
+    const uint32_t bulk = submit_io(BSP_FS_OP_READ, f, 0, buf, sizeof(buf), BSP_FS_PRIO_BULK);
+    const uint32_t bulk2 = submit_stat(path, BSP_FS_PRIO_BULK);
+    for (int i = 0; i < 5; i++) {
+        run_step();
+    }
+
+    /* Submitted in the middle of the copy: runs at the next step, in submission order per priority */
+    const uint32_t normal = submit_stat(path, BSP_FS_PRIO_NORMAL);
+    const uint32_t ui1 = submit_stat(path, BSP_FS_PRIO_INTERACTIVE);
+    const uint32_t ui2 = submit_stat(s_root, BSP_FS_PRIO_INTERACTIVE);
+    run_step();
+    check(s_logged == 1 && s_log[0].id == ui1, name, "interactive request did not overtake the copy");
+    run_all();
+    check(position(ui1) < position(ui2), name, "interactive requests out of order");
+    check(position(ui2) < position(normal), name, "normal request before an interactive one");
+    check(position(normal) < position(bulk), name, "copy before a normal request");
+    check(position(bulk) < position(bulk2), name, "bulk requests out of order");
+    check(find(bulk) && find(bulk)->len == BIG_SIZE, name, "interrupted copy incomplete");
+
+    bsp_fs_stats_t stats;
+    bsp_fs_queue_get_stats(&s_q, &stats);
+    check(stats.wait_max_us[BSP_FS_PRIO_INTERACTIVE] <= 2 * STEP_US, name, "interactive wait");
+    check(stats.wait_max_us[BSP_FS_PRIO_BULK] >= (BIG_SIZE / SLICE) * STEP_US, name, "bulk wait");
+    printf("%-12s copy of %d slices: interactive wait %lld us, second bulk request %lld us (1 step = %d us)\n",
+           name, BIG_SIZE / SLICE, (long long)stats.wait_max_us[BSP_FS_PRIO_INTERACTIVE],
+           (long long)stats.wait_max_us[BSP_FS_PRIO_BULK], STEP_US);
+    submit_close(f);
+    run_all();
+}
+
+static void test_cancel(void)
+{
+    const char *name = "cancel";
+    static uint8_t buf[BIG_SIZE];
+    char path[128];
+    snprintf(path, sizeof(path), "%s/big.bin", s_root);
+    reset(SLICE);
+
+    const int32_t f = open_now(path, O_RDONLY);
+    s_logged = 0;
+    const uint32_t copy = submit_io(BSP_FS_OP_READ, f, 0, buf, sizeof(buf), BSP_FS_PRIO_BULK);
+    const uint32_t waiting = submit_stat(path, BSP_FS_PRIO_BULK);
+    run_step();
+    run_step();
+
+    /* A waiting request completes first, even before a normal one */
+    const uint32_t keep = submit_stat(path, BSP_FS_PRIO_NORMAL);
+    check(bsp_fs_queue_cancel(&s_q, waiting), name, "waiting request not found");
+    run_step();
+    check(s_logged == 1 && s_log[0].id == waiting && s_log[0].err == ECANCELED, name, "cancelled first");
+
+    /* The copy stops after its current step, with what it read so far */
+    run_step();
+    check(bsp_fs_queue_cancel(&s_q, copy), name, "copy not found");
+    run_all();
+    const bsp_fs_result_t *r = find(copy);
+    check(r && r->err == ECANCELED && r->len > 0 && r->len < BIG_SIZE, name, "copy cancelled midway");
+    check(find(keep) && find(keep)->err == 0, name, "other request cancelled");
+    check(!bsp_fs_queue_cancel(&s_q, copy), name, "completed request cancelled again");
+    check(!bsp_fs_queue_cancel(&s_q, 0), name, "id 0 cancelled");
+
+    bsp_fs_stats_t stats;
+    bsp_fs_queue_get_stats(&s_q, &stats);
+    check(stats.cancelled == 2 && stats.failed == 0, name, "cancellations counted");
+    submit_close(f);
+    run_all();
+}
+
+static void test_cancel_path(void)
+{
+    const char *name = "cancel_path";
+    static uint8_t buf[BIG_SIZE];
+    char vol[128];
+    char other[128];
+    char path[192];
+    snprintf(vol, sizeof(vol), "%s/vol", s_root);
+    snprintf(other, sizeof(other), "%s/volume2", s_root);
+    mkdir(vol, 0755);
+    mkdir(other, 0755);
+    snprintf(path, sizeof(path), "%s/a.bin", vol);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    check(write(fd, buf, sizeof(buf)) == (ssize_t)sizeof(buf), name, "setup");
+    close(fd);
+    for (int i = 0; i < 2 * BSP_FS_LIST_BATCH; i++) {
+        snprintf(path, sizeof(path), "%s/f%d", vol, i);
+        close(open(path, O_WRONLY | O_CREAT, 0644));
+    }
+    snprintf(path, sizeof(path), "%s/a.bin", vol);
+    reset(SLICE);
+
+    const int32_t in_vol = open_now(path, O_RDONLY);
+    const int32_t idle = open_now(path, O_RDONLY);
+    snprintf(path, sizeof(path), "%s/b.bin", other);
+    const int32_t outside = open_now(path, O_WRONLY | O_CREAT | O_TRUNC);
+    s_logged = 0;
+
+    /* A listing left half done, then a copy that runs when the drive goes away */
+    list_ctx_t ctx = {0};
+    const uint32_t list = submit_list(vol, &ctx, BSP_FS_PRIO_BULK);
+    bsp_fs_slot_t *slot = bsp_fs_queue_next(&s_q, s_now);
+    check(slot && slot->id == list, name, "first step");
+    bsp_fs_queue_step(&s_q, slot);
+    bsp_fs_completion_t c;
+    check(!bsp_fs_queue_finish(&s_q, slot, &c), name, "listing finished in one step");
+
+    const uint32_t copy = submit_io(BSP_FS_OP_READ, in_vol, 0, buf, sizeof(buf), BSP_FS_PRIO_NORMAL);
+    const uint32_t stat_out = submit_stat(other, BSP_FS_PRIO_NORMAL);
+    const uint32_t write_out = submit_io(BSP_FS_OP_WRITE, outside, 0, buf, 1000, BSP_FS_PRIO_NORMAL);
+    slot = bsp_fs_queue_next(&s_q, s_now);
+    check(slot && slot->id == copy, name, "copy not next");
+    bsp_fs_queue_step(&s_q, slot);
+
+    const uint32_t n = bsp_fs_queue_cancel_path(&s_q, vol);
+    check(n == 2, name, "cancelled count");
+    check(s_q.files[in_vol & 0xFF].fd >= 0, name, "file closed under a running step");
+    check(s_q.files[idle & 0xFF].fd < 0, name, "idle file left open");
+    check(s_q.files[outside & 0xFF].fd >= 0, name, "file of another path closed");
+    check(bsp_fs_queue_busy(&s_q, vol), name, "not busy with a running request");
+    if (bsp_fs_queue_finish(&s_q, slot, &c)) {
+        on_done(&c.result, c.user_ctx);
+    }
+    check(s_q.files[in_vol & 0xFF].fd < 0, name, "file left open after its step");
+    run_all();
+
+    check(!bsp_fs_queue_busy(&s_q, vol), name, "still busy after cancellation");
+    check(find(copy) && find(copy)->err == ECANCELED, name, "copy not cancelled");
+    check(find(list) && find(list)->err == ECANCELED, name, "listing not cancelled");
+    check(find(stat_out) && find(stat_out)->err == 0, name, "request of another path cancelled");
+    check(find(write_out) && find(write_out)->err == 0, name, "write to another path cancelled");
+
+    /* Files of the volume stay allocated and fail until the application closes them */
+    uint8_t small[16];
+    const uint32_t late = submit_io(BSP_FS_OP_READ, idle, 0, small, sizeof(small), BSP_FS_PRIO_INTERACTIVE);
+    const uint32_t c1 = submit_close(in_vol);
+    const uint32_t c2 = submit_close(idle);
+    run_all();
+    check(find(late) && find(late)->err == ECANCELED, name, "read of an invalidated file");
+    check(find(c1) && find(c1)->err == 0 && find(c2) && find(c2)->err == 0, name, "close of invalidated files");
+    check(bsp_fs_queue_cancel_path(&s_q, "/") == 0, name, "nothing left to cancel");
+    submit_close(outside);
+    run_all();
+}
+
+static void test_full(void)
+{
+    const char *name = "full";
+    reset(0);
+    for (int i = 0; i < SLOTS; i++) {
+        check(submit_stat(s_root, BSP_FS_PRIO_NORMAL) != 0, name, "request refused");
+    }
+    bsp_fs_request_t req = { .op = BSP_FS_OP_STAT, .path = s_root };
+    check(bsp_fs_queue_submit(&s_q, &req, 0, NULL) == EAGAIN, name, "full queue accepted a request");
+    run_step();
+    check(bsp_fs_queue_submit(&s_q, &req, 0, NULL) == 0, name, "freed slot not reused");
+    run_all();
+
+    bsp_fs_stats_t stats;
+    bsp_fs_queue_get_stats(&s_q, &stats);
+    check(stats.rejected == 1 && stats.submitted == SLOTS + 1 && stats.completed == SLOTS + 1, name, "stats");
+    check(stats.queued == 0 && stats.queued_max == SLOTS, name, "queue depth");
+}
+
+/* ── Worker thread, the way the service task runs the queue ───────────── */
+
+#define RACE_SUBMITTERS (3)
+#define RACE_REQUESTS   (2000)
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  s_wake = PTHREAD_COND_INITIALIZER;
+static bool            s_stop;
+static uint8_t         s_done_count[RACE_SUBMITTERS * RACE_REQUESTS];
+static int             s_completions;
+
+typedef struct {
+    int  base;
+    char path[128];
+    int  accepted;
+} race_ctx_t;
+
+static void race_done(const bsp_fs_result_t *result, void *user_ctx)
+{
+    (void)result;
+    const int tag = (int)(intptr_t)user_ctx;
+    __atomic_add_fetch(&s_done_count[tag], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s_completions, 1, __ATOMIC_RELAXED);
+}
+
+static bool race_entry(const char *name, bool is_dir, void *user_ctx)
+{
+    (void)name;
+    (void)is_dir;
+    (void)user_ctx;
+    return true;
+}
+
+static void *race_worker(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&s_lock);
+    for (;;) {
+        bsp_fs_slot_t *slot = bsp_fs_queue_next(&s_q, 0);
+        if (!slot) {
+            if (s_stop) {
+                break;
+            }
+            pthread_cond_wait(&s_wake, &s_lock);
+            continue;
+        }
+        pthread_mutex_unlock(&s_lock);
+        bsp_fs_queue_step(&s_q, slot);
+        pthread_mutex_lock(&s_lock);
+        bsp_fs_completion_t c;
+        if (bsp_fs_queue_finish(&s_q, slot, &c)) {
+            pthread_mutex_unlock(&s_lock);
+            c.on_done(&c.result, c.user_ctx);
+            pthread_mutex_lock(&s_lock);
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return NULL;
+}
+
+static void *race_submitter(void *arg)
+{
+    race_ctx_t *ctx = arg;
+    for (int i = 0; i < RACE_REQUESTS; i++) {
+        bsp_fs_request_t req = {
+            .op = (i % 3 == 0) ? BSP_FS_OP_LIST : BSP_FS_OP_STAT,
+            .prio = (bsp_fs_prio_t)(i % BSP_FS_PRIO_COUNT),
+            .path = ctx->path,
+            .on_entry = race_entry,
+            .on_done = race_done,
+            .user_ctx = (void *)(intptr_t)(ctx->base + i),
+        };
+        int ret;
+        do {
+            pthread_mutex_lock(&s_lock);
+            ret = bsp_fs_queue_submit(&s_q, &req, 0, NULL);
+            pthread_cond_signal(&s_wake);
+            pthread_mutex_unlock(&s_lock);
+            if (ret == EAGAIN) {
+                usleep(50);
+            }
+        } while (ret == EAGAIN);
+        ctx->accepted += (ret == 0);
+        if (i % 200 == 100) {
+            /* Unplug: cancel everything of this submitter, then wait until nothing runs there */
+            pthread_mutex_lock(&s_lock);
+            bsp_fs_queue_cancel_path(&s_q, ctx->path);
+            pthread_mutex_unlock(&s_lock);
+            bool busy = true;
+            while (busy) {
+                pthread_mutex_lock(&s_lock);
+                busy = bsp_fs_queue_busy(&s_q, ctx->path);
+                pthread_mutex_unlock(&s_lock);
+            }
+        }
+    }
+    return NULL;
+}
+
+static void test_race(void)
+{
+    const char *name = "race";
+    reset(SLICE);
+    s_stop = false;
+    s_completions = 0;
+    memset(s_done_count, 0, sizeof(s_done_count));
+
+    race_ctx_t ctx[RACE_SUBMITTERS];
+    pthread_t submitters[RACE_SUBMITTERS];
+    pthread_t worker;
+    pthread_create(&worker, NULL, race_worker, NULL);
+    for (int i = 0; i < RACE_SUBMITTERS; i++) {
+        ctx[i] = (race_ctx_t) { .base = i * RACE_REQUESTS };
+        snprintf(ctx[i].path, sizeof(ctx[i].path), "%s/list", s_root);
+        if (i == 1) {
+            snprintf(ctx[i].path, sizeof(ctx[i].path), "%s/vol", s_root);
+        }
+        pthread_create(&submitters[i], NULL, race_submitter, &ctx[i]);
+    }
+    for (int i = 0; i < RACE_SUBMITTERS; i++) {
+        pthread_join(submitters[i], NULL);
+    }
+    pthread_mutex_lock(&s_lock);
+    s_stop = true;
+    pthread_cond_signal(&s_wake);
+    pthread_mutex_unlock(&s_lock);
+    pthread_join(worker, NULL);
+
+    int accepted = 0;
+    int twice = 0;
+    int never = 0;
+    for (int i = 0; i < RACE_SUBMITTERS; i++) {
+        accepted += ctx[i].accepted;
+    }
+    for (int i = 0; i < RACE_SUBMITTERS * RACE_REQUESTS; i++) {
+        twice += s_done_count[i] > 1;
+        never += s_done_count[i] == 0;
+    }
+    bsp_fs_stats_t stats;
+    bsp_fs_queue_get_stats(&s_q, &stats);
+    check(accepted == RACE_SUBMITTERS * RACE_REQUESTS, name, "requests refused");
+    check(never == 0, name, "requests never completed");
+    check(twice == 0, name, "requests completed twice");
+    check(s_completions == accepted && stats.completed == (uint32_t)accepted, name, "completion count");
+    check(stats.queued == 0 && stats.failed == 0, name, "stats");
+    printf("%-12s %d requests from %d threads: %u cancelled by unplugs, %u rejected while full, "
+           "queue depth %u\n", name, accepted, RACE_SUBMITTERS, stats.cancelled, stats.rejected, stats.queued_max);
+}
+
+int main(void)
+{
+    snprintf(s_root, sizeof(s_root), "/tmp/fs_test_XXXXXX");
+    if (!mkdtemp(s_root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    test_init();
+    test_file_io();
+    test_handles();
+    test_list();
+    test_priority();
+    test_cancel();
+    test_cancel_path();
+    test_full();
+    test_race();
+
+    char cmd[96];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", s_root);
+    if (system(cmd) != 0) {
+        printf("could not remove %s\n", s_root);
+    }
+    return check_report();
+}
@@ -0,0 +1,354 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Host-side check for the BSP gesture recognizer.
+ *
+ * Without arguments, replays synthetic traces (tap, drag, long press, pinch,
+ * rotate, two-finger scroll...) and checks the recognized gestures, then
+ * measures the cost per sample. With a trace file, replays it and prints the
+ * events.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bsp/gesture.h"
+#include "bsp/touch_trace.h"
+#include "../common/check.h"
+
+#define PERIOD_MS   (10)
+#define MAX_EVENTS  (4096)
+
+static const char *const s_type_names[] = { "none", "long_press", "pinch", "rotate", "scroll" };
+static const char *const s_phase_names[] = { "begin", "update", "end" };
+
+static bsp_gesture_event_t s_events[MAX_EVENTS];
+static int                 s_event_count;
+
+static void record_cb(const bsp_gesture_event_t *event, void *user_ctx)
+{
+    (void)user_ctx;
+    if (s_event_count < MAX_EVENTS) {
+        s_events[s_event_count++] = *event;
+    }
+}
+
+static void print_cb(const bsp_gesture_event_t *event, void *user_ctx)
+{
+    (void)user_ctx;
+    printf("%8u ms %-10s %-6s x=%d y=%d scale=%.3f angle=%.1f d=(%d,%d) total=(%d,%d)\n",
+           (unsigned)event->time_ms, s_type_names[event->type], s_phase_names[event->phase], event->x, event->y,
+           event->scale_q16 / 65536.0, event->angle_ddeg / 10.0, event->dx, event->dy, event->total_dx,
+           event->total_dy);
+}
+
+/* Synthetic trace builder: two fingers around a centre, interpolated over a number of samples */
+typedef struct {
+    bsp_gesture_t g;
+    uint32_t      t;
+} replay_t;
+
+static void replay_start(replay_t *r)
+{
+    s_event_count = 0;
+    bsp_gesture_init(&r->g, NULL, record_cb, NULL);
+    r->t = 1000;
+}
+
+static void replay_sample(replay_t *r, const bsp_gesture_point_t *pts, uint8_t count)
+{
+    bsp_gesture_feed(&r->g, pts, count, r->t);
+    r->t += PERIOD_MS;
+}
+
+static void replay_lift(replay_t *r)
+{
+    replay_sample(r, NULL, 0);
+}
+
+static void two_fingers(bsp_gesture_point_t pts[2], double cx, double cy, double dist, double deg)
+{
+    const double rad = deg * M_PI / 180.0;
+    const double hx = cos(rad) * dist / 2;
+    const double hy = sin(rad) * dist / 2;
+    pts[0] = (bsp_gesture_point_t){ (int16_t)lround(cx - hx), (int16_t)lround(cy - hy), 1 };
+    pts[1] = (bsp_gesture_point_t){ (int16_t)lround(cx + hx), (int16_t)lround(cy + hy), 2 };
+}
+
+/* Moves two fingers linearly from one pose to another, then lifts them */
+static void replay_two(replay_t *r, double cx0, double cy0, double dist0, double deg0,
+                       double cx1, double cy1, double dist1, double deg1, int steps)
+{
+    bsp_gesture_point_t pts[2];
+    for (int i = 0; i <= steps; i++) {
+        const double f = (double)i / steps;
+        two_fingers(pts, cx0 + (cx1 - cx0) * f, cy0 + (cy1 - cy0) * f, dist0 + (dist1 - dist0) * f,
+                    deg0 + (deg1 - deg0) * f);
+        replay_sample(r, pts, 2);
+    }
+    replay_lift(r);
+}
+
+/* Checks the recorded events form exactly one BEGIN..END sequence of the given type */
+static const bsp_gesture_event_t *check_single(const char *name, bsp_gesture_type_t type)
+{
+    if (s_event_count < 2) {
+        check(0, name, "no gesture");
+        return NULL;
+    }
+    for (int i = 0; i < s_event_count; i++) {
+        const bsp_gesture_phase_t expected = i == 0 ? BSP_GESTURE_BEGIN
+                                             : i == s_event_count - 1 ? BSP_GESTURE_END : BSP_GESTURE_UPDATE;
+        if (s_events[i].type != type || s_events[i].phase != expected) {
+            printf("FAIL %s: event %d is %s %s, expected %s %s\n", name, i, s_type_names[s_events[i].type],
+                   s_phase_names[s_events[i].phase], s_type_names[type], s_phase_names[expected]);
+            s_failures++;
+            return NULL;
+        }
+    }
+    return &s_events[s_event_count - 1];
+}
+
+static void test_tap_and_drag(void)
+{
+    replay_t r;
+    replay_start(&r);
+    const bsp_gesture_point_t p = { 100, 100, 0 };
+    for (int i = 0; i < 10; i++) {
+        replay_sample(&r, &p, 1);
+    }
+    replay_lift(&r);
+    check(s_event_count == 0, "tap", "unexpected gesture");
+
+    replay_start(&r);
+    for (int i = 0; i < 100; i++) {
+        const bsp_gesture_point_t q = { (int16_t)(100 + i * 3), 100, 0 };
+        replay_sample(&r, &q, 1);
+    }
+    replay_lift(&r);
+    check(s_event_count == 0, "drag", "unexpected gesture");
+}
+
+static void test_long_press(void)
+{
+    replay_t r;
+    replay_start(&r);
+    const uint32_t down = r.t;
+    for (int i = 0; i < 100; i++) {
+        /* 2 px jitter stays within the slop */
+        const bsp_gesture_point_t p = { (int16_t)(300 + (i & 1) * 2), (int16_t)(200 - (i & 2)), 0 };
+        replay_sample(&r, &p, 1);
+    }
+    replay_lift(&r);
+    const bsp_gesture_event_t *end = check_single("long_press", BSP_GESTURE_LONG_PRESS);
+    if (end) {
+        const uint32_t held = s_events[0].time_ms - down;
+        check(held >= 600 && held < 600 + PERIOD_MS, "long_press", "BEGIN not 600 ms after landing");
+    }
+}
+
+static void test_pinch(const char *name, double dist0, double dist1)
+{
+    replay_t r;
+    replay_start(&r);
+    replay_two(&r, 400, 240, dist0, 30, 400, 240, dist1, 30, 30);
+    const bsp_gesture_event_t *end = check_single(name, BSP_GESTURE_PINCH);
+    if (end) {
+        const double scale = end->scale_q16 / 65536.0;
+        if (fabs(scale - dist1 / dist0) > 0.02) {
+            printf("FAIL %s: scale %.3f, expected %.3f\n", name, scale, dist1 / dist0);
+            s_failures++;
+        }
+    }
+}
+
+static void test_rotate(const char *name, double deg0, double deg1)
+{
+    replay_t r;
+    replay_start(&r);
+    replay_two(&r, 400, 240, 300, deg0, 400, 240, 300, deg1, 40);
+    const bsp_gesture_event_t *end = check_single(name, BSP_GESTURE_ROTATE);
+    if (end && abs(end->angle_ddeg - (int)lround((deg1 - deg0) * 10)) > 5) {
+        printf("FAIL %s: angle %.1f, expected %.1f\n", name, end->angle_ddeg / 10.0, deg1 - deg0);
+        s_failures++;
+    }
+}
+
+/* Every rotation from -179 to 179 degrees, starting from every octant, within 0.5 degree */
+static void test_angle_sweep(void)
+{
+    int worst = 0;
+    for (int start = 0; start < 360; start += 45) {
+        for (int deg = -179; deg <= 179; deg++) {
+            if (abs(deg) < 20) {
+                continue;
+            }
+            replay_t r;
+            replay_start(&r);
+            bsp_gesture_point_t pts[2];
+            two_fingers(pts, 400, 240, 400, start);
+            replay_sample(&r, pts, 2);
+            two_fingers(pts, 400, 240, 400, start + deg);
+            replay_sample(&r, pts, 2);
+            replay_lift(&r);
+            if (s_event_count != 2 || s_events[0].type != BSP_GESTURE_ROTATE) {
+                printf("FAIL angle_sweep: %d -> %d degrees not a rotate\n", start, start + deg);
+                s_failures++;
+                continue;
+            }
+            const int err = abs(s_events[0].angle_ddeg - deg * 10);
+            if (err > worst) {
+                worst = err;
+            }
+        }
+    }
+    check(worst <= 5, "angle_sweep", "angle error above 0.5 degree");
+    printf("angle_sweep: worst error %.1f degree\n", worst / 10.0);
+}
+
+static void test_scroll(void)
+{
+    replay_t r;
+    replay_start(&r);
+    replay_two(&r, 400, 300, 150, 0, 380, 150, 150, 0, 25);
+    const bsp_gesture_event_t *end = check_single("scroll", BSP_GESTURE_SCROLL);
+    if (end) {
+        int sum_dx = 0;
+        int sum_dy = 0;
+        for (int i = 0; i < s_event_count; i++) {
+            sum_dx += s_events[i].dx;
+            sum_dy += s_events[i].dy;
+        }
+        check(end->total_dx == -20 && end->total_dy == -150, "scroll", "wrong total movement");
+        check(sum_dx == end->total_dx && sum_dy == end->total_dy, "scroll", "deltas do not add up to the total");
+    }
+}
+
+/* A third finger landing and lifting again does not disturb the tracked pair */
+static void test_third_finger(void)
+{
+    replay_t r;
+    replay_start(&r);
+    bsp_gesture_point_t pts[3];
+    for (int i = 0; i <= 30; i++) {
+        two_fingers(pts, 400, 240, 100 + i * 5, 0);
+        pts[2] = (bsp_gesture_point_t){ 700, 400, 3 };
+        replay_sample(&r, pts, (i >= 10 && i < 20) ? 3 : 2);
+    }
+    replay_lift(&r);
+    const bsp_gesture_event_t *end = check_single("third_finger", BSP_GESTURE_PINCH);
+    check(end && abs(end->scale_q16 - 163840) < 1311, "third_finger", "wrong scale");
+}
+
+/* Lifting one finger ends the gesture; no long press before every finger is lifted */
+static void test_lift_one(void)
+{
+    replay_t r;
+    replay_start(&r);
+    bsp_gesture_point_t pts[2];
+    for (int i = 0; i <= 20; i++) {
+        two_fingers(pts, 400, 240, 100 + i * 5, 0);
+        replay_sample(&r, pts, 2);
+    }
+    for (int i = 0; i < 100; i++) {
+        replay_sample(&r, &pts[1], 1);
+    }
+    replay_lift(&r);
+    check_single("lift_one", BSP_GESTURE_PINCH);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void noop_cb(const bsp_gesture_event_t *event, void *user_ctx)
+{
+    (void)event;
+    (void)user_ctx;
+}
+
+/* Cost of bsp_gesture_feed() alone, over a pre-built pinch-and-rotate trace */
+static void bench(void)
+{
+    enum { STEPS = 200, ITERATIONS = 5000 };
+    static bsp_gesture_point_t trace[STEPS][2];
+    for (int i = 0; i < STEPS; i++) {
+        two_fingers(trace[i], 400 + i / 10, 240, 100 + i, i / 2.0);
+    }
+
+    bsp_gesture_t g;
+    bsp_gesture_init(&g, NULL, noop_cb, NULL);
+    uint32_t t = 0;
+    const double start = now_ns();
+    for (int n = 0; n < ITERATIONS; n++) {
+        for (int i = 0; i < STEPS; i++) {
+            bsp_gesture_feed(&g, trace[i], 2, t += PERIOD_MS);
+        }
+        bsp_gesture_feed(&g, NULL, 0, t += PERIOD_MS);
+    }
+    const double ns = now_ns() - start;
+    const unsigned samples = ITERATIONS * (STEPS + 1);
+    printf("bench: %u samples, %.1f ns per sample\n", samples, ns / samples);
+}
+
+/* Trace file in the format of bsp/touch_trace.h, as printed by examples/display_noglib */
+static int replay_file(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+
+    bsp_gesture_t g;
+    bsp_gesture_init(&g, NULL, print_cb, NULL);
+    char line[256];
+    unsigned lines = 0;
+    while (fgets(line, sizeof(line), f)) {
+        bsp_touch_sample_t sample;
+        if (!bsp_touch_trace_parse(line, &sample)) {
+            continue;
+        }
+        bsp_gesture_point_t pts[BSP_TOUCH_RING_MAX_POINTS];
+        for (uint8_t i = 0; i < sample.count; i++) {
+            pts[i].x = (int16_t)sample.points[i].x;
+            pts[i].y = (int16_t)sample.points[i].y;
+            pts[i].id = sample.points[i].id;
+        }
+        bsp_gesture_feed(&g, pts, sample.count, (uint32_t)(sample.time_us / 1000));
+        lines++;
+    }
+    fclose(f);
+    printf("%u samples replayed\n", lines);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        return replay_file(argv[1]);
+    }
+
+    test_tap_and_drag();
+    test_long_press();
+    test_pinch("pinch_out", 100, 250);
+    test_pinch("pinch_in", 300, 150);
+    test_rotate("rotate_cw", 10, 100);
+    test_rotate("rotate_ccw_wrap", 200, 140);
+    test_rotate("rotate_across_180", 160, 200);
+    test_angle_sweep();
+    test_scroll();
+    test_third_finger();
+    test_lift_one();
+    bench();
+
+    return check_report();
+}
@@ -0,0 +1,499 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Host-side check for the BSP sensor hub.
+ *
+ * Runs the AHT30 state machine against a mock AHT30 on a simulated clock:
+ * calibration, busy conversions, CRC errors, a missing and a hot-plugged
+ * sensor, and several sensors multiplexed on one hub. Then checks the sample
+ * ring: overwrite and loss accounting, and torn reads with a writer and
+ * readers racing on real threads.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bsp/sensor.h"
+#include "../common/check.h"
+
+#define MOCK_NACK       (-1)
+#define MAX_SAMPLES     (1024)
+
+static int64_t s_now;               /* simulated clock in [us] */
+
+/* ── Mock AHT30 ───────────────────────────────────────────────────────── */
+
+typedef struct {
+    bool     present;
+    bool     calibrated;
+    uint32_t conversion_ms;         /* time from the measure command to the data */
+    int32_t  temp_mc;               /* reported values */
+    int32_t  hum_m;
+    int      corrupt_reads;         /* data reads to send with a bad CRC */
+    int64_t  ready_us;              /* end of the conversion, -1 when none started */
+    uint32_t transfers;
+    uint32_t init_cmds;
+    uint32_t busy_reads;
+} mock_aht30_t;
+
+static void mock_init(mock_aht30_t *m, int32_t temp_mc, int32_t hum_m)
+{
+    memset(m, 0, sizeof(*m));
+    m->present = true;
+    m->calibrated = true;
+    m->conversion_ms = 80;
+    m->temp_mc = temp_mc;
+    m->hum_m = hum_m;
+    m->ready_us = -1;
+}
+
+static uint8_t crc8(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0xff;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static int mock_write(void *ctx, const uint8_t *data, size_t len)
+{
+    mock_aht30_t *m = ctx;
+    m->transfers++;
+    if (!m->present) {
+        return MOCK_NACK;
+    }
+    if (len == 3 && data[0] == 0xbe) {
+        m->calibrated = true;
+        m->init_cmds++;
+    } else if (len == 3 && data[0] == 0xac) {
+        m->ready_us = s_now + (int64_t)m->conversion_ms * 1000;
+    }
+    return 0;
+}
+
+static int mock_read(void *ctx, uint8_t *data, size_t len)
+{
+    mock_aht30_t *m = ctx;
+    m->transfers++;
+    if (!m->present) {
+        return MOCK_NACK;
+    }
+    const bool busy = m->ready_us >= 0 && s_now < m->ready_us;
+    uint8_t buf[7];
+    buf[0] = (uint8_t)((m->calibrated ? 0x08 : 0) | (busy ? 0x80 : 0) | 0x10);
+    uint32_t hum_raw = (uint32_t)(((uint64_t)m->hum_m << 20) / 100000);
+    uint32_t temp_raw = (uint32_t)(((uint64_t)(m->temp_mc + 50000) << 20) / 200000);
+    hum_raw = hum_raw > 0xfffff ? 0xfffff : hum_raw;       /* 20-bit fields */
+    temp_raw = temp_raw > 0xfffff ? 0xfffff : temp_raw;
+    buf[1] = (uint8_t)(hum_raw >> 12);
+    buf[2] = (uint8_t)(hum_raw >> 4);
+    buf[3] = (uint8_t)((hum_raw << 4) | (temp_raw >> 16));
+    buf[4] = (uint8_t)(temp_raw >> 8);
+    buf[5] = (uint8_t)temp_raw;
+    buf[6] = crc8(buf, 6);
+    if (len == 7 && busy) {
+        m->busy_reads++;
+    } else if (len == 7 && m->corrupt_reads > 0) {
+        m->corrupt_reads--;
+        buf[6] ^= 0x5a;
+    }
+    memcpy(data, buf, len < sizeof(buf) ? len : sizeof(buf));
+    return 0;
+}
+
+/* ── Simulation ───────────────────────────────────────────────────────── */
+
+typedef struct {
+    mock_aht30_t      mock;
+    bsp_sensor_t      sensor;
+    bsp_sensor_slot_t slots[64];
+} sim_sensor_t;
+
+static void sim_sensor_init(sim_sensor_t *s, uint32_t period_ms, int32_t temp_mc, int32_t hum_m)
+{
+    memset(s->slots, 0, sizeof(s->slots));
+    mock_init(&s->mock, temp_mc, hum_m);
+    const bsp_sensor_io_t io = { .write = mock_write, .read = mock_read, .ctx = &s->mock };
+    bsp_sensor_init(&s->sensor, &bsp_sensor_aht30, &io, period_ms, s->slots, 64);
+}
+
+/* Runs the hub on the simulated clock, jumping from one due step to the next; returns the wake-ups */
+static uint32_t run_until(bsp_sensor_hub_t *hub, int64_t end_us)
+{
+    uint32_t wakes = 0;
+    while (1) {
+        const int64_t next = bsp_sensor_hub_run(hub, s_now);
+        wakes++;
+        if (next > end_us) {
+            s_now = end_us;
+            return wakes;
+        }
+        if (next > s_now) {
+            s_now = next;
+        }
+    }
+}
+
+static size_t all_samples(const bsp_sensor_t *sensor, bsp_sensor_sample_t *out)
+{
+    uint32_t cursor = 0;
+    uint32_t lost = 0;
+    return bsp_sensor_ring_read(&sensor->ring, &cursor, out, MAX_SAMPLES, &lost);
+}
+
+static bsp_sensor_sample_t s_samples[MAX_SAMPLES];
+
+static void test_basic(void)
+{
+    const char *name = "basic";
+    static sim_sensor_t s;
+    bsp_sensor_hub_t hub;
+    s_now = 1000000;
+    const int64_t start = s_now;
+    sim_sensor_init(&s, 2000, 23456, 45678);
+    bsp_sensor_hub_init(&hub);
+    bsp_sensor_hub_add(&hub, &s.sensor, s_now);
+
+    check(s.sensor.status == BSP_SENSOR_PENDING, name, "status before the first sample");
+    const uint32_t wakes = run_until(&hub, start + 10000000 - 1);
+    const size_t n = all_samples(&s.sensor, s_samples);
+
+    check(n == 5, name, "5 samples in 10 s");
+    check(s.sensor.status == 0 && s.sensor.errors == 0, name, "status");
+    check(s_samples[0].time_us == start + 80000, name, "first sample 80 ms after the start");
+    for (size_t i = 0; i < n; i++) {
+        check(s_samples[i].seq == i, name, "sequence numbers");
+        check(abs(s_samples[i].value[0] - 23456) <= 1, name, "temperature");
+        check(abs(s_samples[i].value[1] - 45678) <= 1, name, "humidity");
+        if (i > 0) {
+            check(s_samples[i].time_us - s_samples[i - 1].time_us == 2000000, name, "2 s between samples");
+        }
+    }
+    /* status read, then measure + read per sample: nothing waits inside a step */
+    check(s.mock.transfers == 1 + 2 * n, name, "transfers per sample");
+    check(wakes == 2 * n, name, "two wake-ups per sample");
+
+    bsp_sensor_sample_t latest;
+    check(bsp_sensor_ring_latest(&s.sensor.ring, &latest) && latest.seq == n - 1, name, "latest");
+    printf("%-12s %zu samples, %u transfers, %u wake-ups, %d.%03d °C %d.%03d %%RH\n", name, n, s.mock.transfers,
+           wakes, latest.value[0] / 1000, latest.value[0] % 1000, latest.value[1] / 1000, latest.value[1] % 1000);
+}
+
+static void test_extremes(void)
+{
+    const char *name = "extremes";
+    static const int32_t temps[] = { -40000, -123, 0, 85000 };
+    static const int32_t hums[] = { 0, 1, 50000, 100000 };
+    for (size_t i = 0; i < 4; i++) {
+        static sim_sensor_t s;
+        bsp_sensor_hub_t hub;
+        s_now = 0;
+        sim_sensor_init(&s, 1000, temps[i], hums[i]);
+        bsp_sensor_hub_init(&hub);
+        bsp_sensor_hub_add(&hub, &s.sensor, s_now);
+        run_until(&hub, 500000);
+        bsp_sensor_sample_t latest;
+        check(bsp_sensor_ring_latest(&s.sensor.ring, &latest), name, "sample");
+        check(abs(latest.value[0] - temps[i]) <= 1, name, "temperature");
+        check(abs(latest.value[1] - hums[i]) <= 1, name, "humidity");
+    }
+}
+
+static void test_uncalibrated(void)
+{
+    const char *name = "calibration";
+    static sim_sensor_t s;
+    bsp_sensor_hub_t hub;
+    s_now = 0;
+    sim_sensor_init(&s, 1000, 20000, 40000);
+    s.mock.calibrated = false;
+    bsp_sensor_hub_init(&hub);
+    bsp_sensor_hub_add(&hub, &s.sensor, s_now);
+    run_until(&hub, 3500000);
+    const size_t n = all_samples(&s.sensor, s_samples);
+
+    check(s.mock.init_cmds == 1, name, "one init command");
+    check(n == 4, name, "4 samples in 3.5 s");
+    check(s_samples[0].time_us == 90000, name, "first sample after 10 ms init and 80 ms conversion");
+    printf("%-12s init once, first sample at %lld ms\n", name, (long long)s_samples[0].time_us / 1000);
+}
+
+static void test_busy(void)
+{
+    const char *name = "busy";
+    static sim_sensor_t s;
+    bsp_sensor_hub_t hub;
+    s_now = 0;
+    sim_sensor_init(&s, 1000, 20000, 40000);
+    s.mock.conversion_ms = 105;
+    bsp_sensor_hub_init(&hub);
+    bsp_sensor_hub_add(&hub, &s.sensor, s_now);
+    run_until(&hub, 2500000);
+    size_t n = all_samples(&s.sensor, s_samples);
+
+    check(n == 3, name, "3 samples in 2.5 s");
+    check(s_samples[0].time_us == 110000, name, "read again every 10 ms until ready");
+    check(s_samples[1].time_us - s_samples[0].time_us == 1000000, name, "period kept from the conversion start");
+    check(s.mock.busy_reads == 3 * n, name, "3 busy reads per sample");
+    check(s.sensor.errors == 0, name, "no error");
+
+    /* A conversion that never ends is an error, and the sensor is restarted a period later */
+    s.mock.conversion_ms = 100000;
+    const uint32_t errors = s.sensor.errors;
+    run_until(&hub, 5500000);
+    check(s.sensor.status == BSP_SENSOR_ERR_TIMEOUT, name, "timeout reported");
+    check(s.sensor.errors - errors == 3, name, "one timeout per period");
+    check(all_samples(&s.sensor, s_samples) == n, name, "no sample while stuck");
+    s.mock.conversion_ms = 80;
+    run_until(&hub, 7500000);
+    check(s.sensor.status == 0 && all_samples(&s.sensor, s_samples) == n + 2, name, "recovers");
+    printf("%-12s %u busy reads, %u timeouts\n", name, s.mock.busy_reads, (unsigned)s.sensor.errors);
+}
+
+static void test_crc(void)
+{
+    const char *name = "crc";
+    static sim_sensor_t s;
+    bsp_sensor_hub_t hub;
+    s_now = 0;
+    sim_sensor_init(&s, 1000, 20000, 40000);
+    s.mock.corrupt_reads = 2;
+    bsp_sensor_hub_init(&hub);
+    bsp_sensor_hub_add(&hub, &s.sensor, s_now);
+
+    run_until(&hub, 1500000);
+    check(s.sensor.status == BSP_SENSOR_ERR_CRC, name, "CRC error reported");
+    check(all_samples(&s.sensor, s_samples) == 0, name, "corrupt data not stored");
+    run_until(&hub, 5500000);
+    const size_t n = all_samples(&s.sensor, s_samples);
+    check(s.sensor.status == 0 && s.sensor.errors == 2, name, "recovers");
+    check(n == 4, name, "samples after the errors");
+    for (size_t i = 0; i < n; i++) {
+        check(abs(s_samples[i].value[0] - 20000) <= 1, name, "values");
+    }
+}
+
+static void test_absent(void)
+{
+    const char *name = "absent";
+    static sim_sensor_t s;
+    bsp_sensor_hub_t hub;
+    s_now = 0;
+    sim_sensor_init(&s, 1000, 20000, 40000);
+    s.mock.present = false;
+    bsp_sensor_hub_init(&hub);
+    bsp_sensor_hub_add(&hub, &s.sensor, s_now);
+
+    const uint32_t wakes = run_until(&hub, 10000000 - 1);
+    check(s.sensor.status == MOCK_NACK, name, "error reported");
+    check(s.sensor.errors == 10 && s.mock.transfers == 10, name, "one attempt per period, no spinning");
+    check(wakes == 10, name, "one wake-up per period");
+
+    /* Plugged in: samples start at the next attempt */
+    s.mock.present = true;
+    run_until(&hub, 12500000);
+    const size_t n = all_samples(&s.sensor, s_samples);
+    check(s.sensor.status == 0 && n == 3, name, "hot-plug");
+    printf("%-12s %u failed attempts in 10 s, %zu samples after plug-in\n", name, (unsigned)s.sensor.errors, n);
+}
+
+static void test_multiplex(void)
+{
+    const char *name = "multiplex";
+    static const uint32_t periods[] = { 100, 250, 500, 1000, 1000, 2000, 5000, 333 };
+    enum { SENSORS = sizeof(periods) / sizeof(periods[0]) };
+    static sim_sensor_t s[SENSORS];
+    bsp_sensor_hub_t hub;
+    const int64_t duration_us = 60000000;
+    s_now = 0;
+    bsp_sensor_hub_init(&hub);
+    for (int i = 0; i < SENSORS; i++) {
+        sim_sensor_init(&s[i], periods[i], 20000 + i * 1000, 30000 + i * 1000);
+        bsp_sensor_hub_add(&hub, &s[i].sensor, s_now);
+    }
+    const uint32_t wakes = run_until(&hub, duration_us - 1);
+
+    uint32_t samples = 0;
+    for (int i = 0; i < SENSORS; i++) {
+        bsp_sensor_sample_t buf[64];
+        uint32_t cursor = 0;
+        uint32_t lost = 0;
+        const size_t n = bsp_sensor_ring_read(&s[i].sensor.ring, &cursor, buf, 64, &lost);
+        const uint32_t expected = (uint32_t)((duration_us - 80000 - 1) / ((int64_t)periods[i] * 1000) + 1);
+        check(cursor == expected, name, "samples per sensor");
+        check(n + lost == cursor, name, "ring accounting");
+        for (size_t k = 1; k < n; k++) {
+            check(buf[k].time_us - buf[k - 1].time_us == (int64_t)periods[i] * 1000, name, "exact period");
+            check(abs(buf[k].value[0] - (20000 + i * 1000)) <= 1, name, "values per sensor");
+        }
+        samples += cursor;
+    }
+    /* A blocking read would have held a task for every conversion; the hub slept through them */
+    printf("%-12s %d sensors, %u samples in 60 s, %u wake-ups, %u ms of conversions slept through\n", name,
+           SENSORS, samples, wakes, samples * 80);
+}
+
+/* ── Ring ─────────────────────────────────────────────────────────────── */
+
+static void test_ring(void)
+{
+    const char *name = "ring";
+    static bsp_sensor_slot_t slots[8];
+    bsp_sensor_ring_t ring;
+    memset(slots, 0, sizeof(slots));
+    bsp_sensor_ring_init(&ring, slots, 8);
+
+    bsp_sensor_sample_t out[16];
+    uint32_t cursor = 0;
+    uint32_t lost = 0;
+    check(!bsp_sensor_ring_latest(&ring, &out[0]), name, "empty");
+    check(bsp_sensor_ring_read(&ring, &cursor, out, 16, &lost) == 0 && cursor == 0, name, "empty read");
+
+    for (int i = 0; i < 5; i++) {
+        const bsp_sensor_sample_t smp = { .time_us = i, .value = { i } };
+        bsp_sensor_ring_push(&ring, &smp);
+    }
+    check(bsp_sensor_ring_read(&ring, &cursor, out, 3, &lost) == 3 && cursor == 3 && lost == 0, name,
+          "partial read");
+    check(out[0].seq == 0 && out[2].seq == 2 && out[2].value[0] == 2, name, "oldest first");
+    check(bsp_sensor_ring_read(&ring, &cursor, out, 16, &lost) == 2 && cursor == 5, name, "rest");
+    check(bsp_sensor_ring_read(&ring, &cursor, out, 16, &lost) == 0, name, "nothing new");
+
+    for (int i = 5; i < 20; i++) {
+        const bsp_sensor_sample_t smp = { .time_us = i, .value = { i } };
+        bsp_sensor_ring_push(&ring, &smp);
+    }
+    const size_t n = bsp_sensor_ring_read(&ring, &cursor, out, 16, &lost);
+    check(n == 8 && lost == 7 && cursor == 20, name, "overwritten samples counted as lost");
+    check(out[0].seq == 12 && out[7].seq == 19 && out[7].value[0] == 19, name, "newest kept");
+    check(bsp_sensor_ring_latest(&ring, &out[0]) && out[0].seq == 19, name, "latest");
+
+    cursor = 1000;
+    check(bsp_sensor_ring_read(&ring, &cursor, out, 16, &lost) == 0 && cursor == 20, name, "cursor ahead");
+}
+
+/* Writer and readers on real threads: a torn copy would break the relation between the fields */
+#define RACE_SAMPLES    (2000000u)
+#define RACE_READERS    (3)
+
+static bsp_sensor_slot_t  s_race_slots[16];
+static bsp_sensor_ring_t  s_race_ring;
+static volatile int       s_race_done;
+
+typedef struct {
+    uint32_t reads;
+    uint32_t samples;
+    uint32_t lost;
+    uint32_t torn;
+    uint32_t reordered;
+} race_stats_t;
+
+static void *race_writer(void *arg)
+{
+    (void)arg;
+    for (uint32_t i = 0; i < RACE_SAMPLES; i++) {
+        const bsp_sensor_sample_t smp = {
+            .time_us = (int64_t)i * 7,
+            .value = { (int32_t)i, (int32_t)~i, (int32_t)(i * 3u), (int32_t)(i ^ 0x5a5a5a5au) },
+        };
+        bsp_sensor_ring_push(&s_race_ring, &smp);
+        for (volatile int spin = 0; spin < 50; spin++) {
+            /* leave the readers time to copy while samples are being written */
+        }
+    }
+    s_race_done = 1;
+    return NULL;
+}
+
+static bool race_consistent(const bsp_sensor_sample_t *smp)
+{
+    const uint32_t i = smp->seq;
+    return smp->time_us == (int64_t)i * 7 && smp->value[0] == (int32_t)i && smp->value[1] == (int32_t)~i
+           && smp->value[2] == (int32_t)(i * 3u) && smp->value[3] == (int32_t)(i ^ 0x5a5a5a5au);
+}
+
+static void *race_reader(void *arg)
+{
+    race_stats_t *st = arg;
+    uint32_t cursor = 0;
+    uint32_t last_latest = 0;
+    bsp_sensor_sample_t out[8];
+    while (!s_race_done) {
+        uint32_t lost = 0;
+        const size_t n = bsp_sensor_ring_read(&s_race_ring, &cursor, out, 8, &lost);
+        st->reads++;
+        st->lost += lost;
+        for (size_t k = 0; k < n; k++) {
+            st->samples++;
+            st->torn += !race_consistent(&out[k]);
+            st->reordered += k > 0 && out[k].seq <= out[k - 1].seq;
+        }
+        if (bsp_sensor_ring_latest(&s_race_ring, &out[0])) {
+            st->samples++;
+            st->torn += !race_consistent(&out[0]);
+            st->reordered += out[0].seq < last_latest;
+            last_latest = out[0].seq;
+        }
+    }
+    return NULL;
+}
+
+static void test_ring_race(void)
+{
+    const char *name = "ring_race";
+    pthread_t writer;
+    pthread_t readers[RACE_READERS];
+    race_stats_t stats[RACE_READERS];
+    memset(stats, 0, sizeof(stats));
+    memset(s_race_slots, 0, sizeof(s_race_slots));
+    bsp_sensor_ring_init(&s_race_ring, s_race_slots, 16);
+    s_race_done = 0;
+
+    for (int i = 0; i < RACE_READERS; i++) {
+        pthread_create(&readers[i], NULL, race_reader, &stats[i]);
+    }
+    pthread_create(&writer, NULL, race_writer, NULL);
+    pthread_join(writer, NULL);
+    for (int i = 0; i < RACE_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    uint32_t samples = 0;
+    uint32_t lost = 0;
+    uint32_t torn = 0;
+    uint32_t reordered = 0;
+    for (int i = 0; i < RACE_READERS; i++) {
+        samples += stats[i].samples;
+        lost += stats[i].lost;
+        torn += stats[i].torn;
+        reordered += stats[i].reordered;
+    }
+    check(torn == 0, name, "torn samples");
+    check(reordered == 0, name, "samples out of order");
+    check(samples > 0, name, "readers saw samples");
+    printf("%-12s %u pushes, %d readers: %u samples read, %u lost to overwrite, %u torn\n", name,
+           RACE_SAMPLES, RACE_READERS, samples, lost, torn);
+}
+
+int main(void)
+{
+    test_basic();
+    test_extremes();
+    test_uncalibrated();
+    test_busy();
+    test_crc();
+    test_absent();
+    test_multiplex();
+    test_ring();
+    test_ring_race();
+
+    return check_report();
+}
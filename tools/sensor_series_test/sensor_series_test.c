@@ -0,0 +1,311 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Host-side check for the BSP sensor time series.
+ *
+ * Checks the averaging of the levels, the stitching of the levels into one
+ * time-ordered view of a range, that queries return exactly n points with
+ * the ends of the range kept, LTTB against a double-precision reference,
+ * peaks surviving the decimation, picks, and draining a sensor ring. Then
+ * times adds and full-width queries.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bsp/sensor_series.h"
+#include "../common/check.h"
+
+#define PERIOD_US       (2000000LL)     /* one sample every 2 s, like the AHT30 of display_demo */
+#define CAPACITY        (512)
+#define LEVELS          (4)
+#define FACTOR          (8)
+
+static bsp_sensor_point_t s_storage[LEVELS * CAPACITY];
+static bsp_sensor_xy_t    s_out[LEVELS * CAPACITY];
+
+static void add_value(bsp_sensor_series_t *s, int64_t time_us, int32_t v0)
+{
+    const int32_t values[BSP_SENSOR_MAX_VALUES] = { v0, -v0, 0, 1 };
+    bsp_sensor_series_add(s, time_us, values);
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Points of a query are in time order, inside the range */
+static int ordered(const bsp_sensor_xy_t *out, size_t n, int64_t from_us, int64_t to_us)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (out[i].time_us < from_us || out[i].time_us >= to_us || (i && out[i].time_us <= out[i - 1].time_us)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_init(void)
+{
+    bsp_sensor_series_t s;
+    check(!bsp_sensor_series_init(&s, s_storage, CAPACITY, 0, FACTOR), "init", "0 levels accepted");
+    check(!bsp_sensor_series_init(&s, s_storage, CAPACITY, BSP_SENSOR_SERIES_MAX_LEVELS + 1, FACTOR), "init",
+          "too many levels accepted");
+    check(!bsp_sensor_series_init(&s, s_storage, CAPACITY, LEVELS, 1), "init", "factor 1 accepted");
+    check(!bsp_sensor_series_init(&s, s_storage, 4, LEVELS, FACTOR), "init", "capacity below factor accepted");
+    check(bsp_sensor_series_init(&s, s_storage, CAPACITY, LEVELS, FACTOR), "init", "valid series rejected");
+    check(!bsp_sensor_series_span(&s, NULL, NULL), "init", "empty series has a span");
+    check(bsp_sensor_series_query(&s, 0, 0, INT64_MAX, s_out, 10) == 0, "init", "empty series returned points");
+}
+
+/* Small levels: averages, rounding of negative values, span and stitching */
+static void test_levels(void)
+{
+    static bsp_sensor_point_t storage[3 * 16];
+    bsp_sensor_series_t s;
+    bsp_sensor_series_init(&s, storage, 16, 3, 4);
+
+    for (int i = 0; i < 1000; i++) {
+        add_value(&s, (int64_t)i * 1000000, i);
+    }
+    /* Level 1 point j averages samples 4j..4j+3, level 2 point j samples 16j..16j+15 */
+    const bsp_sensor_point_t *l1 = &s.level[1].points[(s.level[1].head - 1) % 16];
+    const bsp_sensor_point_t *l2 = &s.level[2].points[(s.level[2].head - 1) % 16];
+    check(s.level[1].head == 250 && s.level[2].head == 62, "levels", "point counts");
+    check(l1->value[0] == 998 && l1->value[1] == -998 && l1->time_us == 997500000, "levels", "level 1 average");
+    check(l2->value[0] == 984 && l2->value[1] == -984 && l2->value[3] == 1, "levels", "level 2 average");
+
+    int64_t first = 0;
+    int64_t last = 0;
+    check(bsp_sensor_series_span(&s, &first, &last), "levels", "no span");
+    check(first == (62 - 16) * 16000000LL + 7500000 && last == 999000000, "levels", "span");
+
+    /*
+     * The whole history: level 0 keeps samples 984..999, level 1 the averages at 937.5..997.5 s and
+     * level 2 those at 743.5..983.5 s. Each level fills in the time before the oldest point of the
+     * finer one: 13 level-2 points, 12 level-1 points and 16 samples.
+     */
+    size_t n = bsp_sensor_series_query(&s, 0, 0, INT64_MAX, s_out, 100);
+    check(n == 13 + 12 + 16, "levels", "stitched point count");
+    check(ordered(s_out, n, 0, INT64_MAX), "levels", "stitched points out of order");
+    check(n == 41 && s_out[0].time_us == 743500000 && s_out[12].time_us == 935500000 &&
+          s_out[13].time_us == 937500000 && s_out[24].time_us == 981500000 && s_out[25].value == 984 &&
+          s_out[40].value == 999, "levels", "stitched points");
+
+    /* A recent range reads the raw samples */
+    n = bsp_sensor_series_query(&s, 0, 990000000, INT64_MAX, s_out, 100);
+    check(n == 10 && s_out[0].value == 990 && s_out[9].value == 999, "levels", "recent range");
+    n = bsp_sensor_series_query(&s, 1, 990000000, 995000000, s_out, 100);
+    check(n == 5 && s_out[4].value == -994, "levels", "range end or value index");
+}
+
+/* Double-precision LTTB over a plain array, returning indices */
+static void lttb_ref(const int64_t *t, const int32_t *v, size_t total, size_t n, size_t *idx)
+{
+    size_t a = 0;
+    idx[0] = 0;
+    for (size_t b = 0; b < n - 2; b++) {
+        const size_t lo = 1 + b * (total - 2) / (n - 2);
+        const size_t hi = 1 + (b + 1) * (total - 2) / (n - 2);
+        const size_t next_hi = b + 1 < n - 2 ? 1 + (b + 2) * (total - 2) / (n - 2) : total;
+        double cx = 0;
+        double cy = 0;
+        for (size_t j = hi; j < next_hi; j++) {
+            cx += (t[j] - t[0]) / 1000;
+            cy += v[j];
+        }
+        cx /= next_hi - hi;
+        cy /= next_hi - hi;
+        const double ax = (t[a] - t[0]) / 1000;
+        const double ay = v[a];
+        double best_area = -1;
+        size_t best = lo;
+        for (size_t j = lo; j < hi; j++) {
+            const double area = fabs((ax - cx) * (v[j] - ay) - (ax - (t[j] - t[0]) / 1000) * (cy - ay));
+            if (area >= best_area) {
+                best_area = area;
+                best = j;
+            }
+        }
+        idx[b + 1] = a = best;
+    }
+    idx[n - 1] = total - 1;
+}
+
+static void test_lttb(void)
+{
+    static int64_t t[CAPACITY];
+    static int32_t v[CAPACITY];
+    static size_t idx[CAPACITY];
+    bsp_sensor_series_t s;
+    bsp_sensor_series_init(&s, s_storage, CAPACITY, LEVELS, FACTOR);
+
+    srand(1);
+    for (int i = 0; i < 400; i++) {
+        t[i] = 5000000000LL + i * PERIOD_US + (rand() % 1000) * 1000;
+        v[i] = 20000 + (int32_t)(3000 * sin(i / 25.0)) + rand() % 400;
+        add_value(&s, t[i], v[i]);
+    }
+
+    const size_t widths[] = { 2, 3, 7, 50, 199, 398, 399 };
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        const size_t n = widths[w];
+        const size_t got = bsp_sensor_series_query(&s, 0, 0, INT64_MAX, s_out, n);
+        check(got == n, "lttb", "not exactly n points");
+        check(s_out[0].time_us == t[0] && s_out[n - 1].time_us == t[399], "lttb", "range ends not kept");
+        check(ordered(s_out, got, 0, INT64_MAX), "lttb", "points out of order");
+
+        lttb_ref(t, v, 400, n, idx);
+        size_t same = 0;
+        for (size_t i = 0; i < n; i++) {
+            same += s_out[i].time_us == t[idx[i]];
+        }
+        /* float and double may only disagree on near-ties */
+        check(same * 100 >= n * 99, "lttb", "differs from the reference");
+    }
+
+    check(bsp_sensor_series_query(&s, 0, 0, INT64_MAX, s_out, 1) == 1 && s_out[0].time_us == t[399], "lttb",
+          "n = 1 is not the newest point");
+    check(bsp_sensor_series_query(&s, 0, 0, INT64_MAX, s_out, 400) == 400, "lttb", "n = total");
+    check(bsp_sensor_series_query(&s, 0, 0, INT64_MAX, s_out, 1000) == 400, "lttb", "n above total");
+    check(bsp_sensor_series_query(&s, 0, t[100], t[100], s_out, 10) == 0, "lttb", "empty range");
+    check(bsp_sensor_series_query(&s, BSP_SENSOR_MAX_VALUES, 0, INT64_MAX, s_out, 10) == 0, "lttb",
+          "bad value index accepted");
+}
+
+/* A week of samples: every range gets exactly n points, and a one-sample spike survives */
+static void test_history(void)
+{
+    bsp_sensor_series_t s;
+    bsp_sensor_series_init(&s, s_storage, CAPACITY, LEVELS, FACTOR);
+
+    const int total = 7 * 24 * 3600 / 2;
+    const int spike = total - 300;                  /* 10 min ago */
+    for (int i = 0; i < total; i++) {
+        const int32_t v = 20000 + (int32_t)(3000 * sin(i / 1800.0));
+        add_value(&s, (int64_t)i * PERIOD_US, i == spike ? 45000 : v);
+    }
+    const int64_t last_us = (int64_t)(total - 1) * PERIOD_US;
+    int64_t first_us = 0;
+    bsp_sensor_series_span(&s, &first_us, NULL);
+    check(first_us > 0 && first_us < last_us - 5 * 24 * 3600 * 1000000LL, "history", "span too short");
+
+    const int64_t spans_s[] = { 60, 600, 3600, 6 * 3600, 24 * 3600, 7 * 24 * 3600 };
+    const size_t widths[] = { 100, 480, 800 };
+    for (size_t r = 0; r < sizeof(spans_s) / sizeof(spans_s[0]); r++) {
+        const int64_t from_us = last_us - spans_s[r] * 1000000;
+        for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+            const size_t avail = bsp_sensor_series_query(&s, 0, from_us, INT64_MAX, s_out, LEVELS * CAPACITY);
+            const size_t got = bsp_sensor_series_query(&s, 0, from_us, INT64_MAX, s_out, widths[w]);
+            const size_t expect = avail < widths[w] ? avail : widths[w];
+            char what[64];
+            snprintf(what, sizeof(what), "%lld s at %zu points: %zu", (long long)spans_s[r], widths[w], got);
+            check(got == expect, "history", what);
+            check(spans_s[r] < 3600 || got == widths[w] || widths[w] == 800, "history", "too few points kept");
+            check(ordered(s_out, got, from_us, INT64_MAX), "history", "points out of order or out of range");
+            check(got && s_out[got - 1].time_us == last_us, "history", "newest sample missing");
+            if (spans_s[r] == 600 || spans_s[r] == 3600) {
+                int found = 0;
+                for (size_t i = 0; i < got; i++) {
+                    found |= s_out[i].value == 45000;
+                }
+                check(found, "history", "spike decimated away");
+            }
+        }
+    }
+}
+
+static void test_pick(void)
+{
+    bsp_sensor_series_t s;
+    bsp_sensor_series_init(&s, s_storage, CAPACITY, LEVELS, FACTOR);
+    for (int i = 0; i < 100; i++) {
+        add_value(&s, (int64_t)i * PERIOD_US, i == 42 ? 30000 : 20000);
+    }
+
+    bsp_sensor_xy_t prev = { .time_us = 39 * PERIOD_US, .value = 20000 };
+    bsp_sensor_xy_t out;
+    check(bsp_sensor_series_pick(&s, 0, 40 * PERIOD_US, 50 * PERIOD_US, &prev, &out), "pick", "no point");
+    check(out.value == 30000 && out.time_us == 42 * PERIOD_US, "pick", "peak not picked");
+    check(bsp_sensor_series_pick(&s, 0, 40 * PERIOD_US, 50 * PERIOD_US, NULL, &out) && out.value == 30000,
+          "pick", "peak not picked without prev");
+    check(bsp_sensor_series_pick(&s, 0, 60 * PERIOD_US, 61 * PERIOD_US, &prev, &out) &&
+          out.time_us == 60 * PERIOD_US, "pick", "single point");
+    check(!bsp_sensor_series_pick(&s, 0, 200 * PERIOD_US, 210 * PERIOD_US, &prev, &out), "pick",
+          "empty range picked");
+}
+
+static void test_drain(void)
+{
+    static bsp_sensor_slot_t slots[64];
+    bsp_sensor_ring_t ring;
+    bsp_sensor_series_t s;
+    bsp_sensor_ring_init(&ring, slots, 64);
+    bsp_sensor_series_init(&s, s_storage, CAPACITY, LEVELS, FACTOR);
+
+    bsp_sensor_sample_t sample = {0};
+    for (int i = 0; i < 100; i++) {
+        sample.time_us = (int64_t)i * PERIOD_US;
+        sample.value[0] = i;
+        bsp_sensor_ring_push(&ring, &sample);
+    }
+    uint32_t lost = 0;
+    check(bsp_sensor_series_drain(&s, &ring, &lost) == 64 && lost == 36, "drain", "history");
+    check(bsp_sensor_series_drain(&s, &ring, &lost) == 0 && lost == 0, "drain", "drained twice");
+    for (int i = 100; i < 110; i++) {
+        sample.time_us = (int64_t)i * PERIOD_US;
+        sample.value[0] = i;
+        bsp_sensor_ring_push(&ring, &sample);
+    }
+    check(bsp_sensor_series_drain(&s, &ring, NULL) == 10, "drain", "new samples");
+    const size_t n = bsp_sensor_series_query(&s, 0, 0, INT64_MAX, s_out, 1000);
+    check(n == 74 && s_out[0].value == 36 && s_out[73].value == 109, "drain", "series content");
+}
+
+static void bench(void)
+{
+    bsp_sensor_series_t s;
+    bsp_sensor_series_init(&s, s_storage, CAPACITY, LEVELS, FACTOR);
+
+    const int total = 1000000;
+    double t0 = now_s();
+    for (int i = 0; i < total; i++) {
+        add_value(&s, (int64_t)i * PERIOD_US, 20000 + (int32_t)(3000 * sin(i / 1800.0)));
+    }
+    const double add_ns = (now_s() - t0) / total * 1e9;
+
+    const int64_t last_us = (int64_t)(total - 1) * PERIOD_US;
+    const int64_t spans_s[] = { 600, 3600, 24 * 3600, 7 * 24 * 3600 };
+    printf("add: %.0f ns per sample, %zu bytes for %d levels of %d points\n", add_ns, sizeof(s_storage), LEVELS,
+           CAPACITY);
+    for (size_t r = 0; r < sizeof(spans_s) / sizeof(spans_s[0]); r++) {
+        const int reps = 200;
+        size_t n = 0;
+        t0 = now_s();
+        for (int k = 0; k < reps; k++) {
+            n = bsp_sensor_series_query(&s, 0, last_us - spans_s[r] * 1000000, INT64_MAX, s_out, 800);
+        }
+        printf("query %7llds -> %zu points: %.1f us\n", (long long)spans_s[r], n, (now_s() - t0) / reps * 1e6);
+    }
+}
+
+int main(void)
+{
+    test_init();
+    test_levels();
+    test_lttb();
+    test_history();
+    test_pick();
+    test_drain();
+    bench();
+
+    return check_report();
+}
@@ -0,0 +1,350 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Host-side evaluation of the BSP touch filter.
+ *
+ * Replays touch traces through the filter, without and with prediction, and
+ * compares the output with the finger position:
+ *   jitter_px  RMS distance to the finger while it rests
+ *   lag_ms     delay that best aligns the output with the finger while it
+ *              moves (negative: the output runs ahead)
+ *   err_px     RMS distance between the output and where the finger is
+ *              pipeline_ms later, when the frame showing it lights up
+ *
+ * Synthetic traces know the true finger position. For a recorded trace the
+ * finger position is estimated with a centred (non-causal) average of the
+ * raw samples.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bsp/touch_filter.h"
+#include "bsp/touch_trace.h"
+#include "../common/check.h"
+
+#define MAX_SAMPLES     (100000)
+#define PERIOD_US       (10000)     /* GT911 report period */
+#define REST_SPEED      (20.0)      /* px/s; slower counts as resting */
+#define MOVE_SPEED      (100.0)     /* px/s; faster counts as moving */
+
+typedef struct {
+    uint32_t t_us;
+    int16_t  x;
+    int16_t  y;
+    bool     down;
+    double   true_x;    /* finger position */
+    double   true_y;
+} sample_t;
+
+typedef struct {
+    const char *name;
+    sample_t   *s;
+    int         n;
+} trace_t;
+
+typedef struct {
+    double jitter_px;
+    double lag_ms;
+    double err_px;
+} metrics_t;
+
+static bsp_touch_filter_cfg_t s_cfg;
+static uint16_t               s_predict_ms  = 20;
+static uint32_t               s_pipeline_ms = 35;
+
+/* Deterministic Gaussian noise (Box-Muller over an LCG) */
+static uint32_t s_seed = 12345;
+
+static double urand(void)
+{
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return ((s_seed >> 8) + 0.5) / 16777216.0;
+}
+
+static double gauss(double sigma)
+{
+    return sigma * sqrt(-2.0 * log(urand())) * cos(2 * M_PI * urand());
+}
+
+/* Finger position (linear interpolation) at time t, for the stretch of contact containing index i */
+static int true_at(const trace_t *tr, int i, double t_us, double *x, double *y)
+{
+    int j = i;
+    while (j > 0 && tr->s[j - 1].down && tr->s[j].t_us > t_us) {
+        j--;
+    }
+    while (j + 1 < tr->n && tr->s[j + 1].down && tr->s[j + 1].t_us <= t_us) {
+        j++;
+    }
+    if (t_us < tr->s[j].t_us || j + 1 >= tr->n || !tr->s[j + 1].down) {
+        if (t_us != tr->s[j].t_us) {
+            return 0;
+        }
+        *x = tr->s[j].true_x;
+        *y = tr->s[j].true_y;
+        return 1;
+    }
+    const double f = (t_us - tr->s[j].t_us) / (double)(tr->s[j + 1].t_us - tr->s[j].t_us);
+    *x = tr->s[j].true_x + (tr->s[j + 1].true_x - tr->s[j].true_x) * f;
+    *y = tr->s[j].true_y + (tr->s[j + 1].true_y - tr->s[j].true_y) * f;
+    return 1;
+}
+
+static double true_speed(const trace_t *tr, int i)
+{
+    double x0, y0, x1, y1;
+    const double t = tr->s[i].t_us;
+    if (!true_at(tr, i, t - PERIOD_US, &x0, &y0) || !true_at(tr, i, t + PERIOD_US, &x1, &y1)) {
+        return -1;
+    }
+    return hypot(x1 - x0, y1 - y0) * 1e6 / (2 * PERIOD_US);
+}
+
+/* mode 0: raw, 1: filter, 2: filter + prediction */
+static metrics_t evaluate(const trace_t *tr, int mode)
+{
+    bsp_touch_filter_cfg_t cfg = s_cfg;
+    cfg.predict_ms = (mode == 2) ? s_predict_ms : 0;
+    bsp_touch_filter_t f;
+    bsp_touch_filter_init(&f, &cfg);
+
+    int16_t *ox = malloc(tr->n * sizeof(int16_t));
+    int16_t *oy = malloc(tr->n * sizeof(int16_t));
+    for (int i = 0; i < tr->n; i++) {
+        const sample_t *s = &tr->s[i];
+        if (!s->down) {
+            bsp_touch_filter_reset(&f);
+            continue;
+        }
+        if (mode == 0) {
+            ox[i] = s->x;
+            oy[i] = s->y;
+        } else {
+            bsp_touch_filter_apply(&f, s->x, s->y, s->t_us, &ox[i], &oy[i]);
+        }
+    }
+
+    metrics_t m = { 0 };
+    double rest_sq = 0;
+    int rest_n = 0;
+    double err_sq = 0;
+    int err_n = 0;
+    for (int i = 0; i < tr->n; i++) {
+        if (!tr->s[i].down) {
+            continue;
+        }
+        const double v = true_speed(tr, i);
+        if (v >= 0 && v < REST_SPEED) {
+            rest_sq += pow(ox[i] - tr->s[i].true_x, 2) + pow(oy[i] - tr->s[i].true_y, 2);
+            rest_n++;
+        }
+        double fx, fy;
+        if (v > MOVE_SPEED && true_at(tr, i, tr->s[i].t_us + s_pipeline_ms * 1000.0, &fx, &fy)) {
+            err_sq += pow(ox[i] - fx, 2) + pow(oy[i] - fy, 2);
+            err_n++;
+        }
+    }
+    m.jitter_px = rest_n ? sqrt(rest_sq / rest_n) : NAN;
+    m.err_px = err_n ? sqrt(err_sq / err_n) : NAN;
+
+    /* Delay in 1 ms steps between -100 and +200 ms that best aligns the output with the finger */
+    double best = INFINITY;
+    m.lag_ms = NAN;
+    for (int lag = -100; lag <= 200; lag++) {
+        double sq = 0;
+        int n = 0;
+        for (int i = 0; i < tr->n; i++) {
+            double fx, fy;
+            if (tr->s[i].down && true_speed(tr, i) > MOVE_SPEED &&
+                    true_at(tr, i, tr->s[i].t_us - lag * 1000.0, &fx, &fy)) {
+                sq += pow(ox[i] - fx, 2) + pow(oy[i] - fy, 2);
+                n++;
+            }
+        }
+        if (n > 10 && sq / n < best) {
+            best = sq / n;
+            m.lag_ms = lag;
+        }
+    }
+
+    free(ox);
+    free(oy);
+    return m;
+}
+
+static sample_t *trace_alloc(trace_t *tr, const char *name)
+{
+    tr->name = name;
+    tr->n = 0;
+    tr->s = calloc(MAX_SAMPLES, sizeof(sample_t));
+    return tr->s;
+}
+
+static void trace_add(trace_t *tr, uint32_t t_us, double x, double y, bool down, double sigma)
+{
+    sample_t *s = &tr->s[tr->n++];
+    s->t_us = t_us;
+    s->down = down;
+    s->true_x = x;
+    s->true_y = y;
+    s->x = (int16_t)lround(x + gauss(sigma));
+    s->y = (int16_t)lround(y + gauss(sigma));
+}
+
+/* Finger resting, with the GT911 jitter of a few pixels */
+static void make_rest(trace_t *tr)
+{
+    trace_alloc(tr, "rest");
+    for (int i = 0; i < 300; i++) {
+        trace_add(tr, i * PERIOD_US, 400, 240, true, 1.2);
+    }
+}
+
+/* Slider drag: rest, smooth move over 400 px, rest */
+static void make_drag(trace_t *tr)
+{
+    trace_alloc(tr, "drag");
+    for (int i = 0; i < 200; i++) {
+        const double t = i * PERIOD_US / 1e6;
+        double p = 0;
+        if (t > 0.5) {
+            p = (t > 1.3) ? 1 : (1 - cos(M_PI * (t - 0.5) / 0.8)) / 2;
+        }
+        trace_add(tr, i * PERIOD_US, 200 + 400 * p, 300, true, 1.2);
+    }
+}
+
+/* List scrolling: fast flicks back and forth */
+static void make_flick(trace_t *tr)
+{
+    trace_alloc(tr, "flick");
+    for (int i = 0; i < 300; i++) {
+        const double t = i * PERIOD_US / 1e6;
+        trace_add(tr, i * PERIOD_US, 400, 240 + 180 * sin(2 * M_PI * t / 1.0), true, 1.2);
+    }
+}
+
+/* Trace file in the format of bsp/touch_trace.h; only the first point of each sample is used */
+static int load_trace(trace_t *tr, const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    trace_alloc(tr, path);
+    char line[256];
+    while (tr->n < MAX_SAMPLES && fgets(line, sizeof(line), fp)) {
+        bsp_touch_sample_t sample;
+        if (!bsp_touch_trace_parse(line, &sample)) {
+            continue;
+        }
+        sample_t *s = &tr->s[tr->n++];
+        s->t_us = (uint32_t)sample.time_us;
+        s->down = sample.count > 0;
+        if (s->down) {
+            s->x = (int16_t)sample.x;
+            s->y = (int16_t)sample.y;
+        }
+    }
+    fclose(fp);
+
+    /* Finger position: centred average over 5 samples of the same contact */
+    for (int i = 0; i < tr->n; i++) {
+        double sx = 0, sy = 0;
+        int n = 0;
+        for (int j = i - 2; j <= i + 2; j++) {
+            if (j >= 0 && j < tr->n && tr->s[j].down) {
+                sx += tr->s[j].x;
+                sy += tr->s[j].y;
+                n++;
+            }
+        }
+        tr->s[i].true_x = n ? sx / n : 0;
+        tr->s[i].true_y = n ? sy / n : 0;
+    }
+    return 0;
+}
+
+static void report(const trace_t *tr, metrics_t m[3])
+{
+    static const char *const modes[] = { "raw", "filter", "predict" };
+    for (int i = 0; i < 3; i++) {
+        m[i] = evaluate(tr, i);
+        printf("%-8s %-8s jitter_px=%5.2f lag_ms=%6.1f err_px=%6.2f\n", tr->name, modes[i], m[i].jitter_px,
+               m[i].lag_ms, m[i].err_px);
+    }
+}
+
+static void usage(const char *prog)
+{
+    printf("usage: %s [--min-cutoff MHZ] [--beta B] [--d-cutoff MHZ] [--predict MS] [--predict-max PX]\n"
+           "          [--pipeline MS] [trace]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (arg[0] != '-') {
+            path = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const unsigned long v = strtoul(argv[++i], NULL, 10);
+        if (!strcmp(arg, "--min-cutoff")) {
+            s_cfg.min_cutoff_mhz = v;
+        } else if (!strcmp(arg, "--beta")) {
+            s_cfg.beta = v;
+        } else if (!strcmp(arg, "--d-cutoff")) {
+            s_cfg.d_cutoff_mhz = v;
+        } else if (!strcmp(arg, "--predict")) {
+            s_predict_ms = v;
+        } else if (!strcmp(arg, "--predict-max")) {
+            s_cfg.predict_max_px = v;
+        } else if (!strcmp(arg, "--pipeline")) {
+            s_pipeline_ms = v;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    metrics_t m[3];
+    trace_t tr;
+    if (path) {
+        if (load_trace(&tr, path)) {
+            return 1;
+        }
+        report(&tr, m);
+        free(tr.s);
+        return 0;
+    }
+
+    make_rest(&tr);
+    report(&tr, m);
+    check(m[1].jitter_px < m[0].jitter_px / 2 && m[2].jitter_px < m[0].jitter_px / 2, "rest",
+          "filtering does not halve the jitter");
+    free(tr.s);
+
+    trace_t moving[2];
+    make_drag(&moving[0]);
+    make_flick(&moving[1]);
+    for (int i = 0; i < 2; i++) {
+        report(&moving[i], m);
+        check(m[2].lag_ms < m[1].lag_ms && m[2].err_px < m[1].err_px, moving[i].name,
+              "prediction does not reduce lag and error");
+        free(moving[i].s);
+    }
+
+    return check_report();
+}
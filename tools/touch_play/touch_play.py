@@ -0,0 +1,114 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2026 fmauNeko
+# SPDX-License-Identifier: MIT
+
+"""
+Stream a touch trace to a Panda Touch and print the frame statistics of the run.
+
+The board must run firmware that forwards console lines to bsp_touch_play_feed(), such as
+examples/display_touch_replay. Also generates synthetic scenario traces.
+"""
+
+import argparse
+import json
+import math
+import re
+import sys
+import time
+
+TRACE_RE = re.compile(r"^\s*(?:.*TRACE )?(\d+)\s+(\d+)")
+DONE_RE = re.compile(r"TOUCH_PLAY_DONE((?: \w+=-?\d+)+)")
+
+
+def read_trace(path):
+    """Return the sample lines of a trace with their time in [ms]"""
+    samples = []
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            if line.lstrip().startswith("#"):
+                continue
+            m = TRACE_RE.match(line)
+            if m:
+                samples.append((int(m[1]), line[m.start(1):].strip()))
+    return samples
+
+
+def stream(port, baud, samples, lead_ms, timeout_s):
+    """Send the samples lead_ms ahead of their time; return the statistics of the run"""
+    import serial  # pyserial, only needed on this path
+
+    with serial.Serial(port, baud, timeout=0.1) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"TOUCH_PLAY_BEGIN\n")
+        _expect(ser, "TOUCH_PLAY_READY", 5)
+
+        start = time.monotonic()
+        t0 = samples[0][0] if samples else 0
+        for t_ms, line in samples:
+            delay = start + (t_ms - t0 - lead_ms) / 1000 - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            ser.write(line.encode() + b"\n")
+        ser.write(b"TOUCH_PLAY_END\n")
+
+        m = DONE_RE.search(_expect(ser, "TOUCH_PLAY_DONE", timeout_s))
+        return {k: int(v) for k, v in (kv.split("=") for kv in m[1].split())}
+
+
+def _expect(ser, token, timeout_s):
+    deadline = time.monotonic() + timeout_s
+    while time.monotonic() < deadline:
+        line = ser.readline().decode(errors="replace")
+        if token in line:
+            return line
+    sys.exit(f"timed out waiting for {token}")
+
+
+def generate(kind, out):
+    """Write a synthetic scenario: 'scroll' flings a list up and down, 'draw' traces circles"""
+    lines = ["# touch trace: <time_ms> <count> [<x> <y> <id>]..."]
+    t = 0
+    if kind == "scroll":
+        for i in range(10):
+            y0, y1 = (400, 80) if i % 2 == 0 else (80, 400)
+            for k in range(31):         # 150 ms fling, reported every 5 ms, eased out
+                f = 1 - (1 - k / 30) ** 2
+                lines.append(f"{t} 1 400 {round(y0 + (y1 - y0) * f)} 0")
+                t += 5
+            lines.append(f"{t} 0")
+            t += 600                    # let the scroll throw settle
+    else:
+        for i in range(4):
+            for k in range(121):        # one circle in 600 ms
+                a = 2 * math.pi * k / 120
+                lines.append(f"{t} 1 {round(400 + 150 * math.cos(a))} {round(240 + 150 * math.sin(a))} 0")
+                t += 5
+            lines.append(f"{t} 0")
+            t += 300
+    with open(out, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("trace", help="trace to play, or to write with --generate")
+    parser.add_argument("-p", "--port", help="serial port of the board")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("--lead-ms", type=int, default=200, help="how far ahead of their time lines are sent")
+    parser.add_argument("--timeout", type=float, default=30, help="wait for the end of the run, in [s]")
+    parser.add_argument("--json", help="also write the statistics to this file")
+    parser.add_argument("--generate", choices=["scroll", "draw"], help="write a synthetic trace and exit")
+    args = parser.parse_args()
+
+    if args.generate:
+        generate(args.generate, args.trace)
+        sys.exit(0)
+    if not args.port:
+        parser.error("--port is required to play a trace")
+
+    stats = stream(args.port, args.baud, read_trace(args.trace), args.lead_ms, args.timeout)
+    print(" ".join(f"{k}={v}" for k, v in stats.items()))
+    if args.json:
+        with open(args.json, "w", encoding="utf-8") as f:
+            json.dump(stats, f, indent=4)
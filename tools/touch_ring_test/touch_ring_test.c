@@ -0,0 +1,276 @@
+/*
+ * SPDX-FileCopyrightText: 2026 fmauNeko
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Host-side check for the BSP touch sample ring.
+ *
+ * Checks order, release samples and loss accounting, then draws a fast
+ * circular stroke reported every 5 ms and read back every 33 ms, as LVGL does
+ * while it renders: reading the latest sample only against draining the ring.
+ * Finally races a writer against lock-free readers on real threads to look
+ * for torn samples. Also round-trips samples through the trace format.
+ */
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "bsp/touch_ring.h"
+#include "bsp/touch_trace.h"
+#include "../common/check.h"
+
+static bsp_touch_sample_t make_sample(int64_t time_us, uint8_t count, uint16_t x, uint16_t y)
+{
+    bsp_touch_sample_t smp = { .time_us = time_us, .x = x, .y = y, .count = count };
+    for (uint8_t i = 0; i < count; i++) {
+        smp.points[i].x = (uint16_t)(x + i * 100);
+        smp.points[i].y = y;
+        smp.points[i].strength = (uint16_t)(10 + i);
+        smp.points[i].id = i;
+    }
+    return smp;
+}
+
+static void test_ring(void)
+{
+    const char *name = "ring";
+    static bsp_touch_slot_t slots[8];
+    bsp_touch_ring_t ring;
+    memset(slots, 0, sizeof(slots));
+    bsp_touch_ring_init(&ring, slots, 8);
+
+    bsp_touch_sample_t out[16];
+    uint32_t cursor = 0;
+    uint32_t lost = 0;
+    check(bsp_touch_ring_head(&ring) == 0, name, "empty head");
+    check(bsp_touch_ring_read(&ring, &cursor, out, 16, &lost) == 0 && cursor == 0, name, "empty read");
+
+    /* A two-finger press, a move and the release */
+    bsp_touch_sample_t smp = make_sample(1000, 2, 10, 20);
+    bsp_touch_ring_push(&ring, &smp);
+    smp = make_sample(6000, 2, 15, 25);
+    bsp_touch_ring_push(&ring, &smp);
+    smp = make_sample(11000, 0, 15, 25);
+    bsp_touch_ring_push(&ring, &smp);
+    check(bsp_touch_ring_read(&ring, &cursor, out, 16, &lost) == 3 && cursor == 3 && lost == 0, name, "read");
+    check(out[0].seq == 0 && out[0].count == 2 && out[0].points[1].x == 110 && out[0].points[1].id == 1,
+          name, "points");
+    check(out[1].time_us == 6000 && out[1].x == 15, name, "order");
+    check(out[2].count == 0 && out[2].x == 15 && out[2].y == 25, name, "release at the last position");
+
+    for (int i = 0; i < 20; i++) {
+        smp = make_sample(20000 + i * 5000, 1, (uint16_t)i, 0);
+        bsp_touch_ring_push(&ring, &smp);
+    }
+    const size_t n = bsp_touch_ring_read(&ring, &cursor, out, 16, &lost);
+    check(n == 8 && lost == 12 && cursor == 23, name, "overwritten samples counted as lost");
+    check(out[0].seq == 15 && out[7].seq == 22 && out[7].x == 19, name, "newest kept");
+
+    cursor = bsp_touch_ring_head(&ring);
+    check(bsp_touch_ring_read(&ring, &cursor, out, 16, &lost) == 0, name, "head skips the history");
+    cursor = 1000;
+    check(bsp_touch_ring_read(&ring, &cursor, out, 16, &lost) == 0 && cursor == 23, name, "cursor ahead");
+}
+
+static void test_trace(void)
+{
+    const char *name = "trace";
+    char line[BSP_TOUCH_TRACE_LINE_MAX];
+    bsp_touch_sample_t out;
+
+    /* Every point survives, the time is relative to the start of the recording */
+    bsp_touch_sample_t smp = make_sample(1500000, 5, 700, 479);
+    size_t n = bsp_touch_trace_format(&smp, 1000000, line, sizeof(line));
+    check(n == strlen(line) && strcmp(line, "500 5 700 479 0 800 479 1 900 479 2 1000 479 3 1100 479 4\n") == 0,
+          name, "format");
+    check(bsp_touch_trace_parse(line, &out), name, "parse");
+    check(out.time_us == 500000 && out.count == 5 && out.x == 700 && out.y == 479, name, "round trip");
+    check(out.points[4].x == 1100 && out.points[4].id == 4 && out.points[4].strength == 0, name, "points");
+
+    smp = make_sample(1999999, 0, 10, 20);
+    check(bsp_touch_trace_format(&smp, 1000000, line, sizeof(line)) && strcmp(line, "999 0\n") == 0, name,
+          "release");
+    check(bsp_touch_trace_parse(line, &out) && out.count == 0 && out.time_us == 999000, name, "parse release");
+
+    smp = make_sample(INT64_MAX, 5, 65535, 65535);
+    for (uint8_t i = 0; i < 5; i++) {
+        smp.points[i].x = 65535;
+        smp.points[i].id = 255;
+    }
+    check(bsp_touch_trace_format(&smp, 0, line, sizeof(line)) > 0, name,
+          "longest line fits");
+    check(bsp_touch_trace_format(&smp, 0, line, 8) == 0, name, "too small");
+
+    /* Console logs, comments and bad lines */
+    check(bsp_touch_trace_parse("I (1234) demo: TRACE 42 1 10 20 3", &out) && out.time_us == 42000 &&
+          out.points[0].id == 3, name, "TRACE prefix");
+    check(!bsp_touch_trace_parse("# touch trace", &out), name, "comment");
+    check(!bsp_touch_trace_parse("  \r\n", &out), name, "empty line");
+    check(!bsp_touch_trace_parse("10 2 1 2 0 3", &out), name, "truncated line");
+    check(!bsp_touch_trace_parse("x 1 2 3", &out), name, "not a sample");
+    check(bsp_touch_trace_parse("7 6 1 1 0 2 2 1 3 3 2 4 4 3 5 5 4 6 6 5", &out) && out.count == 5 &&
+          out.points[4].x == 5, name, "extra points ignored");
+}
+
+/* Longest straight segment of the polyline through the points, in pixels */
+static double max_segment(const bsp_touch_sample_t *pts, size_t n)
+{
+    double max = 0;
+    for (size_t i = 1; i < n; i++) {
+        const double d = hypot((double)pts[i].x - pts[i - 1].x, (double)pts[i].y - pts[i - 1].y);
+        max = d > max ? d : max;
+    }
+    return max;
+}
+
+/* A circle of radius 150 px drawn in 300 ms, reported every 5 ms, read every 33 ms */
+static void test_stroke(void)
+{
+    const char *name = "stroke";
+    static bsp_touch_slot_t slots[64];
+    static bsp_touch_sample_t latest[64];
+    static bsp_touch_sample_t drained[128];
+    bsp_touch_ring_t ring;
+    memset(slots, 0, sizeof(slots));
+    bsp_touch_ring_init(&ring, slots, 64);
+
+    size_t n_latest = 0;
+    size_t n_drained = 0;
+    uint32_t cursor = 0;
+    uint32_t lost_total = 0;
+    const int reports = 60;
+    for (int t_ms = 0; t_ms <= reports * 5 + 33; t_ms++) {
+        if (t_ms % 5 == 0 && t_ms / 5 < reports) {
+            const double a = 2.0 * M_PI * t_ms / 300.0;
+            bsp_touch_sample_t smp = make_sample((int64_t)t_ms * 1000, 1, (uint16_t)(400 + 150 * cos(a)),
+                                                 (uint16_t)(240 + 150 * sin(a)));
+            bsp_touch_ring_push(&ring, &smp);
+        }
+        if (t_ms % 33 == 32) {
+            uint32_t lost = 0;
+            const uint32_t head = bsp_touch_ring_head(&ring);
+            uint32_t latest_cursor = head ? head - 1 : 0;
+            bsp_touch_sample_t smp;
+            if (bsp_touch_ring_read(&ring, &latest_cursor, &smp, 1, NULL) == 1
+                    && (n_latest == 0 || smp.seq != latest[n_latest - 1].seq)) {
+                latest[n_latest++] = smp;
+            }
+            n_drained += bsp_touch_ring_read(&ring, &cursor, &drained[n_drained], 128 - n_drained, &lost);
+            lost_total += lost;
+        }
+    }
+
+    check(n_drained == (size_t)reports && lost_total == 0, name, "every report drained");
+    for (size_t i = 1; i < n_drained; i++) {
+        check(drained[i].time_us - drained[i - 1].time_us == 5000, name, "report times kept");
+    }
+    const double seg_latest = max_segment(latest, n_latest);
+    const double seg_drained = max_segment(drained, n_drained);
+    check(seg_drained < seg_latest / 4, name, "drained stroke follows the finger");
+    printf("%-12s latest only: %zu points, longest segment %.0f px; drained: %zu points, longest %.0f px\n",
+           name, n_latest, seg_latest, n_drained, seg_drained);
+}
+
+/* Writer and readers on real threads: a torn copy would break the relation between the fields */
+#define RACE_SAMPLES    (2000000u)
+#define RACE_READERS    (3)
+
+static bsp_touch_slot_t  s_race_slots[16];
+static bsp_touch_ring_t  s_race_ring;
+static volatile int      s_race_done;
+
+typedef struct {
+    uint32_t samples;
+    uint32_t lost;
+    uint32_t torn;
+    uint32_t reordered;
+} race_stats_t;
+
+static void *race_writer(void *arg)
+{
+    (void)arg;
+    for (uint32_t i = 0; i < RACE_SAMPLES; i++) {
+        bsp_touch_sample_t smp = make_sample((int64_t)i * 5, (uint8_t)(i % 6), (uint16_t)i, (uint16_t)~i);
+        bsp_touch_ring_push(&s_race_ring, &smp);
+        for (volatile int spin = 0; spin < 50; spin++) {
+            /* leave the readers time to copy while samples are being written */
+        }
+    }
+    s_race_done = 1;
+    return NULL;
+}
+
+static bool race_consistent(const bsp_touch_sample_t *smp)
+{
+    const uint32_t i = smp->seq;
+    const bsp_touch_sample_t ref = make_sample((int64_t)i * 5, (uint8_t)(i % 6), (uint16_t)i, (uint16_t)~i);
+    return smp->time_us == ref.time_us && smp->count == ref.count && smp->x == ref.x && smp->y == ref.y
+           && memcmp(smp->points, ref.points, sizeof(ref.points)) == 0;
+}
+
+static void *race_reader(void *arg)
+{
+    race_stats_t *st = arg;
+    uint32_t cursor = 0;
+    bsp_touch_sample_t out[8];
+    while (!s_race_done) {
+        uint32_t lost = 0;
+        const size_t n = bsp_touch_ring_read(&s_race_ring, &cursor, out, 8, &lost);
+        st->lost += lost;
+        for (size_t k = 0; k < n; k++) {
+            st->samples++;
+            st->torn += !race_consistent(&out[k]);
+            st->reordered += k > 0 && out[k].seq <= out[k - 1].seq;
+        }
+    }
+    return NULL;
+}
+
+static void test_ring_race(void)
+{
+    const char *name = "ring_race";
+    pthread_t writer;
+    pthread_t readers[RACE_READERS];
+    race_stats_t stats[RACE_READERS];
+    memset(stats, 0, sizeof(stats));
+    memset(s_race_slots, 0, sizeof(s_race_slots));
+    bsp_touch_ring_init(&s_race_ring, s_race_slots, 16);
+    s_race_done = 0;
+
+    for (int i = 0; i < RACE_READERS; i++) {
+        pthread_create(&readers[i], NULL, race_reader, &stats[i]);
+    }
+    pthread_create(&writer, NULL, race_writer, NULL);
+    pthread_join(writer, NULL);
+    for (int i = 0; i < RACE_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    uint32_t samples = 0;
+    uint32_t lost = 0;
+    uint32_t torn = 0;
+    uint32_t reordered = 0;
+    for (int i = 0; i < RACE_READERS; i++) {
+        samples += stats[i].samples;
+        lost += stats[i].lost;
+        torn += stats[i].torn;
+        reordered += stats[i].reordered;
+    }
+    check(torn == 0, name, "torn samples");
+    check(reordered == 0, name, "samples out of order");
+    check(samples > 0, name, "readers saw samples");
+    printf("%-12s %u pushes, %d readers: %u samples read, %u lost to overwrite, %u torn\n", name,
+           RACE_SAMPLES, RACE_READERS, samples, lost, torn);
+}
+
+int main(void)
+{
+    test_ring();
+    test_stroke();
+    test_ring_race();
+    test_trace();
+
+    return check_report();
+}